@@ -30,12 +30,16 @@ limitations under the License.
 #include "oneflow/core/common/shape.h"
 #include "oneflow/core/common/symbol.h"
 #include "oneflow/core/common/util.h"
+#include "oneflow/core/eager/eager_blob_object.h"
+#include "oneflow/core/eager/local_dep_object.h"
 #include "oneflow/core/framework/device.h"
 #include "oneflow/core/framework/dtype.h"
 #include "oneflow/core/framework/multi_client_session_context.h"
 #include "oneflow/core/framework/nn_graph.h"
 #include "oneflow/core/framework/scope_util.h"
 #include "oneflow/core/framework/tensor.h"
+#include "oneflow/core/framework/tensor_impl.h"
+#include "oneflow/core/framework/tensor_storage.h"
 #include "oneflow/core/framework/tensor_tuple.h"
 #include "oneflow/core/framework/tensor_util.h"
 #include "oneflow/core/functional/functional_api.yaml.h"
@@ -53,6 +57,7 @@ limitations under the License.
 #include "oneflow/core/job/session.h"
 #include "oneflow/core/operator/interface_blob_conf.pb.h"
 #include "oneflow/core/operator/op_conf.pb.h"
+#include "oneflow/core/persistence/mapped_file.h"
 #include "oneflow/core/register/logical_blob_id.pb.h"
 
 namespace oneflow_api {
@@ -120,6 +125,31 @@ const std::pair<std::vector<T1>, std::vector<T2>> Unzip(const of::HashMap<T1, T2
   return std::make_pair(vec1, vec2);
 }
 
+// Builds a cpu tensor on the pages of mapped_file, the tensor keeps the mapping alive.
+of::Maybe<of::one::Tensor> MakeTensorOnMappedFile(
+    const std::shared_ptr<of::MappedFile>& mapped_file, const of::Shape& shape,
+    of::DataType data_type, of::Symbol<of::Device> device) {
+  const size_t byte_size = shape.elem_cnt() * of::GetSizeOfDataType(data_type);
+  CHECK_EQ_OR_RETURN(mapped_file->size(), byte_size) << "unexpected variable file size";
+  char* dptr = mapped_file->data();
+  CHECK_EQ_OR_RETURN(reinterpret_cast<uintptr_t>(dptr) % of::kHostAlignSize, 0)
+      << "mapped variable is not aligned";
+  const auto tensor_meta =
+      std::make_shared<of::one::MirroredTensorMeta>(std::make_shared<of::Shape>(shape), data_type,
+                                                    device);
+  auto tensor_data = std::make_shared<of::vm::TensorStorage>();
+  tensor_data->set_blob_dptr(
+      std::unique_ptr<char, std::function<void(char*)>>(dptr, [mapped_file](char*) {}), byte_size);
+  const auto tensor_storage = std::make_shared<of::one::TensorStorage>(tensor_data);
+  const auto tensor_impl = std::make_shared<of::one::EagerMirroredTensorImpl>(
+      tensor_meta, tensor_storage, /*requires_grad=*/false, /*is_leaf=*/true);
+  JUST(tensor_impl->InitEagerBlobObject(JUST(of::GetLocalDepObject4Device(*device))));
+  JUST(tensor_impl->eager_blob_object())->set_last_used_device(device);
+  JUST(JUST(tensor_impl->eager_blob_object())->TryInitBlob());
+  JUST(tensor_impl->eager_blob_object())->mut_blob()->reset_dptr(dptr);
+  return std::shared_ptr<of::one::Tensor>(new of::one::MirroredTensor(tensor_impl));
+}
+
 }  // namespace
 
 class Graph::GraphImpl final {
@@ -137,6 +167,7 @@ class Graph::GraphImpl final {
   std::vector<Tensor> Forward(const std::vector<Tensor>& inputs);
   void set_batch_size(int batch_size) { batch_size_ = batch_size; }
   void enable_tensorrt() { xrt_kind_ = XrtKind::kTensorRT; }
+  void enable_mmap_weights() { mmap_weights_ = true; }
 
  private:
   oneflow::Maybe<void> Compile(const std::vector<Tensor>& inputs);
@@ -151,12 +182,16 @@ class Graph::GraphImpl final {
   bool is_compiled_ = false;
   int batch_size_ = 0;
   XrtKind xrt_kind_ = XrtKind::kNone;
+  bool mmap_weights_ = false;
   Device device_;
   oneflow::Job job_;
 
   oneflow::HashMap<std::string, int> input_name_to_order_;
   oneflow::HashMap<std::string, std::shared_ptr<oneflow::one::Tensor>> output_name_to_tensor_;
   oneflow::HashMap<std::string, std::shared_ptr<oneflow::one::Tensor>> variable_op_name_to_tensor_;
+  // mappings of the non-cpu variables with enable_mmap_weights, released after LoadCheckpoint
+  oneflow::HashMap<std::string, std::shared_ptr<oneflow::MappedFile>>
+      variable_op_name_to_mapped_file_;
   std::shared_ptr<oneflow::one::TensorTuple> output_tensor_tuple_;
   std::shared_ptr<oneflow::one::TensorTuple> parameter_tensor_tuple_;
 };
@@ -200,6 +235,8 @@ void Graph::set_batch_size(int batch_size) { graph_->set_batch_size(batch_size);
 
 void Graph::enable_tensorrt() { graph_->enable_tensorrt(); }
 
+void Graph::enable_mmap_weights() { graph_->enable_mmap_weights(); }
+
 Graph Graph::Load(const std::string& model_path, const Device& device) {
   Graph graph(model_path, device);
   return graph;
@@ -220,11 +257,13 @@ Graph::GraphImpl::GraphImpl(GraphImpl&& graph) noexcept
       is_compiled_(graph.is_compiled_),
       batch_size_(graph.batch_size_),
       xrt_kind_(graph.xrt_kind_),
+      mmap_weights_(graph.mmap_weights_),
       device_(std::move(graph.device_)),
       job_(std::move(graph.job_)),
       input_name_to_order_(std::move(graph.input_name_to_order_)),
       output_name_to_tensor_(std::move(graph.output_name_to_tensor_)),
       variable_op_name_to_tensor_(std::move(graph.variable_op_name_to_tensor_)),
+      variable_op_name_to_mapped_file_(std::move(graph.variable_op_name_to_mapped_file_)),
       output_tensor_tuple_(std::move(graph.output_tensor_tuple_)),
       parameter_tensor_tuple_(std::move(graph.parameter_tensor_tuple_)) {}
 
@@ -235,11 +274,13 @@ Graph::GraphImpl& Graph::GraphImpl::operator=(Graph::GraphImpl&& graph) noexcept
   is_compiled_ = graph.is_compiled_;
   batch_size_ = graph.batch_size_;
   xrt_kind_ = graph.xrt_kind_;
+  mmap_weights_ = graph.mmap_weights_;
   device_ = std::move(graph.device_);
   job_ = std::move(graph.job_);
   input_name_to_order_ = std::move(graph.input_name_to_order_);
   output_name_to_tensor_ = std::move(graph.output_name_to_tensor_);
   variable_op_name_to_tensor_ = std::move(graph.variable_op_name_to_tensor_);
+  variable_op_name_to_mapped_file_ = std::move(graph.variable_op_name_to_mapped_file_);
   output_tensor_tuple_ = std::move(graph.output_tensor_tuple_);
   parameter_tensor_tuple_ = std::move(graph.parameter_tensor_tuple_);
   return *this;
@@ -306,10 +347,20 @@ of::Maybe<void> Graph::GraphImpl::BuildGraph(const std::vector<Tensor>& inputs)
       } else if (op_conf.has_variable_conf()) {
         const of::LazyMode::Guard lazy_mode_disabled_guard{false};
         const of::VariableOpConf& variable_conf = op_conf.variable_conf();
-        variable_op_name_to_tensor_[op_conf.name()] = JUST(of::one::functional::Empty(
-            of::Shape(variable_conf.shape()),
-            JUST(of::DType::Get(static_cast<of::DataType>(variable_conf.data_type()))),
-            *device_.device_));
+        const of::Shape shape(variable_conf.shape());
+        const auto data_type = static_cast<of::DataType>(variable_conf.data_type());
+        if (mmap_weights_) {
+          const auto mapped_file = JUST(of::MappedFile::Open(
+              model_path_ + "/" + op_conf.name() + "/out", of::MmapPrefetchFromEnv()));
+          if (device_.type() == "cpu") {
+            variable_op_name_to_tensor_[op_conf.name()] =
+                JUST(MakeTensorOnMappedFile(mapped_file, shape, data_type, *device_.device_));
+            return of::Maybe<void>::Ok();
+          }
+          variable_op_name_to_mapped_file_[op_conf.name()] = mapped_file;
+        }
+        variable_op_name_to_tensor_[op_conf.name()] = JUST(
+            of::one::functional::Empty(shape, JUST(of::DType::Get(data_type)), *device_.device_));
       }
       return of::Maybe<void>::Ok();
     });
@@ -344,6 +395,22 @@ of::Maybe<void> Graph::GraphImpl::LoadCheckpoint() {
   for (const auto& variable_op_name_and_tensor : variable_op_name_to_tensor_) {
     const auto& variable_op_name = variable_op_name_and_tensor.first;
     const auto& variable_tensor = variable_op_name_and_tensor.second;
+    const size_t byte_size = variable_tensor->shape()->elem_cnt()
+                             * of::GetSizeOfDataType(variable_tensor->dtype()->data_type());
+    if (mmap_weights_) {
+      const auto it = variable_op_name_to_mapped_file_.find(variable_op_name);
+      // cpu variables already alias their mapping
+      if (it == variable_op_name_to_mapped_file_.end()) { continue; }
+      const std::shared_ptr<of::MappedFile> mapped_file = it->second;
+      CHECK_EQ_OR_RETURN(mapped_file->size(), byte_size) << "unexpected variable file size";
+      const auto& callback =
+          std::make_shared<std::function<void(uint64_t)>>([&](uint64_t of_blob_ptr) {
+            CHECK_JUST(
+                of::BlobBufferCopyUtil<void>::From(of_blob_ptr, mapped_file->data(), byte_size));
+          });
+      JUST(of::one::SyncAccessTensorWithTimeOut(variable_tensor, callback, "mut"));
+      continue;
+    }
     const std::string variable_filename = model_path_ + "/" + variable_op_name + "/out";
     const std::string buffer = [&]() {
       std::ifstream variable_file(variable_filename, std::ios::binary);
@@ -354,13 +421,12 @@ of::Maybe<void> Graph::GraphImpl::LoadCheckpoint() {
     }();
     const auto& callback =
         std::make_shared<std::function<void(uint64_t)>>([&](uint64_t of_blob_ptr) {
-          CHECK_JUST(of::BlobBufferCopyUtil<void>::From(
-              of_blob_ptr, buffer.data(),
-              variable_tensor->shape()->elem_cnt()
-                  * of::GetSizeOfDataType(variable_tensor->dtype()->data_type())));
+          CHECK_JUST(of::BlobBufferCopyUtil<void>::From(of_blob_ptr, buffer.data(), byte_size));
         });
     JUST(of::one::SyncAccessTensorWithTimeOut(variable_tensor, callback, "mut"));
   }
+  // the device copies are done, the pages of the files may be dropped
+  variable_op_name_to_mapped_file_.clear();
 
   return of::Maybe<void>::Ok();
 }
@@ -43,6 +43,10 @@ class Graph {
   IValue Forward(const IValue& inputs);
   void set_batch_size(int batch_size);
   void enable_tensorrt();
+  // Maps the variable files instead of reading them. On cpu the variables alias the mapped pages,
+  // so the processes serving one model share a single copy of its weights. Call before the first
+  // Forward.
+  void enable_mmap_weights();
 
   static Graph Load(const std::string& model_path, const Device& device = Device("cpu"));
 
@@ -98,7 +98,23 @@ TEST(Api, graph_cpu_batching_test) {
   Forward(graph, device, 10);
 }
 
+TEST(Api, graph_cpu_mmap_weights_test) {
+  EnvScope scope;
+  Device device("cpu");
+  Graph graph = LoadGraph(device);
+  graph.enable_mmap_weights();
+  Forward(graph, device, 1);
+}
+
 #ifdef WITH_CUDA
+TEST(Api, graph_gpu_mmap_weights_test) {
+  EnvScope scope;
+  Device device("cuda", 0);
+  Graph graph = LoadGraph(device);
+  graph.enable_mmap_weights();
+  Forward(graph, device);
+}
+
 TEST(Api, graph_gpu_batching_test) {
   EnvScope scope;
   Device device("cuda", 0);
@@ -0,0 +1,48 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include "oneflow/api/python/of_api_registry.h"
+#include "oneflow/core/common/throw.h"
+#include "oneflow/core/persistence/async_snapshot_writer.h"
+
+namespace py = pybind11;
+
+namespace oneflow {
+
+ONEFLOW_API_PYBIND11_MODULE("async_snapshot", m) {
+  m.def("write", [](const std::string& root_path, const std::string& key, py::array data) {
+    CHECK_OR_THROW(data.flags() & py::array::c_style) << "snapshot data must be contiguous";
+    const char* ptr = static_cast<const char*>(data.data());
+    const size_t size = data.nbytes();
+    // may block on the cap of staging memory
+    py::gil_scoped_release release;
+    AsyncSnapshotWriter::Get()->Write(root_path, key, ptr, size);
+  });
+  m.def("close", [](const std::string& root_path, const std::string& manifest_name) {
+    AsyncSnapshotWriter::Get()->Close(root_path, manifest_name);
+  });
+  m.def("is_done",
+        [](const std::string& root_path) { return AsyncSnapshotWriter::Get()->IsDone(root_path); });
+  m.def(
+      "wait", [](const std::string& root_path) { AsyncSnapshotWriter::Get()->Wait(root_path); },
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "wait_all", []() { AsyncSnapshotWriter::Get()->WaitAll(); },
+      py::call_guard<py::gil_scoped_release>());
+}
+
+}  // namespace oneflow
@@ -0,0 +1,46 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <pybind11/pybind11.h>
+#include "oneflow/api/python/of_api_registry.h"
+#include "oneflow/core/framework/op_interpreter/eager_trace_cache.h"
+
+namespace py = pybind11;
+
+namespace oneflow {
+
+namespace one {
+
+ONEFLOW_API_PYBIND11_MODULE("eager_trace", m) {
+  m.def("begin_region", [](const std::string& key) {
+    return EagerTraceCache::ThisThread()->BeginRegion(key).GetOrThrow();
+  });
+  m.def("end_region", []() { return EagerTraceCache::ThisThread()->EndRegion().GetOrThrow(); });
+  m.def("clear", []() { EagerTraceCache::ThisThread()->Clear(); });
+  m.def("stats", []() {
+    const EagerTraceCacheStats& stats = EagerTraceCache::ThisThread()->stats();
+    py::dict dict;
+    dict["region_hit_num"] = stats.region_hit_num;
+    dict["region_miss_num"] = stats.region_miss_num;
+    dict["op_hit_num"] = stats.op_hit_num;
+    dict["op_miss_num"] = stats.op_miss_num;
+    dict["invalidation_num"] = stats.invalidation_num;
+    return dict;
+  });
+}
+
+}  // namespace one
+
+}  // namespace oneflow
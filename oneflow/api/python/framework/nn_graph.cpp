@@ -34,6 +34,9 @@ ONEFLOW_API_PYBIND11_MODULE("nn.graph.", m) {
   py::class_<NNGraph, std::shared_ptr<NNGraph>>(m, "CNNGraph")
       .def(py::init<const std::string&>())
       .def_property_readonly("name", &NNGraph::job_name)
+      .def_property_readonly(
+          "serialized_plan",
+          [](const NNGraph& graph) { return py::bytes(graph.plan().SerializeAsString()); })
       .def(
           "register_input_op_names_and_tensors",
           [](NNGraph& graph, const std::vector<std::string>& input_op_names,
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <stack>
 #include <queue>
+#include <deque>
 #include "oneflow/core/autograd/autograd_engine.h"
 #include "oneflow/core/autograd/autograd_meta.h"
 #include "oneflow/core/framework/tensor.h"
@@ -23,8 +24,10 @@ limitations under the License.
 #include "oneflow/core/framework/tensor_tuple.h"
 #include "oneflow/core/framework/tensor_rpc_util.h"
 #include "oneflow/core/autograd/autograd_mode.h"
+#include "oneflow/core/common/blocking_counter.h"
 #include "oneflow/core/eager/dev_vm_dep_object_consume_mode.h"
 #include "oneflow/core/functional/functional.h"
+#include "oneflow/core/thread/thread_pool.h"
 
 namespace oneflow {
 namespace one {
@@ -79,6 +82,35 @@ Maybe<void> CheckConsistentTensorsMeta(const TensorTuple& tensor_tuple) {
   return Maybe<void>::Ok();
 }
 
+// Runs the backward functions of the graph autograd engine which are ready at the same time.
+// Disabled by default, backward functions then run on the thread calling backward.
+ThreadPool* BackwardThreadPool() {
+  static const int64_t thread_num = ParseIntegerFromEnv("ONEFLOW_AUTOGRAD_BACKWARD_THREAD_NUM", 0);
+  if (thread_num <= 0) { return nullptr; }
+  // Leaked, the pool may be used by threads still running at exit.
+  static ThreadPool* thread_pool = new ThreadPool(thread_num);
+  return thread_pool;
+}
+
+// The ComputeInputGrads half of FunctionNode::Apply of one node.
+struct BackwardWork final {
+  explicit BackwardWork(FunctionNode* node) : node(node), is_async(false), done_counter(1) {}
+
+  void Compute(bool create_graph) {
+    is_applied.reset(new Maybe<bool>(node->ComputeInputGrads(create_graph, &input_grads)));
+    done_counter.Decrease();
+  }
+  void WaitDone() {
+    if (is_async) { done_counter.WaitUntilCntEqualZero(); }
+  }
+
+  FunctionNode* node;
+  TensorTuple input_grads;
+  std::unique_ptr<Maybe<bool>> is_applied;
+  bool is_async;
+  BlockingCounter done_counter;
+};
+
 }  // namespace
 
 Maybe<void> AutogradEngine::RunBackwardAndSaveGrads4LeafTensorIf(const TensorTuple& outputs,
@@ -159,12 +191,21 @@ void StackFunctionNode::ReleaseData() {
 }
 
 Maybe<bool> FunctionNode::Apply(bool create_graph) {
+  TensorTuple input_grads;
+  if (/*bool not_ready_to_apply=*/!JUST(ComputeInputGrads(create_graph, &input_grads))) {
+    return false;
+  }
+  JUST(PushInputGrads(input_grads));
+  return true;
+}
+
+Maybe<bool> FunctionNode::ComputeInputGrads(bool create_graph, TensorTuple* input_grads) {
   CHECK_NOTNULL_OR_RETURN(backward_fn_.get())
       << "This FunctionNode with name `" << GetOpTypeName() << "` has been released.\n"
       << "Maybe you try to backward through the node a second time. Specify retain_graph=True when "
          "calling .backward() or autograd.grad() the first time.";
   if (!IsReadyToRun(output_meta_data_)) { return false; }
-  TensorTuple input_grads(input_meta_data_.size());
+  input_grads->resize(input_meta_data_.size());
   TensorTuple output_grads(output_meta_data_.size());
   for (int i = 0; i < output_meta_data_.size(); ++i) {
     if (output_meta_data_.at(i)->current_grad()->Empty()) {
@@ -173,7 +214,11 @@ Maybe<bool> FunctionNode::Apply(bool create_graph) {
       output_grads.at(i) = JUST(output_meta_data_.at(i)->current_grad()->GetAccTensor());
     }
   }
-  JUST((*backward_fn_)(output_grads, &input_grads, create_graph));
+  JUST((*backward_fn_)(output_grads, input_grads, create_graph));
+  return true;
+}
+
+Maybe<void> FunctionNode::PushInputGrads(const TensorTuple& input_grads) {
   for (int i = 0; i < input_meta_data_.size(); ++i) {
     if (input_grads.at(i)) {
       CHECK_NOTNULL_OR_RETURN(input_meta_data_.at(i))
@@ -184,7 +229,7 @@ Maybe<bool> FunctionNode::Apply(bool create_graph) {
       JUST(input_meta_data_.at(i)->current_grad()->PushPartialTensor(input_grads.at(i)));
     }
   }
-  return true;
+  return Maybe<void>::Ok();
 }
 
 void StackAutogradEngine::ClearEngine() { node_list_.clear(); }
@@ -399,19 +444,49 @@ Maybe<void> GraphTask::ComputeDependenciesAndPruneNode(const TensorTuple& inputs
 }
 
 Maybe<void> GraphTask::Apply(bool save_grad_for_leaf) {
-  std::queue<FunctionNode*> queue;
+  // Building the graph of a higher order backward sets grad_fn nodes of shared tensors.
+  ThreadPool* thread_pool = create_graph_ ? nullptr : BackwardThreadPool();
+  std::queue<FunctionNode*> ready_queue;
   for (FunctionNode* node : roots_) {
-    if (dependencies_[node] == 0) { queue.push(node); }
+    if (dependencies_[node] == 0) { ready_queue.push(node); }
   }
 
-  while (!queue.empty()) {
-    FunctionNode* node = queue.front();
-    queue.pop();
-    if (!need_execute_.empty() && need_execute_.find(node) == need_execute_.end()) {
-      node->ReleaseOutTensorArgs();
-      continue;
+  // Works are committed in the order they are launched, which is the order of the former serial
+  // queue. So gradients are accumulated in the same order however many threads compute them.
+  std::deque<std::unique_ptr<BackwardWork>> launched_works;
+  // Launched works refer to this frame, wait for them before returning an error.
+  struct WaitLaunchedWorksGuard {
+    ~WaitLaunchedWorksGuard() {
+      for (const auto& work : *launched_works) { work->WaitDone(); }
+    }
+    std::deque<std::unique_ptr<BackwardWork>>* launched_works;
+  } wait_launched_works_guard{&launched_works};
+
+  while (!ready_queue.empty() || !launched_works.empty()) {
+    while (!ready_queue.empty()) {
+      FunctionNode* node = ready_queue.front();
+      ready_queue.pop();
+      if (!need_execute_.empty() && need_execute_.find(node) == need_execute_.end()) {
+        node->ReleaseOutTensorArgs();
+        continue;
+      }
+      launched_works.emplace_back(new BackwardWork(node));
+      BackwardWork* work = launched_works.back().get();
+      // The last ready node is computed by this thread instead of waiting idle.
+      if (thread_pool == nullptr || node->runs_on_caller_thread() || ready_queue.empty()) {
+        work->Compute(create_graph_);
+      } else {
+        const bool create_graph = create_graph_;
+        work->is_async = true;
+        thread_pool->AddWork([work, create_graph]() { work->Compute(create_graph); });
+      }
     }
-    if (/*bool not_ready_to_apply=*/!(JUST(node->Apply(create_graph_)))) { continue; }
+    std::unique_ptr<BackwardWork> work = std::move(launched_works.front());
+    launched_works.pop_front();
+    work->WaitDone();
+    FunctionNode* node = work->node;
+    if (/*bool not_ready_to_apply=*/!JUST(*work->is_applied)) { continue; }
+    JUST(node->PushInputGrads(work->input_grads));
     if (save_grad_for_leaf) { JUST(node->AccGrad4LeafTensor(create_graph_)); }
     JUST(node->AccGrad4RetainGradTensor());
     node->ReleaseOutTensorArgs();
@@ -420,7 +495,7 @@ Maybe<void> GraphTask::Apply(bool save_grad_for_leaf) {
     for (const auto& next_grad_fn : *(node->GetNextFunctions())) {
       FunctionNode* next_node = next_grad_fn.get();
       dependencies_[next_node] -= 1;
-      if (dependencies_[next_node] == 0) { queue.push(next_node); }
+      if (dependencies_[next_node] == 0) { ready_queue.push(next_node); }
     }
   }
   return Maybe<void>::Ok();
@@ -37,6 +37,11 @@ class FunctionNode {
   virtual ~FunctionNode() = default;
 
   Maybe<bool> Apply(bool create_graph);
+  // The two halves of Apply. ComputeInputGrads only reads the grads of this node's outputs, so
+  // nodes which are ready at the same time may compute concurrently. PushInputGrads accumulates
+  // into the grads of the next functions and must be called in a deterministic order.
+  Maybe<bool> ComputeInputGrads(bool create_graph, TensorTuple* input_grads);
+  Maybe<void> PushInputGrads(const TensorTuple& input_grads);
   Maybe<void> AccGrad4LeafTensor(bool create_graph);
   Maybe<void> AccGrad4RetainGradTensor();
   void ReleaseOutTensorArgs();
@@ -49,14 +54,20 @@ class FunctionNode {
     return next_functions_;
   }
   const std::string& GetOpTypeName() const { return op_type_name_; }
+  // Backward functions written in python or working on consistent tensors are not run by the
+  // backward thread pool.
+  bool runs_on_caller_thread() const { return runs_on_caller_thread_; }
+  void set_runs_on_caller_thread(bool val) { runs_on_caller_thread_ = val; }
 
  protected:
   explicit FunctionNode(const std::string& op_type_name)
       : op_type_name_(op_type_name),
-        next_functions_(new std::vector<std::shared_ptr<FunctionNode>>{}) {}
+        next_functions_(new std::vector<std::shared_ptr<FunctionNode>>{}),
+        runs_on_caller_thread_(false) {}
 
   const std::string op_type_name_;
   std::shared_ptr<std::vector<std::shared_ptr<FunctionNode>>> next_functions_;
+  bool runs_on_caller_thread_;
 
   std::vector<std::shared_ptr<AutogradMeta>> input_meta_data_;
   std::vector<std::shared_ptr<AutogradMeta>> output_meta_data_;
@@ -22,7 +22,7 @@ limitations under the License.
 #include "oneflow/core/common/data_type_seq.h"
 #include "oneflow/core/common/balanced_splitter.h"
 #include "oneflow/core/rpc/include/global_process_ctx.h"
-#include "oneflow/core/thread/thread_manager.h"
+#include "oneflow/core/ep/cpu/cpu_parallel.h"
 #include "oneflow/core/job/eager_nccl_comm_manager.h"
 #include "oneflow/core/ep/cuda/cuda_stream.h"
 
@@ -50,104 +50,308 @@ int64_t RingDecrease(int64_t n, int64_t size) { return (n - 1 + size) % size; }
 
 int64_t RingIncrease(int64_t n, int64_t size) { return (n + 1 + size) % size; }
 
+// Parts of the ring algorithms are split into sub-chunks of about this many bytes, the transfer of
+// the next sub-chunk overlaps the reduction of the current one. Must be the same on all ranks.
+size_t RingChunkBytes() {
+  static const size_t ring_chunk_bytes =
+      std::max<int64_t>(ParseIntegerFromEnv("ONEFLOW_CCL_CPU_RING_CHUNK_BYTES", 1 << 20), 1);
+  return ring_chunk_bytes;
+}
+
+// All-reduces not larger than this use recursive doubling, which takes log2(n) rounds instead of
+// the 2 * (n - 1) rounds of the ring. Must be the same on all ranks.
+size_t RecursiveDoublingMaxBytes() {
+  static const size_t recursive_doubling_max_bytes =
+      ParseIntegerFromEnv("ONEFLOW_CCL_CPU_RECURSIVE_DOUBLING_MAX_BYTES", 64 << 10);
+  return recursive_doubling_max_bytes;
+}
+
+constexpr size_t kVecReduceGrainSize = 32768;
+
+template<typename T, ReduceType reduce_type>
+struct ReduceFunctor;
+
+template<typename T>
+struct ReduceFunctor<T, kSum> {
+  static T Invoke(T a, T b) { return static_cast<T>(a + b); }
+};
+
+template<typename T>
+struct ReduceFunctor<T, kMax> {
+  static T Invoke(T a, T b) { return a < b ? b : a; }
+};
+
+template<typename T>
+struct ReduceFunctor<T, kMin> {
+  static T Invoke(T a, T b) { return b < a ? b : a; }
+};
+
 template<typename T>
-void VecAdd(size_t size, T* out, const T* in0, const T* in1) {
-  size_t thread_num = Global<ThreadPool>::Get()->thread_num();
-  BalancedSplitter bs(size, thread_num);
-  MultiThreadLoop(thread_num, [&](size_t thread_idx) {
-    size_t end = bs.At(thread_idx).end();
-    for (size_t i = bs.At(thread_idx).begin(); i < end; ++i) { out[i] = in0[i] + in1[i]; }
+struct ReduceFunctor<T, kProd> {
+  static T Invoke(T a, T b) { return static_cast<T>(a * b); }
+};
+
+template<typename T, ReduceType reduce_type>
+void VecReduce(size_t size, T* out, const T* in0, const T* in1) {
+  ep::CpuParallelFor(size, kVecReduceGrainSize, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      out[i] = ReduceFunctor<T, reduce_type>::Invoke(in0[i], in1[i]);
+    }
   });
 }
 
-}  // namespace
+struct TransferBuffer {
+  void* ptr;
+  size_t size;
+};
+
+using PrepareBufferFn = std::function<Maybe<void>(void**, std::size_t*, std::function<void()>*)>;
+
+PrepareBufferFn MakePrepareBuffer(const TransferBuffer& transfer_buffer) {
+  return [transfer_buffer](void** buffer, std::size_t* size,
+                           std::function<void()>* Cb) -> Maybe<void> {
+    *buffer = transfer_buffer.ptr;
+    *size = transfer_buffer.size;
+    *Cb = [] {};
+    return Maybe<void>::Ok();
+  };
+}
+
+Maybe<void> UnimplementedPrepareBuffer(void** buffer, std::size_t* size,
+                                       std::function<void()>* Cb) {
+  UNIMPLEMENTED_THEN_RETURN();
+}
+
+// Posts the send of transfer_buffer by Post and returns the transport ctx in ctx, which is nullptr
+// for empty buffers. The buffer must be kept alive until the ctx is waited by WaitTransfer.
+Maybe<void> AsyncSend(const TransportToken& transport_token, const TransferBuffer& transfer_buffer,
+                      const std::function<Maybe<void>(AsyncTransportCtx*)>& Post,
+                      std::unique_ptr<AsyncTransportCtx>* ctx) {
+  ctx->reset();
+  if (transfer_buffer.size == 0) { return Maybe<void>::Ok(); }
+  ctx->reset(new NaiveAsyncTransportCtx(transport_token, MakePrepareBuffer(transfer_buffer),
+                                        PrepareBufferFn(&UnimplementedPrepareBuffer)));
+  return Post(ctx->get());
+}
+
+// Same as AsyncSend for receiving.
+Maybe<void> AsyncRecv(const TransportToken& transport_token, const TransferBuffer& transfer_buffer,
+                      const std::function<Maybe<void>(AsyncTransportCtx*)>& Post,
+                      std::unique_ptr<AsyncTransportCtx>* ctx) {
+  ctx->reset();
+  if (transfer_buffer.size == 0) { return Maybe<void>::Ok(); }
+  ctx->reset(new NaiveAsyncTransportCtx(transport_token,
+                                        PrepareBufferFn(&UnimplementedPrepareBuffer),
+                                        MakePrepareBuffer(transfer_buffer)));
+  return Post(ctx->get());
+}
+
+Maybe<void> WaitTransfer(std::unique_ptr<AsyncTransportCtx>* ctx) {
+  if (*ctx) {
+    JUST(TransportUtil::WaitUntilDoneOrTimeout(**ctx, TransportUtil::TimeoutSeconds()));
+    ctx->reset();
+  }
+  return Maybe<void>::Ok();
+}
+
+int64_t RingChunkNum(size_t max_part_bytes) {
+  return std::max<int64_t>((max_part_bytes + RingChunkBytes() - 1) / RingChunkBytes(), 1);
+}
+
+// Returns the range of the sub-chunk chunk_id of part.
+Range RingChunk(const Range& part, int64_t chunk_num, int64_t chunk_id) {
+  const Range range = BalancedSplitter(part.size(), chunk_num).At(chunk_id);
+  return Range(part.begin() + range.begin(), part.begin() + range.end());
+}
+
+// Runs step_num steps of a ring whose parts are split into chunk_num sub-chunks. At step i the
+// sub-chunk c given by SendChunk(i, c) is sent to the next rank and the one given by
+// RecvChunk(i, c) is received from the previous rank, then OnRecv(i, c) is called. The transfers
+// of sub-chunk c of step i + 1 are posted right after OnRecv(i, c), so they overlap OnRecv of the
+// other sub-chunks. The send of sub-chunk c of step i - 1 is done before OnRecv(i, c), so OnRecv
+// may overwrite it.
+Maybe<void> PipelinedRingTransfer(Symbol<RankGroup> rank_group,
+                                  const TransportToken& transport_token, int64_t step_num,
+                                  int64_t chunk_num,
+                                  const std::function<TransferBuffer(int64_t, int64_t)>& SendChunk,
+                                  const std::function<TransferBuffer(int64_t, int64_t)>& RecvChunk,
+                                  const std::function<Maybe<void>(int64_t, int64_t)>& OnRecv) {
+  const auto& SendToNext = [&](AsyncTransportCtx* ctx) -> Maybe<void> {
+    return TransportUtil::SendToNextRankInRing(rank_group, transport_token, ctx);
+  };
+  const auto& RecvFromPrev = [&](AsyncTransportCtx* ctx) -> Maybe<void> {
+    return TransportUtil::ReceiveFromPrevRankInRing(rank_group, transport_token, ctx);
+  };
+  std::vector<std::unique_ptr<AsyncTransportCtx>> prev_send_ctxs(chunk_num);
+  std::vector<std::unique_ptr<AsyncTransportCtx>> send_ctxs(chunk_num);
+  std::vector<std::unique_ptr<AsyncTransportCtx>> recv_ctxs(chunk_num);
+  if (step_num == 0) { return Maybe<void>::Ok(); }
+  for (int64_t chunk_id = 0; chunk_id < chunk_num; ++chunk_id) {
+    JUST(AsyncSend(transport_token, SendChunk(0, chunk_id), SendToNext, &send_ctxs[chunk_id]));
+    JUST(AsyncRecv(transport_token, RecvChunk(0, chunk_id), RecvFromPrev, &recv_ctxs[chunk_id]));
+  }
+  for (int64_t step = 0; step < step_num; ++step) {
+    for (int64_t chunk_id = 0; chunk_id < chunk_num; ++chunk_id) {
+      JUST(WaitTransfer(&recv_ctxs[chunk_id]));
+      JUST(WaitTransfer(&prev_send_ctxs[chunk_id]));
+      JUST(OnRecv(step, chunk_id));
+      if (step + 1 < step_num) {
+        prev_send_ctxs[chunk_id] = std::move(send_ctxs[chunk_id]);
+        JUST(AsyncSend(transport_token, SendChunk(step + 1, chunk_id), SendToNext,
+                       &send_ctxs[chunk_id]));
+        JUST(AsyncRecv(transport_token, RecvChunk(step + 1, chunk_id), RecvFromPrev,
+                       &recv_ctxs[chunk_id]));
+      }
+    }
+  }
+  for (int64_t chunk_id = 0; chunk_id < chunk_num; ++chunk_id) {
+    JUST(WaitTransfer(&prev_send_ctxs[chunk_id]));
+    JUST(WaitTransfer(&send_ctxs[chunk_id]));
+  }
+  return Maybe<void>::Ok();
+}
 
+// Recursive doubling over the largest power of two of ranks, the remaining ranks fold their data
+// into the first ones at the beginning and get the result back at the end. All reduce types are
+// commutative, so all ranks end up with the same result.
 template<typename T, ReduceType reduce_type>
-struct DtypeAllReduce;
+Maybe<void> RecursiveDoublingAllReduce(const T* in, T* out, size_t elem_cnt,
+                                       Symbol<ParallelDesc> parallel_desc, int64_t parallel_id) {
+  const int64_t parallel_num = parallel_desc->parallel_num();
+  const TransferBuffer out_buffer{out, elem_cnt * sizeof(T)};
+  if (out != in) { std::memcpy(out, in, out_buffer.size); }
+  std::vector<T> recv_buffer(elem_cnt);
+  const TransferBuffer recv_transfer_buffer{recv_buffer.data(), out_buffer.size};
+  TransportToken transport_token =
+      JUST(TransportToken::NewTransportToken(kTransportTokenTypeData));
+  const auto& Transfer = [&](bool is_send, int64_t peer_parallel_id,
+                             const TransferBuffer& transfer_buffer) -> Maybe<void> {
+    const int64_t peer_rank = JUST(parallel_desc->MachineId4ParallelId(peer_parallel_id));
+    std::unique_ptr<AsyncTransportCtx> ctx;
+    if (is_send) {
+      JUST(AsyncSend(
+          transport_token, transfer_buffer,
+          [&](AsyncTransportCtx* transport_ctx) -> Maybe<void> {
+            return TransportUtil::SendDataToRank(peer_rank, transport_token, transport_ctx);
+          },
+          &ctx));
+    } else {
+      JUST(AsyncRecv(
+          transport_token, transfer_buffer,
+          [&](AsyncTransportCtx* transport_ctx) -> Maybe<void> {
+            return TransportUtil::ReceiveDataFromRank(peer_rank, transport_token, transport_ctx);
+          },
+          &ctx));
+    }
+    return WaitTransfer(&ctx);
+  };
+  int64_t power_of_two_num = 1;
+  while (power_of_two_num * 2 <= parallel_num) { power_of_two_num *= 2; }
+  const int64_t remaining_num = parallel_num - power_of_two_num;
+  if (parallel_id >= power_of_two_num) {
+    JUST(Transfer(true, parallel_id - power_of_two_num, out_buffer));
+    JUST(Transfer(false, parallel_id - power_of_two_num, out_buffer));
+    return Maybe<void>::Ok();
+  }
+  if (parallel_id < remaining_num) {
+    JUST(Transfer(false, parallel_id + power_of_two_num, recv_transfer_buffer));
+    VecReduce<T, reduce_type>(elem_cnt, out, out, recv_buffer.data());
+  }
+  for (int64_t mask = 1; mask < power_of_two_num; mask *= 2) {
+    const int64_t peer_rank = JUST(parallel_desc->MachineId4ParallelId(parallel_id ^ mask));
+    std::unique_ptr<AsyncTransportCtx> send_ctx;
+    std::unique_ptr<AsyncTransportCtx> recv_ctx;
+    JUST(AsyncSend(
+        transport_token, out_buffer,
+        [&](AsyncTransportCtx* ctx) -> Maybe<void> {
+          return TransportUtil::SendDataToRank(peer_rank, transport_token, ctx);
+        },
+        &send_ctx));
+    JUST(AsyncRecv(
+        transport_token, recv_transfer_buffer,
+        [&](AsyncTransportCtx* ctx) -> Maybe<void> {
+          return TransportUtil::ReceiveDataFromRank(peer_rank, transport_token, ctx);
+        },
+        &recv_ctx));
+    JUST(WaitTransfer(&send_ctx));
+    JUST(WaitTransfer(&recv_ctx));
+    VecReduce<T, reduce_type>(elem_cnt, out, out, recv_buffer.data());
+  }
+  if (parallel_id < remaining_num) {
+    JUST(Transfer(true, parallel_id + power_of_two_num, out_buffer));
+  }
+  return Maybe<void>::Ok();
+}
 
-template<typename T>
-struct DtypeAllReduce<T, kSum> {
+// Ring reduce-scatter followed by ring all-gather, both pipelined by sub-chunks.
+template<typename T, ReduceType reduce_type>
+Maybe<void> RingAllReduce(const T* in, T* out, size_t elem_cnt, Symbol<ParallelDesc> parallel_desc,
+                          int64_t parallel_id) {
+  const int64_t parallel_num = parallel_desc->parallel_num();
+  BalancedSplitter bs(elem_cnt, parallel_num);
+  const int64_t chunk_num = RingChunkNum(bs.At(0).size() * sizeof(T));
+  const int64_t max_chunk_size = BalancedSplitter(bs.At(0).size(), chunk_num).At(0).size();
+  std::vector<T> recv_buffer(max_chunk_size * chunk_num);
+  const auto& rank_group = JUST(RankGroup::New(parallel_desc));
+  TransportToken transport_token =
+      JUST(TransportToken::NewTransportToken(kTransportTokenTypeData));
+  const auto& Chunk = [&](int64_t part_offset, int64_t chunk_id) {
+    const int64_t part_id =
+        ((parallel_id + part_offset) % parallel_num + parallel_num) % parallel_num;
+    return RingChunk(bs.At(part_id), chunk_num, chunk_id);
+  };
+  // After the reduce-scatter, part parallel_id + 1 of out is reduced.
+  JUST(PipelinedRingTransfer(
+      rank_group, transport_token, parallel_num - 1, chunk_num,
+      [&](int64_t step, int64_t chunk_id) {
+        const Range range = Chunk(-step, chunk_id);
+        const T* send_ptr = step == 0 ? in : out;
+        return TransferBuffer{const_cast<T*>(send_ptr) + range.begin(), range.size() * sizeof(T)};
+      },
+      [&](int64_t step, int64_t chunk_id) {
+        const Range range = Chunk(-step - 1, chunk_id);
+        return TransferBuffer{recv_buffer.data() + chunk_id * max_chunk_size,
+                              range.size() * sizeof(T)};
+      },
+      [&](int64_t step, int64_t chunk_id) -> Maybe<void> {
+        const Range range = Chunk(-step - 1, chunk_id);
+        VecReduce<T, reduce_type>(range.size(), out + range.begin(), in + range.begin(),
+                                  recv_buffer.data() + chunk_id * max_chunk_size);
+        return Maybe<void>::Ok();
+      }));
+  JUST(PipelinedRingTransfer(
+      rank_group, transport_token, parallel_num - 1, chunk_num,
+      [&](int64_t step, int64_t chunk_id) {
+        const Range range = Chunk(1 - step, chunk_id);
+        return TransferBuffer{out + range.begin(), range.size() * sizeof(T)};
+      },
+      [&](int64_t step, int64_t chunk_id) {
+        const Range range = Chunk(-step, chunk_id);
+        return TransferBuffer{out + range.begin(), range.size() * sizeof(T)};
+      },
+      [](int64_t step, int64_t chunk_id) -> Maybe<void> { return Maybe<void>::Ok(); }));
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+template<typename T, ReduceType reduce_type>
+struct DtypeAllReduce {
   static Maybe<void> Call(const void* void_in, void* void_out, size_t elem_cnt,
                           Symbol<ParallelDesc> parallel_desc) {
     const T* in = reinterpret_cast<const T*>(void_in);
     T* out = reinterpret_cast<T*>(void_out);
-    int64_t parallel_num = parallel_desc->parallel_num();
-    BalancedSplitter bs(elem_cnt, parallel_num);
-    std::vector<T> recv_buffer(bs.At(0).size());
     Optional<int64_t> parallel_id;
     JUST(GetTensorDevice4CurrentProcessCtx(parallel_desc, &parallel_id));
-    const auto& rank_group = JUST(RankGroup::New(parallel_desc));
-    TransportToken transport_token =
-        JUST(TransportToken::NewTransportToken(kTransportTokenTypeData));
-    for (int64_t i = 0, part_id = JUST(parallel_id); i < parallel_num - 1;
-         ++i, part_id = RingDecrease(part_id, parallel_num)) {
-      int64_t send_part_id = part_id;
-      const T* send_ptr = nullptr;
-      if (i == 0) {
-        send_ptr = &in[bs.At(send_part_id).begin()];
-      } else {
-        send_ptr = &out[bs.At(send_part_id).begin()];
-      }
-      size_t send_size = bs.At(send_part_id).size();
-      int64_t recv_part_id = RingDecrease(part_id, parallel_num);
-      T* recv_ptr = recv_buffer.data();
-      size_t recv_size = bs.At(recv_part_id).size();
-      NaiveAsyncTransportCtx ctx(
-          transport_token,
-          [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-            *buffer = const_cast<T*>(send_ptr);
-            *size = send_size * sizeof(T);
-            *Cb = [] {};
-            return Maybe<void>::Ok();
-          },
-          [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-            *buffer = recv_ptr;
-            *size = recv_size * sizeof(T);
-            *Cb = [] {};
-            return Maybe<void>::Ok();
-          });
-      if (send_size > 0) {
-        JUST(TransportUtil::SendToNextRankInRing(rank_group, transport_token, &ctx));
-      }
-      if (recv_size > 0) {
-        JUST(TransportUtil::ReceiveFromPrevRankInRing(rank_group, transport_token, &ctx));
-      }
-      JUST(TransportUtil::WaitUntilDoneOrTimeout(ctx, TransportUtil::TimeoutSeconds()));
-      const T* cur_in = &in[bs.At(recv_part_id).begin()];
-      T* cur_out = &out[bs.At(recv_part_id).begin()];
-      if (recv_size > 0) { VecAdd(recv_size, cur_out, cur_in, recv_ptr); }
+    if (parallel_desc->parallel_num() == 1) {
+      if (out != in) { std::memcpy(out, in, elem_cnt * sizeof(T)); }
+      return Maybe<void>::Ok();
     }
-    for (int64_t i = 0, part_id = RingIncrease(JUST(parallel_id), parallel_num);
-         i < parallel_num - 1; ++i, part_id = RingDecrease(part_id, parallel_num)) {
-      int64_t send_part_id = part_id;
-      const T* send_ptr = &out[bs.At(send_part_id).begin()];
-      size_t send_size = bs.At(send_part_id).size();
-      int64_t recv_part_id = RingDecrease(part_id, parallel_num);
-      T* recv_ptr = &out[bs.At(recv_part_id).begin()];
-      size_t recv_size = bs.At(recv_part_id).size();
-      NaiveAsyncTransportCtx ctx(
-          transport_token,
-          [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-            *buffer = const_cast<T*>(send_ptr);
-            *size = send_size * sizeof(T);
-            *Cb = [] {};
-            return Maybe<void>::Ok();
-          },
-          [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-            *buffer = recv_ptr;
-            *size = recv_size * sizeof(T);
-            *Cb = [] {};
-            return Maybe<void>::Ok();
-          });
-      if (send_size > 0) {
-        JUST(TransportUtil::SendToNextRankInRing(rank_group, transport_token, &ctx));
-      }
-      if (recv_size > 0) {
-        JUST(TransportUtil::ReceiveFromPrevRankInRing(rank_group, transport_token, &ctx));
-      }
-      JUST(TransportUtil::WaitUntilDoneOrTimeout(ctx, TransportUtil::TimeoutSeconds()));
+    if (elem_cnt * sizeof(T) <= RecursiveDoublingMaxBytes()) {
+      return RecursiveDoublingAllReduce<T, reduce_type>(in, out, elem_cnt, parallel_desc,
+                                                        JUST(parallel_id));
     }
-    return Maybe<void>::Ok();
+    return RingAllReduce<T, reduce_type>(in, out, elem_cnt, parallel_desc, JUST(parallel_id));
   }
 };
 
@@ -166,10 +370,7 @@ Maybe<void> AllReduce<DeviceType::kCPU>(const void* in, void* out, size_t elem_c
 }
 
 template<typename T, ReduceType reduce_type>
-struct DtypeReduceScatter;
-
-template<typename T>
-struct DtypeReduceScatter<T, kSum> {
+struct DtypeReduceScatter {
   static Maybe<void> Call(const void* void_in, void* void_out, size_t elem_cnt,
                           Symbol<ParallelDesc> parallel_desc) {
     const T* in = reinterpret_cast<const T*>(void_in);
@@ -180,49 +381,49 @@ struct DtypeReduceScatter<T, kSum> {
     const auto& opt_parallel_id = JUST(GetParallelId4CurrentProcessCtx(parallel_desc));
     CHECK_OR_RETURN(opt_parallel_id->has_value());
     int64_t parallel_id = JUST(*opt_parallel_id);
+    if (parallel_num == 1) {
+      if (out != in) { std::memcpy(out, in, elem_cnt * sizeof(T)); }
+      return Maybe<void>::Ok();
+    }
 
-    std::vector<T> recv_buffer(bs.At(0).size());
+    const int64_t chunk_num = RingChunkNum(elem_cnt * sizeof(T));
+    const int64_t max_chunk_size = BalancedSplitter(elem_cnt, chunk_num).At(0).size();
+    std::vector<T> recv_buffer(max_chunk_size * chunk_num);
+    // Partial results are reduced into out and tmp_buffer by turns, so that a sub-chunk is not
+    // overwritten while it is sent and the last step reduces into out.
+    std::vector<T> tmp_buffer(parallel_num > 2 ? elem_cnt : 0);
+    const auto& PartialResult = [&](int64_t step) {
+      return (parallel_num - 2 - step) % 2 == 0 ? out : tmp_buffer.data();
+    };
+    const auto& PartId = [&](int64_t part_offset) {
+      return ((parallel_id + part_offset) % parallel_num + parallel_num) % parallel_num;
+    };
     const auto& rank_group = JUST(RankGroup::New(parallel_desc));
 
     TransportToken transport_token =
         JUST(TransportToken::NewTransportToken(kTransportTokenTypeData));
-    for (int64_t i = 0, part_id = RingDecrease(parallel_id, parallel_num); i < parallel_num - 1;
-         ++i, part_id = RingDecrease(part_id, parallel_num)) {
-      int64_t send_part_id = part_id;
-      const T* send_ptr = nullptr;
-      if (i == 0) {
-        send_ptr = &in[bs.At(send_part_id).begin()];
-      } else {
-        send_ptr = out;
-      }
-      size_t send_size = bs.At(send_part_id).size();
-      int64_t recv_part_id = RingDecrease(part_id, parallel_num);
-      T* recv_ptr = recv_buffer.data();
-      size_t recv_size = bs.At(recv_part_id).size();
-      NaiveAsyncTransportCtx ctx(
-          transport_token,
-          [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-            *buffer = const_cast<T*>(send_ptr);
-            *size = send_size * sizeof(T);
-            *Cb = [] {};
-            return Maybe<void>::Ok();
-          },
-          [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-            *buffer = recv_ptr;
-            *size = recv_size * sizeof(T);
-            *Cb = [] {};
-            return Maybe<void>::Ok();
-          });
-      if (send_size > 0) {
-        JUST(TransportUtil::SendToNextRankInRing(rank_group, transport_token, &ctx));
-      }
-      if (recv_size > 0) {
-        JUST(TransportUtil::ReceiveFromPrevRankInRing(rank_group, transport_token, &ctx));
-      }
-      JUST(TransportUtil::WaitUntilDoneOrTimeout(ctx, TransportUtil::TimeoutSeconds()));
-      const T* cur_in = &in[bs.At(recv_part_id).begin()];
-      if (recv_size > 0) { VecAdd(recv_size, out, cur_in, recv_ptr); }
-    }
+    JUST(PipelinedRingTransfer(
+        rank_group, transport_token, parallel_num - 1, chunk_num,
+        [&](int64_t step, int64_t chunk_id) {
+          const Range range = RingChunk(Range(0, elem_cnt), chunk_num, chunk_id);
+          const T* send_ptr =
+              step == 0 ? &in[bs.At(PartId(-1)).begin()] : PartialResult(step - 1);
+          return TransferBuffer{const_cast<T*>(send_ptr) + range.begin(),
+                                range.size() * sizeof(T)};
+        },
+        [&](int64_t step, int64_t chunk_id) {
+          const Range range = RingChunk(Range(0, elem_cnt), chunk_num, chunk_id);
+          return TransferBuffer{recv_buffer.data() + chunk_id * max_chunk_size,
+                                range.size() * sizeof(T)};
+        },
+        [&](int64_t step, int64_t chunk_id) -> Maybe<void> {
+          const Range range = RingChunk(Range(0, elem_cnt), chunk_num, chunk_id);
+          const T* cur_in = &in[bs.At(PartId(-step - 2)).begin()];
+          VecReduce<T, reduce_type>(range.size(), PartialResult(step) + range.begin(),
+                                    cur_in + range.begin(),
+                                    recv_buffer.data() + chunk_id * max_chunk_size);
+          return Maybe<void>::Ok();
+        }));
     return Maybe<void>::Ok();
   }
 };
@@ -258,36 +459,18 @@ Maybe<void> AllGather<DeviceType::kCPU>(const void* in, void* out, size_t elem_c
   if (in != &char_out[parallel_id * chunk_size]) {
     memcpy(&char_out[parallel_id * chunk_size], in, chunk_size);
   }
-  for (int64_t i = 0, part_id = parallel_id; i < parallel_num - 1;
-       ++i, part_id = RingDecrease(part_id, parallel_num)) {
-    int64_t send_part_id = part_id;
-    const void* send_ptr = &char_out[bs.At(send_part_id).begin()];
-    size_t send_size = bs.At(send_part_id).size();
-    int64_t recv_part_id = RingDecrease(part_id, parallel_num);
-    void* recv_ptr = &char_out[bs.At(recv_part_id).begin()];
-    size_t recv_size = bs.At(recv_part_id).size();
-    NaiveAsyncTransportCtx ctx(
-        transport_token,
-        [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-          *buffer = const_cast<void*>(send_ptr);
-          *size = send_size;
-          *Cb = [] {};
-          return Maybe<void>::Ok();
-        },
-        [&](void** buffer, std::size_t* size, std::function<void()>* Cb) -> Maybe<void> {
-          *buffer = recv_ptr;
-          *size = recv_size;
-          *Cb = [] {};
-          return Maybe<void>::Ok();
-        });
-    if (send_size > 0) {
-      JUST(TransportUtil::SendToNextRankInRing(rank_group, transport_token, &ctx));
-    }
-    if (recv_size > 0) {
-      JUST(TransportUtil::ReceiveFromPrevRankInRing(rank_group, transport_token, &ctx));
-    }
-    JUST(TransportUtil::WaitUntilDoneOrTimeout(ctx, TransportUtil::TimeoutSeconds()));
-  }
+  const int64_t ring_chunk_num = RingChunkNum(chunk_size);
+  const auto& RingChunkBuffer = [&](int64_t part_offset, int64_t chunk_id) {
+    const int64_t part_id =
+        ((parallel_id + part_offset) % parallel_num + parallel_num) % parallel_num;
+    const Range range = RingChunk(bs.At(part_id), ring_chunk_num, chunk_id);
+    return TransferBuffer{&char_out[range.begin()], static_cast<size_t>(range.size())};
+  };
+  JUST(PipelinedRingTransfer(
+      rank_group, transport_token, parallel_num - 1, ring_chunk_num,
+      [&](int64_t step, int64_t chunk_id) { return RingChunkBuffer(-step, chunk_id); },
+      [&](int64_t step, int64_t chunk_id) { return RingChunkBuffer(-step - 1, chunk_id); },
+      [](int64_t step, int64_t chunk_id) -> Maybe<void> { return Maybe<void>::Ok(); }));
   return Maybe<void>::Ok();
 }
 
@@ -330,10 +513,7 @@ Maybe<void> CpuBroadcast(const void* in, void* out, size_t buffer_size, int64_t
 }
 
 template<typename T, ReduceType reduce_type>
-struct DtypeReduce;
-
-template<typename T>
-struct DtypeReduce<T, kSum> {
+struct DtypeReduce {
   static Maybe<void> Call(const void* void_in, void* void_out, size_t elem_cnt, int64_t root,
                           Symbol<ParallelDesc> parallel_desc) {
     const T* in = reinterpret_cast<const T*>(void_in);
@@ -395,7 +575,7 @@ struct DtypeReduce<T, kSum> {
       }
       JUST(TransportUtil::WaitUntilDoneOrTimeout(ctx, TransportUtil::TimeoutSeconds()));
       const T* cur_in = &in[bs.At(recv_part_id).begin()];
-      if (recv_size > 0) { VecAdd(recv_size, tmp_out, cur_in, recv_ptr); }
+      if (recv_size > 0) { VecReduce<T, reduce_type>(recv_size, tmp_out, cur_in, recv_ptr); }
     }
 
     if (root == GlobalProcessCtx::Rank() && void_in == void_out) {
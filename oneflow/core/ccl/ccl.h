@@ -31,7 +31,11 @@ class TransportToken;
 // collective communication library
 namespace ccl {
 
-#define CCL_REDUCE_TYPE_SEQ OF_PP_MAKE_TUPLE_SEQ(kSum)
+#define CCL_REDUCE_TYPE_SEQ \
+  OF_PP_MAKE_TUPLE_SEQ(kSum)  \
+  OF_PP_MAKE_TUPLE_SEQ(kMax)  \
+  OF_PP_MAKE_TUPLE_SEQ(kMin)  \
+  OF_PP_MAKE_TUPLE_SEQ(kProd)
 
 enum ReduceType {
   kInvalidReduceFunctorType = 0,
@@ -22,6 +22,7 @@ limitations under the License.
 #include "oneflow/core/job/resource_desc.h"
 #include "oneflow/core/job/env_desc.h"
 #include "oneflow/core/job/global_for.h"
+#include "oneflow/core/common/balanced_splitter.h"
 #include <netinet/tcp.h>
 
 namespace oneflow {
@@ -39,7 +40,7 @@ sockaddr_in GetSockAddr(const std::string& addr, uint16_t port) {
   return sa;
 }
 
-int SockListen(int listen_sockfd, int32_t* listen_port, int32_t total_machine_num) {
+int SockListen(int listen_sockfd, int32_t* listen_port, int32_t backlog) {
   // System designated available port if listen_port == kInvlidPort, otherwise, the configured port
   // is used.
   sockaddr_in sa = GetSockAddr("0.0.0.0", *listen_port);
@@ -59,7 +60,7 @@ int SockListen(int listen_sockfd, int32_t* listen_port, int32_t total_machine_nu
     }
   }
   if (bind_result == 0) {
-    PCHECK(listen(listen_sockfd, total_machine_num) == 0);
+    PCHECK(listen(listen_sockfd, backlog) == 0);
     LOG(INFO) << "CommNet:Epoll listening on "
               << "0.0.0.0:" + std::to_string(*listen_port);
   } else {
@@ -88,6 +89,16 @@ EpollCommNet::~EpollCommNet() {
     pollers_[i]->Stop();
   }
   OF_ENV_BARRIER();
+  FOR_RANGE(int64_t, machine_id, 0, machine_id2sockfds_.size()) {
+    for (int sockfd : machine_id2sockfds_[machine_id]) {
+      if (sockfd == -1) { continue; }
+      const SocketWriteStats stats = sockfd2helper_.at(sockfd)->GetWriteStats();
+      VLOG(1) << "CommNet write to machine " << machine_id << " sockfd " << sockfd << ": "
+              << stats.msg_num << " msgs, " << stats.byte_num << " bytes ("
+              << stats.zerocopy_byte_num << " zerocopy), " << stats.syscall_num
+              << " syscalls, max batch " << stats.max_batch_msg_num << " msgs";
+    }
+  }
   for (IOEventPoller* poller : pollers_) { delete poller; }
   for (auto& pair : sockfd2helper_) { delete pair.second; }
 }
@@ -113,6 +124,42 @@ void EpollCommNet::SendSocketMsg(int64_t dst_machine_id, const SocketMsg& msg) {
   GetSocketHelper(dst_machine_id)->AsyncWrite(msg);
 }
 
+void EpollCommNet::SendRequestReadMsg(int64_t dst_machine_id, const SocketMsg& msg) {
+  CHECK(msg.msg_type == SocketMsgType::kRequestRead);
+  const auto* src_mem_desc = static_cast<const SocketMemDesc*>(msg.request_read_msg.src_token);
+  const int64_t byte_size = src_mem_desc->byte_size;
+  SocketMsg stripe_msg = msg;
+  if (data_socket_num_ == 0) {
+    stripe_msg.request_read_msg.offset = 0;
+    stripe_msg.request_read_msg.size = byte_size;
+    stripe_msg.request_read_msg.stripe_num = 1;
+    GetSocketHelper(dst_machine_id)->AsyncWrite(stripe_msg);
+    return;
+  }
+  const int64_t stripe_num =
+      std::min(data_socket_num_, std::max<int64_t>(byte_size / stripe_min_bytes_, 1));
+  const int64_t first_data_socket_id =
+      next_data_socket_id_.fetch_add(stripe_num, std::memory_order_relaxed);
+  BalancedSplitter bs(byte_size, stripe_num);
+  FOR_RANGE(int64_t, i, 0, stripe_num) {
+    stripe_msg.request_read_msg.offset = bs.At(i).begin();
+    stripe_msg.request_read_msg.size = bs.At(i).size();
+    stripe_msg.request_read_msg.stripe_num = stripe_num;
+    GetDataSocketHelper(dst_machine_id, (first_data_socket_id + i) % data_socket_num_)
+        ->AsyncWrite(stripe_msg);
+  }
+}
+
+bool EpollCommNet::RequestReadStripeDone(const RequestReadMsg& msg) {
+  if (msg.stripe_num == 1) { return true; }
+  std::unique_lock<std::mutex> lck(read_id2done_stripe_num_mtx_);
+  int64_t* done_stripe_num = &read_id2done_stripe_num_[msg.read_id];
+  *done_stripe_num += 1;
+  if (*done_stripe_num < msg.stripe_num) { return false; }
+  read_id2done_stripe_num_.erase(msg.read_id);
+  return true;
+}
+
 SocketMemDesc* EpollCommNet::NewMemDesc(void* ptr, size_t byte_size) {
   SocketMemDesc* mem_desc = new SocketMemDesc;
   mem_desc->mem_ptr = ptr;
@@ -120,8 +167,18 @@ SocketMemDesc* EpollCommNet::NewMemDesc(void* ptr, size_t byte_size) {
   return mem_desc;
 }
 
-EpollCommNet::EpollCommNet() : CommNetIf() {
-  pollers_.resize(Global<ResourceDesc, ForSession>::Get()->CommNetWorkerNum(), nullptr);
+EpollCommNet::EpollCommNet() : CommNetIf(), next_data_socket_id_(0) {
+  // The number of data sockets per peer, 0 means that bodies share the control socket with
+  // actor messages. Must be the same on all machines.
+  data_socket_num_ =
+      std::max<int64_t>(ParseIntegerFromEnv("ONEFLOW_COMM_NET_DATA_SOCKET_NUM", 0), 0);
+  // Bodies are split into at most data_socket_num_ stripes of at least stripe_min_bytes_ bytes
+  stripe_min_bytes_ =
+      std::max<int64_t>(ParseIntegerFromEnv("ONEFLOW_COMM_NET_STRIPE_MIN_BYTES", 1 << 20), 1);
+  // The sockets of a peer are served by different pollers if possible
+  pollers_.resize(std::max<size_t>(Global<ResourceDesc, ForSession>::Get()->CommNetWorkerNum(),
+                                   data_socket_num_ + 1),
+                  nullptr);
   for (size_t i = 0; i < pollers_.size(); ++i) { pollers_[i] = new IOEventPoller; }
   InitSockets();
   for (IOEventPoller* poller : pollers_) { poller->Start(); }
@@ -131,13 +188,12 @@ void EpollCommNet::InitSockets() {
   int64_t this_machine_id = GlobalProcessCtx::Rank();
   auto this_machine = Global<ResourceDesc, ForSession>::Get()->machine(this_machine_id);
   int64_t total_machine_num = Global<ResourceDesc, ForSession>::Get()->process_ranks().size();
-  machine_id2sockfd_.assign(total_machine_num, -1);
+  const int64_t socket_num_per_machine = data_socket_num_ + 1;
+  machine_id2sockfds_.assign(total_machine_num, std::vector<int>(socket_num_per_machine, -1));
   sockfd2helper_.clear();
-  size_t poller_idx = 0;
-  auto NewSocketHelper = [&](int sockfd) {
-    IOEventPoller* poller = pollers_[poller_idx];
-    poller_idx = (poller_idx + 1) % pollers_.size();
-    return new SocketHelper(sockfd, poller);
+  auto NewSocketHelper = [&](int sockfd, int64_t peer_id, int64_t socket_id) {
+    const int64_t poller_idx = (peer_id * socket_num_per_machine + socket_id) % pollers_.size();
+    return new SocketHelper(sockfd, pollers_[poller_idx]);
   };
 
   // listen
@@ -150,7 +206,8 @@ void EpollCommNet::InitSockets() {
       this_listen_port = Global<EnvDesc>::Get()->data_port();
     }
   }
-  CHECK_EQ(SockListen(listen_sockfd, &this_listen_port, total_machine_num), 0);
+  CHECK_EQ(
+      SockListen(listen_sockfd, &this_listen_port, total_machine_num * socket_num_per_machine), 0);
   CHECK_NE(this_listen_port, 0);
   PushPort(this_machine_id, this_listen_port);
   int32_t src_machine_count = 0;
@@ -164,42 +221,58 @@ void EpollCommNet::InitSockets() {
     uint16_t peer_port = PullPort(peer_id);
     auto peer_machine = Global<ResourceDesc, ForSession>::Get()->machine(peer_id);
     sockaddr_in peer_sockaddr = GetSockAddr(peer_machine.addr(), peer_port);
-    int sockfd = socket(AF_INET, SOCK_STREAM, 0);
-    const int val = 1;
-    PCHECK(setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, (char*)&val, sizeof(int)) == 0);
-    PCHECK(connect(sockfd, reinterpret_cast<sockaddr*>(&peer_sockaddr), sizeof(peer_sockaddr))
-           == 0);
-    ssize_t n = write(sockfd, &this_machine_id, sizeof(int64_t));
-    PCHECK(n == sizeof(int64_t));
-    CHECK(sockfd2helper_.emplace(sockfd, NewSocketHelper(sockfd)).second);
-    machine_id2sockfd_[peer_id] = sockfd;
+    FOR_RANGE(int64_t, socket_id, 0, socket_num_per_machine) {
+      int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+      const int val = 1;
+      PCHECK(setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, (char*)&val, sizeof(int)) == 0);
+      PCHECK(connect(sockfd, reinterpret_cast<sockaddr*>(&peer_sockaddr), sizeof(peer_sockaddr))
+             == 0);
+      const int64_t handshake[2] = {this_machine_id, socket_id};
+      ssize_t n = write(sockfd, handshake, sizeof(handshake));
+      PCHECK(n == sizeof(handshake));
+      CHECK(sockfd2helper_.emplace(sockfd, NewSocketHelper(sockfd, peer_id, socket_id)).second);
+      machine_id2sockfds_[peer_id][socket_id] = sockfd;
+    }
   }
 
   // accept
-  HashSet<int64_t> processed_ranks;
-  FOR_RANGE(int32_t, idx, 0, src_machine_count) {
+  FOR_RANGE(int32_t, idx, 0, src_machine_count * socket_num_per_machine) {
     sockaddr_in peer_sockaddr;
     socklen_t len = sizeof(peer_sockaddr);
     int sockfd = accept(listen_sockfd, reinterpret_cast<sockaddr*>(&peer_sockaddr), &len);
     PCHECK(sockfd != -1);
-    int64_t peer_rank;
-    ssize_t n = read(sockfd, &peer_rank, sizeof(int64_t));
-    PCHECK(n == sizeof(int64_t));
-    CHECK(sockfd2helper_.emplace(sockfd, NewSocketHelper(sockfd)).second);
-    CHECK(processed_ranks.emplace(peer_rank).second);
-    machine_id2sockfd_[peer_rank] = sockfd;
+    int64_t handshake[2];
+    ssize_t n = read(sockfd, handshake, sizeof(handshake));
+    PCHECK(n == sizeof(handshake));
+    const int64_t peer_rank = handshake[0];
+    const int64_t socket_id = handshake[1];
+    CHECK_GE(socket_id, 0);
+    CHECK_LT(socket_id, socket_num_per_machine);
+    CHECK_EQ(machine_id2sockfds_.at(peer_rank).at(socket_id), -1);
+    CHECK(sockfd2helper_.emplace(sockfd, NewSocketHelper(sockfd, peer_rank, socket_id)).second);
+    machine_id2sockfds_[peer_rank][socket_id] = sockfd;
   }
   PCHECK(close(listen_sockfd) == 0);
   ClearPort(this_machine_id);
 
   // useful log
   FOR_RANGE(int64_t, machine_id, 0, total_machine_num) {
-    LOG(INFO) << "machine " << machine_id << " sockfd " << machine_id2sockfd_[machine_id];
+    std::string data_sockfds;
+    FOR_RANGE(int64_t, socket_id, 1, socket_num_per_machine) {
+      data_sockfds += " " + std::to_string(machine_id2sockfds_[machine_id][socket_id]);
+    }
+    LOG(INFO) << "machine " << machine_id << " sockfd " << machine_id2sockfds_[machine_id][0]
+              << " data sockfds" << data_sockfds;
   }
 }
 
 SocketHelper* EpollCommNet::GetSocketHelper(int64_t machine_id) {
-  int sockfd = machine_id2sockfd_.at(machine_id);
+  int sockfd = machine_id2sockfds_.at(machine_id).at(0);
+  return sockfd2helper_.at(sockfd);
+}
+
+SocketHelper* EpollCommNet::GetDataSocketHelper(int64_t machine_id, int64_t data_socket_id) {
+  int sockfd = machine_id2sockfds_.at(machine_id).at(data_socket_id + 1);
   return sockfd2helper_.at(sockfd);
 }
 
@@ -32,6 +32,11 @@ class EpollCommNet final : public CommNetIf<SocketMemDesc> {
   void SendActorMsg(int64_t dst_machine_id, const ActorMsg& msg) override;
   void SendSocketMsg(int64_t dst_machine_id, const SocketMsg& msg);
   void SendTransportMsg(int64_t dst_machine_id, const TransportMsg& msg);
+  // Splits the body into stripes on the data sockets, or sends it on the control socket when
+  // there is no data socket
+  void SendRequestReadMsg(int64_t dst_machine_id, const SocketMsg& msg);
+  // Returns true when msg is the last received stripe of its read
+  bool RequestReadStripeDone(const RequestReadMsg& msg);
 
  private:
   SocketMemDesc* NewMemDesc(void* ptr, size_t byte_size) override;
@@ -40,11 +45,18 @@ class EpollCommNet final : public CommNetIf<SocketMemDesc> {
   EpollCommNet();
   void InitSockets();
   SocketHelper* GetSocketHelper(int64_t machine_id);
+  SocketHelper* GetDataSocketHelper(int64_t machine_id, int64_t data_socket_id);
   void DoRead(void* read_id, int64_t src_machine_id, void* src_token, void* dst_token) override;
 
   std::vector<IOEventPoller*> pollers_;
-  std::vector<int> machine_id2sockfd_;
+  int64_t data_socket_num_;
+  int64_t stripe_min_bytes_;
+  std::atomic<int64_t> next_data_socket_id_;
+  // the control socket of each machine followed by its data sockets
+  std::vector<std::vector<int>> machine_id2sockfds_;
   HashMap<int, SocketHelper*> sockfd2helper_;
+  std::mutex read_id2done_stripe_num_mtx_;
+  HashMap<void*, int64_t> read_id2done_stripe_num_;
 };
 
 }  // namespace oneflow
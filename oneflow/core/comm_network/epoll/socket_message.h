@@ -29,6 +29,7 @@ limitations under the License.
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include "oneflow/core/lazy/actor/actor_message.h"
 #include "oneflow/core/transport/transport_message.h"
@@ -58,6 +59,11 @@ struct RequestReadMsg {
   void* src_token;
   void* dst_token;
   void* read_id;
+  // the body is bytes [offset, offset + size) of the registered memory, a read is split into
+  // stripe_num such messages on different data sockets
+  int64_t offset;
+  int64_t size;
+  int64_t stripe_num;
 };
 
 struct SocketMsg {
@@ -82,7 +82,8 @@ void SocketReadHelper::SetStatusWhenMsgHeadDone() {
 }
 
 void SocketReadHelper::SetStatusWhenMsgBodyDone() {
-  if (cur_msg_.msg_type == SocketMsgType::kRequestRead) {
+  if (cur_msg_.msg_type == SocketMsgType::kRequestRead
+      && Global<EpollCommNet>::Get()->RequestReadStripeDone(cur_msg_.request_read_msg)) {
     Global<EpollCommNet>::Get()->ReadDone(cur_msg_.request_read_msg.read_id);
   }
   SwitchToMsgHeadReadHandle();
@@ -94,15 +95,17 @@ void SocketReadHelper::SetStatusWhenRequestWriteMsgHeadDone() {
   msg_to_send.request_read_msg.src_token = cur_msg_.request_write_msg.src_token;
   msg_to_send.request_read_msg.dst_token = cur_msg_.request_write_msg.dst_token;
   msg_to_send.request_read_msg.read_id = cur_msg_.request_write_msg.read_id;
-  Global<EpollCommNet>::Get()->SendSocketMsg(cur_msg_.request_write_msg.dst_machine_id,
-                                             msg_to_send);
+  Global<EpollCommNet>::Get()->SendRequestReadMsg(cur_msg_.request_write_msg.dst_machine_id,
+                                                  msg_to_send);
   SwitchToMsgHeadReadHandle();
 }
 
 void SocketReadHelper::SetStatusWhenRequestReadMsgHeadDone() {
   auto mem_desc = static_cast<const SocketMemDesc*>(cur_msg_.request_read_msg.dst_token);
-  read_ptr_ = reinterpret_cast<char*>(mem_desc->mem_ptr);
-  read_size_ = mem_desc->byte_size;
+  const RequestReadMsg& request_read_msg = cur_msg_.request_read_msg;
+  CHECK_LE(request_read_msg.offset + request_read_msg.size, mem_desc->byte_size);
+  read_ptr_ = reinterpret_cast<char*>(mem_desc->mem_ptr) + request_read_msg.offset;
+  read_size_ = request_read_msg.size;
   cur_read_handle_ = &SocketReadHelper::MsgBodyReadHandle;
 }
 
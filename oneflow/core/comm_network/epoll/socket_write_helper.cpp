@@ -18,10 +18,18 @@ limitations under the License.
 #include "oneflow/core/comm_network/epoll/socket_write_helper.h"
 #include "oneflow/core/comm_network/epoll/socket_memory_desc.h"
 
+#include <linux/errqueue.h>
 #include <sys/eventfd.h>
 
 namespace oneflow {
 
+namespace {
+
+// Limits the iovecs of one syscall, which is far below IOV_MAX
+constexpr size_t kMaxIovecNum = 128;
+
+}  // namespace
+
 SocketWriteHelper::~SocketWriteHelper() {
   delete cur_msg_queue_;
   cur_msg_queue_ = nullptr;
@@ -32,29 +40,74 @@ SocketWriteHelper::~SocketWriteHelper() {
   }
 }
 
-SocketWriteHelper::SocketWriteHelper(int sockfd, IOEventPoller* poller) {
+SocketWriteHelper::SocketWriteHelper(int sockfd, IOEventPoller* poller)
+    : msg_num_(0), byte_num_(0), syscall_num_(0), zerocopy_byte_num_(0), max_batch_msg_num_(0) {
   sockfd_ = sockfd;
   queue_not_empty_fd_ = eventfd(0, 0);
   PCHECK(queue_not_empty_fd_ != -1);
   poller->AddFdWithOnlyReadHandler(queue_not_empty_fd_,
                                    std::bind(&SocketWriteHelper::ProcessQueueNotEmptyEvent, this));
-  cur_msg_queue_ = new std::queue<SocketMsg>;
-  pending_msg_queue_ = new std::queue<SocketMsg>;
-  cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
-  write_ptr_ = nullptr;
-  write_size_ = 0;
+  zerocopy_enabled_ = false;
+  zerocopy_min_bytes_ = ParseIntegerFromEnv("ONEFLOW_COMM_NET_SOCKET_ZEROCOPY_MIN_BYTES", 64 << 10);
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+  if (ParseBooleanFromEnv("ONEFLOW_COMM_NET_SOCKET_ZEROCOPY", false)) {
+    const int val = 1;
+    zerocopy_enabled_ = setsockopt(sockfd_, SOL_SOCKET, SO_ZEROCOPY, &val, sizeof(val)) == 0;
+    if (!zerocopy_enabled_) { PLOG(WARNING) << "SO_ZEROCOPY is unavailable on fd " << sockfd_; }
+  }
+#endif
+  cur_msg_queue_ = new std::deque<SocketMsg>;
+  cur_msg_written_ = 0;
+  pending_msg_queue_ = new std::deque<SocketMsg>;
+  iovecs_.reserve(kMaxIovecNum);
 }
 
 void SocketWriteHelper::AsyncWrite(const SocketMsg& msg) {
   pending_msg_queue_mtx_.lock();
   bool need_send_event = pending_msg_queue_->empty();
-  pending_msg_queue_->push(msg);
+  pending_msg_queue_->push_back(msg);
   pending_msg_queue_mtx_.unlock();
   if (need_send_event) { SendQueueNotEmptyEvent(); }
 }
 
 void SocketWriteHelper::NotifyMeSocketWriteable() { WriteUntilMsgQueueEmptyOrSocketNotWriteable(); }
 
+void SocketWriteHelper::NotifyMeSocketError() {
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+  // Drains the completion notifications of MSG_ZEROCOPY sends, the bodies are registers which are
+  // not reused before the peer has read them, so there is nothing to release here
+  while (zerocopy_enabled_) {
+    char control[128];
+    msghdr msg{};
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(sockfd_, &msg, MSG_ERRQUEUE) == -1) {
+      PCHECK(errno == EAGAIN || errno == EWOULDBLOCK);
+      break;
+    }
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      const auto* err = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+      CHECK_EQ(err->ee_errno, 0);
+      CHECK_EQ(err->ee_origin, SO_EE_ORIGIN_ZEROCOPY);
+    }
+  }
+#endif
+  int error = 0;
+  socklen_t len = sizeof(error);
+  PCHECK(getsockopt(sockfd_, SOL_SOCKET, SO_ERROR, &error, &len) == 0);
+  CHECK_EQ(error, 0) << "fd: " << sockfd_ << ", " << strerror(error);
+}
+
+SocketWriteStats SocketWriteHelper::GetStats() const {
+  SocketWriteStats stats;
+  stats.msg_num = msg_num_.load(std::memory_order_relaxed);
+  stats.byte_num = byte_num_.load(std::memory_order_relaxed);
+  stats.syscall_num = syscall_num_.load(std::memory_order_relaxed);
+  stats.zerocopy_byte_num = zerocopy_byte_num_.load(std::memory_order_relaxed);
+  stats.max_batch_msg_num = max_batch_msg_num_.load(std::memory_order_relaxed);
+  return stats;
+}
+
 void SocketWriteHelper::SendQueueNotEmptyEvent() {
   uint64_t event_num = 1;
   PCHECK(write(queue_not_empty_fd_, &event_num, 8) == 8);
@@ -67,10 +120,10 @@ void SocketWriteHelper::ProcessQueueNotEmptyEvent() {
 }
 
 void SocketWriteHelper::WriteUntilMsgQueueEmptyOrSocketNotWriteable() {
-  while ((this->*cur_write_handle_)()) {}
+  while (WriteBatch()) {}
 }
 
-bool SocketWriteHelper::InitMsgWriteHandle() {
+bool SocketWriteHelper::WriteBatch() {
   if (cur_msg_queue_->empty()) {
     {
       std::unique_lock<std::mutex> lck(pending_msg_queue_mtx_);
@@ -78,30 +131,28 @@ bool SocketWriteHelper::InitMsgWriteHandle() {
     }
     if (cur_msg_queue_->empty()) { return false; }
   }
-  cur_msg_ = cur_msg_queue_->front();
-  cur_msg_queue_->pop();
-  write_ptr_ = reinterpret_cast<const char*>(&cur_msg_);
-  write_size_ = sizeof(cur_msg_);
-  cur_write_handle_ = &SocketWriteHelper::MsgHeadWriteHandle;
-  return true;
-}
-
-bool SocketWriteHelper::MsgHeadWriteHandle() {
-  return DoCurWrite(&SocketWriteHelper::SetStatusWhenMsgHeadDone);
-}
-
-bool SocketWriteHelper::MsgBodyWriteHandle() {
-  return DoCurWrite(&SocketWriteHelper::SetStatusWhenMsgBodyDone);
-}
-
-bool SocketWriteHelper::DoCurWrite(void (SocketWriteHelper::*set_cur_write_done)()) {
-  ssize_t n = write(sockfd_, write_ptr_, write_size_);
-  if (n == write_size_) {
-    (this->*set_cur_write_done)();
-    return true;
-  } else if (n >= 0) {
-    write_ptr_ += n;
-    write_size_ -= n;
+  bool zerocopy = false;
+  const size_t size = InitIovecs(&zerocopy);
+  msghdr msg{};
+  msg.msg_iov = iovecs_.data();
+  msg.msg_iovlen = iovecs_.size();
+  int flags = 0;
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+  if (zerocopy) { flags |= MSG_ZEROCOPY; }
+#endif
+  ssize_t n = sendmsg(sockfd_, &msg, flags);
+  syscall_num_.fetch_add(1, std::memory_order_relaxed);
+  if (n == -1 && zerocopy && errno == ENOBUFS) {
+    // the pinned page budget of the socket is used up, falls back to copying
+    zerocopy = false;
+    n = sendmsg(sockfd_, &msg, 0);
+    syscall_num_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (n >= 0) {
+    CHECK_LE(static_cast<size_t>(n), size);
+    byte_num_.fetch_add(n, std::memory_order_relaxed);
+    if (zerocopy) { zerocopy_byte_num_.fetch_add(n, std::memory_order_relaxed); }
+    ConsumeWrittenBytes(n);
     return true;
   } else {
     CHECK_EQ(n, -1);
@@ -110,38 +161,63 @@ bool SocketWriteHelper::DoCurWrite(void (SocketWriteHelper::*set_cur_write_done)
   }
 }
 
-void SocketWriteHelper::SetStatusWhenMsgHeadDone() {
-  switch (cur_msg_.msg_type) {
-#define MAKE_ENTRY(x, y) \
-  case SocketMsgType::k##x: return SetStatusWhen##x##MsgHeadDone();
-    OF_PP_FOR_EACH_TUPLE(MAKE_ENTRY, SOCKET_MSG_TYPE_SEQ);
-#undef MAKE_ENTRY
-    default: UNIMPLEMENTED();
+size_t SocketWriteHelper::InitIovecs(bool* zerocopy) {
+  iovecs_.clear();
+  *zerocopy = false;
+  size_t size = 0;
+  size_t written = cur_msg_written_;
+  const auto& Append = [&](const char* ptr, size_t len) {
+    iovecs_.push_back(iovec{const_cast<char*>(ptr), len});
+    size += len;
+  };
+  for (const SocketMsg& msg : *cur_msg_queue_) {
+    if (iovecs_.size() + 2 > kMaxIovecNum) { break; }
+    if (written < sizeof(SocketMsg)) {
+      Append(reinterpret_cast<const char*>(&msg) + written, sizeof(SocketMsg) - written);
+      written = 0;
+    } else {
+      written -= sizeof(SocketMsg);
+    }
+    const size_t body_size = MsgBodySize(msg);
+    if (body_size == 0) { continue; }
+    if (zerocopy_enabled_ && body_size >= zerocopy_min_bytes_) {
+      // large bodies are sent alone so that only they are pinned
+      if (!iovecs_.empty()) { break; }
+      *zerocopy = true;
+      Append(MsgBodyPtr(msg) + written, body_size - written);
+      break;
+    }
+    Append(MsgBodyPtr(msg) + written, body_size - written);
+    written = 0;
+  }
+  return size;
+}
+
+void SocketWriteHelper::ConsumeWrittenBytes(size_t n) {
+  cur_msg_written_ += n;
+  int64_t done_msg_num = 0;
+  while (!cur_msg_queue_->empty()) {
+    const size_t msg_size = sizeof(SocketMsg) + MsgBodySize(cur_msg_queue_->front());
+    if (cur_msg_written_ < msg_size) { break; }
+    cur_msg_written_ -= msg_size;
+    cur_msg_queue_->pop_front();
+    ++done_msg_num;
+  }
+  msg_num_.fetch_add(done_msg_num, std::memory_order_relaxed);
+  if (done_msg_num > max_batch_msg_num_.load(std::memory_order_relaxed)) {
+    max_batch_msg_num_.store(done_msg_num, std::memory_order_relaxed);
   }
 }
 
-void SocketWriteHelper::SetStatusWhenMsgBodyDone() {
-  cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
-}
-
-void SocketWriteHelper::SetStatusWhenRequestWriteMsgHeadDone() {
-  cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
-}
-
-void SocketWriteHelper::SetStatusWhenRequestReadMsgHeadDone() {
-  const void* src_token = cur_msg_.request_read_msg.src_token;
-  auto src_mem_desc = static_cast<const SocketMemDesc*>(src_token);
-  write_ptr_ = reinterpret_cast<const char*>(src_mem_desc->mem_ptr);
-  write_size_ = src_mem_desc->byte_size;
-  cur_write_handle_ = &SocketWriteHelper::MsgBodyWriteHandle;
-}
-
-void SocketWriteHelper::SetStatusWhenActorMsgHeadDone() {
-  cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
+size_t SocketWriteHelper::MsgBodySize(const SocketMsg& msg) const {
+  if (msg.msg_type != SocketMsgType::kRequestRead) { return 0; }
+  return msg.request_read_msg.size;
 }
 
-void SocketWriteHelper::SetStatusWhenTransportMsgHeadDone() {
-  cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
+const char* SocketWriteHelper::MsgBodyPtr(const SocketMsg& msg) const {
+  CHECK(msg.msg_type == SocketMsgType::kRequestRead);
+  const auto* src_mem_desc = static_cast<const SocketMemDesc*>(msg.request_read_msg.src_token);
+  return reinterpret_cast<const char*>(src_mem_desc->mem_ptr) + msg.request_read_msg.offset;
 }
 
 }  // namespace oneflow
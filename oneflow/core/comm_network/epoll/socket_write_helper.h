@@ -23,6 +23,15 @@ limitations under the License.
 
 namespace oneflow {
 
+struct SocketWriteStats {
+  int64_t msg_num;
+  int64_t byte_num;
+  int64_t syscall_num;
+  int64_t zerocopy_byte_num;
+  // the largest number of messages written by a single syscall
+  int64_t max_batch_msg_num;
+};
+
 class SocketWriteHelper final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(SocketWriteHelper);
@@ -34,36 +43,40 @@ class SocketWriteHelper final {
   void AsyncWrite(const SocketMsg& msg);
 
   void NotifyMeSocketWriteable();
+  void NotifyMeSocketError();
+
+  SocketWriteStats GetStats() const;
 
  private:
   void SendQueueNotEmptyEvent();
   void ProcessQueueNotEmptyEvent();
 
   void WriteUntilMsgQueueEmptyOrSocketNotWriteable();
-  bool InitMsgWriteHandle();
-  bool MsgHeadWriteHandle();
-  bool MsgBodyWriteHandle();
-
-  bool DoCurWrite(void (SocketWriteHelper::*set_cur_write_done)());
-  void SetStatusWhenMsgHeadDone();
-  void SetStatusWhenMsgBodyDone();
-
-#define MAKE_ENTRY(x, y) void SetStatusWhen##x##MsgHeadDone();
-  OF_PP_FOR_EACH_TUPLE(MAKE_ENTRY, SOCKET_MSG_TYPE_SEQ);
-#undef MAKE_ENTRY
+  bool WriteBatch();
+  size_t InitIovecs(bool* zerocopy);
+  void ConsumeWrittenBytes(size_t n);
+  size_t MsgBodySize(const SocketMsg& msg) const;
+  const char* MsgBodyPtr(const SocketMsg& msg) const;
 
   int sockfd_;
   int queue_not_empty_fd_;
+  bool zerocopy_enabled_;
+  size_t zerocopy_min_bytes_;
 
-  std::queue<SocketMsg>* cur_msg_queue_;
+  // messages being written, the first cur_msg_written_ bytes of the front one are written
+  std::deque<SocketMsg>* cur_msg_queue_;
+  size_t cur_msg_written_;
 
   std::mutex pending_msg_queue_mtx_;
-  std::queue<SocketMsg>* pending_msg_queue_;
+  std::deque<SocketMsg>* pending_msg_queue_;
+
+  std::vector<iovec> iovecs_;
 
-  SocketMsg cur_msg_;
-  bool (SocketWriteHelper::*cur_write_handle_)();
-  const char* write_ptr_;
-  size_t write_size_;
+  std::atomic<int64_t> msg_num_;
+  std::atomic<int64_t> byte_num_;
+  std::atomic<int64_t> syscall_num_;
+  std::atomic<int64_t> zerocopy_byte_num_;
+  std::atomic<int64_t> max_batch_msg_num_;
 };
 
 }  // namespace oneflow
@@ -0,0 +1,296 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifdef __linux__
+
+#include <chrono>
+#include <numeric>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "oneflow/core/comm_network/epoll/socket_write_helper.h"
+#include "oneflow/core/comm_network/epoll/socket_memory_desc.h"
+#include "oneflow/core/common/balanced_splitter.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+constexpr int64_t kMsgNum = 4000;
+// Every kBodyInterval-th message carries a body of kBodySize bytes, like a register read.
+constexpr int64_t kBodyInterval = 100;
+constexpr size_t kBodySize = 64 << 10;
+// a broken writer or a failed reader leaves the stats short, the test gives up at this deadline
+constexpr auto kWriteTimeout = std::chrono::seconds(60);
+// A register read split over kStripeNum data sockets, the size does not divide evenly.
+constexpr int64_t kStripeNum = 3;
+constexpr size_t kStripedBodySize = (1 << 20) + 1;
+
+// Returns a socket listening on a free loopback port and sets addr to its address.
+int ListenOnLoopback(sockaddr_in* addr, int backlog) {
+  int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  PCHECK(listen_fd != -1);
+  *addr = sockaddr_in{};
+  addr->sin_family = AF_INET;
+  addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr->sin_port = 0;
+  PCHECK(bind(listen_fd, reinterpret_cast<sockaddr*>(addr), sizeof(*addr)) == 0);
+  socklen_t addr_len = sizeof(*addr);
+  PCHECK(getsockname(listen_fd, reinterpret_cast<sockaddr*>(addr), &addr_len) == 0);
+  PCHECK(listen(listen_fd, backlog) == 0);
+  return listen_fd;
+}
+
+int ConnectToLoopback(const sockaddr_in& addr) {
+  int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  PCHECK(sockfd != -1);
+  const int val = 1;
+  PCHECK(setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &val, sizeof(val)) == 0);
+  PCHECK(connect(sockfd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0);
+  return sockfd;
+}
+
+bool ReadAll(int fd, char* ptr, size_t size) {
+  while (size > 0) {
+    ssize_t n = read(fd, ptr, size);
+    if (n <= 0) { return false; }
+    ptr += n;
+    size -= n;
+  }
+  return true;
+}
+
+// Runs in the forked reader process, the bodies and mem descs are copied into it by fork.
+bool ReadAndCheckMsgs(int fd, const std::vector<SocketMsg>& msgs) {
+  SocketMsg msg;
+  std::vector<char> body(kBodySize);
+  for (const SocketMsg& expected : msgs) {
+    if (!ReadAll(fd, reinterpret_cast<char*>(&msg), sizeof(msg))) { return false; }
+    if (std::memcmp(&msg, &expected, sizeof(msg)) != 0) { return false; }
+    if (msg.msg_type != SocketMsgType::kRequestRead) { continue; }
+    const auto* mem_desc = static_cast<const SocketMemDesc*>(msg.request_read_msg.src_token);
+    const size_t size = msg.request_read_msg.size;
+    if (!ReadAll(fd, body.data(), size)) { return false; }
+    if (std::memcmp(body.data(), mem_desc->mem_ptr, size) != 0) { return false; }
+  }
+  return true;
+}
+
+// Runs in the forked reader process. Reads the stripe headers of one register read from all the
+// sockets, then the bodies from the last stripe to the first, each into its range of the
+// destination like SocketReadHelper does. The read must only be done after the first stripe.
+bool ReadAndCheckStripesInReverse(const std::vector<int>& fds) {
+  std::vector<SocketMsg> msgs(fds.size());
+  FOR_RANGE(size_t, i, 0, fds.size()) {
+    if (!ReadAll(fds.at(i), reinterpret_cast<char*>(&msgs.at(i)), sizeof(SocketMsg))) {
+      return false;
+    }
+    if (msgs.at(i).msg_type != SocketMsgType::kRequestRead) { return false; }
+  }
+  std::vector<size_t> order(fds.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    return msgs.at(lhs).request_read_msg.offset > msgs.at(rhs).request_read_msg.offset;
+  });
+  const RequestReadMsg& first_msg = msgs.at(order.back()).request_read_msg;
+  const auto* src_mem_desc = static_cast<const SocketMemDesc*>(first_msg.src_token);
+  std::vector<char> dst(src_mem_desc->byte_size, 0);
+  int64_t done_stripe_num = 0;
+  int64_t expected_offset = dst.size();
+  for (size_t i : order) {
+    const RequestReadMsg& msg = msgs.at(i).request_read_msg;
+    if (msg.read_id != first_msg.read_id || msg.src_token != first_msg.src_token) { return false; }
+    if (msg.stripe_num != static_cast<int64_t>(fds.size())) { return false; }
+    // the stripes cover the register without gaps
+    if (msg.size <= 0 || msg.offset + msg.size != expected_offset) { return false; }
+    expected_offset = msg.offset;
+    if (!ReadAll(fds.at(i), dst.data() + msg.offset, msg.size)) { return false; }
+    done_stripe_num += 1;
+    // counted like EpollCommNet::RequestReadStripeDone
+    if ((done_stripe_num == msg.stripe_num) != (msg.offset == 0)) { return false; }
+  }
+  if (expected_offset != 0 || done_stripe_num != kStripeNum) { return false; }
+  return std::memcmp(dst.data(), src_mem_desc->mem_ptr, dst.size()) == 0;
+}
+
+}  // namespace
+
+// Two process loopback test: the parent writes through a SocketWriteHelper and the forked
+// child reads and checks the byte stream.
+TEST(SocketWriteHelper, loopback_batched_write) {
+  std::vector<std::vector<char>> bodies(kMsgNum / kBodyInterval, std::vector<char>(kBodySize));
+  std::vector<SocketMemDesc> mem_descs(bodies.size());
+  std::vector<SocketMsg> msgs(kMsgNum);
+  int64_t total_bytes = 0;
+  FOR_RANGE(int64_t, i, 0, kMsgNum) {
+    SocketMsg* msg = &msgs.at(i);
+    std::memset(msg, 0, sizeof(SocketMsg));
+    total_bytes += sizeof(SocketMsg);
+    if (i % kBodyInterval == 0) {
+      const int64_t body_id = i / kBodyInterval;
+      std::fill(bodies.at(body_id).begin(), bodies.at(body_id).end(), static_cast<char>(i));
+      mem_descs.at(body_id).mem_ptr = bodies.at(body_id).data();
+      mem_descs.at(body_id).byte_size = kBodySize;
+      msg->msg_type = SocketMsgType::kRequestRead;
+      msg->request_read_msg.src_token = &mem_descs.at(body_id);
+      msg->request_read_msg.read_id = reinterpret_cast<void*>(i);
+      msg->request_read_msg.offset = 0;
+      msg->request_read_msg.size = kBodySize;
+      msg->request_read_msg.stripe_num = 1;
+      total_bytes += kBodySize;
+    } else {
+      msg->msg_type = SocketMsgType::kRequestWrite;
+      msg->request_write_msg.dst_machine_id = i;
+    }
+  }
+
+  sockaddr_in addr{};
+  int listen_fd = ListenOnLoopback(&addr, 1);
+
+  pid_t pid = fork();
+  ASSERT_NE(pid, -1);
+  if (pid == 0) {
+    int fd = accept(listen_fd, nullptr, nullptr);
+    _exit(fd != -1 && ReadAndCheckMsgs(fd, msgs) ? 0 : 1);
+  }
+  PCHECK(close(listen_fd) == 0);
+  int sockfd = ConnectToLoopback(addr);
+
+  SocketWriteStats stats{};
+  double elapsed_ms = 0;
+  bool timed_out = false;
+  {
+    IOEventPoller poller;
+    SocketWriteHelper write_helper(sockfd, &poller);
+    poller.AddFd(
+        sockfd, []() {}, [&]() { write_helper.NotifyMeSocketWriteable(); },
+        [&]() { write_helper.NotifyMeSocketError(); });
+    const auto start = std::chrono::steady_clock::now();
+    // all messages are queued before the poller runs, so the batch depth does not depend on
+    // how fast this thread produces them
+    for (const SocketMsg& msg : msgs) { write_helper.AsyncWrite(msg); }
+    poller.Start();
+    const auto deadline = start + kWriteTimeout;
+    while (write_helper.GetStats().msg_num < kMsgNum) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        timed_out = true;
+        break;
+      }
+      std::this_thread::yield();
+    }
+    elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                     .count();
+    stats = write_helper.GetStats();
+    poller.Stop();
+  }
+  if (timed_out) { PCHECK(kill(pid, SIGKILL) == 0); }
+  int status = 0;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  ASSERT_FALSE(timed_out) << stats.msg_num << " of " << kMsgNum << " msgs written";
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+  ASSERT_EQ(stats.msg_num, kMsgNum);
+  ASSERT_EQ(stats.byte_num, total_bytes);
+  // headers are coalesced, the former path made at least one syscall per header and body
+  ASSERT_LT(stats.syscall_num, kMsgNum);
+  ASSERT_GT(stats.max_batch_msg_num, 1);
+  LOG(INFO) << "SocketWriteHelper: " << kMsgNum << " msgs, " << total_bytes << " bytes in "
+            << elapsed_ms << " ms, " << stats.syscall_num << " syscalls, max batch "
+            << stats.max_batch_msg_num << " msgs";
+}
+
+// One register read striped over kStripeNum sockets, like EpollCommNet::SendRequestReadMsg does
+// with data sockets. The forked reader completes the stripes in reverse order and checks the
+// reassembled register.
+TEST(SocketWriteHelper, loopback_striped_read) {
+  std::vector<char> body(kStripedBodySize);
+  FOR_RANGE(size_t, i, 0, body.size()) { body.at(i) = static_cast<char>(i * 7 + i / 4096); }
+  SocketMemDesc mem_desc{};
+  mem_desc.mem_ptr = body.data();
+  mem_desc.byte_size = body.size();
+  std::vector<SocketMsg> msgs(kStripeNum);
+  BalancedSplitter bs(body.size(), kStripeNum);
+  FOR_RANGE(int64_t, i, 0, kStripeNum) {
+    SocketMsg* msg = &msgs.at(i);
+    std::memset(msg, 0, sizeof(SocketMsg));
+    msg->msg_type = SocketMsgType::kRequestRead;
+    msg->request_read_msg.src_token = &mem_desc;
+    msg->request_read_msg.read_id = &mem_desc;
+    msg->request_read_msg.offset = bs.At(i).begin();
+    msg->request_read_msg.size = bs.At(i).size();
+    msg->request_read_msg.stripe_num = kStripeNum;
+  }
+
+  sockaddr_in addr{};
+  int listen_fd = ListenOnLoopback(&addr, kStripeNum);
+  pid_t pid = fork();
+  ASSERT_NE(pid, -1);
+  if (pid == 0) {
+    std::vector<int> fds;
+    FOR_RANGE(int64_t, i, 0, kStripeNum) {
+      fds.emplace_back(accept(listen_fd, nullptr, nullptr));
+      if (fds.back() == -1) { _exit(1); }
+    }
+    _exit(ReadAndCheckStripesInReverse(fds) ? 0 : 1);
+  }
+  PCHECK(close(listen_fd) == 0);
+  std::vector<int> sockfds;
+  FOR_RANGE(int64_t, i, 0, kStripeNum) { sockfds.emplace_back(ConnectToLoopback(addr)); }
+
+  bool timed_out = false;
+  {
+    IOEventPoller poller;
+    std::vector<std::unique_ptr<SocketWriteHelper>> write_helpers;
+    for (int sockfd : sockfds) {
+      write_helpers.emplace_back(new SocketWriteHelper(sockfd, &poller));
+      SocketWriteHelper* write_helper = write_helpers.back().get();
+      poller.AddFd(
+          sockfd, []() {}, [write_helper]() { write_helper->NotifyMeSocketWriteable(); },
+          [write_helper]() { write_helper->NotifyMeSocketError(); });
+    }
+    // the stripes are written in order, the reader takes the last one first
+    FOR_RANGE(int64_t, i, 0, kStripeNum) { write_helpers.at(i)->AsyncWrite(msgs.at(i)); }
+    poller.Start();
+    const auto deadline = std::chrono::steady_clock::now() + kWriteTimeout;
+    auto IsAllWritten = [&]() {
+      for (const auto& write_helper : write_helpers) {
+        if (write_helper->GetStats().msg_num < 1) { return false; }
+      }
+      return true;
+    };
+    while (!IsAllWritten()) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        timed_out = true;
+        break;
+      }
+      std::this_thread::yield();
+    }
+    poller.Stop();
+  }
+  if (timed_out) { PCHECK(kill(pid, SIGKILL) == 0); }
+  int status = 0;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  ASSERT_FALSE(timed_out) << "stripes are not written";
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+}
+
+}  // namespace test
+
+}  // namespace oneflow
+
+#endif  // __linux__
@@ -43,4 +43,9 @@ void Notifier::Close() {
   cond_.notify_all();
 }
 
+bool Notifier::IsClosed() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return is_closed_;
+}
+
 }  // namespace oneflow
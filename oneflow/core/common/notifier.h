@@ -31,6 +31,7 @@ class Notifier final {
   NotifierStatus Notify();
   NotifierStatus WaitAndClearNotifiedCnt();
   void Close();
+  bool IsClosed();
 
  private:
   size_t notified_cnt_;
@@ -0,0 +1,60 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/ep/cpu/cpu_isa.h"
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+namespace ep {
+
+namespace {
+
+CpuIsa DetectCpuIsa() {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2")
+      && __builtin_cpu_supports("fma")) {
+    return CpuIsa::kAvx512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) { return CpuIsa::kAvx2; }
+#endif
+  return CpuIsa::kScalar;
+}
+
+CpuIsa MaxCpuIsa4Env() {
+  const std::string max_isa = GetStringFromEnv("ONEFLOW_EP_CPU_MAX_ISA", "avx512");
+  if (max_isa == "scalar") {
+    return CpuIsa::kScalar;
+  } else if (max_isa == "avx2") {
+    return CpuIsa::kAvx2;
+  } else if (max_isa == "avx512") {
+    return CpuIsa::kAvx512;
+  } else {
+    LOG(WARNING) << "Unknown ONEFLOW_EP_CPU_MAX_ISA: " << max_isa;
+    return CpuIsa::kAvx512;
+  }
+}
+
+}  // namespace
+
+CpuIsa GetCpuIsa() {
+  static const CpuIsa isa = std::min(DetectCpuIsa(), MaxCpuIsa4Env());
+  return isa;
+}
+
+}  // namespace ep
+
+}  // namespace oneflow
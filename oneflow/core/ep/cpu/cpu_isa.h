@@ -0,0 +1,38 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_EP_CPU_CPU_ISA_H_
+#define ONEFLOW_CORE_EP_CPU_CPU_ISA_H_
+
+namespace oneflow {
+
+namespace ep {
+
+// Instruction set extensions used by the hand vectorized cpu primitives, in ascending order.
+enum class CpuIsa {
+  kScalar = 0,
+  kAvx2 = 1,    // avx2 + fma
+  kAvx512 = 2,  // avx512f
+};
+
+// Returns the best instruction set supported by the running cpu, it can be lowered by setting
+// ONEFLOW_EP_CPU_MAX_ISA to one of "scalar", "avx2" and "avx512".
+CpuIsa GetCpuIsa();
+
+}  // namespace ep
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_EP_CPU_CPU_ISA_H_
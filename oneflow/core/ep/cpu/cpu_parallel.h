@@ -0,0 +1,51 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_EP_CPU_CPU_PARALLEL_H_
+#define ONEFLOW_CORE_EP_CPU_CPU_PARALLEL_H_
+
+#include "oneflow/core/thread/thread_pool.h"
+#include "oneflow/core/platform/include/pthread_fork.h"
+
+namespace oneflow {
+
+namespace ep {
+
+// Runs DoRange(begin, end) over [0, num) on Global<ThreadPool> together with the calling thread.
+// Small loops, which are not larger than grain_size, and loops in a forked subprocess or without a
+// compute pool run on the calling thread directly.
+template<typename DoRangeT>
+void CpuParallelFor(size_t num, size_t grain_size, const DoRangeT& DoRange) {
+  if (num == 0) { return; }
+  ThreadPool* thread_pool = Global<ThreadPool>::Get();
+  if (num <= grain_size || thread_pool == nullptr || pthread_fork::IsForkedSubProcess()) {
+    DoRange(0, num);
+    return;
+  }
+  thread_pool->ParallelFor(num, grain_size, DoRange);
+}
+
+// Returns the number of threads, including the calling one, CpuParallelFor may run on.
+inline size_t CpuParallelNum() {
+  ThreadPool* thread_pool = Global<ThreadPool>::Get();
+  if (thread_pool == nullptr || pthread_fork::IsForkedSubProcess()) { return 1; }
+  return thread_pool->thread_num() + 1;
+}
+
+}  // namespace ep
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_EP_CPU_CPU_PARALLEL_H_
@@ -18,6 +18,8 @@ limitations under the License.
 #include "oneflow/core/ep/common/primitive/broadcast_elementwise_binary.h"
 #include "oneflow/core/ep/cpu/primitive/binary_functor.h"
 #include "oneflow/core/ep/cpu/primitive/type_seq.h"
+#include "oneflow/core/ep/cpu/primitive/vectorized_math.h"
+#include "oneflow/core/ep/cpu/cpu_parallel.h"
 #include "oneflow/core/ndarray/ndarray_util.h"
 #include "oneflow/core/ndarray/xpu_var_ndarray.h"
 
@@ -39,6 +41,161 @@ float16 GetValue<float16>(Scalar value) {
   return static_cast<float16>(GetValue<float>(value));
 }
 
+// Elements computed by a task of the thread pool at least.
+constexpr size_t kParallelGrainSize = 32768;
+// float16 is converted to float in blocks of this size.
+constexpr size_t kFloat16BlockSize = 512;
+
+// How the two operands of a contiguous run of dst are read.
+enum class LoopPattern {
+  kVecVec,     // both operands are contiguous
+  kScalarVec,  // src0 is a single element
+  kVecScalar,  // src1 is a single element
+};
+
+// The loops are simple enough to be vectorized by the compiler, they are compiled once for the
+// baseline instruction set and once for each of avx2 and avx512, see BinaryLoopFunc.
+template<BinaryOp binary_op, typename Src, typename Dst, LoopPattern pattern>
+ALWAYS_INLINE inline void BinaryLoop(size_t n, const Src* src0, const Src* src1, Dst* dst) {
+  BinaryFunctor<DeviceType::kCPU, binary_op, Src, Dst> functor;
+  if (pattern == LoopPattern::kVecVec) {
+    for (size_t i = 0; i < n; ++i) { dst[i] = functor(src0[i], src1[i]); }
+  } else if (pattern == LoopPattern::kScalarVec) {
+    const Src src0_val = *src0;
+    for (size_t i = 0; i < n; ++i) { dst[i] = functor(src0_val, src1[i]); }
+  } else {
+    const Src src1_val = *src1;
+    for (size_t i = 0; i < n; ++i) { dst[i] = functor(src0[i], src1_val); }
+  }
+}
+
+template<BinaryOp binary_op, typename Src, typename Dst, LoopPattern pattern>
+void BinaryLoopDefault(size_t n, const Src* src0, const Src* src1, Dst* dst) {
+  BinaryLoop<binary_op, Src, Dst, pattern>(n, src0, src1, dst);
+}
+
+#ifdef OF_CPU_X86_SIMD
+
+template<BinaryOp binary_op, typename Src, typename Dst, LoopPattern pattern>
+OF_CPU_AVX2_TARGET void BinaryLoopAvx2(size_t n, const Src* src0, const Src* src1, Dst* dst) {
+  BinaryLoop<binary_op, Src, Dst, pattern>(n, src0, src1, dst);
+}
+
+template<BinaryOp binary_op, typename Src, typename Dst, LoopPattern pattern>
+OF_CPU_AVX512_TARGET void BinaryLoopAvx512(size_t n, const Src* src0, const Src* src1, Dst* dst) {
+  BinaryLoop<binary_op, Src, Dst, pattern>(n, src0, src1, dst);
+}
+
+#endif  // OF_CPU_X86_SIMD
+
+template<BinaryOp binary_op, typename Src, typename Dst, LoopPattern pattern>
+struct BinaryLoopFunc {
+  using FuncType = void (*)(size_t n, const Src* src0, const Src* src1, Dst* dst);
+  static FuncType Get() {
+#ifdef OF_CPU_X86_SIMD
+    const CpuIsa isa = GetCpuIsa();
+    if (isa == CpuIsa::kAvx512) { return &BinaryLoopAvx512<binary_op, Src, Dst, pattern>; }
+    if (isa == CpuIsa::kAvx2) { return &BinaryLoopAvx2<binary_op, Src, Dst, pattern>; }
+#endif  // OF_CPU_X86_SIMD
+    return &BinaryLoopDefault<binary_op, Src, Dst, pattern>;
+  }
+};
+
+// Computes a contiguous run of dst.
+template<BinaryOp binary_op, typename Src, typename Dst>
+class BinaryRunKernel {
+ public:
+  BinaryRunKernel()
+      : vec_vec_(BinaryLoopFunc<binary_op, Src, Dst, LoopPattern::kVecVec>::Get()),
+        scalar_vec_(BinaryLoopFunc<binary_op, Src, Dst, LoopPattern::kScalarVec>::Get()),
+        vec_scalar_(BinaryLoopFunc<binary_op, Src, Dst, LoopPattern::kVecScalar>::Get()) {}
+
+  void operator()(LoopPattern pattern, size_t n, const Src* src0, const Src* src1,
+                  Dst* dst) const {
+    if (pattern == LoopPattern::kVecVec) {
+      vec_vec_(n, src0, src1, dst);
+    } else if (pattern == LoopPattern::kScalarVec) {
+      scalar_vec_(n, src0, src1, dst);
+    } else {
+      vec_scalar_(n, src0, src1, dst);
+    }
+  }
+
+ private:
+  typename BinaryLoopFunc<binary_op, Src, Dst, LoopPattern::kVecVec>::FuncType vec_vec_;
+  typename BinaryLoopFunc<binary_op, Src, Dst, LoopPattern::kScalarVec>::FuncType scalar_vec_;
+  typename BinaryLoopFunc<binary_op, Src, Dst, LoopPattern::kVecScalar>::FuncType vec_scalar_;
+};
+
+// float16 is computed in float, which gives the same results as the float16 operators since float
+// has more than twice the precision of float16.
+template<BinaryOp binary_op, typename Dst>
+class BinaryRunKernel<binary_op, float16, Dst> {
+ public:
+  using ComputeDst = typename std::conditional<std::is_same<Dst, float16>::value, float, Dst>::type;
+
+  void operator()(LoopPattern pattern, size_t n, const float16* src0, const float16* src1,
+                  Dst* dst) const {
+    float src0_block[kFloat16BlockSize];
+    float src1_block[kFloat16BlockSize];
+    ComputeDst dst_block[kFloat16BlockSize];
+    for (size_t offset = 0; offset < n; offset += kFloat16BlockSize) {
+      const size_t block_size = std::min(kFloat16BlockSize, n - offset);
+      if (pattern == LoopPattern::kScalarVec) {
+        src0_block[0] = static_cast<float>(*src0);
+      } else {
+        ConvertBlock(block_size, src0 + offset, src0_block);
+      }
+      if (pattern == LoopPattern::kVecScalar) {
+        src1_block[0] = static_cast<float>(*src1);
+      } else {
+        ConvertBlock(block_size, src1 + offset, src1_block);
+      }
+      float_kernel_(pattern, block_size, src0_block, src1_block, dst_block);
+      ConvertBlock(block_size, dst_block, dst + offset);
+    }
+  }
+
+ private:
+  template<typename From, typename To>
+  static void ConvertBlock(size_t n, const From* from, To* to) {
+    for (size_t i = 0; i < n; ++i) { to[i] = static_cast<To>(from[i]); }
+  }
+
+  BinaryRunKernel<binary_op, float, ComputeDst> float_kernel_;
+};
+
+// An operand of a [rows, cols] broadcast: row_stride is 0 if it is broadcast along the rows and
+// is_col_broadcast is true if it has a single element per row.
+template<typename Src>
+struct BinaryOperand {
+  const Src* ptr;
+  size_t row_stride;
+  bool is_col_broadcast;
+};
+
+// Computes dst of shape [rows, cols], the flat dst is split into ranges of at least
+// kParallelGrainSize elements which run on the thread pool.
+template<BinaryOp binary_op, typename Src, typename Dst>
+void LaunchRows(const BinaryRunKernel<binary_op, Src, Dst>& kernel, size_t rows, size_t cols,
+                const BinaryOperand<Src>& src0, const BinaryOperand<Src>& src1, Dst* dst) {
+  CHECK(!(src0.is_col_broadcast && src1.is_col_broadcast));
+  const LoopPattern pattern = src0.is_col_broadcast   ? LoopPattern::kScalarVec
+                              : src1.is_col_broadcast ? LoopPattern::kVecScalar
+                                                      : LoopPattern::kVecVec;
+  CpuParallelFor(rows * cols, kParallelGrainSize, [&](size_t begin, size_t end) {
+    size_t offset = begin;
+    while (offset < end) {
+      const size_t row = offset / cols;
+      const size_t col = offset % cols;
+      const size_t n = std::min(cols - col, end - offset);
+      kernel(pattern, n, src0.ptr + row * src0.row_stride + (src0.is_col_broadcast ? 0 : col),
+             src1.ptr + row * src1.row_stride + (src1.is_col_broadcast ? 0 : col), dst + offset);
+      offset += n;
+    }
+  });
+}
+
 template<BinaryOp binary_op, typename Src, typename Dst,
          void (*binary_func)(ep::Stream* stream, const XpuVarNdarray<Dst>& z,
                              const XpuVarNdarray<const Src>& x, const XpuVarNdarray<const Src>& y)>
@@ -52,17 +209,17 @@ class BroadcastElementwiseBinaryImpl : public BroadcastElementwiseBinary {
               const void* src1, void* dst) override {
     int64_t elem_cnt = GetElementCount(num_src1_dims, src1_dims);
     Src src0_val = GetValue<Src>(src0);
-    binary_func(stream, XpuVarNdarray<Dst>(Shape({elem_cnt}), reinterpret_cast<Dst*>(dst), 1),
-                XpuVarNdarray<const Src>(Shape({1}), &src0_val, 1),
-                XpuVarNdarray<const Src>(Shape({elem_cnt}), reinterpret_cast<const Src*>(src1), 1));
+    LaunchRows(kernel_, 1, elem_cnt, BinaryOperand<Src>{&src0_val, 0, true},
+               BinaryOperand<Src>{reinterpret_cast<const Src*>(src1), 0, false},
+               reinterpret_cast<Dst*>(dst));
   }
   void Launch(Stream* stream, size_t num_src0_dims, const int64_t* src0_dims, const void* src0,
               Scalar src1, void* dst) override {
     int64_t elem_cnt = GetElementCount(num_src0_dims, src0_dims);
     Src src1_val = GetValue<Src>(src1);
-    binary_func(stream, XpuVarNdarray<Dst>(Shape({elem_cnt}), reinterpret_cast<Dst*>(dst), 1),
-                XpuVarNdarray<const Src>(Shape({elem_cnt}), reinterpret_cast<const Src*>(src0), 1),
-                XpuVarNdarray<const Src>(Shape({1}), &src1_val, 1));
+    LaunchRows(kernel_, 1, elem_cnt,
+               BinaryOperand<Src>{reinterpret_cast<const Src*>(src0), 0, false},
+               BinaryOperand<Src>{&src1_val, 0, true}, reinterpret_cast<Dst*>(dst));
   }
   void Launch(Stream* stream, size_t num_src0_dims, const int64_t* src0_dims, const void* src0,
               size_t num_src1_dims, const int64_t* src1_dims, const void* src1,
@@ -79,6 +236,21 @@ class BroadcastElementwiseBinaryImpl : public BroadcastElementwiseBinary {
                                        simplified_dst_dims);
     CheckInplace(num_dims, simplified_src0_dims, src0, simplified_src1_dims, src1,
                  simplified_dst_dims, dst);
+    if (num_dims <= 2) {
+      // same shape, scalar-tensor, row and column broadcast
+      const size_t rows = num_dims == 2 ? simplified_dst_dims[0] : 1;
+      const size_t cols = simplified_dst_dims[num_dims - 1];
+      auto MakeOperand = [&](const int64_t* dims, const void* ptr) {
+        const bool is_col_broadcast = (dims[num_dims - 1] == 1 && cols != 1);
+        const bool is_row_broadcast = (num_dims == 1 || dims[0] == 1);
+        return BinaryOperand<Src>{reinterpret_cast<const Src*>(ptr),
+                                  is_row_broadcast ? 0 : (is_col_broadcast ? 1 : cols),
+                                  is_col_broadcast};
+      };
+      LaunchRows(kernel_, rows, cols, MakeOperand(simplified_src0_dims, src0),
+                 MakeOperand(simplified_src1_dims, src1), reinterpret_cast<Dst*>(dst));
+      return;
+    }
     for (int64_t i = 0; i < num_dims; ++i) {
       src0_dim_vec.push_back(simplified_src0_dims[i]);
       src1_dim_vec.push_back(simplified_src1_dims[i]);
@@ -90,6 +262,9 @@ class BroadcastElementwiseBinaryImpl : public BroadcastElementwiseBinary {
         XpuVarNdarray<const Src>(Shape(src1_dim_vec), reinterpret_cast<const Src*>(src1),
                                  num_dims));
   }
+
+ private:
+  BinaryRunKernel<binary_op, Src, Dst> kernel_;
 };
 
 template<BinaryOp binary_op, typename Src, typename Dst,
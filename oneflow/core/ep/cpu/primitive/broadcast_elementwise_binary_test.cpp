@@ -0,0 +1,116 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/ep/include/primitive/broadcast_elementwise_binary.h"
+#include "oneflow/core/ep/common/primitive/util.h"
+#include <gtest/gtest.h>
+
+namespace oneflow {
+
+namespace ep {
+namespace primitive {
+
+namespace {
+
+std::vector<float> MakeInput(const std::vector<int64_t>& dims, float start) {
+  std::vector<float> input(GetElementCount(dims.size(), dims.data()));
+  for (size_t i = 0; i < input.size(); ++i) { input[i] = start + static_cast<float>(i % 97); }
+  return input;
+}
+
+// Reads src of dims, right aligned and broadcast to the 3d dst_dims, at dst index (i, j, k).
+float BroadcastAt(const std::vector<float>& src, std::vector<int64_t> dims,
+                  const std::vector<int64_t>& dst_dims, int64_t i, int64_t j, int64_t k) {
+  while (dims.size() < dst_dims.size()) { dims.insert(dims.begin(), 1); }
+  const int64_t index[3] = {dims[0] == 1 ? 0 : i, dims[1] == 1 ? 0 : j, dims[2] == 1 ? 0 : k};
+  return src[(index[0] * dims[1] + index[1]) * dims[2] + index[2]];
+}
+
+}  // namespace
+
+TEST(BroadcastElementwiseBinary, cpu_patterns) {
+  std::unique_ptr<BroadcastElementwiseBinary> sub =
+      NewPrimitive<BroadcastElementwiseBinaryFactory>(DeviceType::kCPU, BinaryOp::kSub,
+                                                      DataType::kFloat, DataType::kFloat, 3);
+  ASSERT_TRUE(sub);
+  // same shape, scalar, row broadcast, column broadcast, outer and a generic 3d broadcast
+  const std::vector<std::pair<std::vector<int64_t>, std::vector<int64_t>>> cases = {
+      {{2, 300, 700}, {2, 300, 700}}, {{2, 300, 700}, {1}},    {{1}, {2, 300, 700}},
+      {{2, 300, 700}, {700}},         {{700}, {2, 300, 700}},  {{2, 300, 700}, {2, 300, 1}},
+      {{2, 300, 1}, {2, 300, 700}},   {{600, 1, 1}, {1, 700}}, {{2, 1, 700}, {1, 300, 1}},
+  };
+  for (const auto& dims_pair : cases) {
+    const std::vector<int64_t>& src0_dims = dims_pair.first;
+    const std::vector<int64_t>& src1_dims = dims_pair.second;
+    std::vector<int64_t> dst_dims(3);
+    for (int i = 0; i < 3; ++i) {
+      const int64_t src0_dim = i < 3 - static_cast<int>(src0_dims.size())
+                                   ? 1
+                                   : src0_dims[i - 3 + src0_dims.size()];
+      const int64_t src1_dim = i < 3 - static_cast<int>(src1_dims.size())
+                                   ? 1
+                                   : src1_dims[i - 3 + src1_dims.size()];
+      dst_dims[i] = std::max(src0_dim, src1_dim);
+    }
+    const std::vector<float> src0 = MakeInput(src0_dims, 0);
+    const std::vector<float> src1 = MakeInput(src1_dims, 0.5);
+    std::vector<float> dst(GetElementCount(3, dst_dims.data()));
+    sub->Launch(nullptr, src0_dims.size(), src0_dims.data(), src0.data(), src1_dims.size(),
+                src1_dims.data(), src1.data(), dst.data());
+    FOR_RANGE(int64_t, i, 0, dst_dims[0]) {
+      FOR_RANGE(int64_t, j, 0, dst_dims[1]) {
+        FOR_RANGE(int64_t, k, 0, dst_dims[2]) {
+          const float expected = BroadcastAt(src0, src0_dims, dst_dims, i, j, k)
+                                 - BroadcastAt(src1, src1_dims, dst_dims, i, j, k);
+          ASSERT_EQ(dst[(i * dst_dims[1] + j) * dst_dims[2] + k], expected);
+        }
+      }
+    }
+  }
+}
+
+TEST(BroadcastElementwiseBinary, cpu_inplace_and_scalar) {
+  std::unique_ptr<BroadcastElementwiseBinary> mul =
+      NewPrimitive<BroadcastElementwiseBinaryFactory>(DeviceType::kCPU, BinaryOp::kMul,
+                                                      DataType::kFloat16, DataType::kFloat16, 2);
+  std::unique_ptr<BroadcastElementwiseBinary> less =
+      NewPrimitive<BroadcastElementwiseBinaryFactory>(DeviceType::kCPU, BinaryOp::kLessThan,
+                                                      DataType::kFloat16, DataType::kInt8, 2);
+  ASSERT_TRUE(mul);
+  ASSERT_TRUE(less);
+  const std::vector<int64_t> dims = {1000, 129};
+  const std::vector<int64_t> row_dims = {129};
+  std::vector<float16> x(1000 * 129);
+  std::vector<float16> row(129);
+  for (size_t i = 0; i < x.size(); ++i) { x[i] = static_cast<float16>((i % 17) * 0.5f); }
+  for (size_t i = 0; i < row.size(); ++i) { row[i] = static_cast<float16>(i % 3); }
+  std::vector<float16> expected(x.size());
+  for (size_t i = 0; i < x.size(); ++i) { expected[i] = x[i] * row[i % 129]; }
+  mul->Launch(nullptr, dims.size(), dims.data(), x.data(), row_dims.size(), row_dims.data(),
+              row.data(), x.data());
+  for (size_t i = 0; i < x.size(); ++i) {
+    ASSERT_EQ(static_cast<float>(x[i]), static_cast<float>(expected[i]));
+  }
+  std::vector<int8_t> mask(x.size());
+  less->Launch(nullptr, dims.size(), dims.data(), x.data(), Scalar(2.0), mask.data());
+  for (size_t i = 0; i < x.size(); ++i) {
+    ASSERT_EQ(mask[i], static_cast<int8_t>(static_cast<float>(x[i]) < 2.0f));
+  }
+}
+
+}  // namespace primitive
+}  // namespace ep
+
+}  // namespace oneflow
@@ -15,6 +15,8 @@ limitations under the License.
 */
 #include "oneflow/core/ep/include/primitive/permute.h"
 #include "oneflow/core/ep/common/primitive/permute_impl.h"
+#include "oneflow/core/ep/cpu/cpu_parallel.h"
+#include "oneflow/core/ep/cpu/primitive/vectorized_math.h"
 
 namespace oneflow {
 
@@ -27,30 +29,194 @@ namespace internal {
 
 namespace {
 
+// Number of elements moved by one CpuParallelFor work item.
+constexpr size_t kParallelGrainSize = 32 * 1024;
+// The 2d transpose moves square tiles, a 32 x 32 tile of 16 bytes elements is 16KB.
+constexpr int64_t kTileSize = 32;
+
+// Walks dst in order and steps the src offset along, the nd index is only decoded once per range.
 template<size_t num_dims, size_t movement_size, typename IndexType>
-void PermuteKernel(PermuteKernelParams<num_dims, IndexType> params) {
+void PermuteKernel(PermuteKernelParams<num_dims, IndexType> params, const int64_t* src_dims) {
   using T = typename std::aligned_storage<movement_size, movement_size>::type;
   const T* src = reinterpret_cast<const T*>(params.src);
   T* dst = reinterpret_cast<T*>(params.dst);
-  for (IndexType i = 0; i < params.count; ++i) {
-    IndexType src_index[num_dims];
+  IndexType src_strides[num_dims];
+  src_strides[num_dims - 1] = 1;
+  for (int dim = static_cast<int>(num_dims) - 2; dim >= 0; --dim) {
+    src_strides[dim] = src_strides[dim + 1] * src_dims[dim + 1];
+  }
+  // dst_dims[dim] and the src stride of one step along dst dim
+  IndexType dst_dims[num_dims];
+  IndexType strides[num_dims];
+  for (size_t dim = 0; dim < num_dims; ++dim) {
+    dst_dims[dim] = src_dims[params.permutation[dim]];
+    strides[dim] = src_strides[params.permutation[dim]];
+  }
+  const IndexType inner_dim = dst_dims[num_dims - 1];
+  const IndexType inner_stride = strides[num_dims - 1];
+  CpuParallelFor(params.count, kParallelGrainSize, [&](size_t begin, size_t end) {
     IndexType dst_index[num_dims];
-    params.dst_index_helper.OffsetToNdIndex(i, dst_index);
-    for (size_t dim = 0; dim < num_dims; ++dim) {
-      src_index[params.permutation[dim]] = dst_index[dim];
+    params.dst_index_helper.OffsetToNdIndex(static_cast<IndexType>(begin), dst_index);
+    IndexType src_offset = 0;
+    for (size_t dim = 0; dim < num_dims; ++dim) { src_offset += dst_index[dim] * strides[dim]; }
+    const IndexType end_index = static_cast<IndexType>(end);
+    IndexType i = static_cast<IndexType>(begin);
+    while (true) {
+      const IndexType n = std::min<IndexType>(inner_dim - dst_index[num_dims - 1], end_index - i);
+      const T* src_row = src + src_offset;
+      T* dst_row = dst + i;
+      for (IndexType j = 0; j < n; ++j) { dst_row[j] = src_row[j * inner_stride]; }
+      i += n;
+      if (i >= end_index) { break; }
+      // the innermost dim wrapped around, carry into the outer dims
+      src_offset += (n - inner_dim) * inner_stride;
+      dst_index[num_dims - 1] = 0;
+      for (int dim = static_cast<int>(num_dims) - 2; dim >= 0; --dim) {
+        dst_index[dim] += 1;
+        src_offset += strides[dim];
+        if (dst_index[dim] < dst_dims[dim]) { break; }
+        src_offset -= dst_dims[dim] * strides[dim];
+        dst_index[dim] = 0;
+      }
+    }
+  });
+}
+
+template<typename T, typename IndexType>
+void TransposeTile(const T* src, IndexType src_ld, T* dst, IndexType dst_ld, IndexType rows,
+                   IndexType cols) {
+  for (IndexType c = 0; c < cols; ++c) {
+    for (IndexType r = 0; r < rows; ++r) { dst[c * dst_ld + r] = src[r * src_ld + c]; }
+  }
+}
+
+#ifdef OF_CPU_X86_SIMD
+
+// Transposes an 8 x 8 block of 4 bytes elements in registers. The shuffles only move bits, so
+// it is good for any 4 bytes data type.
+OF_CPU_AVX2_TARGET inline void Transpose8x8Avx2(const float* src, int64_t src_ld, float* dst,
+                                                int64_t dst_ld) {
+  const __m256 r0 = _mm256_loadu_ps(src + 0 * src_ld);
+  const __m256 r1 = _mm256_loadu_ps(src + 1 * src_ld);
+  const __m256 r2 = _mm256_loadu_ps(src + 2 * src_ld);
+  const __m256 r3 = _mm256_loadu_ps(src + 3 * src_ld);
+  const __m256 r4 = _mm256_loadu_ps(src + 4 * src_ld);
+  const __m256 r5 = _mm256_loadu_ps(src + 5 * src_ld);
+  const __m256 r6 = _mm256_loadu_ps(src + 6 * src_ld);
+  const __m256 r7 = _mm256_loadu_ps(src + 7 * src_ld);
+  const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+  const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+  const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+  const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+  const __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+  const __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+  const __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+  const __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+  const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+  _mm256_storeu_ps(dst + 0 * dst_ld, _mm256_permute2f128_ps(s0, s4, 0x20));
+  _mm256_storeu_ps(dst + 1 * dst_ld, _mm256_permute2f128_ps(s1, s5, 0x20));
+  _mm256_storeu_ps(dst + 2 * dst_ld, _mm256_permute2f128_ps(s2, s6, 0x20));
+  _mm256_storeu_ps(dst + 3 * dst_ld, _mm256_permute2f128_ps(s3, s7, 0x20));
+  _mm256_storeu_ps(dst + 4 * dst_ld, _mm256_permute2f128_ps(s0, s4, 0x31));
+  _mm256_storeu_ps(dst + 5 * dst_ld, _mm256_permute2f128_ps(s1, s5, 0x31));
+  _mm256_storeu_ps(dst + 6 * dst_ld, _mm256_permute2f128_ps(s2, s6, 0x31));
+  _mm256_storeu_ps(dst + 7 * dst_ld, _mm256_permute2f128_ps(s3, s7, 0x31));
+}
+
+template<typename IndexType>
+OF_CPU_AVX2_TARGET void TransposeTileAvx2(const float* src, IndexType src_ld, float* dst,
+                                          IndexType dst_ld, IndexType rows, IndexType cols) {
+  const IndexType body_rows = rows / 8 * 8;
+  const IndexType body_cols = cols / 8 * 8;
+  for (IndexType r = 0; r < body_rows; r += 8) {
+    for (IndexType c = 0; c < body_cols; c += 8) {
+      Transpose8x8Avx2(src + r * src_ld + c, src_ld, dst + c * dst_ld + r, dst_ld);
     }
-    IndexType src_offset = params.src_index_helper.NdIndexToOffset(src_index);
-    dst[i] = src[src_offset];
+  }
+  if (body_cols < cols) {
+    TransposeTile<float, IndexType>(src + body_cols, src_ld, dst + body_cols * dst_ld, dst_ld,
+                                    rows, cols - body_cols);
+  }
+  if (body_rows < rows) {
+    TransposeTile<float, IndexType>(src + body_rows * src_ld, src_ld, dst + body_rows, dst_ld,
+                                    rows - body_rows, body_cols);
+  }
+}
+
+#endif  // OF_CPU_X86_SIMD
+
+// dst[b][c][r] = src[b][r][c], src is of shape (num_batches, rows, cols).
+template<size_t movement_size, typename IndexType>
+void LaunchBatchTranspose(IndexType num_batches, IndexType rows, IndexType cols, const void* src,
+                          void* dst) {
+  using T = typename std::aligned_storage<movement_size, movement_size>::type;
+  const T* src_ptr = reinterpret_cast<const T*>(src);
+  T* dst_ptr = reinterpret_cast<T*>(dst);
+  const IndexType row_tiles = (rows + kTileSize - 1) / kTileSize;
+  const IndexType col_tiles = (cols + kTileSize - 1) / kTileSize;
+  const IndexType tiles_per_batch = row_tiles * col_tiles;
+  bool use_avx2 = false;
+#ifdef OF_CPU_X86_SIMD
+  use_avx2 = movement_size == 4 && GetCpuIsa() >= CpuIsa::kAvx2;
+#endif  // OF_CPU_X86_SIMD
+  const size_t grain_size = std::max<size_t>(kParallelGrainSize / (kTileSize * kTileSize), 1);
+  CpuParallelFor(num_batches * tiles_per_batch, grain_size, [&](size_t begin, size_t end) {
+    for (IndexType i = static_cast<IndexType>(begin); i < static_cast<IndexType>(end); ++i) {
+      const IndexType batch = i / tiles_per_batch;
+      const IndexType tile = i - batch * tiles_per_batch;
+      const IndexType row = tile / col_tiles * kTileSize;
+      const IndexType col = tile % col_tiles * kTileSize;
+      const IndexType tile_rows = std::min<IndexType>(kTileSize, rows - row);
+      const IndexType tile_cols = std::min<IndexType>(kTileSize, cols - col);
+      const T* tile_src = src_ptr + batch * rows * cols + row * cols + col;
+      T* tile_dst = dst_ptr + batch * rows * cols + col * rows + row;
+#ifdef OF_CPU_X86_SIMD
+      if (use_avx2) {
+        TransposeTileAvx2<IndexType>(reinterpret_cast<const float*>(tile_src), cols,
+                                     reinterpret_cast<float*>(tile_dst), rows, tile_rows,
+                                     tile_cols);
+        continue;
+      }
+#endif  // OF_CPU_X86_SIMD
+      TransposeTile<T, IndexType>(tile_src, cols, tile_dst, rows, tile_rows, tile_cols);
+    }
+  });
+}
+
+// SimplifyPermutation merges the dims which stay adjacent, so a batched 2d transpose always
+// comes here as (1, 0) or (0, 2, 1).
+template<size_t num_dims>
+bool IsBatchTranspose(const int* permutation) {
+  if (num_dims == 2) {
+    return permutation[0] == 1 && permutation[1] == 0;
+  } else if (num_dims == 3) {
+    return permutation[0] == 0 && permutation[1] == 2 && permutation[2] == 1;
+  } else {
+    return false;
   }
 }
 
 template<size_t num_dims, size_t movement_size, typename IndexType>
 void LaunchKernel(Stream* stream, const int64_t* src_dims, const void* src, const int* permutation,
                   void* dst, size_t count) {
+  if (IsBatchTranspose<num_dims>(permutation)) {
+    const int64_t num_batches = num_dims == 2 ? 1 : src_dims[0];
+    LaunchBatchTranspose<movement_size, IndexType>(num_batches, src_dims[num_dims - 2],
+                                                   src_dims[num_dims - 1], src, dst);
+    return;
+  }
   PermuteKernelParams<num_dims, IndexType> params =
       MakePermuteParams<num_dims, IndexType>(src_dims, src, permutation, dst, count);
-  PermuteKernel<num_dims, movement_size, IndexType>(params);
+  PermuteKernel<num_dims, movement_size, IndexType>(params, src_dims);
 }
+
 class PermuteImpl : public Permute {
  public:
   OF_DISALLOW_COPY_AND_MOVE(PermuteImpl);
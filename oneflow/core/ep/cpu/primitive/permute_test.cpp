@@ -0,0 +1,78 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/ep/include/primitive/permute.h"
+#include "oneflow/core/ep/common/primitive/util.h"
+#include <gtest/gtest.h>
+
+namespace oneflow {
+
+namespace ep {
+namespace primitive {
+
+namespace {
+
+template<typename T>
+void TestPermute(DataType data_type, const std::vector<int64_t>& src_dims,
+                 const std::vector<int>& permutation) {
+  const size_t num_dims = src_dims.size();
+  std::unique_ptr<Permute> permute = NewPrimitive<PermuteFactory>(DeviceType::kCPU, num_dims);
+  ASSERT_TRUE(permute);
+  const int64_t count = GetElementCount(num_dims, src_dims.data());
+  std::vector<T> src(count);
+  for (int64_t i = 0; i < count; ++i) { src[i] = static_cast<T>(i % 127); }
+  std::vector<T> dst(count);
+  permute->Launch(nullptr, data_type, num_dims, src_dims.data(), src.data(), permutation.data(),
+                  dst.data());
+  std::vector<int64_t> src_strides(num_dims, 1);
+  for (int dim = static_cast<int>(num_dims) - 2; dim >= 0; --dim) {
+    src_strides[dim] = src_strides[dim + 1] * src_dims[dim + 1];
+  }
+  for (int64_t i = 0; i < count; ++i) {
+    int64_t remaining = i;
+    int64_t src_offset = 0;
+    for (int dim = static_cast<int>(num_dims) - 1; dim >= 0; --dim) {
+      const int64_t dst_dim = src_dims[permutation[dim]];
+      src_offset += remaining % dst_dim * src_strides[permutation[dim]];
+      remaining /= dst_dim;
+    }
+    ASSERT_EQ(dst[i], src[src_offset]);
+  }
+}
+
+}  // namespace
+
+TEST(Permute, cpu_batch_transpose) {
+  // tile tails on both dims, a single row and the (0, 2, 1) batched form
+  TestPermute<float>(DataType::kFloat, {37, 1029}, {1, 0});
+  TestPermute<float>(DataType::kFloat, {1, 100}, {1, 0});
+  TestPermute<float>(DataType::kFloat, {3, 65, 47}, {0, 2, 1});
+  TestPermute<int8_t>(DataType::kInt8, {300, 129}, {1, 0});
+  TestPermute<double>(DataType::kDouble, {4, 33, 70}, {0, 2, 1});
+}
+
+TEST(Permute, cpu_general) {
+  // NCHW <-> NHWC, a full reverse and a 5d shuffle which does not simplify
+  TestPermute<float>(DataType::kFloat, {2, 3, 57, 61}, {0, 2, 3, 1});
+  TestPermute<float>(DataType::kFloat, {2, 57, 61, 3}, {0, 3, 1, 2});
+  TestPermute<int32_t>(DataType::kInt32, {5, 6, 7}, {2, 1, 0});
+  TestPermute<double>(DataType::kDouble, {3, 4, 5, 6, 7}, {4, 2, 0, 3, 1});
+  TestPermute<int8_t>(DataType::kInt8, {64, 3, 256}, {1, 2, 0});
+}
+
+}  // namespace primitive
+}  // namespace ep
+
+}  // namespace oneflow
@@ -16,6 +16,9 @@ limitations under the License.
 #include "oneflow/core/ep/include/primitive/softmax.h"
 #include "oneflow/core/ep/include/primitive/log_softmax.h"
 #include "oneflow/core/ep/cpu/primitive/type_seq.h"
+#include "oneflow/core/ep/cpu/primitive/vectorized_math.h"
+#include "oneflow/core/ep/cpu/cpu_parallel.h"
+#include <limits>
 
 namespace oneflow {
 
@@ -29,38 +32,247 @@ enum class Algorithm {
   kLogSoftmax,
 };
 
+// Rows longer than this do not stay in L2 cache, the vectorized kernels compute max and sum in one
+// online pass for them to save a pass over memory.
+constexpr size_t kOnlineSoftmaxMinRowBytes = 256 * 1024;
+// Number of elements a task of the row parallel loop handles at least.
+constexpr size_t kParallelGrainSize = 32 * 1024;
+
 template<Algorithm algorithm, typename T>
-void SoftmaxCpu(size_t rows, size_t cols, const T* x, T* y) {
-  for (size_t i = 0; i < rows; ++i) {
-    size_t row_offset = i * cols;
-    const T* row_x = x + row_offset;
-    T* row_y = y + row_offset;
-    const T row_max = *std::max_element(row_x, row_x + cols);
-    T row_sum = 0;
-    for (size_t j = 0; j < cols; ++j) {
-      if (algorithm == Algorithm::kSoftmax) {
-        T exp_x = std::exp(row_x[j] - row_max);
-        row_sum += exp_x;
-        row_y[j] = exp_x;
-      } else if (algorithm == Algorithm::kLogSoftmax) {
-        row_y[j] = row_x[j] - row_max;
-        row_sum += std::exp(row_y[j]);
-      } else {
-        UNIMPLEMENTED();
-      }
-    }
-    for (size_t j = 0; j < cols; ++j) {
-      if (algorithm == Algorithm::kSoftmax) {
-        row_y[j] /= row_sum;
-      } else if (algorithm == Algorithm::kLogSoftmax) {
-        row_y[j] -= std::log(row_sum);
-      } else {
-        UNIMPLEMENTED();
-      }
+void SoftmaxRowScalar(size_t cols, const T* row_x, T* row_y) {
+  const T row_max = *std::max_element(row_x, row_x + cols);
+  T row_sum = 0;
+  for (size_t j = 0; j < cols; ++j) {
+    if (algorithm == Algorithm::kSoftmax) {
+      T exp_x = std::exp(row_x[j] - row_max);
+      row_sum += exp_x;
+      row_y[j] = exp_x;
+    } else if (algorithm == Algorithm::kLogSoftmax) {
+      row_y[j] = row_x[j] - row_max;
+      row_sum += std::exp(row_y[j]);
+    } else {
+      UNIMPLEMENTED();
+    }
+  }
+  for (size_t j = 0; j < cols; ++j) {
+    if (algorithm == Algorithm::kSoftmax) {
+      row_y[j] /= row_sum;
+    } else if (algorithm == Algorithm::kLogSoftmax) {
+      row_y[j] -= std::log(row_sum);
+    } else {
+      UNIMPLEMENTED();
+    }
+  }
+}
+
+#ifdef OF_CPU_X86_SIMD
+
+using vectorized_math::Exp256;
+using vectorized_math::Exp512;
+using vectorized_math::ExpApprox;
+using vectorized_math::ReduceMax256;
+using vectorized_math::ReduceSum256;
+
+// Adds the tail elements [begin, cols) to the online (max, sum) pair.
+inline void OnlineSoftmaxTail(size_t begin, size_t cols, const float* row_x, float* row_max,
+                              float* row_sum) {
+  for (size_t j = begin; j < cols; ++j) {
+    if (row_x[j] > *row_max) {
+      *row_sum = *row_sum * ExpApprox(*row_max - row_x[j]) + 1.0f;
+      *row_max = row_x[j];
+    } else {
+      *row_sum += ExpApprox(row_x[j] - *row_max);
+    }
+  }
+}
+
+// Finishes a row once its max and sum of exp are known. `y_is_exp` tells whether row_y already
+// holds exp(x - max).
+template<Algorithm algorithm>
+OF_CPU_AVX2_TARGET void SoftmaxNormalizeRowAvx2(size_t cols, const float* row_x, float row_max,
+                                                float row_sum, bool y_is_exp, float* row_y) {
+  constexpr size_t kPackSize = 8;
+  const size_t vec_cols = cols / kPackSize * kPackSize;
+  if (algorithm == Algorithm::kSoftmax) {
+    const float inv_sum = 1.0f / row_sum;
+    const __m256 v_inv_sum = _mm256_set1_ps(inv_sum);
+    const __m256 v_max = _mm256_set1_ps(row_max);
+    for (size_t j = 0; j < vec_cols; j += kPackSize) {
+      const __m256 e = y_is_exp ? _mm256_loadu_ps(row_y + j)
+                                : Exp256(_mm256_sub_ps(_mm256_loadu_ps(row_x + j), v_max));
+      _mm256_storeu_ps(row_y + j, _mm256_mul_ps(e, v_inv_sum));
+    }
+    for (size_t j = vec_cols; j < cols; ++j) {
+      const float e = y_is_exp ? row_y[j] : ExpApprox(row_x[j] - row_max);
+      row_y[j] = e * inv_sum;
+    }
+  } else if (algorithm == Algorithm::kLogSoftmax) {
+    const float shift = row_max + std::log(row_sum);
+    const __m256 v_shift = _mm256_set1_ps(shift);
+    for (size_t j = 0; j < vec_cols; j += kPackSize) {
+      _mm256_storeu_ps(row_y + j, _mm256_sub_ps(_mm256_loadu_ps(row_x + j), v_shift));
+    }
+    for (size_t j = vec_cols; j < cols; ++j) { row_y[j] = row_x[j] - shift; }
+  } else {
+    UNIMPLEMENTED();
+  }
+}
+
+template<Algorithm algorithm>
+OF_CPU_AVX2_TARGET void SoftmaxRowAvx2(size_t cols, const float* row_x, float* row_y) {
+  constexpr size_t kPackSize = 8;
+  const size_t vec_cols = cols / kPackSize * kPackSize;
+  float row_max = -std::numeric_limits<float>::max();
+  float row_sum = 0;
+  bool y_is_exp = false;
+  if (cols * sizeof(float) < kOnlineSoftmaxMinRowBytes) {
+    __m256 v_max = _mm256_set1_ps(row_max);
+    for (size_t j = 0; j < vec_cols; j += kPackSize) {
+      v_max = _mm256_max_ps(v_max, _mm256_loadu_ps(row_x + j));
+    }
+    row_max = ReduceMax256(v_max);
+    for (size_t j = vec_cols; j < cols; ++j) { row_max = std::max(row_max, row_x[j]); }
+    v_max = _mm256_set1_ps(row_max);
+    __m256 v_sum = _mm256_setzero_ps();
+    for (size_t j = 0; j < vec_cols; j += kPackSize) {
+      const __m256 e = Exp256(_mm256_sub_ps(_mm256_loadu_ps(row_x + j), v_max));
+      if (algorithm == Algorithm::kSoftmax) { _mm256_storeu_ps(row_y + j, e); }
+      v_sum = _mm256_add_ps(v_sum, e);
+    }
+    row_sum = ReduceSum256(v_sum);
+    for (size_t j = vec_cols; j < cols; ++j) {
+      const float e = ExpApprox(row_x[j] - row_max);
+      if (algorithm == Algorithm::kSoftmax) { row_y[j] = e; }
+      row_sum += e;
     }
+    y_is_exp = (algorithm == Algorithm::kSoftmax);
+  } else {
+    // online softmax: every lane keeps its own max and the sum of exp rescaled to that max.
+    __m256 v_max = _mm256_set1_ps(row_max);
+    __m256 v_sum = _mm256_setzero_ps();
+    for (size_t j = 0; j < vec_cols; j += kPackSize) {
+      const __m256 x = _mm256_loadu_ps(row_x + j);
+      const __m256 new_max = _mm256_max_ps(v_max, x);
+      v_sum = _mm256_fmadd_ps(v_sum, Exp256(_mm256_sub_ps(v_max, new_max)),
+                              Exp256(_mm256_sub_ps(x, new_max)));
+      v_max = new_max;
+    }
+    row_max = ReduceMax256(v_max);
+    row_sum = ReduceSum256(
+        _mm256_mul_ps(v_sum, Exp256(_mm256_sub_ps(v_max, _mm256_set1_ps(row_max)))));
+    OnlineSoftmaxTail(vec_cols, cols, row_x, &row_max, &row_sum);
+  }
+  SoftmaxNormalizeRowAvx2<algorithm>(cols, row_x, row_max, row_sum, y_is_exp, row_y);
+}
+
+template<Algorithm algorithm>
+OF_CPU_AVX512_TARGET void SoftmaxNormalizeRowAvx512(size_t cols, const float* row_x,
+                                                    float row_max, float row_sum, bool y_is_exp,
+                                                    float* row_y) {
+  constexpr size_t kPackSize = 16;
+  const size_t vec_cols = cols / kPackSize * kPackSize;
+  if (algorithm == Algorithm::kSoftmax) {
+    const float inv_sum = 1.0f / row_sum;
+    const __m512 v_inv_sum = _mm512_set1_ps(inv_sum);
+    const __m512 v_max = _mm512_set1_ps(row_max);
+    for (size_t j = 0; j < vec_cols; j += kPackSize) {
+      const __m512 e = y_is_exp ? _mm512_loadu_ps(row_y + j)
+                                : Exp512(_mm512_sub_ps(_mm512_loadu_ps(row_x + j), v_max));
+      _mm512_storeu_ps(row_y + j, _mm512_mul_ps(e, v_inv_sum));
+    }
+    for (size_t j = vec_cols; j < cols; ++j) {
+      const float e = y_is_exp ? row_y[j] : ExpApprox(row_x[j] - row_max);
+      row_y[j] = e * inv_sum;
+    }
+  } else if (algorithm == Algorithm::kLogSoftmax) {
+    const float shift = row_max + std::log(row_sum);
+    const __m512 v_shift = _mm512_set1_ps(shift);
+    for (size_t j = 0; j < vec_cols; j += kPackSize) {
+      _mm512_storeu_ps(row_y + j, _mm512_sub_ps(_mm512_loadu_ps(row_x + j), v_shift));
+    }
+    for (size_t j = vec_cols; j < cols; ++j) { row_y[j] = row_x[j] - shift; }
+  } else {
+    UNIMPLEMENTED();
   }
 }
 
+template<Algorithm algorithm>
+OF_CPU_AVX512_TARGET void SoftmaxRowAvx512(size_t cols, const float* row_x, float* row_y) {
+  constexpr size_t kPackSize = 16;
+  const size_t vec_cols = cols / kPackSize * kPackSize;
+  float row_max = -std::numeric_limits<float>::max();
+  float row_sum = 0;
+  bool y_is_exp = false;
+  if (cols * sizeof(float) < kOnlineSoftmaxMinRowBytes) {
+    __m512 v_max = _mm512_set1_ps(row_max);
+    for (size_t j = 0; j < vec_cols; j += kPackSize) {
+      v_max = _mm512_max_ps(v_max, _mm512_loadu_ps(row_x + j));
+    }
+    row_max = _mm512_reduce_max_ps(v_max);
+    for (size_t j = vec_cols; j < cols; ++j) { row_max = std::max(row_max, row_x[j]); }
+    v_max = _mm512_set1_ps(row_max);
+    __m512 v_sum = _mm512_setzero_ps();
+    for (size_t j = 0; j < vec_cols; j += kPackSize) {
+      const __m512 e = Exp512(_mm512_sub_ps(_mm512_loadu_ps(row_x + j), v_max));
+      if (algorithm == Algorithm::kSoftmax) { _mm512_storeu_ps(row_y + j, e); }
+      v_sum = _mm512_add_ps(v_sum, e);
+    }
+    row_sum = _mm512_reduce_add_ps(v_sum);
+    for (size_t j = vec_cols; j < cols; ++j) {
+      const float e = ExpApprox(row_x[j] - row_max);
+      if (algorithm == Algorithm::kSoftmax) { row_y[j] = e; }
+      row_sum += e;
+    }
+    y_is_exp = (algorithm == Algorithm::kSoftmax);
+  } else {
+    __m512 v_max = _mm512_set1_ps(row_max);
+    __m512 v_sum = _mm512_setzero_ps();
+    for (size_t j = 0; j < vec_cols; j += kPackSize) {
+      const __m512 x = _mm512_loadu_ps(row_x + j);
+      const __m512 new_max = _mm512_max_ps(v_max, x);
+      v_sum = _mm512_fmadd_ps(v_sum, Exp512(_mm512_sub_ps(v_max, new_max)),
+                              Exp512(_mm512_sub_ps(x, new_max)));
+      v_max = new_max;
+    }
+    row_max = _mm512_reduce_max_ps(v_max);
+    row_sum = _mm512_reduce_add_ps(
+        _mm512_mul_ps(v_sum, Exp512(_mm512_sub_ps(v_max, _mm512_set1_ps(row_max)))));
+    OnlineSoftmaxTail(vec_cols, cols, row_x, &row_max, &row_sum);
+  }
+  SoftmaxNormalizeRowAvx512<algorithm>(cols, row_x, row_max, row_sum, y_is_exp, row_y);
+}
+
+#endif  // OF_CPU_X86_SIMD
+
+template<Algorithm algorithm, typename T>
+struct SoftmaxRowFunc {
+  using FuncType = void (*)(size_t cols, const T* row_x, T* row_y);
+  static FuncType Get() { return &SoftmaxRowScalar<algorithm, T>; }
+};
+
+template<Algorithm algorithm>
+struct SoftmaxRowFunc<algorithm, float> {
+  using FuncType = void (*)(size_t cols, const float* row_x, float* row_y);
+  static FuncType Get() {
+#ifdef OF_CPU_X86_SIMD
+    const CpuIsa isa = GetCpuIsa();
+    if (isa == CpuIsa::kAvx512) { return &SoftmaxRowAvx512<algorithm>; }
+    if (isa == CpuIsa::kAvx2) { return &SoftmaxRowAvx2<algorithm>; }
+#endif  // OF_CPU_X86_SIMD
+    return &SoftmaxRowScalar<algorithm, float>;
+  }
+};
+
+template<Algorithm algorithm, typename T>
+void SoftmaxCpu(size_t rows, size_t cols, const T* x, T* y) {
+  if (rows == 0 || cols == 0) { return; }
+  const auto RowFunc = SoftmaxRowFunc<algorithm, T>::Get();
+  const size_t grain_size = std::max<size_t>(kParallelGrainSize / cols, 1);
+  CpuParallelFor(rows, grain_size, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) { RowFunc(cols, x + i * cols, y + i * cols); }
+  });
+}
+
 template<typename SoftmaxBase, Algorithm algorithm, typename T>
 class SoftmaxImpl : public SoftmaxBase {
  public:
@@ -16,6 +16,8 @@ limitations under the License.
 #include "oneflow/core/ep/include/primitive/softmax_backward.h"
 #include "oneflow/core/ep/include/primitive/log_softmax_backward.h"
 #include "oneflow/core/ep/cpu/primitive/type_seq.h"
+#include "oneflow/core/ep/cpu/primitive/vectorized_math.h"
+#include "oneflow/core/ep/cpu/cpu_parallel.h"
 
 namespace oneflow {
 
@@ -29,35 +31,147 @@ enum class Algorithm {
   kLogSoftmax,
 };
 
+// Number of elements a task of the row parallel loop handles at least.
+constexpr size_t kParallelGrainSize = 32 * 1024;
+
 template<Algorithm algorithm, typename T>
-void SoftmaxBackwardCpu(size_t rows, size_t cols, const T* y, const T* dy, T* dx) {
-  for (size_t i = 0; i < rows; ++i) {
-    size_t row_offset = i * cols;
-    const T* row_y = y + row_offset;
-    const T* row_dy = dy + row_offset;
-    T* row_dx = dx + row_offset;
-    T row_sum = 0;
-    for (size_t j = 0; j < cols; ++j) {
-      if (algorithm == Algorithm::kSoftmax) {
-        row_sum += row_y[j] * row_dy[j];
-      } else if (algorithm == Algorithm::kLogSoftmax) {
-        row_sum += row_dy[j];
-      } else {
-        UNIMPLEMENTED();
-      }
+void SoftmaxBackwardRowScalar(size_t cols, const T* row_y, const T* row_dy, T* row_dx) {
+  T row_sum = 0;
+  for (size_t j = 0; j < cols; ++j) {
+    if (algorithm == Algorithm::kSoftmax) {
+      row_sum += row_y[j] * row_dy[j];
+    } else if (algorithm == Algorithm::kLogSoftmax) {
+      row_sum += row_dy[j];
+    } else {
+      UNIMPLEMENTED();
     }
-    for (size_t j = 0; j < cols; ++j) {
-      if (algorithm == Algorithm::kSoftmax) {
-        row_dx[j] = (row_dy[j] - row_sum) * row_y[j];
-      } else if (algorithm == Algorithm::kLogSoftmax) {
-        row_dx[j] = row_dy[j] - std::exp(row_y[j]) * row_sum;
-      } else {
-        UNIMPLEMENTED();
-      }
+  }
+  for (size_t j = 0; j < cols; ++j) {
+    if (algorithm == Algorithm::kSoftmax) {
+      row_dx[j] = (row_dy[j] - row_sum) * row_y[j];
+    } else if (algorithm == Algorithm::kLogSoftmax) {
+      row_dx[j] = row_dy[j] - std::exp(row_y[j]) * row_sum;
+    } else {
+      UNIMPLEMENTED();
     }
   }
 }
 
+#ifdef OF_CPU_X86_SIMD
+
+using vectorized_math::Exp256;
+using vectorized_math::Exp512;
+using vectorized_math::ExpApprox;
+using vectorized_math::ReduceSum256;
+
+template<Algorithm algorithm>
+OF_CPU_AVX2_TARGET void SoftmaxBackwardRowAvx2(size_t cols, const float* row_y,
+                                               const float* row_dy, float* row_dx) {
+  constexpr size_t kPackSize = 8;
+  const size_t vec_cols = cols / kPackSize * kPackSize;
+  __m256 v_sum = _mm256_setzero_ps();
+  for (size_t j = 0; j < vec_cols; j += kPackSize) {
+    const __m256 dy = _mm256_loadu_ps(row_dy + j);
+    if (algorithm == Algorithm::kSoftmax) {
+      v_sum = _mm256_fmadd_ps(_mm256_loadu_ps(row_y + j), dy, v_sum);
+    } else {
+      v_sum = _mm256_add_ps(v_sum, dy);
+    }
+  }
+  float row_sum = ReduceSum256(v_sum);
+  for (size_t j = vec_cols; j < cols; ++j) {
+    row_sum += (algorithm == Algorithm::kSoftmax) ? row_y[j] * row_dy[j] : row_dy[j];
+  }
+  v_sum = _mm256_set1_ps(row_sum);
+  for (size_t j = 0; j < vec_cols; j += kPackSize) {
+    const __m256 y = _mm256_loadu_ps(row_y + j);
+    const __m256 dy = _mm256_loadu_ps(row_dy + j);
+    if (algorithm == Algorithm::kSoftmax) {
+      _mm256_storeu_ps(row_dx + j, _mm256_mul_ps(_mm256_sub_ps(dy, v_sum), y));
+    } else {
+      _mm256_storeu_ps(row_dx + j, _mm256_fnmadd_ps(Exp256(y), v_sum, dy));
+    }
+  }
+  for (size_t j = vec_cols; j < cols; ++j) {
+    if (algorithm == Algorithm::kSoftmax) {
+      row_dx[j] = (row_dy[j] - row_sum) * row_y[j];
+    } else {
+      row_dx[j] = row_dy[j] - ExpApprox(row_y[j]) * row_sum;
+    }
+  }
+}
+
+template<Algorithm algorithm>
+OF_CPU_AVX512_TARGET void SoftmaxBackwardRowAvx512(size_t cols, const float* row_y,
+                                                   const float* row_dy, float* row_dx) {
+  constexpr size_t kPackSize = 16;
+  const size_t vec_cols = cols / kPackSize * kPackSize;
+  __m512 v_sum = _mm512_setzero_ps();
+  for (size_t j = 0; j < vec_cols; j += kPackSize) {
+    const __m512 dy = _mm512_loadu_ps(row_dy + j);
+    if (algorithm == Algorithm::kSoftmax) {
+      v_sum = _mm512_fmadd_ps(_mm512_loadu_ps(row_y + j), dy, v_sum);
+    } else {
+      v_sum = _mm512_add_ps(v_sum, dy);
+    }
+  }
+  float row_sum = _mm512_reduce_add_ps(v_sum);
+  for (size_t j = vec_cols; j < cols; ++j) {
+    row_sum += (algorithm == Algorithm::kSoftmax) ? row_y[j] * row_dy[j] : row_dy[j];
+  }
+  v_sum = _mm512_set1_ps(row_sum);
+  for (size_t j = 0; j < vec_cols; j += kPackSize) {
+    const __m512 y = _mm512_loadu_ps(row_y + j);
+    const __m512 dy = _mm512_loadu_ps(row_dy + j);
+    if (algorithm == Algorithm::kSoftmax) {
+      _mm512_storeu_ps(row_dx + j, _mm512_mul_ps(_mm512_sub_ps(dy, v_sum), y));
+    } else {
+      _mm512_storeu_ps(row_dx + j, _mm512_fnmadd_ps(Exp512(y), v_sum, dy));
+    }
+  }
+  for (size_t j = vec_cols; j < cols; ++j) {
+    if (algorithm == Algorithm::kSoftmax) {
+      row_dx[j] = (row_dy[j] - row_sum) * row_y[j];
+    } else {
+      row_dx[j] = row_dy[j] - ExpApprox(row_y[j]) * row_sum;
+    }
+  }
+}
+
+#endif  // OF_CPU_X86_SIMD
+
+template<Algorithm algorithm, typename T>
+struct SoftmaxBackwardRowFunc {
+  using FuncType = void (*)(size_t cols, const T* row_y, const T* row_dy, T* row_dx);
+  static FuncType Get() { return &SoftmaxBackwardRowScalar<algorithm, T>; }
+};
+
+template<Algorithm algorithm>
+struct SoftmaxBackwardRowFunc<algorithm, float> {
+  using FuncType = void (*)(size_t cols, const float* row_y, const float* row_dy, float* row_dx);
+  static FuncType Get() {
+#ifdef OF_CPU_X86_SIMD
+    const CpuIsa isa = GetCpuIsa();
+    if (isa == CpuIsa::kAvx512) { return &SoftmaxBackwardRowAvx512<algorithm>; }
+    if (isa == CpuIsa::kAvx2) { return &SoftmaxBackwardRowAvx2<algorithm>; }
+#endif  // OF_CPU_X86_SIMD
+    return &SoftmaxBackwardRowScalar<algorithm, float>;
+  }
+};
+
+template<Algorithm algorithm, typename T>
+void SoftmaxBackwardCpu(size_t rows, size_t cols, const T* y, const T* dy, T* dx) {
+  if (rows == 0 || cols == 0) { return; }
+  const auto RowFunc = SoftmaxBackwardRowFunc<algorithm, T>::Get();
+  const size_t grain_size = std::max<size_t>(kParallelGrainSize / cols, 1);
+  CpuParallelFor(rows, grain_size, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const size_t row_offset = i * cols;
+      RowFunc(cols, y + row_offset, dy + row_offset, dx + row_offset);
+    }
+  });
+}
+
 template<typename SoftmaxBackwardBase, Algorithm algorithm, typename T>
 class SoftmaxBackwardImpl : public SoftmaxBackwardBase {
  public:
@@ -0,0 +1,139 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_EP_CPU_PRIMITIVE_VECTORIZED_MATH_H_
+#define ONEFLOW_CORE_EP_CPU_PRIMITIVE_VECTORIZED_MATH_H_
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "oneflow/core/ep/cpu/cpu_isa.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define OF_CPU_X86_SIMD 1
+#include <immintrin.h>
+// Functions compiled for an instruction set extension must only be called after checking
+// GetCpuIsa(), the remaining translation unit is compiled for the baseline instruction set.
+#define OF_CPU_AVX2_TARGET __attribute__((target("avx2,fma")))
+#define OF_CPU_AVX512_TARGET __attribute__((target("avx512f,avx2,fma")))
+#endif
+
+namespace oneflow {
+
+namespace ep {
+namespace primitive {
+
+namespace vectorized_math {
+
+// Cephes style expf: exp(x) = 2^n * exp(r), |r| <= ln(2) / 2, with exp(r) a degree 7 polynomial.
+// The maximum relative error is below 2e-7 (about 2 ulp) for x in [kExpLo, kExpHi].
+// Inputs are clamped to that range, so tiny results are flushed to about 1.2e-38 instead of 0.
+constexpr float kExpHi = 88.0f;
+constexpr float kExpLo = -87.33654f;
+constexpr float kLog2e = 1.44269504088896341f;
+constexpr float kExpC1 = 0.693359375f;
+constexpr float kExpC2 = -2.12194440e-4f;
+constexpr float kExpP0 = 1.9875691500E-4f;
+constexpr float kExpP1 = 1.3981999507E-3f;
+constexpr float kExpP2 = 8.3334519073E-3f;
+constexpr float kExpP3 = 4.1665795894E-2f;
+constexpr float kExpP4 = 1.6666665459E-1f;
+constexpr float kExpP5 = 5.0000001201E-1f;
+
+// Scalar version of the vectorized exp, used for the tails of the vectorized loops.
+inline float ExpApprox(float x) {
+  x = std::fmin(std::fmax(x, kExpLo), kExpHi);
+  const float fx = std::floor(x * kLog2e + 0.5f);
+  x = x - fx * kExpC1 - fx * kExpC2;
+  const float z = x * x;
+  float y = kExpP0;
+  y = y * x + kExpP1;
+  y = y * x + kExpP2;
+  y = y * x + kExpP3;
+  y = y * x + kExpP4;
+  y = y * x + kExpP5;
+  y = y * z + x + 1.0f;
+  const int32_t pow2n_bits = (static_cast<int32_t>(fx) + 127) << 23;
+  float pow2n;
+  std::memcpy(&pow2n, &pow2n_bits, sizeof(float));
+  return y * pow2n;
+}
+
+#ifdef OF_CPU_X86_SIMD
+
+OF_CPU_AVX2_TARGET inline __m256 Exp256(__m256 x) {
+  x = _mm256_min_ps(x, _mm256_set1_ps(kExpHi));
+  x = _mm256_max_ps(x, _mm256_set1_ps(kExpLo));
+  __m256 fx = _mm256_fmadd_ps(x, _mm256_set1_ps(kLog2e), _mm256_set1_ps(0.5f));
+  fx = _mm256_floor_ps(fx);
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(kExpC1), x);
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(kExpC2), x);
+  const __m256 z = _mm256_mul_ps(x, x);
+  __m256 y = _mm256_set1_ps(kExpP0);
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP1));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP2));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP3));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP4));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP5));
+  y = _mm256_fmadd_ps(y, z, _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+  __m256i pow2n = _mm256_cvttps_epi32(fx);
+  pow2n = _mm256_slli_epi32(_mm256_add_epi32(pow2n, _mm256_set1_epi32(127)), 23);
+  return _mm256_mul_ps(y, _mm256_castsi256_ps(pow2n));
+}
+
+OF_CPU_AVX2_TARGET inline float ReduceSum256(__m256 v) {
+  __m128 x = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+  x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 1));
+  return _mm_cvtss_f32(x);
+}
+
+OF_CPU_AVX2_TARGET inline float ReduceMax256(__m256 v) {
+  __m128 x = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  x = _mm_max_ps(x, _mm_movehl_ps(x, x));
+  x = _mm_max_ss(x, _mm_shuffle_ps(x, x, 1));
+  return _mm_cvtss_f32(x);
+}
+
+OF_CPU_AVX512_TARGET inline __m512 Exp512(__m512 x) {
+  x = _mm512_min_ps(x, _mm512_set1_ps(kExpHi));
+  x = _mm512_max_ps(x, _mm512_set1_ps(kExpLo));
+  __m512 fx = _mm512_fmadd_ps(x, _mm512_set1_ps(kLog2e), _mm512_set1_ps(0.5f));
+  fx = _mm512_roundscale_ps(fx, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+  x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(kExpC1), x);
+  x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(kExpC2), x);
+  const __m512 z = _mm512_mul_ps(x, x);
+  __m512 y = _mm512_set1_ps(kExpP0);
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP1));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP2));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP3));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP4));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP5));
+  y = _mm512_fmadd_ps(y, z, _mm512_add_ps(x, _mm512_set1_ps(1.0f)));
+  __m512i pow2n = _mm512_cvttps_epi32(fx);
+  pow2n = _mm512_slli_epi32(_mm512_add_epi32(pow2n, _mm512_set1_epi32(127)), 23);
+  return _mm512_mul_ps(y, _mm512_castsi512_ps(pow2n));
+}
+
+#endif  // OF_CPU_X86_SIMD
+
+}  // namespace vectorized_math
+
+}  // namespace primitive
+}  // namespace ep
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_EP_CPU_PRIMITIVE_VECTORIZED_MATH_H_
@@ -0,0 +1,108 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/ep/cpu/primitive/vectorized_math.h"
+#include "oneflow/core/ep/include/primitive/softmax.h"
+#include "oneflow/core/ep/include/primitive/log_softmax.h"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace oneflow {
+
+namespace ep {
+namespace primitive {
+
+namespace vectorized_math {
+
+namespace {
+
+constexpr double kExpMaxRelativeError = 2e-7;
+
+#ifdef OF_CPU_X86_SIMD
+
+OF_CPU_AVX2_TARGET float Exp256At(float x) {
+  float out[8];
+  _mm256_storeu_ps(out, Exp256(_mm256_set1_ps(x)));
+  return out[0];
+}
+
+OF_CPU_AVX512_TARGET float Exp512At(float x) {
+  float out[16];
+  _mm512_storeu_ps(out, Exp512(_mm512_set1_ps(x)));
+  return out[0];
+}
+
+#endif  // OF_CPU_X86_SIMD
+
+double RelativeError(float value, double expected) { return std::abs(value - expected) / expected; }
+
+TEST(VectorizedMath, exp_accuracy) {
+  for (float x = kExpLo; x < kExpHi; x += 0.001f) {
+    const double expected = std::exp(static_cast<double>(x));
+    ASSERT_LT(RelativeError(ExpApprox(x), expected), kExpMaxRelativeError) << x;
+#ifdef OF_CPU_X86_SIMD
+    if (GetCpuIsa() >= CpuIsa::kAvx2) {
+      ASSERT_LT(RelativeError(Exp256At(x), expected), kExpMaxRelativeError) << x;
+    }
+    if (GetCpuIsa() >= CpuIsa::kAvx512) {
+      ASSERT_LT(RelativeError(Exp512At(x), expected), kExpMaxRelativeError) << x;
+    }
+#endif  // OF_CPU_X86_SIMD
+  }
+  ASSERT_GE(ExpApprox(-std::numeric_limits<float>::infinity()), 0);
+  ASSERT_LT(ExpApprox(-std::numeric_limits<float>::infinity()), 1e-37);
+}
+
+TEST(VectorizedMath, softmax) {
+  std::unique_ptr<Softmax> softmax = NewPrimitive<SoftmaxFactory>(DeviceType::kCPU, kFloat);
+  std::unique_ptr<LogSoftmax> log_softmax =
+      NewPrimitive<LogSoftmaxFactory>(DeviceType::kCPU, kFloat);
+  ASSERT_TRUE(softmax);
+  ASSERT_TRUE(log_softmax);
+  std::mt19937 generator(0);
+  std::normal_distribution<float> distribution(0, 4);
+  // covers vector tails and the online path for long rows
+  for (size_t cols : {1, 7, 16, 33, 1000, 100000}) {
+    const size_t rows = 5;
+    std::vector<float> x(rows * cols);
+    std::vector<float> y(rows * cols);
+    std::vector<float> log_y(rows * cols);
+    for (float& v : x) { v = distribution(generator); }
+    softmax->Launch(nullptr, rows, cols, x.data(), y.data());
+    log_softmax->Launch(nullptr, rows, cols, x.data(), log_y.data());
+    for (size_t i = 0; i < rows; ++i) {
+      const float* row_x = x.data() + i * cols;
+      const double row_max = *std::max_element(row_x, row_x + cols);
+      double row_sum = 0;
+      for (size_t j = 0; j < cols; ++j) { row_sum += std::exp(row_x[j] - row_max); }
+      for (size_t j = 0; j < cols; ++j) {
+        const double expected = std::exp(row_x[j] - row_max) / row_sum;
+        ASSERT_NEAR(y[i * cols + j], expected, 1e-5 * expected + 1e-12);
+        const double expected_log = row_x[j] - row_max - std::log(row_sum);
+        ASSERT_NEAR(log_y[i * cols + j], expected_log,
+                    1e-5 * std::max(1.0, std::abs(expected_log)));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+}  // namespace vectorized_math
+
+}  // namespace primitive
+}  // namespace ep
+
+}  // namespace oneflow
@@ -55,8 +55,7 @@ namespace {
 Maybe<int64_t> NewSymbolId(vm::IdGenerator* id_generator,
                            vm::InstructionMsgList* instruction_list) {
   int64_t symbol_id = JUST(id_generator->NewSymbolId());
-  intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("NewSymbol");
+  intrusive::shared_ptr<vm::InstructionMsg> instruction = vm::NewInstructionMsg("NewSymbol");
   instruction->add_int64_operand(symbol_id);
   instruction_list->PushBack(instruction.Mutable());
   return symbol_id;
@@ -191,7 +190,7 @@ Maybe<int64_t> CreateSymbolIdHelper<T>::Call(vm::IdGenerator* id_generator,
   int64_t symbol_id = JUST(NewSymbolId(id_generator, instruction_list));
   {
     intrusive::shared_ptr<vm::InstructionMsg> instruction =
-        intrusive::make_shared<vm::InstructionMsg>(GetInstrTypeName<T>());
+        vm::NewInstructionMsg(GetInstrTypeName<T>());
     instruction->add_init_symbol_operand(symbol_id);
     instruction_list->PushBack(instruction.Mutable());
   }
@@ -213,7 +212,7 @@ Maybe<int64_t> CreateSymbolIdHelper<cfg::ParallelConf>::Call(
   int64_t symbol_id = JUST(id_generator->NewSymbolId());
   {
     intrusive::shared_ptr<vm::InstructionMsg> instruction =
-        intrusive::make_shared<vm::InstructionMsg>(GetInstrTypeName<cfg::ParallelConf>());
+        vm::NewInstructionMsg(GetInstrTypeName<cfg::ParallelConf>());
     instruction->add_int64_operand(symbol_id);
     instruction_list->PushBack(instruction.Mutable());
   }
@@ -228,8 +227,7 @@ Maybe<int64_t> CreateSymbolIdHelper<cfg::ParallelConf>::Call(
 }  // namespace detail
 
 Maybe<int64_t> InstructionsBuilder::NewSymbolId() {
-  intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("NewSymbol");
+  intrusive::shared_ptr<vm::InstructionMsg> instruction = vm::NewInstructionMsg("NewSymbol");
   int64_t symbol_id = JUST(id_generator_->NewSymbolId());
   instruction->add_int64_operand(symbol_id);
   instruction_list_->PushBack(instruction.Mutable());
@@ -239,8 +237,7 @@ Maybe<int64_t> InstructionsBuilder::NewSymbolId() {
 Maybe<int64_t> InstructionsBuilder::NewObjectId(
     const std::shared_ptr<ParallelDesc>& parallel_desc_sym) {
   int64_t object_id = JUST(id_generator_->NewObjectId());
-  intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("NewObject");
+  intrusive::shared_ptr<vm::InstructionMsg> instruction = vm::NewInstructionMsg("NewObject");
   instruction->add_parallel_desc(JUST(parallel_desc_sym->symbol_id()));
   instruction->add_int64_operand(object_id);
   instruction_list_->PushBack(instruction.Mutable());
@@ -259,7 +256,7 @@ static constexpr auto* GetCriticalSectionDevice =
 template<typename PhyInstrOperandT>
 Maybe<void> InstructionsBuilder::MakeCriticalSectionBegin(
     const std::shared_ptr<PhyInstrOperandT>& phy_instr_operand) {
-  auto instruction = intrusive::make_shared<vm::InstructionMsg>(
+  auto instruction = vm::NewInstructionMsg(
       Global<VirtualMachine>::Get()->mut_vm(), "CriticalSectionBegin",
       std::shared_ptr<const ParallelDesc>(), phy_instr_operand);
   instruction_list_->EmplaceBack(std::move(instruction));
@@ -269,7 +266,7 @@ Maybe<void> InstructionsBuilder::MakeCriticalSectionBegin(
 template<typename PhyInstrOperandT>
 Maybe<void> InstructionsBuilder::MakeCriticalSectionEnd(
     const std::shared_ptr<PhyInstrOperandT>& phy_instr_operand) {
-  auto instruction = intrusive::make_shared<vm::InstructionMsg>(
+  auto instruction = vm::NewInstructionMsg(
       Global<VirtualMachine>::Get()->mut_vm(), "CriticalSectionEnd",
       std::shared_ptr<const ParallelDesc>(), phy_instr_operand);
   instruction_list_->EmplaceBack(std::move(instruction));
@@ -355,7 +352,7 @@ Maybe<void> InstructionsBuilder::LaunchLazyJob(const one::EagerBlobObjectListPtr
     {
       const auto& phy_instr_operand =
           std::make_shared<vm::LaunchLazyJobPhyInstrOperand>(nn_graph, parameters);
-      auto instruction = intrusive::make_shared<vm::InstructionMsg>(
+      auto instruction = vm::NewInstructionMsg(
           Global<VirtualMachine>::Get()->mut_vm(), "LaunchLazyJob",
           std::shared_ptr<const ParallelDesc>(), phy_instr_operand);
       instruction_list_->EmplaceBack(std::move(instruction));
@@ -628,8 +625,7 @@ Maybe<void> InstructionsBuilder::ReplaceMirrored(
     const std::shared_ptr<ParallelDesc>& parallel_desc_sym,
     const std::vector<std::shared_ptr<compatible_py::BlobObject>>& lhs_objects,
     const std::vector<std::shared_ptr<compatible_py::BlobObject>>& rhs_objects) {
-  intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("ReplaceMirrored");
+  intrusive::shared_ptr<vm::InstructionMsg> instruction = vm::NewInstructionMsg("ReplaceMirrored");
   instruction->set_parallel_desc_symbol_id(JUST(parallel_desc_sym->symbol_id()));
   for (const auto& lhs_object : lhs_objects) {
     instruction->add_int64_operand(lhs_object->object_id());
@@ -752,7 +748,7 @@ Maybe<int64_t> InstructionsBuilder::BroadcastObjectReference(
     const std::shared_ptr<ParallelDesc>& parallel_desc_sym) {
   int64_t object_id = JUST(id_generator_->NewObjectId());
   intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("BroadcastObjectReference");
+      vm::NewInstructionMsg("BroadcastObjectReference");
   instruction->set_parallel_desc_symbol_id(JUST(parallel_desc_sym->symbol_id()));
   instruction->add_int64_operand(object_id);
   instruction->add_int64_operand(sole_mirrored_object->object_id());
@@ -782,8 +778,7 @@ Maybe<void> InstructionsBuilder::BuildSendInstruction(
     const std::shared_ptr<ParallelDesc>& dst_parallel_desc_symbol,
     const std::shared_ptr<compatible_py::BlobObject>& src_blob_object,
     const std::tuple<std::vector<uint64_t>, std::vector<uint64_t>>& token_ids) {
-  intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("SendBlob");
+  intrusive::shared_ptr<vm::InstructionMsg> instruction = vm::NewInstructionMsg("SendBlob");
   instruction->set_parallel_desc_symbol_id(
       JUST(src_blob_object->parallel_desc_symbol()->symbol_id()));
   instruction->add_symbol_operand(JUST(dst_parallel_desc_symbol->symbol_id()));
@@ -800,8 +795,7 @@ Maybe<void> InstructionsBuilder::BuildRecvInstruction(
     const std::shared_ptr<ParallelDesc>& src_parallel_desc_symbol,
     const std::shared_ptr<compatible_py::BlobObject>& dst_blob_object,
     const std::tuple<std::vector<uint64_t>, std::vector<uint64_t>>& token_ids) {
-  intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("ReceiveBlob");
+  intrusive::shared_ptr<vm::InstructionMsg> instruction = vm::NewInstructionMsg("ReceiveBlob");
   instruction->set_parallel_desc_symbol_id(
       JUST(dst_blob_object->parallel_desc_symbol()->symbol_id()));
   instruction->add_symbol_operand(JUST(src_parallel_desc_symbol->symbol_id()));
@@ -841,7 +835,7 @@ Maybe<void> InstructionsBuilder::LocalCallOpKernel(
   auto phy_instr_operand = JUST(vm::LocalCallOpKernelPhyInstrOperand::New(
       opkernel, input_eager_blob_objects, output_eager_blob_objects, consistent_tensor_infer_result,
       ctx, *one::CurrentDevVmDepObjectConsumeMode()));
-  auto instruction = intrusive::make_shared<vm::InstructionMsg>(
+  auto instruction = vm::NewInstructionMsg(
       Global<VirtualMachine>::Get()->mut_vm(), JUST(op_device->local_call_instruction_name()),
       parallel_desc_sym, phy_instr_operand);
   instruction_list_->EmplaceBack(std::move(instruction));
@@ -857,7 +851,7 @@ Maybe<void> InstructionsBuilder::LocalCallOpKernel(
 Maybe<void> InstructionsBuilder::CudaHostRegisterBlob(
     const std::shared_ptr<compatible_py::BlobObject>& blob_object) {
   intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("CudaHostRegisterBlob");
+      vm::NewInstructionMsg("CudaHostRegisterBlob");
   instruction->set_parallel_desc_symbol_id(JUST(blob_object->parallel_desc_symbol()->symbol_id()));
   instruction->add_mut_operand(blob_object->object_id());
   instruction_list_->PushBack(instruction.Mutable());
@@ -867,7 +861,7 @@ Maybe<void> InstructionsBuilder::CudaHostRegisterBlob(
 Maybe<void> InstructionsBuilder::CudaHostUnregisterBlob(
     const std::shared_ptr<compatible_py::BlobObject>& blob_object) {
   intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("CudaHostUnregisterBlob");
+      vm::NewInstructionMsg("CudaHostUnregisterBlob");
   instruction->set_parallel_desc_symbol_id(JUST(blob_object->parallel_desc_symbol()->symbol_id()));
   instruction->add_mut_operand(blob_object->object_id());
   instruction_list_->PushBack(instruction.Mutable());
@@ -896,7 +890,7 @@ Maybe<void> InstructionsBuilder::LazyReference(
     const std::string& interface_op_name) {
   std::string device_tag = blob_object->parallel_desc_symbol()->device_tag();
   intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>(device_tag + ".LazyReference");
+      vm::NewInstructionMsg(device_tag + ".LazyReference");
   instruction->set_parallel_desc_symbol_id(JUST(blob_object->parallel_desc_symbol()->symbol_id()));
   instruction->add_mut_operand(blob_object->object_id());
   std::shared_ptr<StringSymbol> interface_op_name_sym =
@@ -937,8 +931,7 @@ Maybe<compatible_py::Object> InstructionsBuilder::GetSharedOpKernelObject4Parall
 }
 
 Maybe<void> InstructionsBuilder::InitStringSymbol(int64_t symbol_id, std::string str) {
-  intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("InitStringSymbol");
+  intrusive::shared_ptr<vm::InstructionMsg> instruction = vm::NewInstructionMsg("InitStringSymbol");
   instruction->add_init_symbol_operand(symbol_id);
   instruction_list_->PushBack(instruction.Mutable());
   vm::cfg::EagerSymbol eager_symbol;
@@ -951,7 +944,7 @@ Maybe<void> InstructionsBuilder::InitStringSymbol(int64_t symbol_id, std::string
 Maybe<void> InstructionsBuilder::InitJobConfSymbol(
     int64_t symbol_id, const std::shared_ptr<cfg::JobConfigProto>& job_conf) {
   intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("InitJobDescSymbol");
+      vm::NewInstructionMsg("InitJobDescSymbol");
   instruction->add_init_symbol_operand(symbol_id);
   instruction_list_->PushBack(instruction.Mutable());
   vm::cfg::EagerSymbol eager_symbol;
@@ -964,7 +957,7 @@ Maybe<void> InstructionsBuilder::InitJobConfSymbol(
 Maybe<void> InstructionsBuilder::NewParallelConfSymbol(
     int64_t symbol_id, const std::shared_ptr<cfg::ParallelConf>& parallel_conf) {
   intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("NewParallelDescSymbol");
+      vm::NewInstructionMsg("NewParallelDescSymbol");
   instruction->add_int64_operand(symbol_id);
   instruction_list_->PushBack(instruction.Mutable());
   vm::cfg::EagerSymbol eager_symbol;
@@ -976,8 +969,7 @@ Maybe<void> InstructionsBuilder::NewParallelConfSymbol(
 
 Maybe<void> InstructionsBuilder::NewScopeSymbol(
     int64_t symbol_id, const std::shared_ptr<cfg::ScopeProto>& scope_proto) {
-  intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("InitScopeSymbol");
+  intrusive::shared_ptr<vm::InstructionMsg> instruction = vm::NewInstructionMsg("InitScopeSymbol");
   instruction->add_init_symbol_operand(symbol_id);
   instruction_list_->PushBack(instruction.Mutable());
   vm::cfg::EagerSymbol eager_symbol;
@@ -993,7 +985,7 @@ Maybe<int64_t> InstructionsBuilder::_NewOpKernelObject(
     const std::shared_ptr<OperatorConfSymbol>& op_conf_sym) {
   int64_t object_id = JUST(NewObjectId(parallel_desc_symbol));
   intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("InitOpKernelObject");
+      vm::NewInstructionMsg("InitOpKernelObject");
   instruction->set_parallel_desc_symbol_id(JUST(parallel_desc_symbol->symbol_id()));
   instruction->add_symbol_operand(JUST(job_desc_sym->symbol_id()));
   instruction->add_symbol_operand(JUST(op_conf_sym->symbol_id()));
@@ -1005,7 +997,7 @@ Maybe<int64_t> InstructionsBuilder::_NewOpKernelObject(
 Maybe<void> InstructionsBuilder::InitOpNodeSignatureDescSymbol(
     int64_t symbol_id, const std::shared_ptr<cfg::OpNodeSignature>& op_node_signature_sym) {
   intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("InitOpNodeSignatureDescSymbol");
+      vm::NewInstructionMsg("InitOpNodeSignatureDescSymbol");
   instruction->add_init_symbol_operand(symbol_id);
   instruction_list_->PushBack(instruction.Mutable());
   vm::cfg::EagerSymbol eager_symbol;
@@ -1018,7 +1010,7 @@ Maybe<void> InstructionsBuilder::InitOpNodeSignatureDescSymbol(
 Maybe<void> InstructionsBuilder::InitOpConfSymbol(
     int64_t symbol_id, const std::shared_ptr<cfg::OperatorConf>& op_conf) {
   intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("InitOperatorConfSymbol");
+      vm::NewInstructionMsg("InitOperatorConfSymbol");
   instruction->add_init_symbol_operand(symbol_id);
   instruction_list_->PushBack(instruction.Mutable());
   vm::cfg::EagerSymbol eager_symbol;
@@ -1031,7 +1023,7 @@ Maybe<void> InstructionsBuilder::InitOpConfSymbol(
 Maybe<void> InstructionsBuilder::InsertRemoveForeignCallbackInstruction(int64_t object_id,
                                                                         int64_t callback_id) {
   intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("RemoveForeignCallback");
+      vm::NewInstructionMsg("RemoveForeignCallback");
   instruction->add_mut_operand(object_id, vm::AllMirroredObject());
   instruction->add_int64_operand(callback_id);
   instruction_list_->PushBack(instruction.Mutable());
@@ -1043,7 +1035,7 @@ Maybe<void> InstructionsBuilder::_FetchBlob(
     const std::shared_ptr<compatible_py::BlobObject>& blob_object, int64_t callback_id) {
   const std::string& device_tag = blob_object->parallel_desc_symbol()->device_tag();
   intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>(device_tag + "." + instruction_name);
+      vm::NewInstructionMsg(device_tag + "." + instruction_name);
   instruction->set_parallel_desc_symbol_id(JUST(blob_object->parallel_desc_symbol()->symbol_id()));
   instruction->add_const_operand(blob_object->object_id());
   instruction->add_int64_operand(callback_id);
@@ -1055,7 +1047,7 @@ Maybe<void> InstructionsBuilder::FeedBlob(
     const std::shared_ptr<compatible_py::BlobObject>& blob_object, int64_t callback_id) {
   const std::string& device_tag = blob_object->parallel_desc_symbol()->device_tag();
   intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>(device_tag + "." + "FeedBlob");
+      vm::NewInstructionMsg(device_tag + "." + "FeedBlob");
   instruction->set_parallel_desc_symbol_id(JUST(blob_object->parallel_desc_symbol()->symbol_id()));
   instruction->add_mut2_operand(blob_object->object_id());
   instruction->add_int64_operand(callback_id);
@@ -1077,7 +1069,7 @@ Maybe<void> InstructionsBuilder::ReleaseTensor(
   LocalDepObject* compute_local_dep_object = JUST(eager_blob_object->compute_local_dep_object());
   const auto& phy_instr_operand = std::make_shared<vm::ReleaseTensorArgPhyInstrOperand>(
       eager_blob_object, compute_local_dep_object);
-  auto instruction = intrusive::make_shared<vm::InstructionMsg>(
+  auto instruction = vm::NewInstructionMsg(
       Global<VirtualMachine>::Get()->mut_vm(), parallel_desc->device_tag() + ".ReleaseTensor",
       parallel_desc, phy_instr_operand);
   instruction_list_->EmplaceBack(std::move(instruction));
@@ -1093,7 +1085,7 @@ Maybe<void> InstructionsBuilder::SoftSyncStream(LocalDepObject* compute_local_de
   {
     const auto& phy_instr_operand = std::make_shared<vm::ConsumeLocalDepObjectPhyInstrOperand>(
         compute_local_dep_object, modifier);
-    auto instruction = intrusive::make_shared<vm::InstructionMsg>(
+    auto instruction = vm::NewInstructionMsg(
         Global<VirtualMachine>::Get()->mut_vm(), parallel_desc->device_tag() + ".RecordEvent",
         parallel_desc, phy_instr_operand);
     instruction_list_->EmplaceBack(std::move(instruction));
@@ -1101,7 +1093,7 @@ Maybe<void> InstructionsBuilder::SoftSyncStream(LocalDepObject* compute_local_de
   {
     const auto& phy_instr_operand = std::make_shared<vm::ConsumeLocalDepObjectPhyInstrOperand>(
         compute_local_dep_object, modifier);
-    auto instruction = intrusive::make_shared<vm::InstructionMsg>(
+    auto instruction = vm::NewInstructionMsg(
         Global<VirtualMachine>::Get()->mut_vm(), "Touch", parallel_desc, phy_instr_operand);
     instruction_list_->EmplaceBack(std::move(instruction));
   }
@@ -1146,7 +1138,7 @@ Maybe<void> InstructionsBuilder::TensorView(const T input_tensor, const T view_t
   const auto& phy_instr_operand = std::make_shared<vm::TensorViewOperand>(
       eager_blob_object, view_eager_blob_object, local_dep_object);
   // prepare instruction
-  auto instruction = intrusive::make_shared<vm::InstructionMsg>(
+  auto instruction = vm::NewInstructionMsg(
       Global<VirtualMachine>::Get()->mut_vm(), parallel_desc->device_tag() + ".TensorView",
       parallel_desc, phy_instr_operand);
   // assign the data pointer to output view blob
@@ -1191,7 +1183,7 @@ Maybe<void> InstructionsBuilder::AccessBlobByCallback(const T tensor,
   LocalDepObject* compute_local_dep_object = JUST(tensor->compute_local_dep_object());
   const auto& phy_instr_operand = std::make_shared<vm::AccessBlobArgCbPhyInstrOperand>(
       eager_blob_object, compute_local_dep_object, callback, modifier);
-  auto instruction = intrusive::make_shared<vm::InstructionMsg>(
+  auto instruction = vm::NewInstructionMsg(
       Global<VirtualMachine>::Get()->mut_vm(),
       parallel_desc->device_tag() + ".AccessBlobByCallback", parallel_desc, phy_instr_operand);
   instruction_list_->EmplaceBack(std::move(instruction));
@@ -1209,7 +1201,7 @@ template Maybe<void> InstructionsBuilder::AccessBlobByCallback(
 Maybe<void> InstructionsBuilder::ComputeRankFrontSeqCallback(
     const std::function<void()>& callback) {
   const auto& phy_instr_operand = std::make_shared<vm::NoArgCbPhyInstrOperand>(callback);
-  auto instruction = intrusive::make_shared<vm::InstructionMsg>(
+  auto instruction = vm::NewInstructionMsg(
       Global<VirtualMachine>::Get()->mut_vm(), "ComputeRankFrontSeqCallback",
       std::shared_ptr<const ParallelDesc>(), phy_instr_operand);
   instruction->add_int64_operand(GlobalProcessCtx::Rank());
@@ -1219,7 +1211,7 @@ Maybe<void> InstructionsBuilder::ComputeRankFrontSeqCallback(
 
 Maybe<void> InstructionsBuilder::ComputeGlobalFrontSeqBarrier() {
   intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("ComputeGlobalFrontSeqBarrier");
+      vm::NewInstructionMsg("ComputeGlobalFrontSeqBarrier");
   instruction_list_->PushBack(instruction.Mutable());
   return Maybe<void>::Ok();
 }
@@ -1237,8 +1229,7 @@ Maybe<void> InstructionsBuilder::FetchBlobBody(
 }
 
 Maybe<void> InstructionsBuilder::_TryClearObject(compatible_py::Object* blob_object) {
-  intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("TryClearObject");
+  intrusive::shared_ptr<vm::InstructionMsg> instruction = vm::NewInstructionMsg("TryClearObject");
   instruction->set_parallel_desc_symbol_id(JUST(blob_object->parallel_desc_symbol()->symbol_id()));
   instruction->add_mut_operand(blob_object->object_id());
   instruction_list_->PushBack(instruction.Mutable());
@@ -1246,8 +1237,7 @@ Maybe<void> InstructionsBuilder::_TryClearObject(compatible_py::Object* blob_obj
 }
 
 Maybe<void> InstructionsBuilder::_DeleteObject(compatible_py::Object* blob_object) {
-  intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>("DeleteObject");
+  intrusive::shared_ptr<vm::InstructionMsg> instruction = vm::NewInstructionMsg("DeleteObject");
   instruction->set_parallel_desc_symbol_id(JUST(blob_object->parallel_desc_symbol()->symbol_id()));
   instruction->add_del_operand(blob_object->object_id());
   instruction_list_->PushBack(instruction.Mutable());
@@ -1271,8 +1261,7 @@ Maybe<void> InstructionsBuilder::_StatefulCallOpKernel(
         std::pair<std::shared_ptr<StringSymbol>, std::shared_ptr<compatible_py::BlobObject>>>&
         mut2_operand_blob_objects) {
   intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>(parallel_desc_sym->device_tag() + "."
-                                                 + instr_name);
+      vm::NewInstructionMsg(parallel_desc_sym->device_tag() + "." + instr_name);
   instruction->set_parallel_desc_symbol_id(JUST(parallel_desc_sym->symbol_id()));
   instruction->add_mut_operand(opkernel_object->object_id());
   instruction->add_symbol_operand(JUST(op_node_signature_sym->symbol_id()));
@@ -1332,8 +1321,7 @@ Maybe<void> InstructionsBuilder::_StatelessCallOpKernel(
         std::pair<std::shared_ptr<StringSymbol>, std::shared_ptr<compatible_py::BlobObject>>>&
         mut2_operand_blob_objects) {
   intrusive::shared_ptr<vm::InstructionMsg> instruction =
-      intrusive::make_shared<vm::InstructionMsg>(parallel_desc_sym->device_tag() + "."
-                                                 + instr_name);
+      vm::NewInstructionMsg(parallel_desc_sym->device_tag() + "." + instr_name);
   instruction->set_parallel_desc_symbol_id(JUST(parallel_desc_sym->symbol_id()));
   instruction->add_symbol_operand(JUST(job_desc_sym->symbol_id()));
   instruction->add_symbol_operand(JUST(op_conf_sym->symbol_id()));
@@ -0,0 +1,119 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/mirrored_tensor_infer_cache.h"
+#include "oneflow/core/framework/stride.h"
+#include "oneflow/core/framework/tensor.h"
+#include "oneflow/core/framework/tensor_tuple.h"
+#include "oneflow/user/kernels/stateful_local_opkernel.h"
+
+namespace oneflow {
+namespace one {
+
+namespace {
+
+// Unlike MirroredTensorMeta::operator==, is_dynamic_ counts here. Infer functions may read it.
+bool MirroredTensorMetaEqual(const MirroredTensorMeta& lhs, const MirroredTensorMeta& rhs) {
+  return lhs == rhs && lhs.is_dynamic() == rhs.is_dynamic();
+}
+
+}  // namespace
+
+bool MirroredTensorMetaInferArgs::operator==(const MirroredTensorMetaInferArgs& other) const {
+  if (this->hash_value_ != other.hash_value_) { return false; }
+  if (this->default_device_ != other.default_device_ || !(this->attrs_ == other.attrs_)) {
+    return false;
+  }
+  const auto& metas = this->input_mirrored_tensor_metas_;
+  const auto& other_metas = other.input_mirrored_tensor_metas_;
+  if (metas.size() != other_metas.size()) { return false; }
+  for (int i = 0; i < metas.size(); ++i) {
+    if (!MirroredTensorMetaEqual(*metas.at(i), *other_metas.at(i))) { return false; }
+  }
+  return true;
+}
+
+/* static */ Maybe<MirroredTensorMetaInferArgs> MirroredTensorMetaInferArgs::New(
+    const AttrMap& attrs, Symbol<Device> default_device, const TensorTuple& input_tensors) {
+  std::vector<std::shared_ptr<const MirroredTensorMeta>> input_mirrored_tensor_metas;
+  input_mirrored_tensor_metas.reserve(input_tensors.size());
+  for (const auto& tensor : input_tensors) {
+    input_mirrored_tensor_metas.emplace_back(
+        JUST(tensor->mut_eager_mirrored_tensor_impl())->tensor_meta());
+  }
+  return New(attrs, default_device, std::move(input_mirrored_tensor_metas));
+}
+
+/* static */ Maybe<MirroredTensorMetaInferArgs> MirroredTensorMetaInferArgs::New(
+    const AttrMap& attrs, Symbol<Device> default_device,
+    std::vector<std::shared_ptr<const MirroredTensorMeta>> input_mirrored_tensor_metas) {
+  std::shared_ptr<MirroredTensorMetaInferArgs> infer_args(new MirroredTensorMetaInferArgs());
+  infer_args->attrs_ = attrs;
+  infer_args->default_device_ = default_device;
+  infer_args->input_mirrored_tensor_metas_ = std::move(input_mirrored_tensor_metas);
+  size_t hash_value = std::hash<AttrMap>()(attrs);
+  HashCombine(&hash_value, std::hash<Symbol<Device>>()(default_device));
+  for (const auto& tensor_meta : infer_args->input_mirrored_tensor_metas_) {
+    HashCombine(&hash_value, tensor_meta->CalcHashValue());
+  }
+  infer_args->hash_value_ = hash_value;
+  return infer_args;
+}
+
+MirroredTensorMetaInferArgs MirroredTensorMetaInferArgs::DeepCopy() const {
+  MirroredTensorMetaInferArgs infer_args(*this);
+  for (auto& tensor_meta : infer_args.input_mirrored_tensor_metas_) {
+    auto copied = std::make_shared<MirroredTensorMeta>(
+        std::make_shared<const Shape>(tensor_meta->shape()), tensor_meta->dtype(),
+        tensor_meta->device(), std::make_shared<const Stride>(tensor_meta->stride()),
+        tensor_meta->storage_offset());
+    copied->set_is_dynamic(tensor_meta->is_dynamic());
+    tensor_meta = copied;
+  }
+  return infer_args;
+}
+
+MirroredTensorInferCache::MirroredTensorInferCache()
+    : MirroredTensorInferCache(
+          ParseIntegerFromEnv("ONEFLOW_EAGER_MIRRORED_TENSOR_INFER_CACHE_SIZE", 64)) {}
+
+MirroredTensorInferCache::MirroredTensorInferCache(size_t capacity)
+    : capacity_(capacity), hit_num_(0), miss_num_(0) {}
+
+std::shared_ptr<const MirroredTensorInferResult> MirroredTensorInferCache::Find(
+    const MirroredTensorMetaInferArgs& infer_args) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto& iter = cache_.find(infer_args);
+  if (iter == cache_.end()) {
+    ++miss_num_;
+    return nullptr;
+  }
+  ++hit_num_;
+  return iter->second;
+}
+
+void MirroredTensorInferCache::Insert(
+    const MirroredTensorMetaInferArgs& infer_args,
+    const std::shared_ptr<const MirroredTensorInferResult>& result) {
+  if (capacity_ == 0) { return; }
+  MirroredTensorMetaInferArgs key = infer_args.DeepCopy();
+  std::unique_lock<std::mutex> lock(mutex_);
+  // ops called with ever changing shapes would otherwise grow the cache without bound
+  if (cache_.size() >= capacity_) { cache_.clear(); }
+  cache_.emplace(std::move(key), result);
+}
+
+}  // namespace one
+}  // namespace oneflow
@@ -0,0 +1,136 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_FRAMEWORK_MIRRORED_TENSOR_INFER_CACHE_H_
+#define ONEFLOW_CORE_FRAMEWORK_MIRRORED_TENSOR_INFER_CACHE_H_
+
+#include "oneflow/core/common/symbol.h"
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/framework/attr_map.h"
+#include "oneflow/core/framework/device.h"
+#include "oneflow/core/framework/tensor_meta.h"
+
+namespace oneflow {
+namespace one {
+
+class TensorTuple;
+class StatefulLocalOpKernel;
+
+class MirroredTensorMetaInferArgs final {
+ public:
+  MirroredTensorMetaInferArgs(const MirroredTensorMetaInferArgs&) = default;
+  MirroredTensorMetaInferArgs(MirroredTensorMetaInferArgs&&) = default;
+  ~MirroredTensorMetaInferArgs() = default;
+
+  const AttrMap& attrs() const { return attrs_; }
+  Symbol<Device> default_device() const { return default_device_; }
+  const std::vector<std::shared_ptr<const MirroredTensorMeta>>& input_mirrored_tensor_metas()
+      const {
+    return input_mirrored_tensor_metas_;
+  }
+
+  size_t hash_value() const { return hash_value_; }
+
+  bool operator==(const MirroredTensorMetaInferArgs& other) const;
+
+  // The input metas are shared with the input tensors, which is only good for a lookup.
+  static Maybe<MirroredTensorMetaInferArgs> New(const AttrMap& attrs,
+                                                Symbol<Device> default_device,
+                                                const TensorTuple& input_tensors);
+  static Maybe<MirroredTensorMetaInferArgs> New(
+      const AttrMap& attrs, Symbol<Device> default_device,
+      std::vector<std::shared_ptr<const MirroredTensorMeta>> input_mirrored_tensor_metas);
+  // Deep copies the input metas for a cache key, kernels may mutate the shapes of their outputs.
+  MirroredTensorMetaInferArgs DeepCopy() const;
+
+ private:
+  MirroredTensorMetaInferArgs() = default;
+
+  AttrMap attrs_;
+  Symbol<Device> default_device_;
+  std::vector<std::shared_ptr<const MirroredTensorMeta>> input_mirrored_tensor_metas_;
+  size_t hash_value_;
+};
+
+}  // namespace one
+}  // namespace oneflow
+
+namespace std {
+
+template<>
+struct hash<oneflow::one::MirroredTensorMetaInferArgs> final {
+  size_t operator()(const oneflow::one::MirroredTensorMetaInferArgs& val) const {
+    return val.hash_value();
+  }
+};
+
+}  // namespace std
+
+namespace oneflow {
+namespace one {
+
+class MirroredTensorInferResult final {
+ public:
+  MirroredTensorInferResult(Symbol<Device> op_device,
+                            const std::shared_ptr<StatefulLocalOpKernel>& kernel)
+      : op_device_(op_device), kernel_(kernel) {}
+  MirroredTensorInferResult(const MirroredTensorInferResult&) = delete;
+  MirroredTensorInferResult(MirroredTensorInferResult&&) = delete;
+  ~MirroredTensorInferResult() = default;
+
+  const std::vector<MirroredTensorMeta>& output_tensor_metas() const {
+    return output_tensor_metas_;
+  }
+  std::vector<MirroredTensorMeta>* mut_output_tensor_metas() { return &output_tensor_metas_; }
+
+  Symbol<Device> op_device() const { return op_device_; }
+  const std::shared_ptr<StatefulLocalOpKernel>& kernel() const { return kernel_; }
+
+ private:
+  std::vector<MirroredTensorMeta> output_tensor_metas_;
+  Symbol<Device> op_device_;
+  std::shared_ptr<StatefulLocalOpKernel> kernel_;
+};
+
+// Per UserOpExpr cache of the physical device, shape and dtype inference and the kernel lookup
+// done by the eager mirrored interpreter. It is cleared when it grows to
+// ONEFLOW_EAGER_MIRRORED_TENSOR_INFER_CACHE_SIZE entries. Thread safe, eager backward functions
+// may be run by several threads.
+class MirroredTensorInferCache final {
+ public:
+  MirroredTensorInferCache();
+  explicit MirroredTensorInferCache(size_t capacity);
+
+  // Returns nullptr on miss.
+  std::shared_ptr<const MirroredTensorInferResult> Find(
+      const MirroredTensorMetaInferArgs& infer_args);
+  void Insert(const MirroredTensorMetaInferArgs& infer_args,
+              const std::shared_ptr<const MirroredTensorInferResult>& result);
+
+  int64_t hit_num() const { return hit_num_; }
+  int64_t miss_num() const { return miss_num_; }
+
+ private:
+  size_t capacity_;
+  std::atomic<int64_t> hit_num_;
+  std::atomic<int64_t> miss_num_;
+  std::mutex mutex_;
+  HashMap<MirroredTensorMetaInferArgs, std::shared_ptr<const MirroredTensorInferResult>> cache_;
+};
+
+}  // namespace one
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_FRAMEWORK_MIRRORED_TENSOR_INFER_CACHE_H_
@@ -0,0 +1,127 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include "oneflow/core/framework/attr_map.h"
+#include "oneflow/core/framework/attr_value.h"
+#include "oneflow/core/framework/mirrored_tensor_infer_cache.h"
+
+namespace oneflow {
+namespace one {
+namespace test {
+
+namespace {
+
+// "auto" devices skip the initialization which needs the runtime, the cache only compares them.
+Symbol<Device> TestDevice(int64_t device_id) { return CHECK_JUST(Device::New("auto", device_id)); }
+
+AttrMap TestAttrs(int32_t axis) {
+  MutableCfgAttrMap attrs;
+  CHECK_JUST(attrs.SetAttr<int32_t>("axis", axis));
+  return AttrMap(attrs);
+}
+
+std::shared_ptr<const MirroredTensorMeta> TestMeta(const Shape& shape, DataType dtype,
+                                                   Symbol<Device> device,
+                                                   bool is_dynamic = false) {
+  auto meta = std::make_shared<MirroredTensorMeta>(std::make_shared<const Shape>(shape), dtype,
+                                                   device);
+  meta->set_is_dynamic(is_dynamic);
+  return meta;
+}
+
+MirroredTensorMetaInferArgs TestArgs(const AttrMap& attrs, Symbol<Device> default_device,
+                                     const std::shared_ptr<const MirroredTensorMeta>& meta) {
+  const std::vector<std::shared_ptr<const MirroredTensorMeta>> metas{meta};
+  return *CHECK_JUST(MirroredTensorMetaInferArgs::New(attrs, default_device, metas));
+}
+
+std::shared_ptr<const MirroredTensorInferResult> TestResult() {
+  return std::make_shared<MirroredTensorInferResult>(TestDevice(0), nullptr);
+}
+
+}  // namespace
+
+TEST(MirroredTensorInferCache, hit_and_miss) {
+  MirroredTensorInferCache cache(8);
+  const auto& args = TestArgs(TestAttrs(0), TestDevice(0),
+                              TestMeta(Shape({2, 3}), DataType::kFloat, TestDevice(0)));
+  ASSERT_EQ(cache.Find(args), nullptr);
+  const auto& result = TestResult();
+  cache.Insert(args, result);
+  // equal args built from other metas find the entry
+  const auto& same_args = TestArgs(TestAttrs(0), TestDevice(0),
+                                   TestMeta(Shape({2, 3}), DataType::kFloat, TestDevice(0)));
+  ASSERT_EQ(cache.Find(same_args), result);
+  ASSERT_EQ(cache.Find(args), result);
+  ASSERT_EQ(cache.hit_num(), 2);
+  ASSERT_EQ(cache.miss_num(), 1);
+}
+
+TEST(MirroredTensorInferCache, miss_on_changed_args) {
+  MirroredTensorInferCache cache(8);
+  cache.Insert(TestArgs(TestAttrs(0), TestDevice(0),
+                        TestMeta(Shape({2, 3}), DataType::kFloat, TestDevice(0))),
+               TestResult());
+  const std::vector<MirroredTensorMetaInferArgs> changed_args = {
+      // shape
+      TestArgs(TestAttrs(0), TestDevice(0),
+               TestMeta(Shape({3, 2}), DataType::kFloat, TestDevice(0))),
+      // dtype
+      TestArgs(TestAttrs(0), TestDevice(0),
+               TestMeta(Shape({2, 3}), DataType::kDouble, TestDevice(0))),
+      // attrs
+      TestArgs(TestAttrs(1), TestDevice(0),
+               TestMeta(Shape({2, 3}), DataType::kFloat, TestDevice(0))),
+      // default device
+      TestArgs(TestAttrs(0), TestDevice(1),
+               TestMeta(Shape({2, 3}), DataType::kFloat, TestDevice(0))),
+      // input device
+      TestArgs(TestAttrs(0), TestDevice(0),
+               TestMeta(Shape({2, 3}), DataType::kFloat, TestDevice(1))),
+      // dynamic input
+      TestArgs(TestAttrs(0), TestDevice(0),
+               TestMeta(Shape({2, 3}), DataType::kFloat, TestDevice(0), true)),
+  };
+  for (const auto& args : changed_args) { ASSERT_EQ(cache.Find(args), nullptr); }
+  ASSERT_EQ(cache.hit_num(), 0);
+  ASSERT_EQ(cache.miss_num(), static_cast<int64_t>(changed_args.size()));
+}
+
+TEST(MirroredTensorInferCache, clear_on_capacity) {
+  MirroredTensorInferCache cache(2);
+  std::vector<MirroredTensorMetaInferArgs> args;
+  FOR_RANGE(int64_t, i, 0, 3) {
+    args.emplace_back(TestArgs(TestAttrs(0), TestDevice(0),
+                               TestMeta(Shape({i + 1}), DataType::kFloat, TestDevice(0))));
+  }
+  cache.Insert(args.at(0), TestResult());
+  cache.Insert(args.at(1), TestResult());
+  ASSERT_NE(cache.Find(args.at(0)), nullptr);
+  ASSERT_NE(cache.Find(args.at(1)), nullptr);
+  // the cache is full, the third entry clears it
+  cache.Insert(args.at(2), TestResult());
+  ASSERT_EQ(cache.Find(args.at(0)), nullptr);
+  ASSERT_EQ(cache.Find(args.at(1)), nullptr);
+  ASSERT_NE(cache.Find(args.at(2)), nullptr);
+
+  MirroredTensorInferCache disabled_cache(0);
+  disabled_cache.Insert(args.at(0), TestResult());
+  ASSERT_EQ(disabled_cache.Find(args.at(0)), nullptr);
+}
+
+}  // namespace test
+}  // namespace one
+}  // namespace oneflow
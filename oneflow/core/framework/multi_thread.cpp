@@ -24,6 +24,11 @@ void MultiThreadLoopInOpKernel(size_t num, std::function<void(size_t i)> Callbac
   MultiThreadLoop(num, Callback);
 }
 
+void MultiThreadLoopInOpKernel(size_t num, std::function<void(size_t i)> Callback,
+                               size_t grain_size) {
+  MultiThreadLoop(num, Callback, grain_size);
+}
+
 }  // namespace user_op
 
 }  // namespace oneflow
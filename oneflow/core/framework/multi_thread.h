@@ -23,6 +23,8 @@ namespace oneflow {
 namespace user_op {
 
 void MultiThreadLoopInOpKernel(size_t num, std::function<void(size_t i)> Callback);
+void MultiThreadLoopInOpKernel(size_t num, std::function<void(size_t i)> Callback,
+                               size_t grain_size);
 
 }  // namespace user_op
 
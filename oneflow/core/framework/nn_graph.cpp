@@ -14,6 +14,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/framework/nn_graph.h"
+#include <lz4.h>
+#include <cstring>
 #include "oneflow/core/common/buffer_manager.h"
 #include "oneflow/core/common/scalar.h"
 #include "oneflow/core/control/ctrl_client.h"
@@ -31,6 +33,7 @@ limitations under the License.
 #include "oneflow/core/job/job_instance.h"
 #include "oneflow/core/job/critical_section_instance.h"
 #include "oneflow/core/job/lazy_mode.h"
+#include "oneflow/core/job/plan_cache.h"
 #include "oneflow/core/job/plan_util.h"
 #include "oneflow/core/persistence/tee_persistent_log_stream.h"
 #include "oneflow/core/vm/vm_util.h"
@@ -64,6 +67,42 @@ Maybe<std::string> GetTensorMetaString(const std::shared_ptr<one::Tensor>& tenso
   return ret;
 }
 
+std::string RankPlanKey(const std::string& job_name, int64_t rank) {
+  return "plan:" + job_name + ":" + std::to_string(rank);
+}
+
+// A pushed plan is the size of the serialized plan followed by its lz4 compression.
+void PushCompressedPlan(const std::string& key, const Plan& plan) {
+  Global<CtrlClient>::Get()->PushKV(key, [&plan](std::string* value) {
+    const std::string serialized = plan.SerializeAsString();
+    CHECK_LE(serialized.size(), LZ4_MAX_INPUT_SIZE);
+    const int64_t raw_size = serialized.size();
+    value->resize(sizeof(raw_size) + LZ4_compressBound(raw_size));
+    std::memcpy(&value->at(0), &raw_size, sizeof(raw_size));
+    const int compressed_size =
+        LZ4_compress_default(serialized.data(), &value->at(sizeof(raw_size)), raw_size,
+                             value->size() - sizeof(raw_size));
+    CHECK_GT(compressed_size, 0);
+    value->resize(sizeof(raw_size) + compressed_size);
+    VLOG(2) << "push plan " << key << ": " << raw_size << " bytes, " << compressed_size
+            << " bytes compressed";
+  });
+}
+
+void PullCompressedPlan(const std::string& key, Plan* plan) {
+  Global<CtrlClient>::Get()->PullKV(key, [&key, plan](const std::string& value) {
+    int64_t raw_size = 0;
+    CHECK_GE(value.size(), sizeof(raw_size));
+    std::memcpy(&raw_size, value.data(), sizeof(raw_size));
+    std::string serialized(raw_size, '\0');
+    const int decompressed_size =
+        LZ4_decompress_safe(value.data() + sizeof(raw_size), &serialized.at(0),
+                            value.size() - sizeof(raw_size), raw_size);
+    CHECK_EQ(decompressed_size, raw_size) << "corrupted plan " << key;
+    CHECK(plan->ParseFromString(serialized)) << "corrupted plan " << key;
+  });
+}
+
 }  // namespace
 
 NNGraph::~NNGraph() {
@@ -246,13 +285,24 @@ Maybe<void> NNGraph::CompileAndInitRuntime() {
 
   auto scope = std::make_unique<GlobalJobDescScope>(job_.job_conf(), job_ctx->job_id());
   if (GlobalProcessCtx::IsThisProcessMaster()) {
-    double start = GetCurTime();
-    // TODO(chengcheng): new memory reused by chunk
-    Compiler().Compile(&job_, &plan_, /* need_job_complete */ true);
-    PlanUtil::GenMemBlockAndChunkWithVariableOpNames4Plan(&plan_, variable_op_names_);
-
-    LOG(INFO) << "\njob_id: " << job_ctx->job_id() << " , job_name: " << name_
-              << " , compile time: " << (GetCurTime() - start) / 1000000000.0 << " seconds.\n";
+    PlanCache* plan_cache = PlanCache::Get();
+    std::string plan_cache_key;
+    if (plan_cache != nullptr) {
+      plan_cache_key = plan_cache->GenKey(job_, job_ctx->job_id(), variable_op_names_);
+    }
+    if (plan_cache == nullptr || !plan_cache->TryLoad(plan_cache_key, &job_, &plan_)) {
+      double start = GetCurTime();
+      // TODO(chengcheng): new memory reused by chunk
+      Compiler().Compile(&job_, &plan_, /* need_job_complete */ true);
+      PlanUtil::GenMemBlockAndChunkWithVariableOpNames4Plan(&plan_, variable_op_names_);
+      const double compile_seconds = (GetCurTime() - start) / 1000000000.0;
+
+      LOG(INFO) << "\njob_id: " << job_ctx->job_id() << " , job_name: " << name_
+                << " , compile time: " << compile_seconds << " seconds.\n";
+      if (plan_cache != nullptr) {
+        plan_cache->Store(plan_cache_key, job_, plan_, compile_seconds);
+      }
+    }
     if (Global<ResourceDesc, ForSession>::Get()->enable_debug_mode()) {
       TeePersistentLogStream::Create("job_" + name_ + "_plan")->Write(plan_);
       PlanUtil::ToDotFile(plan_, "job_" + name_ + "_plan.dot");
@@ -263,18 +313,22 @@ Maybe<void> NNGraph::CompileAndInitRuntime() {
     PlanUtil::DumpCtrlRegstInfoToPlan(&plan_);
     PlanUtil::PlanMemoryLog(&plan_, name_);
   }
-  if (GlobalProcessCtx::WorldSize() > 1) {
-    std::string plan_name = "plan:" + job_name();
+  const int64_t world_size = GlobalProcessCtx::WorldSize();
+  if (world_size > 1) {
+    // NOTE: every rank pulls only its own compressed sub plan and builds its runtime as soon as
+    //     the sub plan arrives, the master pushes them in rank order.
     if (GlobalProcessCtx::IsThisProcessMaster()) {
-      // TODO(chengcheng): split plan for each rank.
-      Global<CtrlClient>::Get()->PushKV(plan_name, plan_);
+      std::vector<Plan> rank_plans(world_size);
+      PlanUtil::SplitPlan4Ranks(&plan_, variable_op_names_, &rank_plans);
+      FOR_RANGE(int64_t, rank, 0, world_size) {
+        if (rank == GlobalProcessCtx::Rank()) { continue; }
+        PushCompressedPlan(RankPlanKey(job_name(), rank), rank_plans.at(rank));
+        rank_plans.at(rank).Clear();
+      }
+      plan_.Swap(&rank_plans.at(GlobalProcessCtx::Rank()));
     } else {
-      Global<CtrlClient>::Get()->PullKV(plan_name, &plan_);
+      PullCompressedPlan(RankPlanKey(job_name(), GlobalProcessCtx::Rank()), &plan_);
     }
-    OF_SESSION_BARRIER();
-    // NOTE(zwx): After barrier plan is synchronized between all ranks,
-    //     then it can be cleared for saving mem.
-    if (GlobalProcessCtx::IsThisProcessMaster()) { Global<CtrlClient>::Get()->ClearKV(plan_name); }
   }
   // NOTE(chengcheng): recovery op_attr
   PlanUtil::PopulateOpAttribute(&plan_, plan_.job_id2op_attribute_ref_table());
@@ -283,6 +337,14 @@ Maybe<void> NNGraph::CompileAndInitRuntime() {
 
   JUST(GetVariableRealBlobAfterSyncPlan());
   runtime_.reset(new Runtime(plan_, variable_op_name2eager_blob_));
+  // NOTE: Runtime constructs the actors behind a session barrier, so every rank has pulled
+  //     its sub plan and they can be cleared for saving mem.
+  if (world_size > 1 && GlobalProcessCtx::IsThisProcessMaster()) {
+    FOR_RANGE(int64_t, rank, 0, world_size) {
+      if (rank == GlobalProcessCtx::Rank()) { continue; }
+      Global<CtrlClient>::Get()->ClearKV(RankPlanKey(job_name(), rank));
+    }
+  }
   runtime_inited_ = true;
   return Maybe<void>::Ok();
 }
@@ -40,6 +40,7 @@ class NNGraph final : public NNGraphIf {
   const std::vector<bool>& outputs_valid() const override;
   const std::vector<std::string>& inputs_tensor_meta_str() const;
   const std::vector<std::string>& outputs_tensor_meta_str() const;
+  const Plan& plan() const { return plan_; }
   int64_t variable_op_size() const;
 
   Maybe<void> RegisterInputOpNamesAndTensors(
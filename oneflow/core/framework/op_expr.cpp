@@ -13,6 +13,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
+#include <atomic>
 #include <memory>
 #include "oneflow/core/framework/op_expr.h"
 #include "oneflow/core/common/auto_registration_factory.h"
@@ -22,6 +23,7 @@ limitations under the License.
 #include "oneflow/core/framework/op_interpreter/dispatch_frame.h"
 #include "oneflow/core/framework/user_op_registry_manager.h"
 #include "oneflow/core/framework/consistent_tensor_infer_cache.h"
+#include "oneflow/core/framework/mirrored_tensor_infer_cache.h"
 #include "oneflow/core/operator/op_conf.pb.h"
 #include "oneflow/user/kernels/stateful_local_opkernel.h"
 
@@ -112,6 +114,7 @@ Maybe<void> BuiltinOpExprImpl<UserOpConf>::BuildOpConf(OperatorConf* op_conf,
 }
 
 Maybe<StatefulLocalOpKernel> UserOpExpr::MutKernel4Device(Symbol<Device> device) const {
+  std::unique_lock<std::mutex> lock(device2kernel_mutex_);
   const auto& it = device2kernel_.find(device);
   if (it != device2kernel_.end()) { return it->second; }
 
@@ -121,6 +124,9 @@ Maybe<StatefulLocalOpKernel> UserOpExpr::MutKernel4Device(Symbol<Device> device)
   auto parallel_desc = JUST(Placement4Device(device)).shared_from_symbol();
   const auto& opkernel = JUST(StatefulLocalOpKernel::New(
       op_conf, device, base_attrs(), parallel_desc, input_arg_tuple(), output_arg_tuple()));
+  // the flag only depends on the op, set it once here instead of on every call since the kernel
+  // is shared by the threads running eager backward
+  opkernel->set_need_check_mem_case(!has_device_infer_fn());
   device2kernel_.emplace(device, opkernel);
   return opkernel;
 }
@@ -400,13 +406,19 @@ class UserOpExprDeviceInferContext final : public user_op::DeviceInferContext {
   TensorTuple* output_tensors_;
 };
 
+int64_t NewUserOpExprUniqueId() {
+  static std::atomic<int64_t> counter(0);
+  return counter++;
+}
+
 }  // namespace
 
 UserOpExpr::UserOpExpr(const std::string& op_name, UserOpConf&& proto, const AttrMap& base_attrs,
                        const std::vector<std::string>& indexed_ibns,
                        const std::vector<std::string>& indexed_obns)
     : BuiltinOpExprImpl<UserOpConf>(op_name, std::move(proto), indexed_ibns, indexed_obns),
-      base_attrs_(base_attrs) {}
+      base_attrs_(base_attrs),
+      unique_id_(NewUserOpExprUniqueId()) {}
 
 Maybe<void> UserOpExpr::Init(const std::shared_ptr<const UserOpExpr>& self) {
   const auto* registry =
@@ -418,6 +430,7 @@ Maybe<void> UserOpExpr::Init(const std::shared_ptr<const UserOpExpr>& self) {
   CHECK_OR_RETURN(static_cast<bool>(dtype_infer_fn_));
   if (registry->device_infer_fn) { device_infer_fn_ = registry->device_infer_fn; }
   consistent_tensor_infer_cache_.reset(new ConsistentTensorInferCache(self));
+  mirrored_tensor_infer_cache_.reset(new MirroredTensorInferCache());
   return Maybe<void>::Ok();
 }
 
@@ -123,6 +123,7 @@ class BuiltinOpExprImpl : public BuiltinOpExpr {
 
 class StatefulLocalOpKernel;
 class ConsistentTensorInferCache;
+class MirroredTensorInferCache;
 
 class UserOpExpr final : public BuiltinOpExprImpl<UserOpConf> {
  public:
@@ -134,6 +135,8 @@ class UserOpExpr final : public BuiltinOpExprImpl<UserOpConf> {
                                const std::vector<std::string>& indexed_obns);
 
   const AttrMap& base_attrs() const { return base_attrs_; }
+  // Unlike the address, never reused by another op expr after this one is destroyed.
+  int64_t unique_id() const { return unique_id_; }
 
   Maybe<StatefulLocalOpKernel> MutKernel4Device(Symbol<Device> device) const;
 
@@ -154,6 +157,9 @@ class UserOpExpr final : public BuiltinOpExprImpl<UserOpConf> {
   ConsistentTensorInferCache* mut_consistent_tensor_infer_cache() const {
     return consistent_tensor_infer_cache_.get();
   }
+  MirroredTensorInferCache* mut_mirrored_tensor_infer_cache() const {
+    return mirrored_tensor_infer_cache_.get();
+  }
 
  private:
   UserOpExpr(const std::string& op_name, UserOpConf&& proto, const AttrMap& base_attrs,
@@ -161,11 +167,15 @@ class UserOpExpr final : public BuiltinOpExprImpl<UserOpConf> {
              const std::vector<std::string>& indexed_obns);
   Maybe<void> Init(const std::shared_ptr<const UserOpExpr>& self);
   AttrMap base_attrs_;
+  int64_t unique_id_;
   user_op::TensorDescInferFn shape_infer_fn_;
   user_op::DataTypeInferFn dtype_infer_fn_;
   user_op::DeviceInferFn device_infer_fn_;
+  // Guards device2kernel_, eager backward functions may be run by several threads.
+  mutable std::mutex device2kernel_mutex_;
   mutable HashMap<Symbol<Device>, std::shared_ptr<StatefulLocalOpKernel>> device2kernel_;
   std::shared_ptr<ConsistentTensorInferCache> consistent_tensor_infer_cache_;
+  std::shared_ptr<MirroredTensorInferCache> mirrored_tensor_infer_cache_;
 };
 
 class ConsistentToConsistentOpExpr : public OpExpr {
@@ -18,7 +18,9 @@ limitations under the License.
 #include "oneflow/core/framework/device.h"
 #include "oneflow/core/framework/op_interpreter.h"
 #include "oneflow/core/framework/op_interpreter/op_interpreter_util.h"
+#include "oneflow/core/framework/op_interpreter/eager_trace_cache.h"
 #include "oneflow/core/framework/instructions_builder.h"
+#include "oneflow/core/framework/mirrored_tensor_infer_cache.h"
 #include "oneflow/core/framework/op_arg_util.h"
 #include "oneflow/core/framework/scope_util.h"
 #include "oneflow/core/framework/session_util.h"
@@ -80,6 +82,22 @@ std::vector<TensorMeta*>* ThreadLocalDefaultOutputMutTensorMetas(int64_t size) {
   return &ptr_vec;
 }
 
+// Sets the output devices and metas saved by a former inference of the same op.
+Maybe<void> ApplyCachedOutputTensorMetas(const std::vector<MirroredTensorMeta>& cached_metas,
+                                         const TensorTuple& outputs,
+                                         const std::vector<TensorMeta*>& output_tensor_metas) {
+  CHECK_EQ_OR_RETURN(cached_metas.size(), outputs.size());
+  for (int i = 0; i < outputs.size(); i++) {
+    const auto& cached_meta = cached_metas.at(i);
+    *JUST(JUST(TensorImpl4Tensor(outputs.at(i)))->mut_device()) = cached_meta.device();
+    TensorMeta* tensor_meta = output_tensor_metas.at(i);
+    tensor_meta->set_shape(std::make_shared<const Shape>(cached_meta.shape()));
+    tensor_meta->set_dtype(cached_meta.dtype());
+    tensor_meta->set_is_dynamic(cached_meta.is_dynamic());
+  }
+  return Maybe<void>::Ok();
+}
+
 }  // namespace
 
 Maybe<void> NaiveInterpret(const UserOpExpr& user_op_expr, const TensorTuple& inputs,
@@ -110,33 +128,65 @@ Maybe<void> NaiveInterpret(const UserOpExpr& user_op_expr, const TensorTuple& in
     }
   }
   Symbol<Device> op_device;
-  bool need_check_mem_case = true;
-
-  // Infer devices
-  if (!user_op_expr.has_device_infer_fn()) {
-    op_device = default_device;
-    for (int i = 0; i < outputs->size(); i++) {
-      auto* tensor_impl = JUST(TensorImpl4Tensor(outputs->at(i)));
-      *JUST(tensor_impl->mut_device()) = default_device;
-    }
+  std::shared_ptr<StatefulLocalOpKernel> kernel;
+
+  auto* trace_cache = EagerTraceCache::ThisThread();
+  const EagerTraceOp* traced_op = nullptr;
+  if (trace_cache->in_region()) {
+    traced_op = JUST(trace_cache->Lookup(user_op_expr, inputs, *outputs, default_device, ctx));
+  }
+  if (traced_op != nullptr) {
+    // the guards passed, reuse the recorded inference results
+    op_device = traced_op->op_device;
+    kernel = traced_op->kernel;
+    JUST(ApplyCachedOutputTensorMetas(traced_op->output_metas, *outputs, *output_tensor_metas));
   } else {
-    need_check_mem_case = false;
-    op_device = JUST(user_op_expr.InferDevices(attrs, inputs, outputs));
+    auto* infer_cache = user_op_expr.mut_mirrored_tensor_infer_cache();
+    const auto& infer_args = JUST(MirroredTensorMetaInferArgs::New(attrs, default_device, inputs));
+    const auto& infer_result = infer_cache->Find(*infer_args);
+    if (infer_result) {
+      op_device = infer_result->op_device();
+      kernel = infer_result->kernel();
+      JUST(ApplyCachedOutputTensorMetas(infer_result->output_tensor_metas(), *outputs,
+                                        *output_tensor_metas));
+    } else {
+      // Infer devices
+      if (!user_op_expr.has_device_infer_fn()) {
+        op_device = default_device;
+        for (int i = 0; i < outputs->size(); i++) {
+          auto* tensor_impl = JUST(TensorImpl4Tensor(outputs->at(i)));
+          *JUST(tensor_impl->mut_device()) = default_device;
+        }
+      } else {
+        op_device = JUST(user_op_expr.InferDevices(attrs, inputs, outputs));
+      }
+
+      // Infer shapes and dtypes
+      const auto& device_tag = JUST(op_device->of_type());
+      JUST(user_op_expr.InferPhysicalShapeAndDType(
+          attrs, device_tag,
+          [&](int32_t i) -> const TensorMeta* {
+            return CHECK_JUST(TensorImpl4Tensor(inputs.at(i)))->mut_tensor_meta();
+          },
+          [&](int32_t i) -> TensorMeta* {
+            // using thread_local TensorMeta pointer if inplace.
+            // using tensor_impl TensorMeta pointer if not inplace.
+            return output_tensor_metas->at(i);
+          }));
+
+      kernel = JUST(user_op_expr.MutKernel4Device(op_device));
+      auto result = std::make_shared<MirroredTensorInferResult>(op_device, kernel);
+      for (int i = 0; i < outputs->size(); i++) {
+        Symbol<Device> device = JUST(TensorImpl4Tensor(outputs->at(i)))->device();
+        const TensorMeta* tensor_meta = output_tensor_metas->at(i);
+        result->mut_output_tensor_metas()->emplace_back(
+            std::make_shared<const Shape>(tensor_meta->shape()), tensor_meta->dtype(), device);
+        result->mut_output_tensor_metas()->back().set_is_dynamic(tensor_meta->is_dynamic());
+      }
+      infer_cache->Insert(*infer_args, result);
+    }
   }
 
-  // Infer shapes and dtypes
-  const auto& device_tag = JUST(op_device->of_type());
-  JUST(user_op_expr.InferPhysicalShapeAndDType(
-      attrs, device_tag,
-      [&](int32_t i) -> const TensorMeta* {
-        return CHECK_JUST(TensorImpl4Tensor(inputs.at(i)))->mut_tensor_meta();
-      },
-      [&](int32_t i) -> TensorMeta* {
-        // using thread_local TensorMeta pointer if inplace.
-        // using tensor_impl TensorMeta pointer if not inplace.
-        return output_tensor_metas->at(i);
-      }));
-
   for (int i = 0; i < output_eager_blob_objects->size(); i++) {
     auto* tensor_impl = JUST(TensorImpl4Tensor(outputs->at(i)));
     if (!output_eager_blob_objects->at(i)) {
@@ -152,8 +202,9 @@ Maybe<void> NaiveInterpret(const UserOpExpr& user_op_expr, const TensorTuple& in
     }
   }
 
-  const auto& kernel = JUST(user_op_expr.MutKernel4Device(op_device));
-  kernel->set_need_check_mem_case(need_check_mem_case);
+  if (traced_op == nullptr && trace_cache->in_region()) {
+    JUST(trace_cache->Record(op_device, kernel, *outputs));
+  }
 
   for (int64_t index : kernel->output_tuple_indexes4mut2_obns()) {
     output_eager_blob_objects->at(index)->set_is_shape_synced(false);
@@ -0,0 +1,164 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/op_interpreter/eager_trace_cache.h"
+#include "oneflow/core/framework/op_expr.h"
+#include "oneflow/core/framework/op_interpreter.h"
+#include "oneflow/core/framework/stride.h"
+#include "oneflow/core/framework/tensor.h"
+#include "oneflow/core/framework/tensor_tuple.h"
+
+namespace oneflow {
+namespace one {
+
+namespace {
+
+// Shapes may be mutated in place, e.g. by dynamic shape kernels, so the trace keeps its own copies.
+MirroredTensorMeta CopyMirroredTensorMeta(const MirroredTensorMeta& meta) {
+  MirroredTensorMeta copied(std::make_shared<const Shape>(meta.shape()), meta.dtype(),
+                            meta.device(), std::make_shared<const Stride>(meta.stride()),
+                            meta.storage_offset());
+  copied.set_is_dynamic(meta.is_dynamic());
+  return copied;
+}
+
+Maybe<const MirroredTensorMeta&> TensorMeta4Tensor(const std::shared_ptr<Tensor>& tensor) {
+  return *JUST(tensor->mut_eager_mirrored_tensor_impl())->tensor_meta();
+}
+
+}  // namespace
+
+EagerTraceCache* EagerTraceCache::ThisThread() {
+  static thread_local EagerTraceCache trace_cache;
+  return &trace_cache;
+}
+
+Maybe<void> EagerTraceCache::BeginRegion(const std::string& key) {
+  CHECK_EQ_OR_RETURN(mode_, kIdle) << "eager trace region " << key_ << " is not ended";
+  key_ = key;
+  cursor_ = 0;
+  const auto& it = key2trace_.find(key);
+  if (it != key2trace_.end()) {
+    mode_ = kReplay;
+    trace_ = it->second;
+  } else {
+    mode_ = kRecord;
+    trace_ = std::make_shared<std::vector<EagerTraceOp>>();
+  }
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> EagerTraceCache::EndRegion() {
+  CHECK_NE_OR_RETURN(mode_, kIdle) << "no eager trace region to end";
+  // a replay that ran fewer ops than recorded took another path
+  if (mode_ == kReplay && cursor_ != trace_->size()) { Invalidate(); }
+  if (mode_ == kReplay) {
+    ++stats_.region_hit_num;
+  } else {
+    ++stats_.region_miss_num;
+  }
+  // an op failed between Lookup and Record
+  if (mode_ == kRecord && !pending_op_) { key2trace_[key_] = trace_; }
+  mode_ = kIdle;
+  key_.clear();
+  trace_.reset();
+  pending_op_.reset();
+  return Maybe<void>::Ok();
+}
+
+void EagerTraceCache::Clear() { key2trace_.clear(); }
+
+void EagerTraceCache::Invalidate() {
+  key2trace_.erase(key_);
+  trace_.reset();
+  mode_ = kBypass;
+  ++stats_.invalidation_num;
+}
+
+Maybe<const EagerTraceOp*> EagerTraceCache::Lookup(const UserOpExpr& op_expr,
+                                                   const TensorTuple& inputs,
+                                                   const TensorTuple& outputs,
+                                                   Symbol<Device> default_device,
+                                                   const OpExprInterpContext& ctx) {
+  if (mode_ == kReplay) {
+    if (cursor_ < trace_->size()) {
+      const EagerTraceOp* op = &trace_->at(cursor_);
+      if (JUST(MatchGuards(*op, op_expr, inputs, outputs, default_device, ctx))) {
+        ++cursor_;
+        ++stats_.op_hit_num;
+        return op;
+      }
+    }
+    Invalidate();
+  } else if (mode_ == kRecord) {
+    // kernel states passed by the caller are not part of the guards
+    if (ctx.state || pending_op_) {
+      trace_.reset();
+      mode_ = kBypass;
+    } else {
+      pending_op_.reset(new EagerTraceOp());
+      pending_op_->op_expr_unique_id = op_expr.unique_id();
+      pending_op_->attrs = ctx.attrs;
+      pending_op_->default_device = default_device;
+      for (const auto& input : inputs) {
+        const auto& input_meta = JUST(TensorMeta4Tensor(input));
+        pending_op_->input_metas.emplace_back(CopyMirroredTensorMeta(input_meta));
+      }
+      for (const auto& output : outputs) {
+        pending_op_->output_inplaced.emplace_back(static_cast<bool>(output));
+      }
+    }
+  }
+  ++stats_.op_miss_num;
+  return nullptr;
+}
+
+Maybe<void> EagerTraceCache::Record(Symbol<Device> op_device,
+                                    const std::shared_ptr<StatefulLocalOpKernel>& kernel,
+                                    const TensorTuple& outputs) {
+  if (mode_ != kRecord) { return Maybe<void>::Ok(); }
+  CHECK_OR_RETURN(pending_op_);
+  pending_op_->op_device = op_device;
+  pending_op_->kernel = kernel;
+  for (const auto& output : outputs) {
+    pending_op_->output_metas.emplace_back(CopyMirroredTensorMeta(JUST(TensorMeta4Tensor(output))));
+  }
+  trace_->emplace_back(std::move(*pending_op_));
+  pending_op_.reset();
+  return Maybe<void>::Ok();
+}
+
+Maybe<bool> EagerTraceCache::MatchGuards(const EagerTraceOp& op, const UserOpExpr& op_expr,
+                                         const TensorTuple& inputs, const TensorTuple& outputs,
+                                         Symbol<Device> default_device,
+                                         const OpExprInterpContext& ctx) const {
+  if (op_expr.unique_id() != op.op_expr_unique_id) { return false; }
+  if (ctx.state || default_device != op.default_device || !(ctx.attrs == op.attrs)) {
+    return false;
+  }
+  if (inputs.size() != op.input_metas.size() || outputs.size() != op.output_inplaced.size()) {
+    return false;
+  }
+  for (int i = 0; i < inputs.size(); ++i) {
+    if (!(JUST(TensorMeta4Tensor(inputs.at(i))) == op.input_metas.at(i))) { return false; }
+  }
+  for (int i = 0; i < outputs.size(); ++i) {
+    if (static_cast<bool>(outputs.at(i)) != op.output_inplaced.at(i)) { return false; }
+  }
+  return true;
+}
+
+}  // namespace one
+}  // namespace oneflow
@@ -0,0 +1,104 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_FRAMEWORK_OP_INTERPRETER_EAGER_TRACE_CACHE_H_
+#define ONEFLOW_CORE_FRAMEWORK_OP_INTERPRETER_EAGER_TRACE_CACHE_H_
+
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/framework/attr_map.h"
+#include "oneflow/core/framework/device.h"
+#include "oneflow/core/framework/tensor_impl.h"
+
+namespace oneflow {
+namespace one {
+
+class UserOpExpr;
+class TensorTuple;
+class StatefulLocalOpKernel;
+struct OpExprInterpContext;
+
+// One op interpreted inside an eager trace region. The first half guards the second half.
+struct EagerTraceOp {
+  // guards
+  int64_t op_expr_unique_id;
+  AttrMap attrs;
+  Symbol<Device> default_device;
+  std::vector<MirroredTensorMeta> input_metas;
+  std::vector<bool> output_inplaced;
+  // results of device inference, shape inference and kernel lookup
+  Symbol<Device> op_device;
+  std::vector<MirroredTensorMeta> output_metas;
+  std::shared_ptr<StatefulLocalOpKernel> kernel;
+};
+
+struct EagerTraceCacheStats {
+  int64_t region_hit_num;
+  int64_t region_miss_num;
+  int64_t op_hit_num;
+  int64_t op_miss_num;
+  int64_t invalidation_num;
+};
+
+// Caches the ops the eager mirrored interpreter runs inside keyed regions of a thread. The first
+// run of a region records every op. Later runs check each op against its guards: op expr, attrs,
+// devices and input shapes, dtypes and strides. Passing ops skip device inference, shape
+// inference and kernel lookup, the instructions are built for the fresh tensors as usual. A
+// failing guard drops the trace, the rest of the region runs uncached and the next run records
+// the region again.
+class EagerTraceCache final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(EagerTraceCache);
+  ~EagerTraceCache() = default;
+
+  static EagerTraceCache* ThisThread();
+
+  Maybe<void> BeginRegion(const std::string& key);
+  Maybe<void> EndRegion();
+  void Clear();
+
+  bool in_region() const { return mode_ != kIdle; }
+  const EagerTraceCacheStats& stats() const { return stats_; }
+
+  // Called before inference. Returns the recorded op if the guards pass, nullptr otherwise.
+  Maybe<const EagerTraceOp*> Lookup(const UserOpExpr& op_expr, const TensorTuple& inputs,
+                                    const TensorTuple& outputs, Symbol<Device> default_device,
+                                    const OpExprInterpContext& ctx);
+  // Called after inference of an op that Lookup did not find, records it in recording regions.
+  Maybe<void> Record(Symbol<Device> op_device, const std::shared_ptr<StatefulLocalOpKernel>& kernel,
+                     const TensorTuple& outputs);
+
+ private:
+  enum Mode { kIdle, kRecord, kReplay, kBypass };
+
+  EagerTraceCache() : mode_(kIdle), cursor_(0), stats_() {}
+
+  Maybe<bool> MatchGuards(const EagerTraceOp& op, const UserOpExpr& op_expr,
+                          const TensorTuple& inputs, const TensorTuple& outputs,
+                          Symbol<Device> default_device, const OpExprInterpContext& ctx) const;
+  void Invalidate();
+
+  Mode mode_;
+  std::string key_;
+  std::shared_ptr<std::vector<EagerTraceOp>> trace_;
+  size_t cursor_;
+  std::unique_ptr<EagerTraceOp> pending_op_;
+  HashMap<std::string, std::shared_ptr<std::vector<EagerTraceOp>>> key2trace_;
+  EagerTraceCacheStats stats_;
+};
+
+}  // namespace one
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_FRAMEWORK_OP_INTERPRETER_EAGER_TRACE_CACHE_H_
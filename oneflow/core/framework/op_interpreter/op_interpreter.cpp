@@ -108,8 +108,14 @@ Maybe<void> AutogradInterpreter::Apply(const OpExpr& op_expr, const TensorTuple&
               JUST(grad_closure->Apply(out_grads, in_grads));
               return Maybe<void>::Ok();
             });
-    JUST(GetThreadLocalAutogradEngine()->AddBackwardFuncPtr(op_expr.op_type_name() + "_backward",
-                                                            backward_fn, inputs, outputs));
+    const auto& func_node = JUST(GetThreadLocalAutogradEngine()->AddBackwardFuncPtr(
+        op_expr.op_type_name() + "_backward", backward_fn, inputs, outputs));
+    bool has_consistent_input =
+        std::any_of(inputs.begin(), inputs.end(),
+                    [](const std::shared_ptr<Tensor>& tensor) { return tensor->is_consistent(); });
+    if (dynamic_cast<const FunctionOpExpr*>(&op_expr) != nullptr || has_consistent_input) {
+      func_node->set_runs_on_caller_thread(true);
+    }
   }
   for (auto& output : *outputs) {
     output->set_is_leaf(inputs.size() == 0 || !requires_grad);
@@ -21,6 +21,7 @@ limitations under the License.
 #include "oneflow/core/common/str_util.h"
 #include "oneflow/core/graph/node.h"
 #include "oneflow/core/persistence/tee_persistent_log_stream.h"
+#include "oneflow/core/thread/thread_pool.h"
 
 namespace oneflow {
 
@@ -39,6 +40,14 @@ class Graph {
       std::function<Maybe<void>(NodeType*)> NodeHandler) const;
   void ReverseTopoForEachNode(std::function<void(NodeType*)> NodeHandler) const;
   void ForEachEdge(std::function<void(EdgeType*)> EdgeHandler) const;
+  // Level synchronous topological traversal: a node's level is one more than the deepest level of
+  // its in nodes, the nodes of a level are handled in parallel on thread_pool once all the nodes of
+  // the lower levels are handled. NodeHandler may read what the handlers of the in nodes wrote but
+  // must not write anything shared with the other nodes of its level.
+  void ParallelTopoForEachNode(ThreadPool* thread_pool,
+                               std::function<void(NodeType*)> NodeHandler) const;
+  void ParallelForEachEdge(ThreadPool* thread_pool,
+                           std::function<void(EdgeType*)> EdgeHandler) const;
 
   void SortedTopoForEachNode(std::function<bool(const EdgeType* lhs, const EdgeType* rhs)> LessThan,
                              std::function<void(NodeType*)> NodeHandler) const;
@@ -248,6 +257,39 @@ void Graph<NodeType, EdgeType>::ForEachEdge(std::function<void(EdgeType*)> EdgeH
   }
 }
 
+template<typename NodeType, typename EdgeType>
+void Graph<NodeType, EdgeType>::ParallelTopoForEachNode(
+    ThreadPool* thread_pool, std::function<void(NodeType*)> NodeHandler) const {
+  std::vector<std::vector<NodeType*>> level2nodes;
+  HashMap<NodeType*, size_t> node2level;
+  node2level.reserve(node_num());
+  TopoForEachNode([&](NodeType* node) {
+    size_t level = 0;
+    node->ForEachNodeOnInEdge(
+        [&](NodeType* in_node) { level = std::max(level, node2level.at(in_node) + 1); });
+    node2level.emplace(node, level);
+    if (level == level2nodes.size()) { level2nodes.emplace_back(); }
+    level2nodes.at(level).emplace_back(node);
+  });
+  for (const std::vector<NodeType*>& nodes : level2nodes) {
+    thread_pool->ParallelFor(nodes.size(), 1, [&](size_t begin, size_t end) {
+      FOR_RANGE(size_t, i, begin, end) { NodeHandler(nodes.at(i)); }
+    });
+  }
+}
+
+template<typename NodeType, typename EdgeType>
+void Graph<NodeType, EdgeType>::ParallelForEachEdge(
+    ThreadPool* thread_pool, std::function<void(EdgeType*)> EdgeHandler) const {
+  thread_pool->ParallelFor(edges_.size(), 1, [&](size_t begin, size_t end) {
+    FOR_RANGE(size_t, i, begin, end) {
+      EdgeType* edge = edges_.at(i).get();
+      if (edge->src_node() == nullptr && edge->dst_node() == nullptr) { continue; }
+      EdgeHandler(edge);
+    }
+  });
+}
+
 template<typename NodeType, typename EdgeType>
 NodeType* Graph<NodeType, EdgeType>::SoleNode() const {
   CHECK_EQ(nodes_.size(), 1);
@@ -14,17 +14,19 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/graph/node.h"
+#include <atomic>
 
 namespace oneflow {
 
+// nodes and edges are also created by graph handlers running on several threads
 int64_t NewNodeId() {
-  static int64_t node_id = 0;
-  return node_id++;
+  static std::atomic<int64_t> node_id(0);
+  return node_id.fetch_add(1, std::memory_order_relaxed);
 }
 
 int64_t NewEdgeId() {
-  static int64_t edge_id = 0;
-  return edge_id++;
+  static std::atomic<int64_t> edge_id(0);
+  return edge_id.fetch_add(1, std::memory_order_relaxed);
 }
 
 }  // namespace oneflow
@@ -30,6 +30,15 @@ class TaskIdGenerator final {
 
   TaskId Generate(const StreamId& stream_id);
 
+  // The next task index of every stream, saved and restored by IDMgr with a cached plan
+  const HashMap<StreamId, task_index_t>& stream_id2task_index_counter() const {
+    return stream_id2task_index_counter_;
+  }
+  void set_stream_id2task_index_counter(
+      const HashMap<StreamId, task_index_t>& stream_id2task_index_counter) {
+    stream_id2task_index_counter_ = stream_id2task_index_counter;
+  }
+
  private:
   HashMap<StreamId, task_index_t> stream_id2task_index_counter_;
 };
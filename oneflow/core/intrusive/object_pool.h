@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef ONEFLOW_CORE_INTRUSIVE_OBJECT_POOL_H_
 #define ONEFLOW_CORE_INTRUSIVE_OBJECT_POOL_H_
 
+#include <mutex>
 #include <vector>
 #include "oneflow/core/intrusive/cpp_attribute.h"
 
@@ -24,6 +25,7 @@ namespace intrusive {
 
 enum ObjectPoolStrategey {
   kThreadUnsafeAndDisableDestruct,
+  kThreadLocalAndDisableDestruct,
 };
 
 template<typename T, ObjectPoolStrategey object_pool_strategy>
@@ -85,6 +87,74 @@ class ObjectPool<T, kThreadUnsafeAndDisableDestruct> {
   std::vector<T*> container_;
 };
 
+// Every thread allocates from its own pool. Objects released on the owner thread go back to its
+// free list without locking, objects released on other threads are returned to the owner under a
+// mutex and taken back in batches once the free list runs empty. __Delete__ is called on release so
+// the fields drop their resources, but the objects themselves are never destructed.
+template<typename T>
+class ObjectPool<T, kThreadLocalAndDisableDestruct> {
+ public:
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool(ObjectPool&&) = delete;
+
+  // Pools are leaked on purpose, their objects may be released after the owner thread exited.
+  static ObjectPool* ThisThreadPool() {
+    auto** pool = MutThreadLocalPool();
+    if (INTRUSIVE_PREDICT_FALSE(*pool == nullptr)) { *pool = new ObjectPool(); }
+    return *pool;
+  }
+
+  template<typename... Args>
+  intrusive::shared_ptr<T> make_shared(Args&&... args) {
+    if (INTRUSIVE_PREDICT_FALSE(container_.empty())) {
+      std::unique_lock<std::mutex> lock(returned_mutex_);
+      container_.swap(returned_container_);
+    }
+    if (INTRUSIVE_PREDICT_FALSE(container_.empty())) {
+      auto ptr = intrusive::make_shared<T>(std::forward<Args>(args)...);
+      InitObjectPoolFields4Element(ptr.get());
+      return ptr;
+    } else {
+      auto* ptr = container_.back();
+      container_.pop_back();
+      ptr->__Init__(std::forward<Args>(args)...);
+      InitObjectPoolFields4Element(ptr);
+      return intrusive::shared_ptr<T>(ptr);
+    }
+  }
+
+  static void Put(void* raw_ptr) {
+    T* ptr = reinterpret_cast<T*>(raw_ptr);
+    ptr->__Delete__();
+    auto* pool = ptr->mut_object_pool();
+    if (INTRUSIVE_PREDICT_TRUE(pool == *MutThreadLocalPool())) {
+      pool->container_.push_back(ptr);
+    } else {
+      std::unique_lock<std::mutex> lock(pool->returned_mutex_);
+      pool->returned_container_.push_back(ptr);
+    }
+  }
+
+ private:
+  ObjectPool() { container_.reserve(kObjectPoolInitCap); }
+  ~ObjectPool() = default;
+
+  static ObjectPool** MutThreadLocalPool() {
+    static thread_local ObjectPool* pool = nullptr;
+    return &pool;
+  }
+
+  inline void InitObjectPoolFields4Element(T* ptr) {
+    ptr->set_object_pool(this);
+    ptr->mut_intrusive_ref()->set_deleter(&ObjectPool::Put);
+  }
+
+  static constexpr int kObjectPoolInitCap = 1024;
+  std::vector<T*> container_;
+  std::mutex returned_mutex_;
+  std::vector<T*> returned_container_;
+};
+
 }  // namespace intrusive
 }  // namespace oneflow
 
@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include <sstream>
+#include <thread>
 #define private public
 #include "oneflow/core/common/util.h"
 #include "oneflow/core/intrusive/intrusive.h"
@@ -52,6 +53,38 @@ TEST(ObjectPool_kThreadUnsafeAndDisableDestruct, recycle) {
   ASSERT_EQ(ptr, object_pool.make_shared().get());
 }
 
+class IntrusiveBar final  // NOLINT
+    : public intrusive::Base,
+      public intrusive::EnableObjectPool<IntrusiveBar, kThreadLocalAndDisableDestruct> {  // NOLINT
+ public:
+  IntrusiveBar() = default;  // NOLINT
+
+  intrusive::Ref* mut_intrusive_ref() { return &intrusive_ref_; }
+
+ private:
+  intrusive::Ref intrusive_ref_;
+};
+
+using IntrusiveBarPool = ObjectPool<IntrusiveBar, kThreadLocalAndDisableDestruct>;
+
+TEST(ObjectPool_kThreadLocalAndDisableDestruct, append_to_pool) {
+  auto* object_pool = IntrusiveBarPool::ThisThreadPool();
+  IntrusiveBar* ptr = nullptr;
+  { ptr = object_pool->make_shared().get(); }
+  ASSERT_EQ(ptr, object_pool->make_shared().get());
+}
+
+TEST(ObjectPool_kThreadLocalAndDisableDestruct, cross_thread_return) {
+  auto* object_pool = IntrusiveBarPool::ThisThreadPool();
+  auto bar = object_pool->make_shared();
+  auto* ptr = bar.get();
+  std::thread([&]() {
+    ASSERT_NE(object_pool, IntrusiveBarPool::ThisThreadPool());
+    bar.Reset();
+  }).join();
+  ASSERT_EQ(ptr, object_pool->make_shared().get());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace intrusive
@@ -62,25 +62,38 @@ void Compiler::Compile(Job* job, Plan* plan, bool need_job_complete) const {
   // Step3: build task_gph.
   // TODO(levi): we can rewrite this part of code in visitor pattern.
   auto task_gph = std::make_unique<TaskGraph>();
+  const int64_t cpu_num = std::thread::hardware_concurrency();
+  const int64_t thread_pool_size = std::min<int64_t>(task_gph->node_num(), cpu_num);
+  ThreadPool thread_pool(thread_pool_size);
+  // NOTE: Build and InferTimeShapeIfMeaningful only write the regsts produced by the node and
+  // read those of its in nodes, so the nodes of a topological level run in parallel and produce
+  // the same graph as the serial traversal. The other node phases create regst ids in node order
+  // or write the regsts of the neighbours, they stay serial.
+  const bool parallel_build = ParseBooleanFromEnv("ONEFLOW_COMPILER_PARALLEL_BUILD", true);
+  auto TopoForEachTaskNode = [&](const std::function<void(TaskNode*)>& Handler) {
+    if (parallel_build) {
+      task_gph->ParallelTopoForEachNode(&thread_pool, Handler);
+    } else {
+      task_gph->TopoForEachNode(Handler);
+    }
+  };
   using std::placeholders::_1;
   task_gph->ForEachNode(std::bind(&TaskNode::ProduceAllRegstsAndBindEdges, _1));
   task_gph->ForEachNode(std::bind(&TaskNode::ConsumeAllRegsts, _1));
   task_gph->ForEachNode(std::bind(&TaskNode::PinConsumedRegst, _1));
-  task_gph->TopoForEachNode(&TaskNode::Build);
+  TopoForEachTaskNode(&TaskNode::Build);
   task_gph->RemoveEmptyRegsts();
   task_gph->MergeChainAndAddOrderingCtrlEdgeInSameChain();
   auto IsReachable = Global<OpGraph>::Get()->MakePredicatorIsOpNameDataOrCtrlReachable();
   if (job_desc.enable_inplace()) { task_gph->EnableInplaceMemSharing(IsReachable); }
-  task_gph->TopoForEachNode(&TaskNode::InferTimeShapeIfMeaningful);
-  task_gph->ForEachEdge([&](TaskEdge* task_edge) { task_edge->CheckRegstLbiValid(); });
+  TopoForEachTaskNode(&TaskNode::InferTimeShapeIfMeaningful);
+  task_gph->ParallelForEachEdge(&thread_pool,
+                                [&](TaskEdge* task_edge) { task_edge->CheckRegstLbiValid(); });
 
   // Step4: put infomation from task_gph into plan.
   const int64_t node_num = task_gph->node_num();
-  const int64_t cpu_num = std::thread::hardware_concurrency();
-  const int64_t thread_pool_size = std::min(node_num, cpu_num);
   BlockingCounter counter(node_num);
   std::mutex mtx;
-  ThreadPool thread_pool(thread_pool_size);
   task_gph->ForEachNode([&](TaskNode* task_node) {
     thread_pool.AddWork([task_node, plan, &job_desc, &counter, &mtx]() {
       if (!task_node->IsMeaningLess()) {
@@ -28,4 +28,26 @@ IDMgr::IDMgr() {
   chunk_id_count_ = 0;
 }
 
+void IDMgr::SaveIdState(IdState* id_state) const {
+  id_state->set_regst_desc_id_count(regst_desc_id_count_);
+  id_state->set_mem_block_id_count(mem_block_id_count_);
+  id_state->set_chunk_id_count(chunk_id_count_);
+  auto* stream_id2task_index_counter = id_state->mutable_stream_id2task_index_counter();
+  stream_id2task_index_counter->clear();
+  for (const auto& pair : task_id_gen_.stream_id2task_index_counter()) {
+    (*stream_id2task_index_counter)[EncodeStreamIdToInt64(pair.first)] = pair.second;
+  }
+}
+
+void IDMgr::LoadIdState(const IdState& id_state) {
+  regst_desc_id_count_ = id_state.regst_desc_id_count();
+  mem_block_id_count_ = id_state.mem_block_id_count();
+  chunk_id_count_ = id_state.chunk_id_count();
+  HashMap<StreamId, TaskId::task_index_t> stream_id2task_index_counter;
+  for (const auto& pair : id_state.stream_id2task_index_counter()) {
+    stream_id2task_index_counter.emplace(DecodeStreamIdFromInt64(pair.first), pair.second);
+  }
+  task_id_gen_.set_stream_id2task_index_counter(stream_id2task_index_counter);
+}
+
 }  // namespace oneflow
@@ -20,6 +20,7 @@ limitations under the License.
 #include "oneflow/core/job/job_desc.h"
 #include "oneflow/core/job/resource_desc.h"
 #include "oneflow/core/job/global_for.h"
+#include "oneflow/core/job/id_state.pb.h"
 #include "oneflow/core/graph/task_id_generator.h"
 
 namespace oneflow {
@@ -35,6 +36,11 @@ class IDMgr final {
 
   TaskIdGenerator* GetTaskIdGenerator() { return &task_id_gen_; }
 
+  // A plan compiled from the same id counters gets the same ids, a cached plan restores the
+  // counters after its compilation so that its ids are not generated again.
+  void SaveIdState(IdState* id_state) const;
+  void LoadIdState(const IdState& id_state);
+
  private:
   friend class Global<IDMgr>;
   IDMgr();
@@ -14,6 +14,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/job/intra_job_mem_sharing_util.h"
+#include <limits>
+#include <numeric>
+#include <set>
 #include "oneflow/core/common/blocking_counter.h"
 #include "oneflow/core/common/str_util.h"
 #include "oneflow/core/common/shape.h"
@@ -29,6 +32,7 @@ enum MemAllocAlgoType {
   kMemSizeFirstAlgo = 0,
   kMutualExclusionFirstAlgo = 1,
   kTimeLineAlgo = 2,
+  kIntervalBestFitAlgo = 3,
 };
 
 }  // namespace oneflow
@@ -307,7 +311,7 @@ void GenRegstAllocFreeTimeLineAndRegstMutualExclusions(
     HashMap<RegstDescProto*, std::vector<RegstDescProto*>>* regst2mutual_exclusion_regsts,
     HashMap<RegstDescProto*, RegstDescProto*>* consumer2inplaced_regst) {
   CHECK(alloc_regsts_timeline->empty() && free_regsts_timeline->empty());
-  CHECK(regst2mutual_exclusion_regsts->empty());
+  CHECK(regst2mutual_exclusion_regsts == nullptr || regst2mutual_exclusion_regsts->empty());
   CHECK(consumer2inplaced_regst->empty());
   alloc_regsts_timeline->resize(sorted_tasks.size());
   free_regsts_timeline->resize(sorted_tasks.size());
@@ -380,11 +384,13 @@ void GenRegstAllocFreeTimeLineAndRegstMutualExclusions(
   HashSet<RegstDescProto*> remain_regsts;
   for (int64_t i = 0; i < sorted_tasks.size(); ++i) {
     for (RegstDescProto* alloc_regst : alloc_regsts_timeline->at(i)) {
-      CHECK(regst2mutual_exclusion_regsts->emplace(alloc_regst, std::vector<RegstDescProto*>())
-                .second);
-      for (RegstDescProto* remain_regst : remain_regsts) {
-        regst2mutual_exclusion_regsts->at(alloc_regst).emplace_back(remain_regst);
-        regst2mutual_exclusion_regsts->at(remain_regst).emplace_back(alloc_regst);
+      if (regst2mutual_exclusion_regsts != nullptr) {
+        CHECK(regst2mutual_exclusion_regsts->emplace(alloc_regst, std::vector<RegstDescProto*>())
+                  .second);
+        for (RegstDescProto* remain_regst : remain_regsts) {
+          regst2mutual_exclusion_regsts->at(alloc_regst).emplace_back(remain_regst);
+          regst2mutual_exclusion_regsts->at(remain_regst).emplace_back(alloc_regst);
+        }
       }
       CHECK(remain_regsts.insert(alloc_regst).second);
     }
@@ -693,6 +699,101 @@ void MemReusedAlgorithm_TimeLineAlgo(
   result->mem_block_size = bfc_allocator.buffer_size();
 }
 
+using RegstIntervals = IntraJobMemSharingUtil::RegstIntervals;
+
+// The regsts are indexed by the order of allocation.
+void GenRegstIntervals(const std::vector<HashSet<RegstDescProto*>>& alloc_regsts_timeline,
+                       const std::vector<HashSet<RegstDescProto*>>& free_regsts_timeline,
+                       RegstIntervals* intervals, std::vector<RegstDescProto*>* regsts,
+                       HashMap<RegstDescProto*, int64_t>* regst2index) {
+  CHECK_EQ(alloc_regsts_timeline.size(), free_regsts_timeline.size());
+  for (int64_t i = 0; i < alloc_regsts_timeline.size(); ++i) {
+    for (RegstDescProto* regst : alloc_regsts_timeline.at(i)) {
+      CHECK(regst2index->emplace(regst, regsts->size()).second);
+      regsts->emplace_back(regst);
+      intervals->ids.emplace_back(regst->regst_desc_id());
+      intervals->sizes.emplace_back(RtRegstDesc(*regst).TotalMainByteSize4AllRegst());
+      intervals->alloc_indices.emplace_back(i);
+      intervals->free_indices.emplace_back(-1);
+    }
+  }
+  for (int64_t i = 0; i < free_regsts_timeline.size(); ++i) {
+    for (RegstDescProto* regst : free_regsts_timeline.at(i)) {
+      intervals->free_indices.at(regst2index->at(regst)) = i;
+    }
+  }
+}
+
+// Sweeps the alloc/free timeline and places each regst at the tightest gap between the regsts
+// alive at its allocation, or above all of them. The regsts allocated by the same task are placed
+// in their order of priority. Returns the mem block size.
+int64_t PlaceRegstsByBestFit(const RegstIntervals& intervals, const std::vector<int64_t>& priority,
+                             std::vector<int64_t>* offsets) {
+  const int64_t regst_num = intervals.sizes.size();
+  offsets->assign(regst_num, -1);
+  if (regst_num == 0) { return 0; }
+  const int64_t time_num =
+      *std::max_element(intervals.free_indices.begin(), intervals.free_indices.end()) + 1;
+  std::vector<std::vector<int64_t>> time2alloc_indices(time_num);
+  std::vector<std::vector<int64_t>> time2free_indices(time_num);
+  for (int64_t index : priority) {
+    time2alloc_indices.at(intervals.alloc_indices.at(index)).emplace_back(index);
+    time2free_indices.at(intervals.free_indices.at(index)).emplace_back(index);
+  }
+  // the alive regsts ordered by offset, they never overlap in memory
+  std::set<std::pair<int64_t, int64_t>> alive_offset_index_pairs;
+  int64_t mem_block_size = 0;
+  FOR_RANGE(int64_t, time, 0, time_num) {
+    for (int64_t index : time2alloc_indices.at(time)) {
+      const int64_t size = intervals.sizes.at(index);
+      int64_t best_offset = -1;
+      int64_t best_slack = std::numeric_limits<int64_t>::max();
+      int64_t gap_begin = 0;
+      for (const auto& pair : alive_offset_index_pairs) {
+        const int64_t slack = pair.first - gap_begin - size;
+        if (slack >= 0 && slack < best_slack) {
+          best_offset = gap_begin;
+          best_slack = slack;
+          if (slack == 0) { break; }
+        }
+        gap_begin = std::max(gap_begin, pair.first + intervals.sizes.at(pair.second));
+      }
+      if (best_offset == -1) { best_offset = gap_begin; }
+      offsets->at(index) = best_offset;
+      CHECK(alive_offset_index_pairs.emplace(best_offset, index).second);
+      mem_block_size = std::max(mem_block_size, best_offset + size);
+    }
+    // both ends of a lifetime are included, so the regsts freed here overlap the ones allocated
+    for (int64_t index : time2free_indices.at(time)) {
+      CHECK_EQ(alive_offset_index_pairs.erase(std::make_pair(offsets->at(index), index)), 1);
+    }
+  }
+  return mem_block_size;
+}
+
+void MemReusedAlgorithm_IntervalBestFitAlgo(
+    const std::vector<HashSet<RegstDescProto*>>& alloc_regsts_timeline,
+    const std::vector<HashSet<RegstDescProto*>>& free_regsts_timeline,
+    MemBlockResultInfo* result) {
+  RegstIntervals intervals;
+  std::vector<RegstDescProto*> regsts;
+  HashMap<RegstDescProto*, int64_t> regst2index;
+  GenRegstIntervals(alloc_regsts_timeline, free_regsts_timeline, &intervals, &regsts,
+                    &regst2index);
+  const int64_t local_search_rounds = GlobalJobDesc()
+                                          .job_conf()
+                                          .memory_allocation_algorithm_conf()
+                                          .interval_best_fit_local_search_rounds();
+  std::vector<int64_t> offsets;
+  const int64_t mem_block_size = IntraJobMemSharingUtil::PlaceRegstsByIntervalBestFit(
+      intervals, local_search_rounds, &offsets);
+  HashMap<RegstDescProto*, int64_t>* regst_desc2offset = &(result->regst_desc2offset);
+  FOR_RANGE(int64_t, i, 0, regsts.size()) {
+    CHECK(regst_desc2offset->emplace(regsts.at(i), offsets.at(i)).second);
+  }
+  result->mem_block_size = std::max<int64_t>(mem_block_size, 1);
+}
+
 void SelectAlgorithmGenMemBlockOffset4Regsts(
     MemAllocAlgoType algo_id, const std::vector<HashSet<RegstDescProto*>>& alloc_regsts_timeline,
     const std::vector<HashSet<RegstDescProto*>>& free_regsts_timeline,
@@ -710,6 +811,9 @@ void SelectAlgorithmGenMemBlockOffset4Regsts(
     case kTimeLineAlgo:
       MemReusedAlgorithm_TimeLineAlgo(alloc_regsts_timeline, free_regsts_timeline, result);
       break;
+    case kIntervalBestFitAlgo:
+      MemReusedAlgorithm_IntervalBestFitAlgo(alloc_regsts_timeline, free_regsts_timeline, result);
+      break;
     default: UNIMPLEMENTED();
   }
   CHECK_GT(result->mem_block_size, 0);
@@ -723,6 +827,7 @@ int64_t CountMemAllocAlgoNum() {
   if (mem_alloc_algo_conf.use_mem_size_first_algo()) { ++ret; }
   if (mem_alloc_algo_conf.use_mutual_exclusion_first_algo()) { ++ret; }
   if (mem_alloc_algo_conf.use_time_line_algo()) { ++ret; }
+  if (mem_alloc_algo_conf.use_interval_best_fit_algo()) { ++ret; }
   CHECK_GE(ret, 0);
   return ret;
 }
@@ -740,6 +845,9 @@ void InitAlgo2Result(HashMap<MemAllocAlgoType, MemBlockResultInfo>* algo2result)
   if (mem_alloc_algo_conf.use_time_line_algo()) {
     CHECK(algo2result->emplace(kTimeLineAlgo, MemBlockResultInfo()).second);
   }
+  if (mem_alloc_algo_conf.use_interval_best_fit_algo()) {
+    CHECK(algo2result->emplace(kIntervalBestFitAlgo, MemBlockResultInfo()).second);
+  }
 }
 
 }  // namespace
@@ -765,12 +873,19 @@ void IntraJobMemSharingUtil::InferMemBlockId4MemReusedRegst(
   // info for inplace
   HashMap<int64_t, HashMap<RegstDescProto*, RegstDescProto*>> mem_chain2consumer2inplaced_regst;
 
+  const MemoryAllocationAlgorithmConf& mem_alloc_algo_conf =
+      GlobalJobDesc().job_conf().memory_allocation_algorithm_conf();
+  // the mutual exclusions take O(n^2) to build, only the first two algos need them
+  const bool need_mutual_exclusions = mem_alloc_algo_conf.use_mem_size_first_algo()
+                                      || mem_alloc_algo_conf.use_mutual_exclusion_first_algo();
+
   // step 1: generate regst alloc/free queue AND regst mutual exclusions
   for (const auto& pair : mem_chain2mem_reused_regsts) {
+    auto* regst2mutual_exclusion_regsts = &mem_chain2regst2mutual_exclusion_regsts[pair.first];
     GenRegstAllocFreeTimeLineAndRegstMutualExclusions(
         mem_chain2sorted_tasks.at(pair.first), pair.second, regst_desc_id2regst_desc,
         &mem_chain2task2alloc_regsts[pair.first], &mem_chain2task2free_regsts[pair.first],
-        &mem_chain2regst2mutual_exclusion_regsts[pair.first],
+        need_mutual_exclusions ? regst2mutual_exclusion_regsts : nullptr,
         &mem_chain2consumer2inplaced_regst[pair.first]);
   }
 
@@ -801,14 +916,34 @@ void IntraJobMemSharingUtil::InferMemBlockId4MemReusedRegst(
   }
 
   // step 3: choose best one for each mem chain and set offset for inplace consumer regst
+  const bool log_lower_bound = mem_alloc_algo_conf.use_interval_best_fit_algo() || VLOG_IS_ON(2);
+  int64_t total_mem_block_size = 0;
+  int64_t total_lower_bound = 0;
   for (const auto& pair : mem_chain2algo2result) {
     const MemBlockResultInfo* best_result = nullptr;
+    MemAllocAlgoType best_algo_id = kMemSizeFirstAlgo;
     for (const auto& algo_result_pair : pair.second) {
-      if (!best_result || algo_result_pair.second.mem_block_size < best_result->mem_block_size) {
+      if (!best_result || algo_result_pair.second.mem_block_size < best_result->mem_block_size
+          || (algo_result_pair.second.mem_block_size == best_result->mem_block_size
+              && algo_result_pair.first < best_algo_id)) {
         best_result = &algo_result_pair.second;
+        best_algo_id = algo_result_pair.first;
       }
     }
     CHECK(best_result != nullptr);
+    if (log_lower_bound) {
+      RegstIntervals intervals;
+      std::vector<RegstDescProto*> regsts;
+      HashMap<RegstDescProto*, int64_t> regst2index;
+      GenRegstIntervals(mem_chain2task2alloc_regsts.at(pair.first),
+                        mem_chain2task2free_regsts.at(pair.first), &intervals, &regsts,
+                        &regst2index);
+      const int64_t lower_bound = IntraJobMemSharingUtil::MemBlockSizeLowerBound(intervals);
+      VLOG(2) << "mem chain " << pair.first << " uses algo " << best_algo_id << ", "
+              << best_result->mem_block_size << " bytes, lower bound " << lower_bound << " bytes";
+      total_mem_block_size += best_result->mem_block_size;
+      total_lower_bound += lower_bound;
+    }
     int64_t mem_block_id = Global<IDMgr>::Get()->NewMemBlockId();
     CHECK_EQ(mem_chain2mem_reused_regsts.at(pair.first).size(),
              (best_result->regst_desc2offset.size()
@@ -849,6 +984,80 @@ void IntraJobMemSharingUtil::InferMemBlockId4MemReusedRegst(
       consumer_regst_desc->set_inplace_consumed_regst_desc_id(hint);
     }
   }
+  if (log_lower_bound) {
+    LOG(INFO) << "job " << GlobalJobDesc().job_id() << " reuses " << total_mem_block_size
+              << " bytes of memory, the lower bound is " << total_lower_bound << " bytes ("
+              << static_cast<double>(total_mem_block_size)
+                     / std::max<int64_t>(total_lower_bound, 1)
+              << "x)";
+  }
+}
+
+int64_t IntraJobMemSharingUtil::MemBlockSizeLowerBound(const RegstIntervals& intervals) {
+  if (intervals.sizes.empty()) { return 0; }
+  const int64_t time_num =
+      *std::max_element(intervals.free_indices.begin(), intervals.free_indices.end()) + 1;
+  std::vector<int64_t> size_delta(time_num + 1, 0);
+  FOR_RANGE(int64_t, i, 0, intervals.sizes.size()) {
+    size_delta.at(intervals.alloc_indices.at(i)) += intervals.sizes.at(i);
+    size_delta.at(intervals.free_indices.at(i) + 1) -= intervals.sizes.at(i);
+  }
+  int64_t alive_size = 0;
+  int64_t lower_bound = 0;
+  for (int64_t delta : size_delta) {
+    alive_size += delta;
+    lower_bound = std::max(lower_bound, alive_size);
+  }
+  return lower_bound;
+}
+
+int64_t IntraJobMemSharingUtil::PlaceRegstsByIntervalBestFit(const RegstIntervals& intervals,
+                                                             int64_t local_search_rounds,
+                                                             std::vector<int64_t>* offsets) {
+  const int64_t regst_num = intervals.sizes.size();
+  // Among the regsts allocated by the same task the larger ones are placed first, among equal
+  // sizes the longer lived ones take the lower offsets so that the short lived ones fill the gaps
+  // above them. Regst desc ids make the order deterministic.
+  std::vector<int64_t> order(regst_num);
+  std::iota(order.begin(), order.end(), 0);
+  auto Lifetime = [&](int64_t i) {
+    return intervals.free_indices.at(i) - intervals.alloc_indices.at(i);
+  };
+  std::sort(order.begin(), order.end(), [&](int64_t lhs, int64_t rhs) {
+    if (intervals.sizes.at(lhs) != intervals.sizes.at(rhs)) {
+      return intervals.sizes.at(lhs) > intervals.sizes.at(rhs);
+    }
+    if (Lifetime(lhs) != Lifetime(rhs)) { return Lifetime(lhs) > Lifetime(rhs); }
+    return intervals.ids.at(lhs) < intervals.ids.at(rhs);
+  });
+  int64_t mem_block_size = PlaceRegstsByBestFit(intervals, order, offsets);
+  if (local_search_rounds <= 0) { return mem_block_size; }
+
+  // Local search: a regst reaching the top of the block is moved to the front of the order and
+  // the placement is redone, the new order is kept if the block shrinks.
+  const int64_t lower_bound = MemBlockSizeLowerBound(intervals);
+  HashSet<int64_t> tried;
+  std::vector<int64_t> new_order;
+  std::vector<int64_t> new_offsets;
+  for (int64_t round = 0; round < local_search_rounds && mem_block_size > lower_bound; ++round) {
+    auto top_it = std::find_if(order.begin(), order.end(), [&](int64_t i) {
+      return offsets->at(i) + intervals.sizes.at(i) == mem_block_size && tried.count(i) == 0;
+    });
+    if (top_it == order.end() || top_it == order.begin()) { break; }
+    tried.insert(*top_it);
+    new_order.clear();
+    new_order.emplace_back(*top_it);
+    new_order.insert(new_order.end(), order.begin(), top_it);
+    new_order.insert(new_order.end(), std::next(top_it), order.end());
+    const int64_t new_mem_block_size = PlaceRegstsByBestFit(intervals, new_order, &new_offsets);
+    if (new_mem_block_size < mem_block_size) {
+      order.swap(new_order);
+      offsets->swap(new_offsets);
+      mem_block_size = new_mem_block_size;
+      tried.clear();
+    }
+  }
+  return mem_block_size;
 }
 
 }  // namespace oneflow
@@ -19,6 +19,7 @@ limitations under the License.
 #include "oneflow/core/job/plan.pb.h"
 #include <functional>
 #include <string>
+#include <vector>
 
 namespace oneflow {
 
@@ -26,6 +27,24 @@ struct IntraJobMemSharingUtil {
   static void InferMemBlockId4MemReusedRegst(
       Plan* plan, const std::function<bool(const std::string&, const std::string&)>&
                       IsOpNameDataOrCtrlReachable);
+
+  // Sizes and lifetimes of the regsts of a mem chain, the input of the interval best fit algo.
+  struct RegstIntervals {
+    // regst desc ids, they break the ties of the placement order
+    std::vector<int64_t> ids;
+    std::vector<int64_t> sizes;
+    // indices in the sorted tasks, both ends are included
+    std::vector<int64_t> alloc_indices;
+    std::vector<int64_t> free_indices;
+  };
+  // Peak of the total size of the regsts alive at the same time, no placement can be smaller.
+  static int64_t MemBlockSizeLowerBound(const RegstIntervals& intervals);
+  // Places the regsts in allocation order, each at the tightest gap between the regsts alive at
+  // that time, then tries local_search_rounds reorderings. Sets the offsets and returns the mem
+  // block size.
+  static int64_t PlaceRegstsByIntervalBestFit(const RegstIntervals& intervals,
+                                              int64_t local_search_rounds,
+                                              std::vector<int64_t>* offsets);
 };
 
 }  // namespace oneflow
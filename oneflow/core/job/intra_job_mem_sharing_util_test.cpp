@@ -0,0 +1,91 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <random>
+#include <gtest/gtest.h>
+#include "oneflow/core/job/intra_job_mem_sharing_util.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+using RegstIntervals = IntraJobMemSharingUtil::RegstIntervals;
+
+constexpr int64_t kTaskNum = 64;
+constexpr int64_t kRegstNum = 256;
+
+bool IsLifetimeOverlapped(const RegstIntervals& intervals, int64_t i, int64_t j) {
+  return intervals.alloc_indices.at(i) <= intervals.free_indices.at(j)
+         && intervals.alloc_indices.at(j) <= intervals.free_indices.at(i);
+}
+
+// Sizes are drawn from a few values so that the ties of the placement order are exercised.
+RegstIntervals GenRandomIntervals(std::mt19937* generator) {
+  std::uniform_int_distribution<int64_t> alloc_distribution(0, kTaskNum - 1);
+  std::uniform_int_distribution<int64_t> lifetime_distribution(0, kTaskNum / 4);
+  std::uniform_int_distribution<int64_t> size_distribution(1, 16);
+  RegstIntervals intervals;
+  FOR_RANGE(int64_t, i, 0, kRegstNum) {
+    const int64_t alloc_index = alloc_distribution(*generator);
+    intervals.ids.emplace_back(i);
+    intervals.sizes.emplace_back(size_distribution(*generator) * 512);
+    intervals.alloc_indices.emplace_back(alloc_index);
+    intervals.free_indices.emplace_back(
+        std::min(alloc_index + lifetime_distribution(*generator), kTaskNum - 1));
+  }
+  return intervals;
+}
+
+void CheckPlacement(const RegstIntervals& intervals, const std::vector<int64_t>& offsets,
+                    int64_t mem_block_size) {
+  ASSERT_EQ(offsets.size(), static_cast<size_t>(kRegstNum));
+  FOR_RANGE(int64_t, i, 0, kRegstNum) {
+    ASSERT_GE(offsets.at(i), 0);
+    ASSERT_LE(offsets.at(i) + intervals.sizes.at(i), mem_block_size);
+    FOR_RANGE(int64_t, j, i + 1, kRegstNum) {
+      if (!IsLifetimeOverlapped(intervals, i, j)) { continue; }
+      const bool is_mem_overlapped = offsets.at(i) < offsets.at(j) + intervals.sizes.at(j)
+                                     && offsets.at(j) < offsets.at(i) + intervals.sizes.at(i);
+      ASSERT_FALSE(is_mem_overlapped) << "regsts " << i << " and " << j;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(IntraJobMemSharingUtil, interval_best_fit) {
+  std::mt19937 generator(0);
+  FOR_RANGE(int64_t, test_case, 0, 20) {
+    const RegstIntervals intervals = GenRandomIntervals(&generator);
+    const int64_t lower_bound = IntraJobMemSharingUtil::MemBlockSizeLowerBound(intervals);
+    std::vector<int64_t> offsets;
+    const int64_t mem_block_size =
+        IntraJobMemSharingUtil::PlaceRegstsByIntervalBestFit(intervals, 0, &offsets);
+    CheckPlacement(intervals, offsets, mem_block_size);
+    ASSERT_GE(mem_block_size, lower_bound);
+    // the local search only keeps the orders which shrink the block
+    const int64_t searched_mem_block_size =
+        IntraJobMemSharingUtil::PlaceRegstsByIntervalBestFit(intervals, 32, &offsets);
+    CheckPlacement(intervals, offsets, searched_mem_block_size);
+    ASSERT_GE(searched_mem_block_size, lower_bound);
+    ASSERT_LE(searched_mem_block_size, mem_block_size);
+  }
+}
+
+}  // namespace test
+
+}  // namespace oneflow
@@ -0,0 +1,224 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/plan_cache.h"
+#include <dirent.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#include <cstring>
+#include <fstream>
+#include <tuple>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/control/global_process_ctx.h"
+#include "oneflow/core/job/id_manager.h"
+#include "oneflow/core/job/plan_cache.pb.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/persistence/file_system.h"
+
+// the xxhash bundled with lz4 is built with the LZ4_ prefix
+#define XXH_NAMESPACE LZ4_
+#include <xxhash.h>
+
+namespace oneflow {
+
+namespace {
+
+// bump when the layout of PlanCacheEntry or the meaning of its fields changes
+constexpr int64_t kPlanCacheFormatVersion = 1;
+constexpr char kEntrySuffix[] = ".plan";
+
+// Serialization of a map field is only stable across processes when it is deterministic.
+void AppendDeterministically(const PbMessage& msg, std::string* out) {
+  std::string buf;
+  {
+    google::protobuf::io::StringOutputStream string_stream(&buf);
+    google::protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    coded_stream.SetSerializationDeterministic(true);
+    msg.SerializeToCodedStream(&coded_stream);
+  }
+  *out += std::to_string(buf.size());
+  out->push_back(':');
+  *out += buf;
+}
+
+void AppendString(const std::string& str, std::string* out) {
+  *out += std::to_string(str.size());
+  out->push_back(':');
+  *out += str;
+}
+
+// Identity of the library this function is linked into, any rebuild changes its size or mtime.
+std::string GenLibraryStamp() {
+  std::string stamp = "v" + std::to_string(kPlanCacheFormatVersion);
+  Dl_info info;
+  struct stat st;
+  if (dladdr(reinterpret_cast<void*>(&GenLibraryStamp), &info) != 0 && info.dli_fname != nullptr
+      && stat(info.dli_fname, &st) == 0) {
+    stamp += ";" + std::string(info.dli_fname) + ";" + std::to_string(st.st_size) + ";"
+             + std::to_string(st.st_mtime);
+  } else {
+    // without a library identity entries can not be told apart from those of other builds
+    stamp.clear();
+  }
+  return stamp;
+}
+
+std::string ToHex(uint64_t value) {
+  static const char kDigits[] = "0123456789abcdef";
+  std::string hex(16, '0');
+  for (int i = 15; i >= 0; --i) {
+    hex[i] = kDigits[value & 0xf];
+    value >>= 4;
+  }
+  return hex;
+}
+
+}  // namespace
+
+PlanCache::PlanCache(const std::string& cache_dir, int64_t max_bytes)
+    : cache_dir_(cache_dir), max_bytes_(max_bytes), stamp_(GenLibraryStamp()) {}
+
+PlanCache* PlanCache::Get() {
+  static PlanCache* cache = []() -> PlanCache* {
+    const std::string cache_dir = GetStringFromEnv("ONEFLOW_PLAN_CACHE_DIR", "");
+    if (cache_dir.empty()) { return nullptr; }
+    const int64_t max_bytes = ParseIntegerFromEnv("ONEFLOW_PLAN_CACHE_MAX_BYTES", 4LL << 30);
+    auto* plan_cache = new PlanCache(cache_dir, max_bytes);
+    if (plan_cache->stamp_.empty()) {
+      LOG(WARNING) << "plan cache disabled: failed to identify the oneflow library";
+      delete plan_cache;
+      return nullptr;
+    }
+    LocalFS()->RecursivelyCreateDirIfNotExist(cache_dir);
+    return plan_cache;
+  }();
+  return cache;
+}
+
+std::string PlanCache::GenKey(const Job& job, int64_t job_id,
+                              const HashSet<std::string>& variable_op_names) const {
+  std::string material;
+  AppendString(stamp_, &material);
+  AppendDeterministically(job, &material);
+  AppendString(std::to_string(job_id), &material);
+  std::vector<std::string> sorted_variable_op_names(variable_op_names.begin(),
+                                                    variable_op_names.end());
+  std::sort(sorted_variable_op_names.begin(), sorted_variable_op_names.end());
+  for (const std::string& name : sorted_variable_op_names) { AppendString(name, &material); }
+  AppendDeterministically(Global<ResourceDesc, ForSession>::Get()->resource(), &material);
+  AppendString(std::to_string(GlobalProcessCtx::WorldSize()) + ","
+                   + std::to_string(GlobalProcessCtx::NodeSize()) + ","
+                   + std::to_string(GlobalProcessCtx::NumOfProcessPerNode()),
+               &material);
+  IdState id_state;
+  Global<IDMgr>::Get()->SaveIdState(&id_state);
+  AppendDeterministically(id_state, &material);
+  return ToHex(XXH64(material.data(), material.size(), 0))
+         + ToHex(XXH64(material.data(), material.size(), 1));
+}
+
+std::string PlanCache::EntryPath(const std::string& key) const {
+  return JoinPath(cache_dir_, key + kEntrySuffix);
+}
+
+bool PlanCache::TryLoad(const std::string& key, Job* job, Plan* plan) const {
+  const double start = GetCurTime();
+  const std::string path = EntryPath(key);
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open()) {
+    LOG(INFO) << "plan cache miss, key: " << key;
+    return false;
+  }
+  PlanCacheEntry entry;
+  if (!entry.ParseFromIstream(&in) || entry.stamp() != stamp_ || entry.key() != key) {
+    LOG(WARNING) << "plan cache ignores the stale or corrupted entry " << path;
+    return false;
+  }
+  in.close();
+  // refresh the mtime which orders the eviction
+  utime(path.c_str(), nullptr);
+  Global<IDMgr>::Get()->LoadIdState(entry.id_state());
+  job->Swap(entry.mutable_job());
+  plan->Swap(entry.mutable_plan());
+  LOG(INFO) << "plan cache hit: " << path << ", load time: " << (GetCurTime() - start) / 1e9
+            << " seconds, saved " << entry.compile_seconds() << " seconds of compilation";
+  return true;
+}
+
+void PlanCache::Store(const std::string& key, const Job& job, const Plan& plan,
+                      double compile_seconds) const {
+  PlanCacheEntry entry;
+  entry.set_stamp(stamp_);
+  entry.set_key(key);
+  *entry.mutable_job() = job;
+  *entry.mutable_plan() = plan;
+  Global<IDMgr>::Get()->SaveIdState(entry.mutable_id_state());
+  entry.set_compile_seconds(compile_seconds);
+  const std::string path = EntryPath(key);
+  // write to a private file and rename, readers never see a partial entry
+  const std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open() || !entry.SerializeToOstream(&out) || !out.flush()) {
+      LOG(WARNING) << "plan cache failed to write " << tmp_path;
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    PLOG(WARNING) << "plan cache failed to rename " << tmp_path << " to " << path;
+    std::remove(tmp_path.c_str());
+    return;
+  }
+  LOG(INFO) << "plan cache stored " << entry.ByteSizeLong() << " bytes to " << path;
+  RemoveLeastRecentlyUsedEntries();
+}
+
+void PlanCache::RemoveLeastRecentlyUsedEntries() const {
+  DIR* dir = opendir(cache_dir_.c_str());
+  if (dir == nullptr) { return; }
+  // (mtime, size, path)
+  std::vector<std::tuple<int64_t, int64_t, std::string>> entries;
+  int64_t total_bytes = 0;
+  const size_t suffix_len = std::strlen(kEntrySuffix);
+  while (const dirent* ent = readdir(dir)) {
+    const std::string name = ent->d_name;
+    if (name.size() <= suffix_len
+        || name.compare(name.size() - suffix_len, suffix_len, kEntrySuffix) != 0) {
+      continue;
+    }
+    const std::string path = JoinPath(cache_dir_, name);
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) { continue; }
+    entries.emplace_back(st.st_mtime, st.st_size, path);
+    total_bytes += st.st_size;
+  }
+  closedir(dir);
+  if (total_bytes <= max_bytes_) { return; }
+  std::sort(entries.begin(), entries.end());
+  for (const auto& entry : entries) {
+    if (total_bytes <= max_bytes_) { break; }
+    if (std::remove(std::get<2>(entry).c_str()) == 0) {
+      total_bytes -= std::get<1>(entry);
+      LOG(INFO) << "plan cache evicted " << std::get<2>(entry);
+    }
+  }
+}
+
+}  // namespace oneflow
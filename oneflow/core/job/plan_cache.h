@@ -0,0 +1,63 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_JOB_PLAN_CACHE_H_
+#define ONEFLOW_CORE_JOB_PLAN_CACHE_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/job/job.pb.h"
+#include "oneflow/core/job/plan.pb.h"
+
+namespace oneflow {
+
+// On-disk cache of the plans compiled by NNGraph, enabled by setting ONEFLOW_PLAN_CACHE_DIR.
+//
+// An entry is addressed by a hash of everything the compilation reads: the job, the variable op
+// names, the resource config, the world topology, the IDMgr counters and a stamp of the oneflow
+// library, so a new build never reads the entries of an old one. Environment variables which
+// change the job passes are not part of the key.
+//
+// ONEFLOW_PLAN_CACHE_MAX_BYTES (4GB by default) bounds the size of the directory, the least
+// recently used entries are removed first.
+class PlanCache final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(PlanCache);
+  PlanCache(const std::string& cache_dir, int64_t max_bytes);
+  ~PlanCache() = default;
+
+  // The cache configured by the environment variables, nullptr when it is disabled.
+  static PlanCache* Get();
+
+  // Must be called right before the compilation, the key covers the current IDMgr counters.
+  std::string GenKey(const Job& job, int64_t job_id,
+                     const HashSet<std::string>& variable_op_names) const;
+  // On a hit sets job and plan to the compiled ones and moves the IDMgr counters past the ids of
+  // the plan.
+  bool TryLoad(const std::string& key, Job* job, Plan* plan) const;
+  void Store(const std::string& key, const Job& job, const Plan& plan,
+             double compile_seconds) const;
+
+ private:
+  std::string EntryPath(const std::string& key) const;
+  void RemoveLeastRecentlyUsedEntries() const;
+
+  std::string cache_dir_;
+  int64_t max_bytes_;
+  std::string stamp_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_JOB_PLAN_CACHE_H_
@@ -0,0 +1,231 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <utime.h>
+#include <fstream>
+#include <gtest/gtest.h>
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/control/global_process_ctx.h"
+#include "oneflow/core/job/env_desc.h"
+#include "oneflow/core/job/global_for.h"
+#include "oneflow/core/job/id_manager.h"
+#include "oneflow/core/job/plan_cache.h"
+#include "oneflow/core/job/plan_cache.pb.h"
+#include "oneflow/core/persistence/file_system.h"
+
+#ifdef OF_PLATFORM_POSIX
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+EnvProto GetEnvProto() {
+  EnvProto ret;
+  auto* machine = ret.add_machine();
+  machine->set_id(0);
+  machine->set_addr("127.0.0.1");
+  ret.set_ctrl_port(9527);
+  return ret;
+}
+
+Resource GetResource() {
+  Resource ret;
+  ret.set_machine_num(1);
+  ret.set_cpu_device_num(1);
+  return ret;
+}
+
+void New() {
+  Global<EnvDesc>::New(GetEnvProto());
+  Global<ProcessCtx>::New();
+  Global<ProcessCtx>::Get()->mutable_ctrl_addr()->Add();
+  Global<ProcessCtx>::Get()->set_rank(0);
+  Global<ProcessCtx>::Get()->set_node_size(1);
+  Global<ResourceDesc, ForSession>::New(GetResource(), GlobalProcessCtx::NumOfProcessPerNode());
+  Global<IDMgr>::New();
+}
+
+void Delete() {
+  Global<IDMgr>::Delete();
+  Global<ProcessCtx>::Delete();
+  Global<ResourceDesc, ForSession>::Delete();
+  Global<EnvDesc>::Delete();
+}
+
+std::string TestDirPath(const std::string& name) {
+  std::string current_dir = GetCwd();
+  StringReplace(&current_dir, '\\', '/');
+  std::string path = JoinPath(current_dir, name);
+  if (LocalFS()->IsDirectory(path)) { LocalFS()->RecursivelyDeleteDir(path); }
+  LocalFS()->RecursivelyCreateDir(path);
+  return path;
+}
+
+std::string EntryPath(const std::string& cache_dir, const std::string& key) {
+  return JoinPath(cache_dir, key + ".plan");
+}
+
+Job MakeJob(const std::string& name) {
+  Job job;
+  job.mutable_job_conf()->set_job_name(name);
+  return job;
+}
+
+// Stands in for the compilation, takes its ids from IDMgr like the compiler does.
+Plan Compile(const Job& job) {
+  Plan plan;
+  plan.mutable_block_chunk_list();
+  plan.mutable_collective_boxing_plan();
+  (*plan.mutable_job_confs()->mutable_job_id2job_conf())[0] = job.job_conf();
+  auto* ctrl_regst_desc_id2producer_task_id =
+      plan.mutable_ctrl_regst_desc_info()->mutable_ctrl_regst_desc_id2producer_task_id();
+  FOR_RANGE(int64_t, i, 0, 3) {
+    (*ctrl_regst_desc_id2producer_task_id)[Global<IDMgr>::Get()->NewRegstDescId()] = i;
+  }
+  Global<IDMgr>::Get()->NewMemBlockId();
+  Global<IDMgr>::Get()->NewChunkId();
+  return plan;
+}
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void WriteFile(const std::string& path, const std::string& content) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out << content;
+}
+
+void SetMTime(const std::string& path, time_t mtime) {
+  struct utimbuf times;
+  times.actime = mtime;
+  times.modtime = mtime;
+  ASSERT_EQ(utime(path.c_str(), &times), 0);
+}
+
+}  // namespace
+
+TEST(PlanCache, miss_then_hit) {
+  New();
+  const std::string cache_dir = TestDirPath("/tmp_test_plan_cache_hit");
+  const PlanCache cache(cache_dir, 1 << 20);
+  const Job job = MakeJob("job");
+  const std::string key = cache.GenKey(job, 0, {"variable"});
+  ASSERT_NE(cache.GenKey(job, 0, {"other_variable"}), key);
+  ASSERT_NE(cache.GenKey(job, 1, {"variable"}), key);
+  Job loaded_job;
+  Plan loaded_plan;
+  ASSERT_FALSE(cache.TryLoad(key, &loaded_job, &loaded_plan));
+  const Plan plan = Compile(job);
+  IdState compiled_id_state;
+  Global<IDMgr>::Get()->SaveIdState(&compiled_id_state);
+  cache.Store(key, job, plan, 1.0);
+
+  // the next session starts from the same counters and finds the entry
+  Global<IDMgr>::Delete();
+  Global<IDMgr>::New();
+  ASSERT_EQ(cache.GenKey(job, 0, {"variable"}), key);
+  ASSERT_TRUE(cache.TryLoad(key, &loaded_job, &loaded_plan));
+  ASSERT_EQ(loaded_job.SerializeAsString(), job.SerializeAsString());
+  ASSERT_EQ(loaded_plan.SerializeAsString(), plan.SerializeAsString());
+  IdState loaded_id_state;
+  Global<IDMgr>::Get()->SaveIdState(&loaded_id_state);
+  ASSERT_EQ(loaded_id_state.SerializeAsString(), compiled_id_state.SerializeAsString());
+  // ids generated after the hit do not collide with those of the loaded plan
+  ASSERT_EQ(Global<IDMgr>::Get()->NewRegstDescId(), compiled_id_state.regst_desc_id_count());
+
+  LocalFS()->RecursivelyDeleteDir(cache_dir);
+  Delete();
+}
+
+TEST(PlanCache, ignore_mismatched_entry) {
+  New();
+  const std::string cache_dir = TestDirPath("/tmp_test_plan_cache_mismatch");
+  const PlanCache cache(cache_dir, 1 << 20);
+  const Job job = MakeJob("job");
+  const std::string key = cache.GenKey(job, 0, {});
+  const std::string other_key = cache.GenKey(MakeJob("other_job"), 0, {});
+  ASSERT_NE(other_key, key);
+  cache.Store(key, job, Compile(job), 1.0);
+  Job loaded_job;
+  Plan loaded_plan;
+
+  // an entry found under the path of another key
+  WriteFile(EntryPath(cache_dir, other_key), ReadFile(EntryPath(cache_dir, key)));
+  ASSERT_FALSE(cache.TryLoad(other_key, &loaded_job, &loaded_plan));
+
+  // an entry written by another build
+  PlanCacheEntry entry;
+  ASSERT_TRUE(entry.ParseFromString(ReadFile(EntryPath(cache_dir, key))));
+  entry.set_stamp(entry.stamp() + ";another build");
+  WriteFile(EntryPath(cache_dir, key), entry.SerializeAsString());
+  ASSERT_FALSE(cache.TryLoad(key, &loaded_job, &loaded_plan));
+
+  // a corrupted entry
+  WriteFile(EntryPath(cache_dir, key), "not a plan");
+  ASSERT_FALSE(cache.TryLoad(key, &loaded_job, &loaded_plan));
+
+  LocalFS()->RecursivelyDeleteDir(cache_dir);
+  Delete();
+}
+
+TEST(PlanCache, evict_least_recently_used) {
+  New();
+  const std::string cache_dir = TestDirPath("/tmp_test_plan_cache_eviction");
+  // names of the same length give entries of about the same size
+  const Job job_a = MakeJob(std::string(1000, 'a'));
+  const Job job_b = MakeJob(std::string(1000, 'b'));
+  const Job job_c = MakeJob(std::string(1000, 'c'));
+  std::string key_a;
+  int64_t entry_bytes = 0;
+  {
+    const PlanCache unbounded_cache(cache_dir, 1 << 20);
+    key_a = unbounded_cache.GenKey(job_a, 0, {});
+    unbounded_cache.Store(key_a, job_a, Compile(job_a), 1.0);
+    entry_bytes = LocalFS()->GetFileSize(EntryPath(cache_dir, key_a));
+  }
+  // room for two entries
+  const PlanCache cache(cache_dir, entry_bytes * 5 / 2);
+  const std::string key_b = cache.GenKey(job_b, 0, {});
+  cache.Store(key_b, job_b, Compile(job_b), 1.0);
+  ASSERT_TRUE(LocalFS()->FileExists(EntryPath(cache_dir, key_a)));
+  ASSERT_TRUE(LocalFS()->FileExists(EntryPath(cache_dir, key_b)));
+
+  // a is older than b until it is read again
+  SetMTime(EntryPath(cache_dir, key_a), 1000);
+  SetMTime(EntryPath(cache_dir, key_b), 2000);
+  Job loaded_job;
+  Plan loaded_plan;
+  ASSERT_TRUE(cache.TryLoad(key_a, &loaded_job, &loaded_plan));
+
+  const std::string key_c = cache.GenKey(job_c, 0, {});
+  cache.Store(key_c, job_c, Compile(job_c), 1.0);
+  ASSERT_TRUE(LocalFS()->FileExists(EntryPath(cache_dir, key_a)));
+  ASSERT_FALSE(LocalFS()->FileExists(EntryPath(cache_dir, key_b)));
+  ASSERT_TRUE(LocalFS()->FileExists(EntryPath(cache_dir, key_c)));
+
+  LocalFS()->RecursivelyDeleteDir(cache_dir);
+  Delete();
+}
+
+}  // namespace test
+
+}  // namespace oneflow
+
+#endif  // OF_PLATFORM_POSIX
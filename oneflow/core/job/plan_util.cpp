@@ -717,6 +717,70 @@ void PlanUtil::DumpCtrlRegstInfoToPlan(Plan* plan) {
   }
 }
 
+void PlanUtil::SplitPlan4Ranks(Plan* plan, const HashSet<std::string>& variable_op_names,
+                               std::vector<Plan>* rank_plans) {
+  const int64_t rank_num = rank_plans->size();
+  std::vector<HashSet<int64_t>> rank2regst_desc_ids(rank_num);
+  std::vector<HashMap<int64_t, HashSet<std::string>>> rank2job_id2op_attribute_refs(rank_num);
+  for (TaskProto& task : *plan->mutable_task()) {
+    const int64_t rank = task.machine_id();
+    CHECK_GE(rank, 0);
+    CHECK_LT(rank, rank_num);
+    HashSet<int64_t>* regst_desc_ids = &rank2regst_desc_ids.at(rank);
+    for (const auto& pair : task.produced_regst_desc()) {
+      regst_desc_ids->insert(pair.second.regst_desc_id());
+    }
+    for (const auto& pair : task.consumed_regst_desc_id()) {
+      regst_desc_ids->insert(pair.second.regst_desc_id().begin(),
+                             pair.second.regst_desc_id().end());
+    }
+    if (task.exec_sequence().exec_node_size() == 1
+        && task.exec_sequence().exec_node(0).kernel_conf().has_op_attribute_ref()) {
+      rank2job_id2op_attribute_refs.at(rank)[task.job_id()].insert(
+          task.exec_sequence().exec_node(0).kernel_conf().op_attribute_ref());
+    }
+    *rank_plans->at(rank).mutable_task()->Add() = std::move(task);
+  }
+  plan->clear_task();
+  for (const auto& mem_block : plan->block_chunk_list().mem_block()) {
+    *rank_plans->at(mem_block.machine_id()).mutable_block_chunk_list()->add_mem_block() =
+        mem_block;
+  }
+  for (const auto& chunk : plan->block_chunk_list().chunk()) {
+    *rank_plans->at(chunk.machine_id()).mutable_block_chunk_list()->add_chunk() = chunk;
+  }
+  FOR_RANGE(int64_t, rank, 0, rank_num) {
+    Plan* rank_plan = &rank_plans->at(rank);
+    // a rank without memory still sets the required field
+    rank_plan->mutable_block_chunk_list();
+    *rank_plan->mutable_job_confs() = plan->job_confs();
+    // the collective boxing coordinators of all ranks schedule the same request set
+    *rank_plan->mutable_collective_boxing_plan() = plan->collective_boxing_plan();
+    const HashSet<int64_t>& regst_desc_ids = rank2regst_desc_ids.at(rank);
+    auto* ctrl_regst_desc_id2producer_task_id =
+        rank_plan->mutable_ctrl_regst_desc_info()->mutable_ctrl_regst_desc_id2producer_task_id();
+    for (const auto& pair : plan->ctrl_regst_desc_info().ctrl_regst_desc_id2producer_task_id()) {
+      if (regst_desc_ids.find(pair.first) != regst_desc_ids.end()) {
+        ctrl_regst_desc_id2producer_task_id->insert(pair);
+      }
+    }
+    const auto& job_id2op_attribute_refs = rank2job_id2op_attribute_refs.at(rank);
+    for (const auto& job_id7table : plan->job_id2op_attribute_ref_table()) {
+      auto refs_it = job_id2op_attribute_refs.find(job_id7table.first);
+      auto* op_name2op_attribute =
+          (*rank_plan->mutable_job_id2op_attribute_ref_table())[job_id7table.first]
+              .mutable_op_name2op_attribute();
+      for (const auto& pair : job_id7table.second.op_name2op_attribute()) {
+        if (variable_op_names.find(pair.first) != variable_op_names.end()
+            || (refs_it != job_id2op_attribute_refs.end()
+                && refs_it->second.find(pair.first) != refs_it->second.end())) {
+          op_name2op_attribute->insert(pair);
+        }
+      }
+    }
+  }
+}
+
 namespace {
 
 bool IsCollectiveBoxingTaskType(TaskType task_type) {
@@ -40,6 +40,11 @@ struct PlanUtil {
   static void GenCollectiveBoxingPlan(Job* job, Plan* plan);
   static void GenRegisterHint(Plan* plan);
   static void PlanMemoryLog(Plan* plan, const std::string& plan_name);
+  // Moves the tasks, mem blocks and chunks of every rank into rank_plans, which must have one
+  // plan per rank. A rank plan keeps only the ctrl regst info and the op attributes its own tasks
+  // refer to, plus the op attributes of the variables which every rank reads.
+  static void SplitPlan4Ranks(Plan* plan, const HashSet<std::string>& variable_op_names,
+                              std::vector<Plan>* rank_plans);
   static const oneflow::OpAttribute& GetOpAttribute(const Plan* plan, int64_t job_id,
                                                     const oneflow::KernelConf& kernel_conf);
   // NOTE(chengcheng): recovery op_attr
@@ -0,0 +1,139 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <set>
+#include <gtest/gtest.h>
+#include "oneflow/core/job/plan_util.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+constexpr int64_t kJobId = 0;
+constexpr int64_t kRankNum = 2;
+
+TaskProto* AddTask(Plan* plan, int64_t machine_id, int64_t task_id, const std::string& op_name,
+                   int64_t produced_regst_desc_id) {
+  TaskProto* task = plan->add_task();
+  task->set_machine_id(machine_id);
+  task->set_task_id(task_id);
+  task->set_job_id(kJobId);
+  task->mutable_exec_sequence()->add_exec_node()->mutable_kernel_conf()->set_op_attribute_ref(
+      op_name);
+  RegstDescProto* regst = &(*task->mutable_produced_regst_desc())["out"];
+  regst->set_regst_desc_id(produced_regst_desc_id);
+  regst->set_producer_task_id(task_id);
+  (*plan->mutable_ctrl_regst_desc_info()
+        ->mutable_ctrl_regst_desc_id2producer_task_id())[produced_regst_desc_id] = task_id;
+  return task;
+}
+
+void AddConsumedRegst(TaskProto* task, int64_t regst_desc_id) {
+  (*task->mutable_consumed_regst_desc_id())["in"].add_regst_desc_id(regst_desc_id);
+}
+
+void AddOpAttribute(Plan* plan, const std::string& op_name) {
+  OpAttribute* op_attribute =
+      &(*(*plan->mutable_job_id2op_attribute_ref_table())[kJobId].mutable_op_name2op_attribute())
+          [op_name];
+  op_attribute->mutable_op_conf()->set_name(op_name);
+}
+
+// rank 0: var -> a, rank 1: b -> c, b consumes the output of a across the ranks
+Plan GenTwoRankPlan() {
+  Plan plan;
+  AddTask(&plan, 0, 1, "var", 10);
+  AddConsumedRegst(AddTask(&plan, 0, 2, "a", 20), 10);
+  AddConsumedRegst(AddTask(&plan, 1, 3, "b", 30), 20);
+  AddConsumedRegst(AddTask(&plan, 1, 4, "c", 40), 30);
+  // a ctrl regst no task refers to
+  (*plan.mutable_ctrl_regst_desc_info()->mutable_ctrl_regst_desc_id2producer_task_id())[99] = 1;
+  for (const std::string& op_name : {"var", "a", "b", "c", "unused"}) {
+    AddOpAttribute(&plan, op_name);
+  }
+  const std::vector<std::pair<int64_t, int64_t>> mem_block_id7machine_ids = {
+      {100, 0}, {101, 1}, {102, 0}};
+  for (const auto& pair : mem_block_id7machine_ids) {
+    MemBlockProto* mem_block = plan.mutable_block_chunk_list()->add_mem_block();
+    mem_block->set_mem_block_id(pair.first);
+    mem_block->set_machine_id(pair.second);
+  }
+  const std::vector<std::pair<int64_t, int64_t>> chunk_id7machine_ids = {{200, 1}, {201, 0}};
+  for (const auto& pair : chunk_id7machine_ids) {
+    ChunkProto* chunk = plan.mutable_block_chunk_list()->add_chunk();
+    chunk->set_chunk_id(pair.first);
+    chunk->set_machine_id(pair.second);
+  }
+  (*plan.mutable_job_confs()->mutable_job_id2job_conf())[kJobId].set_job_name("test_job");
+  return plan;
+}
+
+template<typename T, typename GetIdT>
+std::set<int64_t> Ids(const T& items, const GetIdT& GetId) {
+  std::set<int64_t> ids;
+  for (const auto& item : items) { ids.insert(GetId(item)); }
+  return ids;
+}
+
+}  // namespace
+
+TEST(PlanUtil, split_plan_4_ranks) {
+  Plan plan = GenTwoRankPlan();
+  std::vector<Plan> rank_plans(kRankNum);
+  PlanUtil::SplitPlan4Ranks(&plan, {"var"}, &rank_plans);
+  ASSERT_EQ(plan.task_size(), 0);
+
+  const std::vector<std::set<int64_t>> rank2task_ids = {{1, 2}, {3, 4}};
+  const std::vector<std::set<int64_t>> rank2mem_block_ids = {{100, 102}, {101}};
+  const std::vector<std::set<int64_t>> rank2chunk_ids = {{201}, {200}};
+  // the produced and consumed regsts of the tasks of the rank
+  const std::vector<std::set<int64_t>> rank2ctrl_regst_desc_ids = {{10, 20}, {20, 30, 40}};
+  // variables are kept on every rank, the other ops only on the ranks of their tasks
+  const std::vector<std::set<std::string>> rank2op_names = {{"var", "a"}, {"var", "b", "c"}};
+  FOR_RANGE(int64_t, rank, 0, kRankNum) {
+    const Plan& rank_plan = rank_plans.at(rank);
+    ASSERT_EQ(Ids(rank_plan.task(), [](const TaskProto& task) { return task.task_id(); }),
+              rank2task_ids.at(rank));
+    for (const TaskProto& task : rank_plan.task()) { ASSERT_EQ(task.machine_id(), rank); }
+    ASSERT_EQ(Ids(rank_plan.block_chunk_list().mem_block(),
+                  [](const MemBlockProto& mem_block) { return mem_block.mem_block_id(); }),
+              rank2mem_block_ids.at(rank));
+    ASSERT_EQ(Ids(rank_plan.block_chunk_list().chunk(),
+                  [](const ChunkProto& chunk) { return chunk.chunk_id(); }),
+              rank2chunk_ids.at(rank));
+    std::set<int64_t> ctrl_regst_desc_ids;
+    for (const auto& pair :
+         rank_plan.ctrl_regst_desc_info().ctrl_regst_desc_id2producer_task_id()) {
+      ASSERT_EQ(pair.second,
+                plan.ctrl_regst_desc_info().ctrl_regst_desc_id2producer_task_id().at(pair.first));
+      ctrl_regst_desc_ids.insert(pair.first);
+    }
+    ASSERT_EQ(ctrl_regst_desc_ids, rank2ctrl_regst_desc_ids.at(rank));
+    std::set<std::string> op_names;
+    for (const auto& pair :
+         rank_plan.job_id2op_attribute_ref_table().at(kJobId).op_name2op_attribute()) {
+      ASSERT_EQ(pair.second.op_conf().name(), pair.first);
+      op_names.insert(pair.first);
+    }
+    ASSERT_EQ(op_names, rank2op_names.at(rank));
+    ASSERT_EQ(rank_plan.job_confs().job_id2job_conf().at(kJobId).job_name(), "test_job");
+  }
+}
+
+}  // namespace test
+
+}  // namespace oneflow
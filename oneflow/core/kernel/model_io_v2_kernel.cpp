@@ -197,6 +197,49 @@ class AutoSyncBlobAccessor<DeviceType::kCPU> final {
   Blob* underlying_;
 };
 
+// Host blobs of the pending reads stay alive until Flush, so they are flushed at this many bytes.
+constexpr int64_t kMaxPendingSnapshotReadBytes = 512 * 1024 * 1024;
+
+// Collects the snapshot reads of variables and loads them in parallel by
+// SnapshotReader::BatchRead. The variables are synced to device when they are flushed.
+template<DeviceType device_type>
+class BatchedSnapshotReader final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(BatchedSnapshotReader);
+  explicit BatchedSnapshotReader(ep::Stream* stream) : stream_(stream), pending_bytes_(0) {}
+  ~BatchedSnapshotReader() = default;
+
+  void Add(const std::string& snapshot_path, const std::string& key,
+           const Shape& logical_blob_shape, const TensorSliceView& slice, Blob* blob) {
+    if (!requests_.empty()
+        && (snapshot_path != snapshot_path_ || pending_bytes_ >= kMaxPendingSnapshotReadBytes)) {
+      Flush();
+    }
+    snapshot_path_ = snapshot_path;
+    accessors_.emplace_back(new AutoSyncBlobAccessor<device_type>(stream_, blob, false, true));
+    Blob* host_blob = accessors_.back()->host_blob();
+    CHECK_EQ(ShapeView(slice.shape()), host_blob->shape());
+    requests_.emplace_back(SnapshotReadRequest{key, logical_blob_shape, host_blob->data_type(),
+                                               slice, host_blob->mut_dptr<char>()});
+    pending_bytes_ += host_blob->ByteSizeOfBlobBody();
+  }
+
+  void Flush() {
+    if (requests_.empty()) { return; }
+    SnapshotReader(snapshot_path_).BatchRead(requests_);
+    requests_.clear();
+    accessors_.clear();
+    pending_bytes_ = 0;
+  }
+
+ private:
+  ep::Stream* stream_;
+  std::string snapshot_path_;
+  std::vector<SnapshotReadRequest> requests_;
+  std::vector<std::unique_ptr<AutoSyncBlobAccessor<device_type>>> accessors_;
+  int64_t pending_bytes_;
+};
+
 }  // namespace
 
 template<DeviceType device_type>
@@ -249,12 +292,13 @@ class ModelInitV2Kernel final : public Kernel {
   void ForwardDataContent(KernelContext* ctx) const override {
     const ModelInitV2OpConf& conf = this->op_conf().model_init_v2_conf();
 
+    BatchedSnapshotReader<device_type> snapshot_reader(ctx->stream());
     FOR_RANGE(int64_t, i, 0, conf.variable_op_name_size()) {
       Blob* ref = ctx->BnInOp2Blob(GenRepeatedBn("ref", i));
       const DataType data_type = ref->data_type();
       const VariableOpConf& original_variable_conf = conf.original_variable_conf(i);
-      AutoSyncBlobAccessor<device_type> ref_accessor(ctx->stream(), ref, false, true);
       if (original_variable_conf.has_initializer()) {
+        AutoSyncBlobAccessor<device_type> ref_accessor(ctx->stream(), ref, false, true);
         std::mt19937 random_seed_gen(seeds_.at(i));
         InitializeWithConfUtil::SwitchInitializeWithConf(
             SwitchCase(data_type), original_variable_conf.initializer(), random_seed_gen(),
@@ -265,12 +309,13 @@ class ModelInitV2Kernel final : public Kernel {
             GenLogicalBlobName(conf.variable_op_name(i), original_variable_conf.out());
         const std::string key = snapshot_conf.has_key() ? snapshot_conf.key() : var_lbn;
         const Shape logical_blob_shape(original_variable_conf.shape());
-        const SnapshotReader reader(snapshot_conf.path());
-        reader.Read(key, logical_blob_shape, tensor_slice_views_.at(i), ref_accessor.host_blob());
+        snapshot_reader.Add(snapshot_conf.path(), key, logical_blob_shape,
+                            tensor_slice_views_.at(i), ref);
       } else {
         UNIMPLEMENTED();
       }
     }
+    snapshot_reader.Flush();
   }
 
   std::vector<int64_t> seeds_;
@@ -310,16 +355,17 @@ class ModelLoadV2Kernel final : public Kernel {
     const ModelLoadV2OpConf& conf = this->op_conf().model_load_v2_conf();
     const Blob* path = ctx->BnInOp2Blob("path");
     const std::string snapshot_path = SyncReadStringFromBlob<device_type>(ctx->stream(), path);
-    SnapshotReader reader(snapshot_path);
+    BatchedSnapshotReader<device_type> snapshot_reader(ctx->stream());
     FOR_RANGE(int64_t, i, 0, conf.variable_op_name_size()) {
       Blob* ref = ctx->BnInOp2Blob(GenRepeatedBn("ref", i));
       const VariableOpConf& original_variable_conf = conf.original_variable_conf(i);
       const Shape logical_blob_shape(original_variable_conf.shape());
       const std::string& var_lbn =
           GenLogicalBlobName(conf.variable_op_name(i), original_variable_conf.out());
-      AutoSyncBlobAccessor<device_type> ref_accessor(ctx->stream(), ref, false, true);
-      reader.Read(var_lbn, logical_blob_shape, tensor_slice_views_.at(i), ref_accessor.host_blob());
+      snapshot_reader.Add(snapshot_path, var_lbn, logical_blob_shape, tensor_slice_views_.at(i),
+                          ref);
     }
+    snapshot_reader.Flush();
   }
   std::vector<TensorSliceView> tensor_slice_views_;
 };
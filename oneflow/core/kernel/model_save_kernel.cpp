@@ -34,7 +34,9 @@ void ModelSaveKernel::ForwardDataContent(KernelContext* ctx) const {
   const ModelSaveOpConf& conf = this->op_conf().model_save_conf();
   const Blob* path_blob = ctx->BnInOp2Blob("path");
   const std::string path(path_blob->dptr<char>(), path_blob->shape_view().elem_cnt());
-  SnapshotWriter writer(path);
+  // The kernel returns once the variables are copied, see AsyncSnapshotWriter
+  static const bool async_write = ParseBooleanFromEnv("ONEFLOW_MODEL_SAVE_ASYNC_WRITE", false);
+  SnapshotWriter writer(path, async_write);
   FOR_RANGE(int64_t, i, 0, conf.in_size()) {
     const Blob* in_i = ctx->BnInOp2Blob(GenRepeatedBn("in", i));
     writer.Write(conf.key(i), in_i);
@@ -17,26 +17,300 @@ limitations under the License.
 #include "oneflow/core/common/preprocessor.h"
 #include "oneflow/core/ndarray/ndarray_reduce_impl.h"
 #include "oneflow/core/ndarray/binary_func.h"
+#include "oneflow/core/ep/cpu/cpu_parallel.h"
 
 namespace oneflow {
 
-#define SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(struct_name)                                        \
-  template<typename T, template<typename> class binary_func>                                   \
-  struct struct_name<DeviceType::kCPU, T, binary_func> final {                                 \
-    using RetT = typename BinaryFuncTrait<binary_func, T>::return_type;                        \
-    static bool Matched(const XpuVarNdarray<RetT>& y, const XpuVarNdarray<const T>& x) {       \
-      return false;                                                                            \
-    }                                                                                          \
-    static void Reduce(ep::Stream* stream, const XpuVarNdarray<RetT>& y,                       \
-                       const XpuVarNdarray<const T>& x, const XpuVarNdarray<T>& tmp_storage) { \
-      UNIMPLEMENTED();                                                                         \
-    }                                                                                          \
-  }
-SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayScalarReduce);
-SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayMatrixRowReduce);
-SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayMatrixColReduce);
-SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayXYZCubeXZReduce);
-#undef SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL
+namespace {
+
+// Every parallel task reduces at least about kReduceChunkElemNum elements.
+constexpr int64_t kReduceChunkElemNum = 32768;
+// Number of kept outputs a task accumulates at once, bounds the accumulators of a task.
+constexpr int64_t kKeepBlockSize = 512;
+// Contiguous float sums are split into halves down to this size, see ReduceContiguous.
+constexpr int64_t kPairwiseBlockSize = 128;
+constexpr int64_t kReduceLaneNum = 8;
+
+inline int64_t CeilDiv(int64_t n, int64_t d) { return (n + d - 1) / d; }
+
+template<template<typename> class binary_func>
+struct IsSumFunc : std::false_type {};
+
+template<>
+struct IsSumFunc<BinaryFuncSum> : std::true_type {};
+
+// float16 is accumulated in float, other types in the return type of binary_func.
+template<typename T, typename RetT>
+struct CpuReduceAccType {
+  using type = RetT;
+};
+
+template<>
+struct CpuReduceAccType<float16, float16> {
+  using type = float;
+};
+
+template<typename T, template<typename> class binary_func>
+struct CpuReduceUtil final {
+  using RetT = typename BinaryFuncTrait<binary_func, T>::return_type;
+  using AccT = typename CpuReduceAccType<T, RetT>::type;
+  // Floating point sums are pairwise within contiguous ranges and Kahan compensated across them.
+  static constexpr bool kCompensated =
+      IsSumFunc<binary_func>::value && std::is_floating_point<AccT>::value;
+  using Compensated = std::integral_constant<bool, kCompensated>;
+
+  static AccT Unit() { return UnitOfBinaryFunc<AccT, binary_func>::Val(); }
+  static AccT Combine(AccT lhs, AccT rhs) { return binary_func<AccT>::Invoke(lhs, rhs); }
+
+  // Independent lanes break the dependency chain of the accumulator so that the loop can be
+  // vectorized, floating point sums additionally halve the range until it is short, which bounds
+  // the rounding error by O(eps * log(n)) instead of O(eps * n).
+  template<typename X>
+  static AccT ReduceContiguous(const X* x, int64_t n) {
+    if (kCompensated && n > kPairwiseBlockSize) {
+      const int64_t half = (n / 2) / kReduceLaneNum * kReduceLaneNum;
+      return Combine(ReduceContiguous(x, half), ReduceContiguous(x + half, n - half));
+    }
+    AccT lanes[kReduceLaneNum];
+    for (int64_t j = 0; j < kReduceLaneNum; ++j) { lanes[j] = Unit(); }
+    int64_t i = 0;
+    for (; i + kReduceLaneNum <= n; i += kReduceLaneNum) {
+      for (int64_t j = 0; j < kReduceLaneNum; ++j) {
+        lanes[j] = Combine(lanes[j], static_cast<AccT>(x[i + j]));
+      }
+    }
+    for (; i < n; ++i) { lanes[0] = Combine(lanes[0], static_cast<AccT>(x[i])); }
+    for (int64_t width = kReduceLaneNum / 2; width > 0; width /= 2) {
+      for (int64_t j = 0; j < width; ++j) { lanes[j] = Combine(lanes[j], lanes[j + width]); }
+    }
+    return lanes[0];
+  }
+
+  static void InitAccumulators(int64_t n, AccT* acc, AccT* compensation) {
+    std::fill(acc, acc + n, Unit());
+    std::fill(compensation, compensation + n, AccT(0));
+  }
+
+  // acc[i] = binary_func(acc[i], value[i])
+  template<typename X>
+  static void Accumulate(const X* value, int64_t n, AccT* acc, AccT* compensation) {
+    Accumulate(value, n, acc, compensation, Compensated());
+  }
+
+ private:
+  template<typename X>
+  static void Accumulate(const X* value, int64_t n, AccT* acc, AccT* compensation,
+                         std::false_type) {
+    for (int64_t i = 0; i < n; ++i) { acc[i] = Combine(acc[i], static_cast<AccT>(value[i])); }
+  }
+
+  template<typename X>
+  static void Accumulate(const X* value, int64_t n, AccT* acc, AccT* compensation,
+                         std::true_type) {
+    for (int64_t i = 0; i < n; ++i) {
+      const AccT y = static_cast<AccT>(value[i]) - compensation[i];
+      const AccT t = acc[i] + y;
+      compensation[i] = (t - acc[i]) - y;
+      acc[i] = t;
+    }
+  }
+};
+
+// Reduces a problem with reduce_num reduced indices and keep_num kept outputs. The kept outputs
+// are split into blocks and, when there are not enough blocks to occupy the threads, the reduced
+// indices are split into chunks whose partial results are combined in the end.
+// ReduceBlock(reduce_begin, reduce_end, keep_begin, keep_end, acc) writes the reduced values of
+// outputs [keep_begin, keep_end) to acc.
+template<typename T, template<typename> class binary_func, typename ReduceBlockT>
+void CpuBlockedReduce(int64_t reduce_num, int64_t keep_num, int64_t elem_num,
+                      typename CpuReduceUtil<T, binary_func>::RetT* y,
+                      const ReduceBlockT& ReduceBlock) {
+  using Util = CpuReduceUtil<T, binary_func>;
+  using AccT = typename Util::AccT;
+  if (keep_num == 0) { return; }
+  if (reduce_num == 0) {
+    // reducing an empty axis gives the unit of binary_func
+    std::fill(y, y + keep_num, static_cast<typename Util::RetT>(Util::Unit()));
+    return;
+  }
+  const int64_t block_size = std::min(keep_num, kKeepBlockSize);
+  const int64_t block_num = CeilDiv(keep_num, block_size);
+  const int64_t block_elem_num = std::max<int64_t>(elem_num / block_num, 1);
+  const int64_t min_chunk_size =
+      std::max<int64_t>(kReduceChunkElemNum / std::max<int64_t>(block_elem_num / reduce_num, 1), 1);
+  const int64_t max_chunk_num =
+      std::max<int64_t>(4 * static_cast<int64_t>(ep::CpuParallelNum()) / block_num, 1);
+  int64_t chunk_num = std::min(CeilDiv(reduce_num, min_chunk_size), max_chunk_num);
+  const int64_t chunk_size = CeilDiv(reduce_num, chunk_num);
+  chunk_num = CeilDiv(reduce_num, chunk_size);
+  if (chunk_num == 1) {
+    const size_t grain_size = std::max<int64_t>(kReduceChunkElemNum / block_elem_num, 1);
+    ep::CpuParallelFor(block_num, grain_size, [&](size_t begin, size_t end) {
+      AccT acc[kKeepBlockSize];
+      for (int64_t block_id = begin; block_id < static_cast<int64_t>(end); ++block_id) {
+        const int64_t keep_begin = block_id * block_size;
+        const int64_t keep_end = std::min(keep_begin + block_size, keep_num);
+        ReduceBlock(0, reduce_num, keep_begin, keep_end, acc);
+        for (int64_t i = keep_begin; i < keep_end; ++i) {
+          y[i] = static_cast<typename Util::RetT>(acc[i - keep_begin]);
+        }
+      }
+    });
+    return;
+  }
+  // not a std::vector, which has no data() for bool
+  std::unique_ptr<AccT[]> partials(new AccT[chunk_num * keep_num]);
+  ep::CpuParallelFor(chunk_num * block_num, 1, [&](size_t begin, size_t end) {
+    for (int64_t task_id = begin; task_id < static_cast<int64_t>(end); ++task_id) {
+      const int64_t chunk_id = task_id / block_num;
+      const int64_t keep_begin = (task_id % block_num) * block_size;
+      const int64_t keep_end = std::min(keep_begin + block_size, keep_num);
+      const int64_t reduce_begin = chunk_id * chunk_size;
+      const int64_t reduce_end = std::min(reduce_begin + chunk_size, reduce_num);
+      ReduceBlock(reduce_begin, reduce_end, keep_begin, keep_end,
+                  partials.get() + chunk_id * keep_num + keep_begin);
+    }
+  });
+  const size_t grain_size = std::max<int64_t>(kReduceChunkElemNum / chunk_num, 1);
+  ep::CpuParallelFor(keep_num, grain_size, [&](size_t begin, size_t end) {
+    AccT acc[kKeepBlockSize];
+    AccT compensation[kKeepBlockSize];
+    for (int64_t keep_begin = begin; keep_begin < static_cast<int64_t>(end);
+         keep_begin += kKeepBlockSize) {
+      const int64_t n = std::min<int64_t>(kKeepBlockSize, end - keep_begin);
+      Util::InitAccumulators(n, acc, compensation);
+      for (int64_t chunk_id = 0; chunk_id < chunk_num; ++chunk_id) {
+        Util::Accumulate(partials.get() + chunk_id * keep_num + keep_begin, n, acc, compensation);
+      }
+      for (int64_t i = 0; i < n; ++i) {
+        y[keep_begin + i] = static_cast<typename Util::RetT>(acc[i]);
+      }
+    }
+  });
+}
+
+// [rows, cols] -> [rows, 1], the reduced axis is contiguous.
+template<typename T, template<typename> class binary_func>
+void CpuMatrixRowReduce(int64_t rows, int64_t cols, const T* x,
+                        typename CpuReduceUtil<T, binary_func>::RetT* y) {
+  using Util = CpuReduceUtil<T, binary_func>;
+  CpuBlockedReduce<T, binary_func>(
+      cols, rows, rows * cols, y,
+      [&](int64_t col_begin, int64_t col_end, int64_t row_begin, int64_t row_end,
+          typename Util::AccT* acc) {
+        for (int64_t row = row_begin; row < row_end; ++row) {
+          acc[row - row_begin] =
+              Util::ReduceContiguous(x + row * cols + col_begin, col_end - col_begin);
+        }
+      });
+}
+
+// [rows, cols] -> [1, cols], a task streams through the rows of a block of columns.
+template<typename T, template<typename> class binary_func>
+void CpuMatrixColReduce(int64_t rows, int64_t cols, const T* x,
+                        typename CpuReduceUtil<T, binary_func>::RetT* y) {
+  using Util = CpuReduceUtil<T, binary_func>;
+  CpuBlockedReduce<T, binary_func>(
+      rows, cols, rows * cols, y,
+      [&](int64_t row_begin, int64_t row_end, int64_t col_begin, int64_t col_end,
+          typename Util::AccT* acc) {
+        typename Util::AccT compensation[kKeepBlockSize];
+        const int64_t n = col_end - col_begin;
+        Util::InitAccumulators(n, acc, compensation);
+        for (int64_t row = row_begin; row < row_end; ++row) {
+          Util::Accumulate(x + row * cols + col_begin, n, acc, compensation);
+        }
+      });
+}
+
+// [dim_x, dim_y, dim_z] -> [1, dim_y, 1], each z run is reduced contiguously and accumulated to
+// its y output, a task streams through the [y, z] slabs of a block of y.
+template<typename T, template<typename> class binary_func>
+void CpuXYZCubeXZReduce(int64_t dim_x, int64_t dim_y, int64_t dim_z, const T* x,
+                        typename CpuReduceUtil<T, binary_func>::RetT* y) {
+  using Util = CpuReduceUtil<T, binary_func>;
+  using AccT = typename Util::AccT;
+  CpuBlockedReduce<T, binary_func>(
+      dim_x, dim_y, dim_x * dim_y * dim_z, y,
+      [&](int64_t x_begin, int64_t x_end, int64_t y_begin, int64_t y_end, AccT* acc) {
+        AccT compensation[kKeepBlockSize];
+        AccT z_reduced[kKeepBlockSize];
+        const int64_t n = y_end - y_begin;
+        Util::InitAccumulators(n, acc, compensation);
+        for (int64_t i = x_begin; i < x_end; ++i) {
+          const T* slab = x + (i * dim_y + y_begin) * dim_z;
+          for (int64_t j = 0; j < n; ++j) {
+            z_reduced[j] = Util::ReduceContiguous(slab + j * dim_z, dim_z);
+          }
+          Util::Accumulate(z_reduced, n, acc, compensation);
+        }
+      });
+}
+
+}  // namespace
+
+template<typename T, template<typename> class binary_func>
+struct NdarrayScalarReduce<DeviceType::kCPU, T, binary_func> final {
+  using RetT = typename BinaryFuncTrait<binary_func, T>::return_type;
+  static bool Matched(const XpuVarNdarray<RetT>& y, const XpuVarNdarray<const T>& x) {
+    return y.shape().ElemNum() == 1;
+  }
+
+  static void Reduce(ep::Stream* stream, const XpuVarNdarray<RetT>& y,
+                     const XpuVarNdarray<const T>& x, const XpuVarNdarray<T>& tmp_storage) {
+    CHECK(Matched(y, x));
+    CpuMatrixRowReduce<T, binary_func>(1, x.shape().ElemNum(), x.ptr(), y.ptr());
+  }
+};
+
+template<typename T, template<typename> class binary_func>
+struct NdarrayMatrixRowReduce<DeviceType::kCPU, T, binary_func> final {
+  using RetT = typename BinaryFuncTrait<binary_func, T>::return_type;
+  static bool Matched(const XpuVarNdarray<RetT>& y, const XpuVarNdarray<const T>& x) {
+    if (x.shape().NumAxes() != 2) { return false; }
+    if (y.shape().NumAxes() != 2) { return false; }
+    return x.shape().At(0) == y.shape().At(0) && y.shape().At(1) == 1;
+  }
+
+  static void Reduce(ep::Stream* stream, const XpuVarNdarray<RetT>& y,
+                     const XpuVarNdarray<const T>& x, const XpuVarNdarray<T>& tmp_storage) {
+    CHECK(Matched(y, x));
+    CpuMatrixRowReduce<T, binary_func>(x.shape().At(0), x.shape().At(1), x.ptr(), y.ptr());
+  }
+};
+
+template<typename T, template<typename> class binary_func>
+struct NdarrayMatrixColReduce<DeviceType::kCPU, T, binary_func> final {
+  using RetT = typename BinaryFuncTrait<binary_func, T>::return_type;
+  static bool Matched(const XpuVarNdarray<RetT>& y, const XpuVarNdarray<const T>& x) {
+    if (x.shape().NumAxes() != 2) { return false; }
+    if (y.shape().NumAxes() != 2) { return false; }
+    return y.shape().At(0) == 1 && x.shape().At(1) == y.shape().At(1);
+  }
+
+  static void Reduce(ep::Stream* stream, const XpuVarNdarray<RetT>& y,
+                     const XpuVarNdarray<const T>& x, const XpuVarNdarray<T>& tmp_storage) {
+    CHECK(Matched(y, x));
+    CpuMatrixColReduce<T, binary_func>(x.shape().At(0), x.shape().At(1), x.ptr(), y.ptr());
+  }
+};
+
+template<typename T, template<typename> class binary_func>
+struct NdarrayXYZCubeXZReduce<DeviceType::kCPU, T, binary_func> final {
+  using RetT = typename BinaryFuncTrait<binary_func, T>::return_type;
+  static bool Matched(const XpuVarNdarray<RetT>& y, const XpuVarNdarray<const T>& x) {
+    if (x.shape().NumAxes() != 3) { return false; }
+    if (y.shape().NumAxes() != 3) { return false; }
+    return y.shape().At(0) == 1 && x.shape().At(1) == y.shape().At(1) && y.shape().At(2) == 1;
+  }
+
+  static void Reduce(ep::Stream* stream, const XpuVarNdarray<RetT>& y,
+                     const XpuVarNdarray<const T>& x, const XpuVarNdarray<T>& tmp_storage) {
+    CHECK(Matched(y, x));
+    CpuXYZCubeXZReduce<T, binary_func>(x.shape().At(0), x.shape().At(1), x.shape().At(2), x.ptr(),
+                                       y.ptr());
+  }
+};
 
 #define INSTANTIATE_NDARRAY_REDUCE_IMPL(dtype, binary_func)                                       \
   template struct NdarrayScalarReduce<DeviceType::kCPU, OF_PP_PAIR_FIRST(dtype), binary_func>;    \
@@ -0,0 +1,152 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <chrono>
+#include <random>
+#include <gtest/gtest.h>
+#include "oneflow/core/ndarray/ndarray_reduce.h"
+#include "oneflow/core/thread/thread_pool.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+struct ReduceCase {
+  Shape x_shape;
+  Shape y_shape;
+  std::string name;
+};
+
+// Matches the scalar, row, column and XZ-cube fast paths in that order after TrySimplifyDims.
+std::vector<ReduceCase> ReduceCases() {
+  return {
+      {Shape({1 << 22}), Shape({1}), "scalar"},
+      {Shape({4096, 1024}), Shape({4096, 1}), "row"},
+      {Shape({4, 1 << 20}), Shape({4, 1}), "long row"},
+      {Shape({4096, 1024}), Shape({1, 1024}), "column"},
+      {Shape({1 << 20, 4}), Shape({1, 4}), "narrow column"},
+      {Shape({64, 256, 256}), Shape({1, 256, 1}), "xz cube"},
+  };
+}
+
+template<template<typename> class binary_func>
+void CheckReduceSameAsDefault(const ReduceCase& reduce_case, double rtol) {
+  const int64_t x_elem_num = reduce_case.x_shape.elem_cnt();
+  const int64_t y_elem_num = reduce_case.y_shape.elem_cnt();
+  std::vector<float> x(x_elem_num);
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<float> distribution(-1, 2);
+  for (float& value : x) { value = distribution(generator); }
+  std::vector<float> fast_y(y_elem_num);
+  std::vector<float> default_y(y_elem_num);
+  std::vector<float> tmp(x_elem_num);
+  XpuVarNdarray<const float> x_ndarray(reduce_case.x_shape, x.data());
+  XpuVarNdarray<float> tmp_ndarray(reduce_case.x_shape, tmp.data());
+  NdarrayReduce<DeviceType::kCPU, float, binary_func>::Reduce(
+      nullptr, XpuVarNdarray<float>(reduce_case.y_shape, fast_y.data()), x_ndarray, tmp_ndarray);
+  NdarrayDefaultReduce<DeviceType::kCPU, float, binary_func>::Reduce(
+      nullptr, XpuVarNdarray<float>(reduce_case.y_shape, default_y.data()), x_ndarray,
+      tmp_ndarray);
+  FOR_RANGE(int64_t, i, 0, y_elem_num) {
+    ASSERT_NEAR(fast_y.at(i), default_y.at(i), rtol * std::abs(default_y.at(i)))
+        << reduce_case.name << " " << i;
+  }
+}
+
+template<typename F>
+double ElapsedMilliseconds(const F& f) {
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+}  // namespace
+
+TEST(NdarrayReduce, cpu_fast_path_same_as_default) {
+  for (const auto& reduce_case : ReduceCases()) {
+    // the default path sums in float without compensation
+    CheckReduceSameAsDefault<BinaryFuncSum>(reduce_case, 1e-4);
+    CheckReduceSameAsDefault<BinaryFuncMax>(reduce_case, 0);
+  }
+}
+
+TEST(NdarrayReduce, cpu_sum_accuracy) {
+  // 0.1 is not representable, a naive float sum of 2^24 of them drifts far beyond the tolerance.
+  const int64_t elem_num = 1 << 24;
+  std::vector<float> x(elem_num, 0.1f);
+  float y = 0;
+  std::vector<float> tmp(elem_num);
+  NdarrayReduce<DeviceType::kCPU, float, BinaryFuncSum>::Reduce(
+      nullptr, XpuVarNdarray<float>(Shape({1}), &y),
+      XpuVarNdarray<const float>(Shape({elem_num}), x.data()),
+      XpuVarNdarray<float>(Shape({elem_num}), tmp.data()));
+  const double expected = static_cast<double>(0.1f) * elem_num;
+  ASSERT_NEAR(y, expected, expected * 1e-6);
+}
+
+TEST(NdarrayReduce, cpu_empty_reduce_axis) {
+  std::vector<float> y(4, 1.0f);
+  NdarrayReduce<DeviceType::kCPU, float, BinaryFuncSum>::Reduce(
+      nullptr, XpuVarNdarray<float>(Shape({4, 1}), y.data()),
+      XpuVarNdarray<const float>(Shape({4, 0}), nullptr),
+      XpuVarNdarray<float>(Shape({4, 0}), nullptr));
+  for (float value : y) { ASSERT_EQ(value, 0.0f); }
+  NdarrayReduce<DeviceType::kCPU, float, BinaryFuncMax>::Reduce(
+      nullptr, XpuVarNdarray<float>(Shape({1, 4}), y.data()),
+      XpuVarNdarray<const float>(Shape({0, 4}), nullptr),
+      XpuVarNdarray<float>(Shape({0, 4}), nullptr));
+  for (float value : y) { ASSERT_EQ(value, (UnitOfBinaryFunc<float, BinaryFuncMax>::Val())); }
+  // nothing is kept, y must stay untouched
+  NdarrayReduce<DeviceType::kCPU, float, BinaryFuncSum>::Reduce(
+      nullptr, XpuVarNdarray<float>(Shape({0, 1}), nullptr),
+      XpuVarNdarray<const float>(Shape({0, 8}), nullptr),
+      XpuVarNdarray<float>(Shape({0, 8}), nullptr));
+}
+
+TEST(NdarrayReduce, cpu_fast_path_benchmark) {
+  const bool own_thread_pool = (Global<ThreadPool>::Get() == nullptr);
+  if (own_thread_pool) {
+    Global<ThreadPool>::New(std::max<int32_t>(std::thread::hardware_concurrency() - 1, 1));
+  }
+  for (const auto& reduce_case : ReduceCases()) {
+    const int64_t x_elem_num = reduce_case.x_shape.elem_cnt();
+    std::vector<float> x(x_elem_num, 1.0f);
+    std::vector<float> y(reduce_case.y_shape.elem_cnt());
+    std::vector<float> tmp(x_elem_num);
+    XpuVarNdarray<const float> x_ndarray(reduce_case.x_shape, x.data());
+    XpuVarNdarray<float> y_ndarray(reduce_case.y_shape, y.data());
+    XpuVarNdarray<float> tmp_ndarray(reduce_case.x_shape, tmp.data());
+    const double fast_ms = ElapsedMilliseconds([&]() {
+      NdarrayReduce<DeviceType::kCPU, float, BinaryFuncSum>::Reduce(nullptr, y_ndarray, x_ndarray,
+                                                                    tmp_ndarray);
+    });
+    const double default_ms = ElapsedMilliseconds([&]() {
+      NdarrayDefaultReduce<DeviceType::kCPU, float, BinaryFuncSum>::Reduce(nullptr, y_ndarray,
+                                                                           x_ndarray, tmp_ndarray);
+    });
+    LOG(INFO) << "reduce sum " << reduce_case.name << " " << reduce_case.x_shape.ToString()
+              << ", fast path: " << fast_ms << " ms ("
+              << x_elem_num * sizeof(float) / fast_ms / 1e6 << " GB/s), default: " << default_ms
+              << " ms";
+  }
+  if (own_thread_pool) { Global<ThreadPool>::Delete(); }
+}
+
+}  // namespace test
+
+}  // namespace oneflow
@@ -0,0 +1,220 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/persistence/async_snapshot_writer.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/thread/thread_pool.h"
+
+namespace oneflow {
+
+namespace {
+
+// Written files are fsynced this many at a time instead of one by one, and at commit.
+constexpr size_t kSyncBatchSize = 64;
+
+void SyncAndCloseFiles(std::vector<std::unique_ptr<fs::WritableFile>>* files) {
+  for (const auto& file : *files) {
+    file->Sync();
+    file->Close();
+  }
+  files->clear();
+}
+
+}  // namespace
+
+struct AsyncSnapshotWriter::Snapshot final {
+  explicit Snapshot(const std::string& root_path)
+      : root_path(root_path), pending_num(0), closed(false) {}
+
+  const std::string root_path;
+  // files queued but not synced, or synced and not accounted yet
+  int64_t pending_num;
+  bool closed;
+  std::string manifest_name;
+  // (key, size) of the written files, the content of the manifest
+  std::vector<std::pair<std::string, size_t>> written_files;
+  std::vector<std::unique_ptr<fs::WritableFile>> unsynced_files;
+};
+
+AsyncSnapshotWriter::AsyncSnapshotWriter(size_t max_inflight_bytes, int64_t write_thread_num)
+    : max_inflight_bytes_(max_inflight_bytes),
+      thread_pool_(new ThreadPool(std::max<int64_t>(write_thread_num, 1))),
+      inflight_bytes_(0) {}
+
+AsyncSnapshotWriter::~AsyncSnapshotWriter() {
+  WaitAll();
+  // joins the write threads before the members they use go away
+  thread_pool_.reset();
+}
+
+AsyncSnapshotWriter* AsyncSnapshotWriter::Get() {
+  // Leaked with its thread pool, files may still be written by them at exit.
+  static AsyncSnapshotWriter* writer = new AsyncSnapshotWriter(
+      ParseIntegerFromEnv("ONEFLOW_ASYNC_SNAPSHOT_MAX_INFLIGHT_BYTES", 2LL * 1024 * 1024 * 1024),
+      ParseIntegerFromEnv("ONEFLOW_ASYNC_SNAPSHOT_WRITE_THREAD_NUM", 2));
+  return writer;
+}
+
+std::shared_ptr<AsyncSnapshotWriter::Snapshot> AsyncSnapshotWriter::GetOrCreateSnapshot(
+    const std::string& root_path) {
+  auto it = root_path2snapshot_.find(root_path);
+  if (it == root_path2snapshot_.end()) {
+    it = root_path2snapshot_.emplace(root_path, std::make_shared<Snapshot>(root_path)).first;
+  }
+  return it->second;
+}
+
+void AsyncSnapshotWriter::Write(const std::string& root_path, const std::string& key,
+                                const char* data, size_t size) {
+  std::shared_ptr<Snapshot> snapshot;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [&]() {
+      // a file larger than the cap is written alone
+      if (inflight_bytes_ != 0 && inflight_bytes_ + size > max_inflight_bytes_) { return false; }
+      // a snapshot being committed is not written again until the manifest is in place
+      const auto it = root_path2snapshot_.find(root_path);
+      return it == root_path2snapshot_.end() || !it->second->closed;
+    });
+    inflight_bytes_ += size;
+    snapshot = GetOrCreateSnapshot(root_path);
+    snapshot->pending_num += 1;
+  }
+  auto buffer = std::make_shared<std::vector<char>>(data, data + size);
+  thread_pool_->AddWork([this, snapshot, key, buffer]() mutable {
+    WriteFile(snapshot, key, std::move(buffer));
+  });
+}
+
+void AsyncSnapshotWriter::WriteFile(const std::shared_ptr<Snapshot>& snapshot,
+                                    const std::string& key,
+                                    std::shared_ptr<std::vector<char>> data) {
+  const std::string path = JoinPath(snapshot->root_path, key);
+  SnapshotFS()->RecursivelyCreateDirIfNotExist(Dirname(path));
+  std::unique_ptr<fs::WritableFile> file;
+  SnapshotFS()->NewWritableFile(path, &file);
+  file->Append(data->data(), data->size());
+  file->Flush();
+  const size_t size = data->size();
+  data.reset();
+  std::vector<std::unique_ptr<fs::WritableFile>> files_to_sync;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    inflight_bytes_ -= size;
+    snapshot->written_files.emplace_back(key, size);
+    snapshot->unsynced_files.emplace_back(std::move(file));
+    if (snapshot->unsynced_files.size() >= kSyncBatchSize) {
+      files_to_sync.swap(snapshot->unsynced_files);
+    }
+  }
+  cond_.notify_all();
+  SyncAndCloseFiles(&files_to_sync);
+  bool need_commit = false;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    snapshot->pending_num -= 1;
+    need_commit = snapshot->closed && snapshot->pending_num == 0;
+  }
+  cond_.notify_all();
+  if (need_commit) { Commit(snapshot); }
+}
+
+void AsyncSnapshotWriter::Close(const std::string& root_path, const std::string& manifest_name) {
+  std::shared_ptr<Snapshot> snapshot;
+  bool need_commit = false;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    snapshot = GetOrCreateSnapshot(root_path);
+    CHECK(!snapshot->closed) << "snapshot " << root_path << " is closed twice";
+    snapshot->closed = true;
+    snapshot->manifest_name = manifest_name;
+    need_commit = snapshot->pending_num == 0;
+  }
+  if (need_commit) {
+    thread_pool_->AddWork([this, snapshot]() { Commit(snapshot); });
+  }
+}
+
+void AsyncSnapshotWriter::Commit(const std::shared_ptr<Snapshot>& snapshot) {
+  std::vector<std::unique_ptr<fs::WritableFile>> files_to_sync;
+  std::vector<std::pair<std::string, size_t>> written_files;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    files_to_sync.swap(snapshot->unsynced_files);
+    written_files = snapshot->written_files;
+  }
+  SyncAndCloseFiles(&files_to_sync);
+  // The manifest is written aside and renamed, so it is either absent or complete.
+  const std::string manifest_path = JoinPath(snapshot->root_path, snapshot->manifest_name);
+  const std::string tmp_manifest_path = manifest_path + ".tmp";
+  SnapshotFS()->RecursivelyCreateDirIfNotExist(snapshot->root_path);
+  {
+    std::unique_ptr<fs::WritableFile> manifest;
+    SnapshotFS()->NewWritableFile(tmp_manifest_path, &manifest);
+    for (const auto& pair : written_files) {
+      const std::string line = pair.first + " " + std::to_string(pair.second) + "\n";
+      manifest->Append(line.data(), line.size());
+    }
+    manifest->Sync();
+    manifest->Close();
+  }
+  SnapshotFS()->RenameFile(tmp_manifest_path, manifest_path);
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    root_path2snapshot_.erase(snapshot->root_path);
+  }
+  cond_.notify_all();
+}
+
+bool AsyncSnapshotWriter::IsDoneLocked(const std::string& root_path) const {
+  const auto it = root_path2snapshot_.find(root_path);
+  return it == root_path2snapshot_.end() || (!it->second->closed && it->second->pending_num == 0);
+}
+
+bool AsyncSnapshotWriter::IsDone(const std::string& root_path) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return IsDoneLocked(root_path);
+}
+
+void AsyncSnapshotWriter::Wait(const std::string& root_path) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait(lock, [&]() { return IsDoneLocked(root_path); });
+}
+
+void AsyncSnapshotWriter::WaitAll() {
+  std::vector<std::unique_ptr<fs::WritableFile>> files_to_sync;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [&]() {
+      for (const auto& pair : root_path2snapshot_) {
+        if (!IsDoneLocked(pair.first)) { return false; }
+      }
+      return true;
+    });
+    // The snapshots left are not closed, their files would stay open and unsynced without a
+    // manifest to commit them.
+    for (const auto& pair : root_path2snapshot_) {
+      auto* unsynced_files = &pair.second->unsynced_files;
+      if (unsynced_files->empty()) { continue; }
+      LOG(WARNING) << "snapshot " << pair.first << " is not closed, syncing its "
+                   << unsynced_files->size() << " unsynced files";
+      std::move(unsynced_files->begin(), unsynced_files->end(), std::back_inserter(files_to_sync));
+      unsynced_files->clear();
+    }
+  }
+  SyncAndCloseFiles(&files_to_sync);
+}
+
+}  // namespace oneflow
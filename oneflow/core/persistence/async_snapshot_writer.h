@@ -0,0 +1,70 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_PERSISTENCE_ASYNC_SNAPSHOT_WRITER_H_
+#define ONEFLOW_CORE_PERSISTENCE_ASYNC_SNAPSHOT_WRITER_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/persistence/file_system.h"
+
+namespace oneflow {
+
+class ThreadPool;
+
+// Writes snapshot files on background threads. Write copies the data into host staging memory
+// and returns, Close commits the snapshot by renaming a manifest of its files into place once
+// all of them are synced. Staging memory in flight is capped by
+// ONEFLOW_ASYNC_SNAPSHOT_MAX_INFLIGHT_BYTES, Write blocks while the cap is reached.
+class AsyncSnapshotWriter final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(AsyncSnapshotWriter);
+  AsyncSnapshotWriter(size_t max_inflight_bytes, int64_t write_thread_num);
+  // Waits like WaitAll.
+  ~AsyncSnapshotWriter();
+
+  // The writer configured by the environment variables.
+  static AsyncSnapshotWriter* Get();
+
+  void Write(const std::string& root_path, const std::string& key, const char* data, size_t size);
+  // Writes the manifest manifest_name under root_path once the files written so far are durable.
+  void Close(const std::string& root_path, const std::string& manifest_name);
+  // Returns true if root_path has no file or manifest still being written. Files of a snapshot
+  // which is not closed may not be synced yet.
+  bool IsDone(const std::string& root_path);
+  void Wait(const std::string& root_path);
+  // Waits for the closed snapshots to be committed, then syncs and closes the files written to
+  // the snapshots which are not closed.
+  void WaitAll();
+
+ private:
+  struct Snapshot;
+
+  std::shared_ptr<Snapshot> GetOrCreateSnapshot(const std::string& root_path);
+  void WriteFile(const std::shared_ptr<Snapshot>& snapshot, const std::string& key,
+                 std::shared_ptr<std::vector<char>> data);
+  void Commit(const std::shared_ptr<Snapshot>& snapshot);
+  bool IsDoneLocked(const std::string& root_path) const;
+
+  const size_t max_inflight_bytes_;
+  std::unique_ptr<ThreadPool> thread_pool_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  size_t inflight_bytes_;
+  HashMap<std::string, std::shared_ptr<Snapshot>> root_path2snapshot_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_PERSISTENCE_ASYNC_SNAPSHOT_WRITER_H_
@@ -0,0 +1,149 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <set>
+#include <sstream>
+#include <gtest/gtest.h>
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/persistence/async_snapshot_writer.h"
+#include "oneflow/core/persistence/persistent_in_stream.h"
+
+#ifdef OF_PLATFORM_POSIX
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+using Manifest = std::set<std::pair<std::string, size_t>>;
+
+std::string TestDirPath(const std::string& name) {
+  std::string current_dir = GetCwd();
+  StringReplace(&current_dir, '\\', '/');
+  std::string path = JoinPath(current_dir, name);
+  if (SnapshotFS()->IsDirectory(path)) { SnapshotFS()->RecursivelyDeleteDir(path); }
+  return path;
+}
+
+std::string ReadFile(const std::string& path) {
+  std::string content(SnapshotFS()->GetFileSize(path), '\0');
+  PersistentInStream in_stream(SnapshotFS(), path);
+  CHECK_EQ(in_stream.ReadFully(&content.front(), content.size()), 0);
+  return content;
+}
+
+// the files are listed in the order they finish, which depends on the write threads
+Manifest ReadManifest(const std::string& path) {
+  Manifest manifest;
+  std::istringstream lines(ReadFile(path));
+  std::string key;
+  size_t size = 0;
+  while (lines >> key >> size) { CHECK(manifest.emplace(key, size).second) << key; }
+  return manifest;
+}
+
+char ByteOf(const std::string& key, size_t size) {
+  return static_cast<char>(std::hash<std::string>()(key) + size);
+}
+
+// Writes file_num files of different sizes and returns the manifest they should get.
+Manifest WriteFiles(AsyncSnapshotWriter* writer, const std::string& root_path,
+                    const std::string& prefix, int64_t file_num) {
+  Manifest manifest;
+  FOR_RANGE(int64_t, i, 0, file_num) {
+    const std::string key = prefix + std::to_string(i) + "/out";
+    const size_t size = 4096 + i;
+    std::vector<char> data(size, ByteOf(key, size));
+    writer->Write(root_path, key, data.data(), data.size());
+    // the data is copied, the caller may reuse its buffer at once
+    std::fill(data.begin(), data.end(), 0);
+    manifest.emplace(key, size);
+  }
+  return manifest;
+}
+
+void CheckFiles(const std::string& root_path, const Manifest& manifest) {
+  for (const auto& pair : manifest) {
+    ASSERT_EQ(ReadFile(JoinPath(root_path, pair.first)),
+              std::string(pair.second, ByteOf(pair.first, pair.second)));
+  }
+}
+
+}  // namespace
+
+TEST(AsyncSnapshotWriter, write_and_commit) {
+  // smaller than one file, so the writes go through the cap one by one
+  AsyncSnapshotWriter writer(1000, 2);
+  const std::string root_path = TestDirPath("/tmp_test_async_snapshot_writer");
+  const Manifest manifest = WriteFiles(&writer, root_path, "var_", 100);
+  writer.Close(root_path, "snapshot_done");
+  writer.Wait(root_path);
+  ASSERT_TRUE(writer.IsDone(root_path));
+  ASSERT_FALSE(SnapshotFS()->FileExists(JoinPath(root_path, "snapshot_done.tmp")));
+  ASSERT_EQ(ReadManifest(JoinPath(root_path, "snapshot_done")), manifest);
+  CheckFiles(root_path, manifest);
+  SnapshotFS()->RecursivelyDeleteDir(root_path);
+}
+
+TEST(AsyncSnapshotWriter, write_to_closed_snapshot) {
+  AsyncSnapshotWriter writer(1 << 20, 2);
+  const std::string root_path = TestDirPath("/tmp_test_async_snapshot_writer_closed");
+  const Manifest first_manifest = WriteFiles(&writer, root_path, "first_", 50);
+  writer.Close(root_path, "first_done");
+  // waits for the commit of the closed snapshot and starts a new one at the same path
+  const Manifest second_manifest = WriteFiles(&writer, root_path, "second_", 1);
+  ASSERT_TRUE(SnapshotFS()->FileExists(JoinPath(root_path, "first_done")));
+  writer.Close(root_path, "second_done");
+  writer.Wait(root_path);
+  ASSERT_EQ(ReadManifest(JoinPath(root_path, "first_done")), first_manifest);
+  ASSERT_EQ(ReadManifest(JoinPath(root_path, "second_done")), second_manifest);
+  CheckFiles(root_path, first_manifest);
+  CheckFiles(root_path, second_manifest);
+  SnapshotFS()->RecursivelyDeleteDir(root_path);
+}
+
+TEST(AsyncSnapshotWriter, wait_all) {
+  AsyncSnapshotWriter writer(1 << 20, 4);
+  std::vector<std::string> root_paths;
+  std::vector<Manifest> manifests;
+  FOR_RANGE(int64_t, i, 0, 3) {
+    root_paths.emplace_back(TestDirPath("/tmp_test_async_snapshot_writer_" + std::to_string(i)));
+    manifests.emplace_back(WriteFiles(&writer, root_paths.back(), "var_", 20 + i));
+  }
+  // the last snapshot is left open, WaitAll waits for its files and syncs them but does not
+  // write a manifest
+  writer.Close(root_paths.at(0), "snapshot_done");
+  writer.Close(root_paths.at(1), "snapshot_done");
+  writer.WaitAll();
+  FOR_RANGE(int64_t, i, 0, 3) {
+    ASSERT_TRUE(writer.IsDone(root_paths.at(i)));
+    CheckFiles(root_paths.at(i), manifests.at(i));
+  }
+  ASSERT_EQ(ReadManifest(JoinPath(root_paths.at(0), "snapshot_done")), manifests.at(0));
+  ASSERT_EQ(ReadManifest(JoinPath(root_paths.at(1), "snapshot_done")), manifests.at(1));
+  ASSERT_FALSE(SnapshotFS()->FileExists(JoinPath(root_paths.at(2), "snapshot_done")));
+  writer.Close(root_paths.at(2), "snapshot_done");
+  writer.WaitAll();
+  ASSERT_EQ(ReadManifest(JoinPath(root_paths.at(2), "snapshot_done")), manifests.at(2));
+  for (const std::string& root_path : root_paths) { SnapshotFS()->RecursivelyDeleteDir(root_path); }
+}
+
+}  // namespace test
+
+}  // namespace oneflow
+
+#endif  // OF_PLATFORM_POSIX
@@ -69,6 +69,10 @@ class WritableFile {
   // persisted, depending on the implementation.
   virtual void Flush() = 0;
 
+  // Flushes the file and waits until its contents are durable on the storage. Falls back to
+  // Flush() for file systems which do not tell.
+  virtual void Sync() { Flush(); }
+
  private:
 };
 
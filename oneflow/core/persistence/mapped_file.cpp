@@ -0,0 +1,87 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/persistence/mapped_file.h"
+#include "oneflow/core/common/platform.h"
+#include "oneflow/core/common/str_util.h"
+
+#ifdef OF_PLATFORM_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // OF_PLATFORM_POSIX
+
+namespace oneflow {
+
+MmapPrefetch MmapPrefetchFromEnv() {
+  const std::string policy = ToLower(GetStringFromEnv("ONEFLOW_MMAP_PREFETCH", "none"));
+  if (policy == "willneed") {
+    return MmapPrefetch::kWillNeed;
+  } else if (policy == "populate") {
+    return MmapPrefetch::kPopulate;
+  } else {
+    CHECK_EQ(policy, "none") << "ONEFLOW_MMAP_PREFETCH should be none, willneed or populate";
+    return MmapPrefetch::kNone;
+  }
+}
+
+#ifdef OF_PLATFORM_POSIX
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) { PCHECK(munmap(data_, size_) == 0); }
+}
+
+Maybe<MappedFile> MappedFile::Open(const std::string& path, MmapPrefetch prefetch) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  CHECK_OR_RETURN(fd != -1) << "fail to open " << path << ", errno is " << errno;
+  struct stat file_stat {};
+  if (fstat(fd, &file_stat) != 0) {
+    const int stat_errno = errno;
+    close(fd);
+    return Error::RuntimeError() << "fail to stat " << path << ", errno is " << stat_errno;
+  }
+  const size_t size = file_stat.st_size;
+  void* ptr = nullptr;
+  if (size > 0) {
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    if (prefetch == MmapPrefetch::kPopulate) { flags |= MAP_POPULATE; }
+#endif  // MAP_POPULATE
+    // writable so that the mapping may back a tensor, written pages become private copies
+    ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+  }
+  const int mmap_errno = errno;
+  // the mapping holds its own reference to the file
+  close(fd);
+  CHECK_OR_RETURN(ptr != MAP_FAILED) << "fail to mmap " << path << ", errno is " << mmap_errno;
+  if (ptr != nullptr && prefetch == MmapPrefetch::kWillNeed) {
+    // only advice, a failure does not matter
+    madvise(ptr, size, MADV_WILLNEED);
+  }
+  return std::shared_ptr<MappedFile>(new MappedFile(static_cast<char*>(ptr), size));
+}
+
+#else
+
+MappedFile::~MappedFile() = default;
+
+Maybe<MappedFile> MappedFile::Open(const std::string& path, MmapPrefetch prefetch) {
+  UNIMPLEMENTED_THEN_RETURN() << "mmap is only supported on posix platforms";
+}
+
+#endif  // OF_PLATFORM_POSIX
+
+}  // namespace oneflow
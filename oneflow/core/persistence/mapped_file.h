@@ -0,0 +1,57 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_PERSISTENCE_MAPPED_FILE_H_
+#define ONEFLOW_CORE_PERSISTENCE_MAPPED_FILE_H_
+
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+enum class MmapPrefetch {
+  kNone = 0,
+  // madvise(MADV_WILLNEED), the kernel reads the file ahead in background
+  kWillNeed,
+  // MAP_POPULATE, the mapping is returned once the whole file is read and mapped
+  kPopulate,
+};
+
+// Reads ONEFLOW_MMAP_PREFETCH, one of "none" (default), "willneed" and "populate".
+MmapPrefetch MmapPrefetchFromEnv();
+
+// Private copy-on-write mapping of a whole local file. The pages which are not written are the
+// page cache pages of the file, so the processes mapping one file share its memory.
+class MappedFile final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(MappedFile);
+  ~MappedFile();
+
+  static Maybe<MappedFile> Open(const std::string& path, MmapPrefetch prefetch);
+
+  // Page aligned, nullptr for an empty file.
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  MappedFile(char* data, size_t size) : data_(data), size_(size) {}
+
+  char* data_;
+  size_t size_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_PERSISTENCE_MAPPED_FILE_H_
@@ -24,7 +24,10 @@ namespace oneflow {
 
 namespace {
 
-constexpr size_t kDefaultBufferSize = 32 * 1024;  // 32KB
+constexpr size_t kDefaultBufferSize = 32 * 1024;         // 32KB
+constexpr size_t kReadAheadMinBufferSize = 1024 * 1024;  // 1MB
+// O_DIRECT reads straight into a buffer only when it and the file offset are aligned to this
+constexpr size_t kReadAheadBufferAlignment = 4096;
 
 size_t GetBufferSize() {
   const char* buf_size_str = std::getenv("ONEFLOW_PERSISTENT_IN_STREAM_BUFFER_SIZE_BYTES");
@@ -41,6 +44,13 @@ size_t GetBufferSize() {
   return kDefaultBufferSize;
 }
 
+// Number of buffers filled ahead of the reader by a background thread, 0 reads synchronously.
+// Off by default, every stream reading ahead costs a thread and its buffers.
+size_t GetReadAheadNum() {
+  return std::max<int64_t>(ParseIntegerFromEnv("ONEFLOW_PERSISTENT_IN_STREAM_READ_AHEAD_NUM", 0),
+                           0);
+}
+
 }  // namespace
 
 PersistentInStream::PersistentInStream(fs::FileSystem* fs,
@@ -48,9 +58,21 @@ PersistentInStream::PersistentInStream(fs::FileSystem* fs,
                                        bool cyclic, bool with_local_copy)
     : PersistentInStream(kInvalidSessionId, fs, file_paths, offset, cyclic, with_local_copy) {}
 
+PersistentInStream::PersistentInStream(fs::FileSystem* fs,
+                                       const std::vector<std::string>& file_paths, uint64_t offset,
+                                       bool cyclic, bool with_local_copy, size_t read_ahead_num)
+    : PersistentInStream(kInvalidSessionId, fs, file_paths, offset, cyclic, with_local_copy,
+                         read_ahead_num) {}
+
 PersistentInStream::PersistentInStream(int64_t session_id, fs::FileSystem* fs,
                                        const std::vector<std::string>& file_paths, uint64_t offset,
-                                       bool cyclic, bool with_local_copy) {
+                                       bool cyclic, bool with_local_copy)
+    : PersistentInStream(session_id, fs, file_paths, offset, cyclic, with_local_copy,
+                         GetReadAheadNum()) {}
+
+PersistentInStream::PersistentInStream(int64_t session_id, fs::FileSystem* fs,
+                                       const std::vector<std::string>& file_paths, uint64_t offset,
+                                       bool cyclic, bool with_local_copy, size_t read_ahead_num) {
   if (with_local_copy) { CHECK_EQ(offset, 0); }
   std::vector<std::shared_ptr<BinaryInStream>> streams;
   for (auto& file_path : file_paths) {
@@ -65,12 +87,29 @@ PersistentInStream::PersistentInStream(int64_t session_id, fs::FileSystem* fs,
   } else {
     stream_scanner_.reset(new AcyclicStreamScanner(fs, streams, offset));
   }
-  buffer_.resize(GetBufferSize() + 1);
+  read_ahead_buffer_size_ = 0;
+  cur_read_ahead_buffer_ = nullptr;
+  read_ahead_eof_ = false;
+  if (read_ahead_num > 0) {
+    // buffer_ only holds the '\0' of an empty buffer, the data lives in the read ahead buffers
+    buffer_.resize(1);
+    StartReadAhead(read_ahead_num);
+  } else {
+    buffer_.resize(GetBufferSize() + 1);
+  }
   cur_buf_begin_ = buffer_.data();
   cur_buf_end_ = buffer_.data();
   *cur_buf_end_ = '\0';
 }
 
+PersistentInStream::~PersistentInStream() {
+  if (read_ahead_thread_.joinable()) {
+    free_buffers_->Close();
+    filled_chunks_->Close();
+    read_ahead_thread_.join();
+  }
+}
+
 PersistentInStream::PersistentInStream(fs::FileSystem* fs,
                                        const std::vector<std::string>& file_paths, bool cyclic,
                                        bool with_local_copy)
@@ -126,13 +165,65 @@ int32_t PersistentInStream::ReadFully(char* s, size_t n) {
 
 void PersistentInStream::UpdateBuffer() {
   CHECK_EQ(cur_buf_begin_, cur_buf_end_);
-  uint64_t n = stream_scanner_->UpdateBuffer(&buffer_);
-  cur_buf_begin_ = buffer_.data();
-  cur_buf_end_ = buffer_.data() + n;
+  if (read_ahead_buffers_.empty()) {
+    uint64_t n = stream_scanner_->UpdateBuffer(&buffer_);
+    cur_buf_begin_ = buffer_.data();
+    cur_buf_end_ = buffer_.data() + n;
+    *cur_buf_end_ = '\0';
+    return;
+  }
+  if (read_ahead_eof_) { return; }
+  if (cur_read_ahead_buffer_ != nullptr) {
+    CHECK_EQ(free_buffers_->Push(cur_read_ahead_buffer_), kBufferStatusSuccess);
+    cur_read_ahead_buffer_ = nullptr;
+  }
+  ReadAheadChunk chunk{};
+  CHECK_EQ(filled_chunks_->Pull(&chunk), kBufferStatusSuccess);
+  if (chunk.buffer == nullptr) {
+    read_ahead_eof_ = true;
+    cur_buf_begin_ = buffer_.data();
+    cur_buf_end_ = buffer_.data();
+  } else {
+    cur_read_ahead_buffer_ = chunk.buffer;
+    cur_buf_begin_ = chunk.buffer;
+    cur_buf_end_ = chunk.buffer + chunk.size;
+  }
   *cur_buf_end_ = '\0';
 }
 
-bool PersistentInStream::IsEof() const {
-  return cur_buf_begin_ == cur_buf_end_ && stream_scanner_->IsEof();
+bool PersistentInStream::IsEof() {
+  if (cur_buf_begin_ != cur_buf_end_) { return false; }
+  if (read_ahead_buffers_.empty()) { return stream_scanner_->IsEof(); }
+  // the scanner is owned by the read ahead thread, wait for its next chunk or the end mark
+  UpdateBuffer();
+  return cur_buf_begin_ == cur_buf_end_;
+}
+
+void PersistentInStream::StartReadAhead(size_t read_ahead_num) {
+  // Whole aligned chunks keep the file offset of every read aligned once the first one is
+  read_ahead_buffer_size_ =
+      RoundUp(std::max(GetBufferSize(), kReadAheadMinBufferSize), kReadAheadBufferAlignment);
+  free_buffers_.reset(new Buffer<char*>(read_ahead_num));
+  filled_chunks_.reset(new Buffer<ReadAheadChunk>(read_ahead_num));
+  FOR_RANGE(size_t, i, 0, read_ahead_num) {
+    read_ahead_buffers_.emplace_back(
+        static_cast<char*>(aligned_alloc(kReadAheadBufferAlignment,
+                                         read_ahead_buffer_size_ + kReadAheadBufferAlignment)),
+        &std::free);
+    CHECK_NOTNULL(read_ahead_buffers_.back().get());
+    CHECK_EQ(free_buffers_->Push(read_ahead_buffers_.back().get()), kBufferStatusSuccess);
+  }
+  read_ahead_thread_ = std::thread(&PersistentInStream::ReadAheadLoop, this);
+}
+
+void PersistentInStream::ReadAheadLoop() {
+  char* buffer = nullptr;
+  while (!stream_scanner_->IsEof()) {
+    if (free_buffers_->Pull(&buffer) != kBufferStatusSuccess) { return; }
+    const uint64_t n = stream_scanner_->UpdateBuffer(buffer, read_ahead_buffer_size_);
+    if (n == 0) { break; }
+    if (filled_chunks_->Push(ReadAheadChunk{buffer, n}) != kBufferStatusSuccess) { return; }
+  }
+  filled_chunks_->Push(ReadAheadChunk{nullptr, 0});
 }
 }  // namespace oneflow
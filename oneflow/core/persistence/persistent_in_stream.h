@@ -16,15 +16,17 @@ limitations under the License.
 #ifndef ONEFLOW_CORE_PERSISTENCE_PERSISTENT_IN_STREAM_H_
 #define ONEFLOW_CORE_PERSISTENCE_PERSISTENT_IN_STREAM_H_
 
+#include "oneflow/core/common/buffer.h"
 #include "oneflow/core/persistence/file_system.h"
 #include "oneflow/core/persistence/stream_scanner.h"
+#include <cstdlib>
 
 namespace oneflow {
 
 class PersistentInStream {
  public:
   OF_DISALLOW_COPY_AND_MOVE(PersistentInStream);
-  virtual ~PersistentInStream() {}
+  virtual ~PersistentInStream();
   PersistentInStream(fs::FileSystem* fs, const std::vector<std::string>& file_paths,
                      uint64_t offset, bool cyclic, bool with_local_copy);
   PersistentInStream(fs::FileSystem* fs, const std::vector<std::string>& file_paths, bool cyclic,
@@ -38,6 +40,13 @@ class PersistentInStream {
   PersistentInStream(int64_t session_id, fs::FileSystem* fs,
                      const std::vector<std::string>& file_paths, uint64_t offset, bool cyclic,
                      bool with_local_copy);
+  // read_ahead_num buffers are filled ahead of the reader by a background thread, 0 reads
+  // synchronously. The other constructors take ONEFLOW_PERSISTENT_IN_STREAM_READ_AHEAD_NUM.
+  PersistentInStream(fs::FileSystem* fs, const std::vector<std::string>& file_paths,
+                     uint64_t offset, bool cyclic, bool with_local_copy, size_t read_ahead_num);
+  PersistentInStream(int64_t session_id, fs::FileSystem* fs,
+                     const std::vector<std::string>& file_paths, uint64_t offset, bool cyclic,
+                     bool with_local_copy, size_t read_ahead_num);
 
   // 0: success
   // -1: eof
@@ -45,14 +54,33 @@ class PersistentInStream {
   int32_t ReadFully(char* s, size_t n);
 
  private:
-  bool IsEof() const;
+  struct ReadAheadChunk {
+    char* buffer;
+    uint64_t size;
+  };
+
+  bool IsEof();
   void UpdateBuffer();
+  void StartReadAhead(size_t read_ahead_num);
+  void ReadAheadLoop();
 
   std::unique_ptr<StreamScanner> stream_scanner_;
 
   std::vector<char> buffer_;
   char* cur_buf_begin_;
   char* cur_buf_end_;
+
+  // With read ahead the scanner belongs to read_ahead_thread_, which fills the free buffers while
+  // the caller parses the chunk in cur_read_ahead_buffer_. A chunk without buffer marks the end.
+  // The read ahead buffers are aligned for O_DIRECT reads, they hold read_ahead_buffer_size_ bytes
+  // and the '\0' after them.
+  std::vector<std::unique_ptr<char, decltype(&std::free)>> read_ahead_buffers_;
+  size_t read_ahead_buffer_size_;
+  std::unique_ptr<Buffer<char*>> free_buffers_;
+  std::unique_ptr<Buffer<ReadAheadChunk>> filled_chunks_;
+  char* cur_read_ahead_buffer_;
+  bool read_ahead_eof_;
+  std::thread read_ahead_thread_;
 };
 
 }  // namespace oneflow
@@ -0,0 +1,119 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/persistence/persistent_in_stream.h"
+#include "oneflow/core/persistence/posix/posix_file_system.h"
+
+#ifdef OF_PLATFORM_POSIX
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+// a few read ahead buffers, which are at least 1MB, and a tail
+constexpr size_t kScanFileSize = 3 * 1024 * 1024 + 123;
+constexpr size_t kScanRecordSize = 4096 + 7;
+
+std::string TestFilePath(const std::string& name) {
+  std::string current_dir = GetCwd();
+  StringReplace(&current_dir, '\\', '/');
+  return JoinPath(current_dir, name);
+}
+
+char ByteAt(size_t pos) { return static_cast<char>((pos * 31) ^ (pos >> 12)); }
+
+void WriteScanFile(fs::FileSystem* file_system, const std::string& file_path) {
+  std::unique_ptr<fs::WritableFile> file;
+  file_system->NewWritableFile(file_path, &file);
+  std::vector<char> chunk(1 << 20);
+  for (size_t pos = 0; pos < kScanFileSize; pos += chunk.size()) {
+    const size_t size = std::min(chunk.size(), kScanFileSize - pos);
+    FOR_RANGE(size_t, i, 0, size) { chunk.at(i) = ByteAt(pos + i); }
+    file->Append(chunk.data(), size);
+  }
+  file->Close();
+}
+
+// Scans the file in records like the dataset readers do, the records straddle the buffers.
+void CheckScanFile(fs::FileSystem* file_system, const std::string& file_path) {
+  PersistentInStream in_stream(file_system, file_path);
+  std::vector<char> record(kScanRecordSize);
+  size_t pos = 0;
+  while (pos < kScanFileSize) {
+    const size_t size = std::min(kScanRecordSize, kScanFileSize - pos);
+    ASSERT_EQ(in_stream.ReadFully(record.data(), size), 0);
+    FOR_RANGE(size_t, i, 0, size) { ASSERT_EQ(record.at(i), ByteAt(pos + i)) << pos + i; }
+    pos += size;
+  }
+  ASSERT_EQ(in_stream.ReadFully(record.data(), 1), -1);
+}
+
+}  // namespace
+
+TEST(PersistentInStream, read_line) {
+  fs::PosixFileSystem file_system;
+  const std::string file_path = TestFilePath("/tmp_test_persistent_in_stream_lines");
+  std::vector<std::string> lines;
+  {
+    std::unique_ptr<fs::WritableFile> file;
+    file_system.NewWritableFile(file_path, &file);
+    FOR_RANGE(int64_t, i, 0, 100000) {
+      lines.emplace_back(std::string(i % 97, 'a' + i % 26));
+      file->Append(lines.back().data(), lines.back().size());
+      file->Append("\n", 1);
+    }
+    file->Close();
+  }
+  for (const char* read_ahead_num : {"0", "1", "3"}) {
+    setenv("ONEFLOW_PERSISTENT_IN_STREAM_READ_AHEAD_NUM", read_ahead_num, 1);
+    PersistentInStream in_stream(&file_system, file_path);
+    std::string line;
+    for (const std::string& expected : lines) {
+      ASSERT_EQ(in_stream.ReadLine(&line), 0);
+      ASSERT_EQ(line, expected);
+    }
+    ASSERT_EQ(in_stream.ReadLine(&line), -1);
+  }
+  unsetenv("ONEFLOW_PERSISTENT_IN_STREAM_READ_AHEAD_NUM");
+  file_system.DelFile(file_path);
+}
+
+// Synchronous reads and read ahead, with and without O_DIRECT.
+TEST(PersistentInStream, sequential_scan) {
+  fs::PosixFileSystem file_system;
+  const std::string file_path = TestFilePath("/tmp_test_persistent_in_stream_scan");
+  WriteScanFile(&file_system, file_path);
+  for (const char* direct_io : {"0", "1"}) {
+    setenv("ONEFLOW_POSIX_FILE_SYSTEM_DIRECT_IO", direct_io, 1);
+    for (const char* read_ahead_num : {"0", "2"}) {
+      setenv("ONEFLOW_PERSISTENT_IN_STREAM_READ_AHEAD_NUM", read_ahead_num, 1);
+      CheckScanFile(&file_system, file_path);
+    }
+  }
+  unsetenv("ONEFLOW_PERSISTENT_IN_STREAM_READ_AHEAD_NUM");
+  unsetenv("ONEFLOW_POSIX_FILE_SYSTEM_DIRECT_IO");
+  file_system.DelFile(file_path);
+}
+
+}  // namespace test
+
+}  // namespace oneflow
+
+#endif  // OF_PLATFORM_POSIX
@@ -17,6 +17,7 @@ limitations under the License.
 
 #ifdef OF_PLATFORM_POSIX
 
+#include <cstring>
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -32,33 +33,83 @@ namespace oneflow {
 
 namespace fs {
 
+namespace {
+
+// O_DIRECT requires the file offset, the length and the memory to be aligned to the logical block
+// size of the device, 4KB covers the common devices.
+constexpr size_t kDirectIOAlignment = 4096;
+constexpr size_t kDirectIOBufferSize = 4 * 1024 * 1024;
+
+char* ThreadLocalDirectIOBuffer() {
+  static thread_local std::unique_ptr<char, decltype(&std::free)> buffer(
+      static_cast<char*>(aligned_alloc(kDirectIOAlignment, kDirectIOBufferSize)), &std::free);
+  CHECK_NOTNULL(buffer.get());
+  return buffer.get();
+}
+
+}  // namespace
+
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
   std::string fname_;
   int fd_;
+  bool direct_io_;
 
- public:
-  PosixRandomAccessFile(const std::string& fname, int fd) : fname_(fname), fd_(fd) {}
-  ~PosixRandomAccessFile() override { close(fd_); }
-
-  void Read(uint64_t offset, size_t n, char* result) const override {
-    char* dst = result;
-    while (n > 0) {
-      ssize_t r = pread(fd_, dst, n, static_cast<off_t>(offset));
+  // reads until n bytes or the end of file, returns the number of bytes read
+  size_t PRead(uint64_t offset, size_t n, char* result) const {
+    size_t read_size = 0;
+    while (read_size < n) {
+      ssize_t r = pread(fd_, result + read_size, n - read_size, static_cast<off_t>(offset));
       if (r > 0) {
-        dst += r;
-        n -= r;
+        read_size += r;
         offset += r;
       } else if (r == 0) {
-        PLOG(FATAL) << "Read EOF";
-        return;
+        break;
       } else if (errno == EINTR || errno == EAGAIN) {
         // Retry
       } else {
         PLOG(FATAL) << "Fail to read file " << fname_;
-        return;
       }
     }
+    return read_size;
+  }
+
+  // the aligned middle of the range is read in place, unaligned parts go through a bounce buffer
+  void ReadDirect(uint64_t offset, size_t n, char* result) const {
+    if (offset % kDirectIOAlignment == 0
+        && reinterpret_cast<uintptr_t>(result) % kDirectIOAlignment == 0) {
+      const size_t aligned_n = n / kDirectIOAlignment * kDirectIOAlignment;
+      if (PRead(offset, aligned_n, result) != aligned_n) { PLOG(FATAL) << "Read EOF"; }
+      offset += aligned_n;
+      result += aligned_n;
+      n -= aligned_n;
+    }
+    char* buffer = ThreadLocalDirectIOBuffer();
+    while (n > 0) {
+      const uint64_t aligned_offset = offset / kDirectIOAlignment * kDirectIOAlignment;
+      const size_t head = offset - aligned_offset;
+      const size_t len = std::min(kDirectIOBufferSize, RoundUp(head + n, kDirectIOAlignment));
+      const size_t r = PRead(aligned_offset, len, buffer);
+      if (r <= head) { PLOG(FATAL) << "Read EOF"; }
+      const size_t copy_size = std::min(r - head, n);
+      std::memcpy(result, buffer + head, copy_size);
+      offset += copy_size;
+      result += copy_size;
+      n -= copy_size;
+    }
+  }
+
+ public:
+  PosixRandomAccessFile(const std::string& fname, int fd, bool direct_io)
+      : fname_(fname), fd_(fd), direct_io_(direct_io) {}
+  ~PosixRandomAccessFile() override { close(fd_); }
+
+  void Read(uint64_t offset, size_t n, char* result) const override {
+    if (direct_io_) {
+      ReadDirect(offset, n, result);
+    } else if (PRead(offset, n, result) != n) {
+      PLOG(FATAL) << "Read EOF";
+    }
   }
 };
 
@@ -88,14 +139,33 @@ class PosixWritableFile : public WritableFile {
   void Flush() override {
     PCHECK(fflush(file_) == 0) << "Fail to flush file " << fname_ << ", errno is " << errno;
   }
+
+  void Sync() override {
+    Flush();
+    PCHECK(fsync(fileno(file_)) == 0) << "Fail to sync file " << fname_ << ", errno is " << errno;
+  }
 };
 
 void PosixFileSystem::NewRandomAccessFile(const std::string& fname,
                                           std::unique_ptr<RandomAccessFile>* result) {
   std::string translated_fname = TranslateName(fname);
-  int fd = open(translated_fname.c_str(), O_RDONLY);
+  int fd = -1;
+  bool direct_io = false;
+#ifdef O_DIRECT
+  // bypass the page cache for datasets that are scanned once and do not fit in memory
+  if (ParseBooleanFromEnv("ONEFLOW_POSIX_FILE_SYSTEM_DIRECT_IO", false)) {
+    fd = open(translated_fname.c_str(), O_RDONLY | O_DIRECT);
+    if (fd >= 0) {
+      direct_io = true;
+    } else {
+      // e.g. tmpfs rejects O_DIRECT with EINVAL
+      PLOG(WARNING) << "Fail to open file " << fname << " with O_DIRECT, fall back to buffered io";
+    }
+  }
+#endif  // O_DIRECT
+  if (fd < 0) { fd = open(translated_fname.c_str(), O_RDONLY); }
   PCHECK(fd >= 0) << "Fail to open file " << fname << ", errno is " << errno;
-  result->reset(new PosixRandomAccessFile(fname, fd));
+  result->reset(new PosixRandomAccessFile(fname, fd, direct_io));
   CHECK_NOTNULL(result->get());
 }
 
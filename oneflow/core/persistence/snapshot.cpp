@@ -13,13 +13,14 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
+#include <chrono>
 #include "oneflow/core/persistence/snapshot.h"
 #include "oneflow/core/common/str_util.h"
-#include "oneflow/core/persistence/persistent_in_stream.h"
+#include "oneflow/core/persistence/async_snapshot_writer.h"
+#include "oneflow/core/persistence/mapped_file.h"
 #include "oneflow/core/persistence/persistent_out_stream.h"
-#include "oneflow/core/register/tensor_slice_copier.h"
-#include "oneflow/core/ep/cpu/cpu_stream.h"
-#include "oneflow/core/ep/include/device_manager_registry.h"
+#include "oneflow/core/persistence/posix/posix_file_system.h"
+#include "oneflow/core/thread/thread_pool.h"
 
 namespace oneflow {
 
@@ -29,6 +30,114 @@ std::string GenDataFilePath(const std::string& root, const std::string& key) {
   return JoinPath(root, key);
 }
 
+// Runs which are at most this far apart in the file are read by one call through the staging
+// buffer. The kernel reads whole pages anyway, so skipping less than a page costs nothing.
+constexpr int64_t kMaxSkippedBytes = 4096;
+constexpr int64_t kStagingBufferSize = 4 * 1024 * 1024;
+
+ThreadPool* SnapshotReadThreadPool() {
+  static const int64_t thread_num = ParseIntegerFromEnv("ONEFLOW_SNAPSHOT_READ_THREAD_NUM", 4);
+  if (thread_num <= 0) { return nullptr; }
+  // Leaked, the pool may be used by threads still running at exit.
+  static ThreadPool* thread_pool = new ThreadPool(thread_num);
+  return thread_pool;
+}
+
+// With ONEFLOW_SNAPSHOT_READ_MMAP local snapshots are copied from a mapping of the file, the
+// prefetch of the mapping follows ONEFLOW_MMAP_PREFETCH.
+bool ReadSnapshotByMmap() {
+#ifdef OF_PLATFORM_POSIX
+  static const bool read_by_mmap = ParseBooleanFromEnv("ONEFLOW_SNAPSHOT_READ_MMAP", false)
+                                   && dynamic_cast<fs::PosixFileSystem*>(SnapshotFS()) != nullptr;
+  return read_by_mmap;
+#else
+  return false;
+#endif  // OF_PLATFORM_POSIX
+}
+
+// Calls Handler(file_offset, size) on the maximal contiguous byte runs of slice in the row major
+// file of logical_blob_shape, in the order of the slice elements.
+template<typename HandlerT>
+void ForEachContiguousRun(const Shape& logical_blob_shape, const TensorSliceView& slice,
+                          int64_t elem_size, const HandlerT& Handler) {
+  const int64_t num_axes = logical_blob_shape.NumAxes();
+  if (num_axes == 0) {
+    Handler(0, elem_size);
+    return;
+  }
+  if (slice.shape().elem_cnt() == 0) { return; }
+  // The axes after run_axis are fully covered by slice, one run spans all of them
+  int64_t run_axis = num_axes - 1;
+  while (run_axis > 0 && slice.At(run_axis).size() == logical_blob_shape.At(run_axis)) {
+    run_axis -= 1;
+  }
+  std::vector<int64_t> strides(num_axes);
+  int64_t offset = 0;
+  FOR_RANGE(int64_t, axis, 0, num_axes) {
+    strides.at(axis) = logical_blob_shape.Count(axis + 1) * elem_size;
+    if (axis <= run_axis) { offset += slice.At(axis).begin() * strides.at(axis); }
+  }
+  const int64_t run_size = slice.At(run_axis).size() * strides.at(run_axis);
+  const int64_t num_runs = slice.shape().Count(0, run_axis);
+  std::vector<int64_t> index(run_axis, 0);
+  FOR_RANGE(int64_t, i, 0, num_runs) {
+    Handler(offset, run_size);
+    for (int64_t axis = run_axis - 1; axis >= 0; --axis) {
+      offset += strides.at(axis);
+      index.at(axis) += 1;
+      if (index.at(axis) < slice.At(axis).size()) { break; }
+      offset -= slice.At(axis).size() * strides.at(axis);
+      index.at(axis) = 0;
+    }
+  }
+}
+
+// Reads runs of a file one after another into dst. Runs close to each other are read by one call
+// into a staging buffer and copied out, large runs go to dst directly.
+class SliceRunReader final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SliceRunReader);
+  SliceRunReader(const fs::RandomAccessFile* file, char* dst) : file_(file), dst_(dst) {}
+  ~SliceRunReader() = default;
+
+  void Add(int64_t file_offset, int64_t size) {
+    if (!runs_.empty()) {
+      const int64_t span_begin = runs_.front().first;
+      const int64_t last_end = runs_.back().first + runs_.back().second;
+      if (file_offset - last_end > kMaxSkippedBytes
+          || file_offset + size - span_begin > kStagingBufferSize) {
+        Flush();
+      }
+    }
+    runs_.emplace_back(file_offset, size);
+  }
+
+  void Flush() {
+    if (runs_.empty()) { return; }
+    if (runs_.size() == 1) {
+      file_->Read(runs_.front().first, runs_.front().second, dst_);
+      dst_ += runs_.front().second;
+    } else {
+      const int64_t span_begin = runs_.front().first;
+      const int64_t span_size = runs_.back().first + runs_.back().second - span_begin;
+      if (buffer_.size() < static_cast<size_t>(span_size)) { buffer_.resize(span_size); }
+      file_->Read(span_begin, span_size, buffer_.data());
+      for (const auto& run : runs_) {
+        std::memcpy(dst_, buffer_.data() + run.first - span_begin, run.second);
+        dst_ += run.second;
+      }
+    }
+    runs_.clear();
+  }
+
+ private:
+  const fs::RandomAccessFile* file_;
+  char* dst_;
+  // (file offset, size) of the runs not read yet
+  std::vector<std::pair<int64_t, int64_t>> runs_;
+  std::vector<char> buffer_;
+};
+
 }  // namespace
 
 SnapshotReader::SnapshotReader(const std::string& snapshot_root_path)
@@ -53,22 +162,33 @@ void SnapshotReader::Read(const std::string& key, const Shape& logical_blob_shap
   const int64_t logical_blob_size = logical_blob_shape.elem_cnt() * GetSizeOfDataType(data_type);
   CHECK_EQ(SnapshotFS()->GetFileSize(path), logical_blob_size)
       << "unexpected model snapshot size, path: " << path;
-  if (slice.shape().Count(1) == logical_blob_shape.Count(1)) {
-    PersistentInStream in_stream(
-        SnapshotFS(), path,
-        slice.At(0).begin() * slice.shape().Count(1) * GetSizeOfDataType(data_type));
-    in_stream.ReadFully(dst, slice.shape().elem_cnt() * GetSizeOfDataType(data_type));
+  const auto start = std::chrono::steady_clock::now();
+  int64_t num_runs = 0;
+  if (ReadSnapshotByMmap()) {
+    const auto mapped_file = CHECK_JUST(MappedFile::Open(path, MmapPrefetchFromEnv()));
+    char* run_dst = dst;
+    ForEachContiguousRun(logical_blob_shape, slice, GetSizeOfDataType(data_type),
+                         [&](int64_t file_offset, int64_t size) {
+                           std::memcpy(run_dst, mapped_file->data() + file_offset, size);
+                           run_dst += size;
+                           num_runs += 1;
+                         });
   } else {
-    std::vector<char> buffer(logical_blob_size);
-    PersistentInStream in_stream(SnapshotFS(), path);
-    in_stream.ReadFully(buffer.data(), logical_blob_size);
-    TensorSliceCopier copier(slice, logical_blob_slice, data_type, DeviceType::kCPU);
-    auto device = Global<ep::DeviceManagerRegistry>::Get()->GetDevice(DeviceType::kCPU, 0);
-    CHECK(device);
-    auto* stream = device->CreateStream();
-    copier.Copy(stream, dst, buffer.data());
-    device->DestroyStream(stream);
+    std::unique_ptr<fs::RandomAccessFile> file;
+    SnapshotFS()->NewRandomAccessFile(path, &file);
+    SliceRunReader reader(file.get(), dst);
+    ForEachContiguousRun(logical_blob_shape, slice, GetSizeOfDataType(data_type),
+                         [&](int64_t file_offset, int64_t size) {
+                           reader.Add(file_offset, size);
+                           num_runs += 1;
+                         });
+    reader.Flush();
   }
+  const double elapsed_ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  VLOG(1) << "load snapshot " << path << ": "
+          << slice.shape().elem_cnt() * GetSizeOfDataType(data_type) << " of " << logical_blob_size
+          << " bytes in " << num_runs << " runs, " << elapsed_ms << " ms";
 }
 
 void SnapshotReader::Read(const std::string& key, const Shape& logical_blob_shape,
@@ -77,10 +197,39 @@ void SnapshotReader::Read(const std::string& key, const Shape& logical_blob_shap
   Read(key, logical_blob_shape, blob->data_type(), slice, blob->mut_dptr<char>());
 }
 
+void SnapshotReader::BatchRead(const std::vector<SnapshotReadRequest>& requests) const {
+  const auto ReadOne = [&](size_t i) {
+    const SnapshotReadRequest& request = requests.at(i);
+    Read(request.key, request.logical_blob_shape, request.data_type, request.slice, request.dst);
+  };
+  const auto start = std::chrono::steady_clock::now();
+  ThreadPool* thread_pool = SnapshotReadThreadPool();
+  if (thread_pool == nullptr || requests.size() <= 1) {
+    FOR_RANGE(size_t, i, 0, requests.size()) { ReadOne(i); }
+  } else {
+    thread_pool->ParallelFor(requests.size(), 1, [&](size_t begin, size_t end) {
+      FOR_RANGE(size_t, i, begin, end) { ReadOne(i); }
+    });
+  }
+  if (requests.empty()) { return; }
+  const double elapsed_ms =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  int64_t total_bytes = 0;
+  for (const auto& request : requests) {
+    total_bytes += request.slice.shape().elem_cnt() * GetSizeOfDataType(request.data_type);
+  }
+  // one line per batch, the variables are logged at VLOG(1)
+  LOG(INFO) << "load snapshot " << root_path_ << ": " << requests.size() << " variables, "
+            << total_bytes << " bytes in " << elapsed_ms << " ms";
+}
+
 void SnapshotReader::Close() {}
 
 SnapshotWriter::SnapshotWriter(const std::string& snapshot_root_path)
-    : root_path_(snapshot_root_path) {
+    : SnapshotWriter(snapshot_root_path, false) {}
+
+SnapshotWriter::SnapshotWriter(const std::string& snapshot_root_path, bool async_write)
+    : root_path_(snapshot_root_path), async_write_(async_write) {
   OfCallOnce("SnapshotWriteCheckRootPath-" + snapshot_root_path, [&]() {
     if (SnapshotFS()->FileExists(snapshot_root_path)) {
       CHECK(SnapshotFS()->IsDirectory(snapshot_root_path))
@@ -94,6 +243,10 @@ SnapshotWriter::SnapshotWriter(const std::string& snapshot_root_path)
 }
 
 void SnapshotWriter::Write(const std::string& key, const char* data, size_t size) {
+  if (async_write_) {
+    AsyncSnapshotWriter::Get()->Write(root_path_, key, data, size);
+    return;
+  }
   const std::string path = GenDataFilePath(root_path_, key);
   const std::string dir_path = Dirname(path);
   SnapshotFS()->CreateDirIfNotExist(dir_path);
@@ -107,6 +260,10 @@ void SnapshotWriter::Write(const std::string& key, const Blob* blob) {
 }
 
 void SnapshotWriter::Close() {
+  if (async_write_) {
+    AsyncSnapshotWriter::Get()->Close(root_path_, "snapshot_done");
+    return;
+  }
   PersistentOutStream out_stream(SnapshotFS(), JoinPath(root_path_, "snapshot_done"));
 }
 
@@ -24,6 +24,15 @@ namespace oneflow {
 
 class Blob;
 
+// One variable of SnapshotReader::BatchRead, the slice of the variable is read into dst.
+struct SnapshotReadRequest {
+  std::string key;
+  Shape logical_blob_shape;
+  DataType data_type;
+  TensorSliceView slice;
+  char* dst;
+};
+
 class SnapshotReader final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(SnapshotReader);
@@ -36,6 +45,8 @@ class SnapshotReader final {
   void Read(const std::string& key, const Shape& logical_blob_shape, const TensorSliceView& slice,
             Blob* blob) const;
   void Read(const std::string& key, Blob* blob) const;
+  // Reads the files of requests in parallel on a bounded pool of I/O threads.
+  void BatchRead(const std::vector<SnapshotReadRequest>& requests) const;
   bool HasKey(const std::string& key) const;
   void Close();
 
@@ -48,6 +59,9 @@ class SnapshotWriter final {
   OF_DISALLOW_COPY_AND_MOVE(SnapshotWriter);
   SnapshotWriter() = delete;
   explicit SnapshotWriter(const std::string& snapshot_root_path);
+  // With async_write the data is copied and written by AsyncSnapshotWriter, Write and Close
+  // return before the files are on the storage.
+  SnapshotWriter(const std::string& snapshot_root_path, bool async_write);
   ~SnapshotWriter() = default;
 
   void Write(const std::string& key, const char* data, size_t size);
@@ -56,6 +70,7 @@ class SnapshotWriter final {
 
  private:
   const std::string root_path_;
+  const bool async_write_;
 };
 
 }  // namespace oneflow
@@ -0,0 +1,96 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/persistence/snapshot.h"
+
+#ifdef OF_PLATFORM_POSIX
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+std::string TestDirPath(const std::string& name) {
+  std::string current_dir = GetCwd();
+  StringReplace(&current_dir, '\\', '/');
+  return JoinPath(current_dir, name);
+}
+
+float ValueAt(int64_t offset) { return static_cast<float>(offset % 1013); }
+
+// Reads slice of the variable written by the test and checks it against the row major values.
+void CheckSlice(const std::vector<float>& dst, const Shape& shape, const TensorSliceView& slice) {
+  ASSERT_EQ(static_cast<int64_t>(dst.size()), slice.shape().elem_cnt());
+  const int64_t num_axes = shape.NumAxes();
+  FOR_RANGE(int64_t, i, 0, slice.shape().elem_cnt()) {
+    int64_t remaining = i;
+    int64_t offset = 0;
+    for (int64_t axis = num_axes - 1; axis >= 0; --axis) {
+      const int64_t index = slice.At(axis).begin() + remaining % slice.At(axis).size();
+      remaining /= slice.At(axis).size();
+      offset += index * shape.Count(axis + 1);
+    }
+    ASSERT_EQ(dst.at(i), ValueAt(offset));
+  }
+}
+
+}  // namespace
+
+TEST(SnapshotReader, slice_read) {
+  const std::string root_path = TestDirPath("/tmp_test_snapshot_reader");
+  const Shape shape({6, 300, 2000});
+  {
+    std::vector<float> data(shape.elem_cnt());
+    FOR_RANGE(int64_t, i, 0, shape.elem_cnt()) { data.at(i) = ValueAt(i); }
+    SnapshotWriter writer(root_path);
+    writer.Write("var", reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+    writer.Write("var_copy", reinterpret_cast<const char*>(data.data()),
+                 data.size() * sizeof(float));
+  }
+  // whole, split(0), split(1), split(2), small runs split on the last axis and a corner box
+  const std::vector<TensorSliceView> slices = {
+      TensorSliceView(shape),
+      TensorSliceView({Range(2, 4), Range(0, 300), Range(0, 2000)}),
+      TensorSliceView({Range(0, 6), Range(75, 150), Range(0, 2000)}),
+      TensorSliceView({Range(0, 6), Range(0, 300), Range(1000, 2000)}),
+      TensorSliceView({Range(0, 6), Range(0, 300), Range(3, 5)}),
+      TensorSliceView({Range(5, 6), Range(299, 300), Range(1999, 2000)}),
+  };
+  const SnapshotReader reader(root_path);
+  std::vector<std::vector<float>> dsts;
+  std::vector<SnapshotReadRequest> requests;
+  for (const TensorSliceView& slice : slices) {
+    std::vector<float> dst(slice.shape().elem_cnt());
+    reader.Read("var", shape, DataType::kFloat, slice, reinterpret_cast<char*>(dst.data()));
+    CheckSlice(dst, shape, slice);
+    dsts.emplace_back(slice.shape().elem_cnt());
+    requests.emplace_back(SnapshotReadRequest{dsts.size() % 2 == 0 ? "var" : "var_copy", shape,
+                                              DataType::kFloat, slice,
+                                              reinterpret_cast<char*>(dsts.back().data())});
+  }
+  reader.BatchRead(requests);
+  FOR_RANGE(size_t, i, 0, slices.size()) { CheckSlice(dsts.at(i), shape, slices.at(i)); }
+  SnapshotFS()->RecursivelyDeleteDir(root_path);
+}
+
+}  // namespace test
+
+}  // namespace oneflow
+
+#endif  // OF_PLATFORM_POSIX
@@ -54,12 +54,15 @@ void StreamScanner::AddStream(fs::FileSystem* fs, const std::shared_ptr<BinaryIn
 bool StreamScanner::IsEof() const { return whole_file_pos_ == whole_file_size_; }
 
 uint64_t StreamScanner::UpdateBuffer(std::vector<char>* buffer) {
+  return UpdateBuffer(buffer->data(), buffer->size() - 1);
+}
+
+uint64_t StreamScanner::UpdateBuffer(char* buffer, size_t capacity) {
   if (cur_stream_id_ == stream_num_) return 0;
-  uint64_t n =
-      std::min<uint64_t>(buffer->size() - 1, streams_[cur_stream_id_]->file_size()
-                                                 - streams_[cur_stream_id_]->cur_file_pos());
+  uint64_t n = std::min<uint64_t>(
+      capacity, streams_[cur_stream_id_]->file_size() - streams_[cur_stream_id_]->cur_file_pos());
   if (n == 0) { return 0; }
-  streams_[cur_stream_id_]->Read(buffer->data(), n);
+  streams_[cur_stream_id_]->Read(buffer, n);
   AddNForCurFilePos(n);
   return n;
 }
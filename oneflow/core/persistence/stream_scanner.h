@@ -32,6 +32,8 @@ class StreamScanner {
                 uint64_t offset);
   bool IsEof() const;
   uint64_t UpdateBuffer(std::vector<char>* buffer);
+  // Reads at most capacity bytes into buffer, returns the number of bytes read.
+  uint64_t UpdateBuffer(char* buffer, size_t capacity);
 
  protected:
   virtual void AddNForCurFilePos(uint64_t n) = 0;
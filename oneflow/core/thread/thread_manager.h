@@ -47,27 +47,23 @@ class ThreadMgr final {
 
 void SingleThreadLoop(size_t num, std::function<void(size_t i)> Callback);
 
+// Runs DoEach(i) for i in [0, num) on Global<ThreadPool> and the calling thread.
+// grain_size is the minimum number of consecutive indices handled by one task.
 template<typename DoEachT>
-void MultiThreadLoop(size_t num, const DoEachT& DoEach) {
+void MultiThreadLoop(size_t num, const DoEachT& DoEach, size_t grain_size) {
   if (num == 0) { return; }
   if (unlikely(pthread_fork::IsForkedSubProcess())) {
     SingleThreadLoop(num, DoEach);
     return;
   }
-  size_t thread_num = Global<ThreadPool>::Get()->thread_num();
-  thread_num = std::min(num, thread_num);
-  BalancedSplitter bs(num, thread_num);
-  BlockingCounter bc(thread_num);
-  FOR_RANGE(size_t, range_id, 0, thread_num) {
-    Global<ThreadPool>::Get()->AddWork([&bc, &bs, range_id, DoEach] {
-      size_t start = bs.At(range_id).begin();
-      size_t end = bs.At(range_id).end();
-      FOR_RANGE(size_t, i, start, end) { DoEach(i); }
-      bc.Decrease();
-    });
-  }
-  // buzy loop wait.
-  bc.WaitUntilCntEqualZero();
+  Global<ThreadPool>::Get()->ParallelFor(num, grain_size, [&DoEach](size_t begin, size_t end) {
+    FOR_RANGE(size_t, i, begin, end) { DoEach(i); }
+  });
+}
+
+template<typename DoEachT>
+void MultiThreadLoop(size_t num, const DoEachT& DoEach) {
+  MultiThreadLoop(num, DoEach, 1);
 }
 
 }  // namespace oneflow
@@ -14,31 +14,211 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/thread/thread_pool.h"
+#include "oneflow/core/common/global.h"
+#include "oneflow/core/common/foreign_lock_helper.h"
 
 namespace oneflow {
 
+namespace {
+
+constexpr int64_t kWorkerQueueCapacityLog2 = 12;
+constexpr int32_t kNumSpinsBeforeSleep = 64;
+// ParallelFor splits the loop into about kNumChunksPerThread chunks per thread to balance skewed
+// workloads, the grain size is the lower bound of a chunk size.
+constexpr size_t kNumChunksPerThread = 8;
+
+thread_local const ThreadPool* tls_thread_pool = nullptr;
+thread_local int32_t tls_worker_id = -1;
+
+class ParallelForCtx final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(ParallelForCtx);
+  ParallelForCtx(size_t num, size_t chunk_size,
+                 const std::function<void(size_t begin, size_t end)>* DoRange)
+      : num_(num),
+        chunk_size_(chunk_size),
+        chunk_num_(RoundUp(num, chunk_size) / chunk_size),
+        DoRange_(DoRange),
+        next_chunk_(0),
+        finished_chunk_cnt_(0) {}
+  ~ParallelForCtx() = default;
+
+  size_t chunk_num() const { return chunk_num_; }
+
+  // DoRange_ is not accessed once all the chunks are claimed, so helpers that start late are safe
+  // even if ParallelFor has already returned.
+  void RunChunks() {
+    while (true) {
+      const size_t chunk_id = next_chunk_.fetch_add(1, std::memory_order_relaxed);
+      if (chunk_id >= chunk_num_) { break; }
+      const size_t begin = chunk_id * chunk_size_;
+      (*DoRange_)(begin, std::min(begin + chunk_size_, num_));
+      if (finished_chunk_cnt_.fetch_add(1, std::memory_order_acq_rel) + 1 == chunk_num_) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.notify_all();
+      }
+    }
+  }
+
+  bool Done() const { return finished_chunk_cnt_.load(std::memory_order_acquire) == chunk_num_; }
+
+  void WaitUntilDone() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this]() { return Done(); });
+  }
+
+ private:
+  const size_t num_;
+  const size_t chunk_size_;
+  const size_t chunk_num_;
+  const std::function<void(size_t begin, size_t end)>* DoRange_;
+  std::atomic<size_t> next_chunk_;
+  std::atomic<size_t> finished_chunk_cnt_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+};
+
+}  // namespace
+
 ThreadPool::ThreadPool(int32_t thread_num)
-    : work_chans_(thread_num), threads_(thread_num), work_cnt_(0) {
+    : worker_queues_(thread_num),
+      threads_(thread_num),
+      pending_work_cnt_(0),
+      sleeping_worker_cnt_(0),
+      shutdown_(false) {
+  FOR_RANGE(int32_t, i, 0, thread_num) {
+    worker_queues_[i].reset(new WorkStealingQueue<Work>(kWorkerQueueCapacityLog2));
+  }
   FOR_RANGE(int32_t, i, 0, thread_num) {
-    Channel<std::function<void()>>* chan = &(work_chans_.at(i));
-    threads_[i] = std::thread([chan]() {
-      std::function<void()> work;
-      while (chan->Receive(&work) == kChannelStatusSuccess) { work(); }
-    });
+    threads_[i] = std::thread([this, i]() { WorkerLoop(i); });
   }
 }
 
 ThreadPool::~ThreadPool() {
-  FOR_RANGE(int32_t, i, 0, work_chans_.size()) {
-    work_chans_.at(i).Close();
-    threads_.at(i).join();
+  {
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    shutdown_ = true;
   }
+  sleep_cond_.notify_all();
+  for (auto& thread : threads_) { thread.join(); }
+  CHECK_EQ(pending_work_cnt_.load(), 0);
+}
+
+int32_t ThreadPool::CurrentWorkerId() const {
+  return tls_thread_pool == this ? tls_worker_id : -1;
 }
 
 void ThreadPool::AddWork(const std::function<void()>& work) {
-  const size_t cur_chan_idx =
-      work_cnt_.fetch_add(1, std::memory_order_relaxed) % work_chans_.size();
-  work_chans_.at(cur_chan_idx).Send(work);
+  Work* new_work = new Work(work);
+  pending_work_cnt_.fetch_add(1);
+  const int32_t worker_id = CurrentWorkerId();
+  if (worker_id < 0 || !worker_queues_.at(worker_id)->Push(new_work)) {
+    std::unique_lock<std::mutex> lock(injection_mutex_);
+    injection_queue_.push_back(new_work);
+  }
+  NotifyOneSleepingWorker();
+}
+
+void ThreadPool::NotifyOneSleepingWorker() {
+  // pairs with the increment of sleeping_worker_cnt_ in WorkerLoop, both are seq_cst so that
+  // either the worker sees the new pending work or we see the sleeping worker.
+  if (sleeping_worker_cnt_.load() > 0) {
+    { std::unique_lock<std::mutex> lock(sleep_mutex_); }
+    sleep_cond_.notify_one();
+  }
+}
+
+ThreadPool::Work* ThreadPool::TryPopInjectedWork() {
+  std::unique_lock<std::mutex> lock(injection_mutex_);
+  if (injection_queue_.empty()) { return nullptr; }
+  Work* work = injection_queue_.front();
+  injection_queue_.pop_front();
+  return work;
+}
+
+ThreadPool::Work* ThreadPool::TrySteal(int32_t worker_id) {
+  const int32_t queue_num = worker_queues_.size();
+  FOR_RANGE(int32_t, i, 1, queue_num + 1) {
+    const int32_t victim = (worker_id + i + queue_num) % queue_num;
+    if (victim == worker_id) { continue; }
+    Work* work = worker_queues_.at(victim)->Steal();
+    if (work != nullptr) { return work; }
+  }
+  return nullptr;
+}
+
+bool ThreadPool::TryRunOneWork(int32_t worker_id) {
+  Work* work = nullptr;
+  if (worker_id >= 0) { work = worker_queues_.at(worker_id)->Pop(); }
+  if (work == nullptr) { work = TryPopInjectedWork(); }
+  if (work == nullptr) { work = TrySteal(worker_id); }
+  if (work == nullptr) { return false; }
+  pending_work_cnt_.fetch_sub(1);
+  (*work)();
+  delete work;
+  return true;
+}
+
+void ThreadPool::WorkerLoop(int32_t worker_id) {
+  tls_thread_pool = this;
+  tls_worker_id = worker_id;
+  int32_t spin_cnt = 0;
+  while (true) {
+    if (TryRunOneWork(worker_id)) {
+      spin_cnt = 0;
+      continue;
+    }
+    if (pending_work_cnt_.load() > 0 || spin_cnt < kNumSpinsBeforeSleep) {
+      // works may be in flight or held by a queue we lost the race on.
+      ++spin_cnt;
+      std::this_thread::yield();
+      continue;
+    }
+    spin_cnt = 0;
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    sleeping_worker_cnt_.fetch_add(1);
+    sleep_cond_.wait(lock, [this]() { return pending_work_cnt_.load() > 0 || shutdown_; });
+    sleeping_worker_cnt_.fetch_sub(1);
+    if (shutdown_ && pending_work_cnt_.load() == 0) { break; }
+  }
+  tls_thread_pool = nullptr;
+  tls_worker_id = -1;
+}
+
+void ThreadPool::ParallelFor(size_t num, size_t grain_size,
+                             const std::function<void(size_t begin, size_t end)>& DoRange) {
+  if (num == 0) { return; }
+  const size_t thread_num = threads_.size();
+  const size_t chunk_size =
+      std::max(std::max<size_t>(grain_size, 1),
+               RoundUp(num, (thread_num + 1) * kNumChunksPerThread)
+                   / ((thread_num + 1) * kNumChunksPerThread));
+  auto ctx = std::make_shared<ParallelForCtx>(num, chunk_size, &DoRange);
+  if (thread_num == 0 || ctx->chunk_num() == 1) {
+    DoRange(0, num);
+    return;
+  }
+  const size_t helper_num = std::min(thread_num, ctx->chunk_num() - 1);
+  FOR_RANGE(size_t, i, 0, helper_num) {
+    AddWork([ctx]() { ctx->RunChunks(); });
+  }
+  // the calling thread takes part in the loop instead of waiting idle.
+  ctx->RunChunks();
+  if (ctx->Done()) { return; }
+  const int32_t worker_id = CurrentWorkerId();
+  if (worker_id >= 0) {
+    // a pool worker keeps running other works while the remaining chunks are in flight.
+    while (!ctx->Done()) {
+      if (!TryRunOneWork(worker_id)) { std::this_thread::yield(); }
+    }
+  } else if (Global<ForeignLockHelper>::Get() != nullptr) {
+    CHECK_JUST(Global<ForeignLockHelper>::Get()->WithScopedRelease([&]() -> Maybe<void> {
+      ctx->WaitUntilDone();
+      return Maybe<void>::Ok();
+    }));
+  } else {
+    ctx->WaitUntilDone();
+  }
 }
 
 }  // namespace oneflow
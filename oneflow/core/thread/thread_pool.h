@@ -17,10 +17,13 @@ limitations under the License.
 #define ONEFLOW_CORE_THREAD_THREAD_POOL_H_
 
 #include "oneflow/core/common/util.h"
-#include "oneflow/core/common/channel.h"
+#include "oneflow/core/thread/work_stealing_queue.h"
 
 namespace oneflow {
 
+// Work-stealing thread pool.
+// Works added by a pool worker go to the worker's own deque and may be stolen by idle workers,
+// works added by other threads go to a shared FIFO injection queue.
 class ThreadPool final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(ThreadPool);
@@ -31,11 +34,35 @@ class ThreadPool final {
   int32_t thread_num() const { return threads_.size(); }
   void AddWork(const std::function<void()>& work);
 
+  // Splits [0, num) into chunks of at least `grain_size` indices and runs DoRange(begin, end) on
+  // each of them. Chunks are claimed dynamically by the pool workers and the calling thread, so a
+  // few slow chunks do not stall the others. Returns when all the chunks are done.
+  void ParallelFor(size_t num, size_t grain_size,
+                   const std::function<void(size_t begin, size_t end)>& DoRange);
+
  private:
-  std::vector<Channel<std::function<void()>>> work_chans_;
+  using Work = std::function<void()>;
+
+  void WorkerLoop(int32_t worker_id);
+  // Returns false if no work was found. worker_id is -1 for non-worker threads.
+  bool TryRunOneWork(int32_t worker_id);
+  Work* TryPopInjectedWork();
+  Work* TrySteal(int32_t worker_id);
+  void NotifyOneSleepingWorker();
+  // Returns the worker id of the current thread in this pool, -1 if it is not a pool worker.
+  int32_t CurrentWorkerId() const;
+
+  std::vector<std::unique_ptr<WorkStealingQueue<Work>>> worker_queues_;
   std::vector<std::thread> threads_;
 
-  std::atomic<size_t> work_cnt_;
+  std::mutex injection_mutex_;
+  std::deque<Work*> injection_queue_;
+
+  std::atomic<int64_t> pending_work_cnt_;
+  std::atomic<int32_t> sleeping_worker_cnt_;
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cond_;
+  bool shutdown_;
 };
 
 }  // namespace oneflow
@@ -0,0 +1,130 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <chrono>
+#include "oneflow/core/thread/thread_pool.h"
+#include "oneflow/core/common/balanced_splitter.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+// Every 64th index is 100x more expensive than the others, like a large jpeg in a batch.
+void SkewedWork(size_t i, std::vector<double>* out) {
+  const int64_t iter_num = (i % 64 == 0) ? 100000 : 1000;
+  double acc = i;
+  FOR_RANGE(int64_t, j, 0, iter_num) { acc = acc * 0.999999 + 1.0; }
+  out->at(i) = acc;
+}
+
+// The splitting strategy of the former round-robin pool: one static range per thread.
+void StaticRangeLoop(ThreadPool* pool, size_t num, const std::function<void(size_t)>& DoEach) {
+  const size_t range_num = std::min<size_t>(num, pool->thread_num());
+  BalancedSplitter bs(num, range_num);
+  std::mutex mtx;
+  std::condition_variable cond;
+  size_t remain = range_num;
+  FOR_RANGE(size_t, range_id, 0, range_num) {
+    pool->AddWork([&, range_id]() {
+      FOR_RANGE(size_t, i, bs.At(range_id).begin(), bs.At(range_id).end()) { DoEach(i); }
+      std::unique_lock<std::mutex> lock(mtx);
+      if (--remain == 0) { cond.notify_all(); }
+    });
+  }
+  std::unique_lock<std::mutex> lock(mtx);
+  cond.wait(lock, [&]() { return remain == 0; });
+}
+
+template<typename F>
+double ElapsedMilliseconds(const F& f) {
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+}  // namespace
+
+TEST(ThreadPool, add_work) {
+  ThreadPool pool(4);
+  std::atomic<int64_t> sum(0);
+  std::mutex mtx;
+  std::condition_variable cond;
+  int64_t remain = 1000;
+  FOR_RANGE(int64_t, i, 0, 1000) {
+    pool.AddWork([&, i]() {
+      sum += i;
+      std::unique_lock<std::mutex> lock(mtx);
+      if (--remain == 0) { cond.notify_all(); }
+    });
+  }
+  std::unique_lock<std::mutex> lock(mtx);
+  cond.wait(lock, [&]() { return remain == 0; });
+  ASSERT_EQ(sum.load(), 999 * 1000 / 2);
+}
+
+TEST(ThreadPool, parallel_for_visits_each_index_once) {
+  ThreadPool pool(4);
+  for (size_t num : {0, 1, 7, 100, 4097}) {
+    for (size_t grain_size : {0, 1, 3, 1000}) {
+      std::vector<std::atomic<int32_t>> visits(num);
+      for (auto& visit : visits) { visit = 0; }
+      pool.ParallelFor(num, grain_size, [&](size_t begin, size_t end) {
+        ASSERT_LE(begin, end);
+        ASSERT_LE(end, num);
+        FOR_RANGE(size_t, i, begin, end) { ++visits[i]; }
+      });
+      for (const auto& visit : visits) { ASSERT_EQ(visit.load(), 1); }
+    }
+  }
+}
+
+TEST(ThreadPool, nested_parallel_for) {
+  ThreadPool pool(3);
+  std::atomic<int64_t> cnt(0);
+  pool.ParallelFor(16, 1, [&](size_t begin, size_t end) {
+    FOR_RANGE(size_t, i, begin, end) {
+      pool.ParallelFor(100, 1, [&](size_t inner_begin, size_t inner_end) {
+        cnt += inner_end - inner_begin;
+      });
+    }
+  });
+  ASSERT_EQ(cnt.load(), 1600);
+}
+
+TEST(ThreadPool, skewed_workload_benchmark) {
+  const int32_t thread_num = std::max<int32_t>(std::thread::hardware_concurrency(), 2);
+  ThreadPool pool(thread_num);
+  const size_t num = 64 * thread_num * 4;
+  std::vector<double> static_out(num);
+  std::vector<double> stealing_out(num);
+  const double static_ms = ElapsedMilliseconds([&]() {
+    StaticRangeLoop(&pool, num, [&](size_t i) { SkewedWork(i, &static_out); });
+  });
+  const double stealing_ms = ElapsedMilliseconds([&]() {
+    pool.ParallelFor(num, 1, [&](size_t begin, size_t end) {
+      FOR_RANGE(size_t, i, begin, end) { SkewedWork(i, &stealing_out); }
+    });
+  });
+  ASSERT_EQ(static_out, stealing_out);
+  LOG(INFO) << "skewed workload with " << thread_num << " threads, static ranges: " << static_ms
+            << " ms, work stealing: " << stealing_ms << " ms";
+}
+
+}  // namespace test
+
+}  // namespace oneflow
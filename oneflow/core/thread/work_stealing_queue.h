@@ -0,0 +1,103 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_THREAD_WORK_STEALING_QUEUE_H_
+#define ONEFLOW_CORE_THREAD_WORK_STEALING_QUEUE_H_
+
+#include <atomic>
+#include <memory>
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+// Bounded Chase-Lev deque.
+// Push/Pop may only be called by the owner thread and work on the bottom end (LIFO),
+// Steal may be called by any thread and works on the top end (FIFO).
+// See "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al., PPoPP'13).
+template<typename T>
+class WorkStealingQueue final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(WorkStealingQueue);
+  explicit WorkStealingQueue(int64_t capacity_log2)
+      : capacity_(int64_t(1) << capacity_log2),
+        mask_(capacity_ - 1),
+        buffer_(new std::atomic<T*>[capacity_]),
+        top_(0),
+        bottom_(0) {}
+  ~WorkStealingQueue() = default;
+
+  // Returns false if the queue is full.
+  bool Push(T* item) {
+    const int64_t b = bottom_.load(std::memory_order_relaxed);
+    const int64_t t = top_.load(std::memory_order_acquire);
+    if (b - t >= capacity_) { return false; }
+    buffer_[b & mask_].store(item, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Returns nullptr if the queue is empty.
+  T* Pop() {
+    const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    T* item = nullptr;
+    if (t <= b) {
+      item = buffer_[b & mask_].load(std::memory_order_relaxed);
+      if (t == b) {
+        // the last item, race against stealers.
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+          item = nullptr;
+        }
+        bottom_.store(b + 1, std::memory_order_relaxed);
+      }
+    } else {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // Returns nullptr if the queue is empty or the race against other thieves is lost.
+  T* Steal() {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) { return nullptr; }
+    T* item = buffer_[t & mask_].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  bool Empty() const {
+    return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const int64_t capacity_;
+  const int64_t mask_;
+  std::unique_ptr<std::atomic<T*>[]> buffer_;
+  alignas(64) std::atomic<int64_t> top_;
+  alignas(64) std::atomic<int64_t> bottom_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_THREAD_WORK_STEALING_QUEUE_H_
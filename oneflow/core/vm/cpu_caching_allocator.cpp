@@ -0,0 +1,492 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <sys/mman.h>
+#include <cstdlib>
+#include <sstream>
+#include "oneflow/core/vm/cpu_caching_allocator.h"
+#include "oneflow/core/vm/cpu_allocator.h"
+#include "oneflow/core/vm/thread_safe_allocator.h"
+
+namespace oneflow {
+namespace vm {
+
+namespace {
+
+inline size_t HostMemAlignedBytes(size_t bytes) { return RoundUp(bytes, kHostAlignSize); }
+
+inline bool IsAlignedSize(size_t size) { return size % kHostAlignSize == 0; }
+
+static const size_t kPieceSplitThreshold = 1 << 20;  // 1MiB
+static const size_t kHugePageSize = 2 << 20;         // 2MiB
+
+void UpdatePeak(std::atomic<int64_t>* peak, int64_t value) {
+  int64_t cur = peak->load(std::memory_order_relaxed);
+  while (value > cur && !peak->compare_exchange_weak(cur, value, std::memory_order_relaxed)) {}
+}
+
+}  // namespace
+
+double CpuCachingAllocatorStat::HitRate() const {
+  if (allocate_cnt == 0) { return 0; }
+  return static_cast<double>(cache_hit_cnt) / allocate_cnt;
+}
+
+double CpuCachingAllocatorStat::Fragmentation() const {
+  if (reserved_bytes == 0) { return 0; }
+  return 1.0 - static_cast<double>(allocated_bytes) / reserved_bytes;
+}
+
+std::string CpuCachingAllocatorStat::ToString() const {
+  std::stringstream ss;
+  ss << "allocate_cnt: " << allocate_cnt << ", hit_rate: " << HitRate()
+     << ", allocated_bytes: " << allocated_bytes << ", reserved_bytes: " << reserved_bytes
+     << ", fragmentation: " << Fragmentation()
+     << ", peak_allocated_bytes: " << peak_allocated_bytes
+     << ", peak_reserved_bytes: " << peak_reserved_bytes << ", block_cnt: " << block_cnt;
+  return ss.str();
+}
+
+CpuCachingAllocator::CpuCachingAllocator(bool use_huge_page, size_t release_threshold)
+    : Allocator(),
+      use_huge_page_(use_huge_page),
+      release_threshold_(release_threshold),
+      recycle_piece_list_(nullptr),
+      allocate_cnt_(0),
+      cache_hit_cnt_(0),
+      allocated_bytes_(0),
+      reserved_bytes_(0),
+      peak_allocated_bytes_(0),
+      peak_reserved_bytes_(0),
+      block_cnt_(0) {
+  bins_.resize(kBinNumSize);
+  for (int i = 0; i < kBinNumSize; ++i) {
+    size_t bin_size = BinSize4BinNum(i);
+    bins_.at(i).size = bin_size;
+    CHECK_EQ(BinNum4BinSize(bin_size), i);
+    CHECK_EQ(BinNum4BinSize(bin_size + kHostAlignSize - 1), i);
+    CHECK_EQ(BinNum4BinSize(bin_size * 2 - 1), i);
+    CHECK_EQ(BinNum4BinSize(bin_size * 2), i == (kBinNumSize - 1) ? i : i + 1);
+  }
+}
+
+CpuCachingAllocator::~CpuCachingAllocator() {
+  for (auto& pair : mem_ptr2block_) { DeallocateHostMemory(pair.first, pair.second.size); }
+}
+
+CpuCachingAllocatorStat CpuCachingAllocator::GetStat() const {
+  CpuCachingAllocatorStat stat;
+  stat.allocate_cnt = allocate_cnt_.load(std::memory_order_relaxed);
+  stat.cache_hit_cnt = cache_hit_cnt_.load(std::memory_order_relaxed);
+  stat.allocated_bytes = allocated_bytes_.load(std::memory_order_relaxed);
+  stat.reserved_bytes = reserved_bytes_.load(std::memory_order_relaxed);
+  stat.peak_allocated_bytes = peak_allocated_bytes_.load(std::memory_order_relaxed);
+  stat.peak_reserved_bytes = peak_reserved_bytes_.load(std::memory_order_relaxed);
+  stat.block_cnt = block_cnt_.load(std::memory_order_relaxed);
+  return stat;
+}
+
+void CpuCachingAllocator::UpdateAllocatedBytes(int64_t delta) {
+  const int64_t value = allocated_bytes_.fetch_add(delta, std::memory_order_relaxed) + delta;
+  UpdatePeak(&peak_allocated_bytes_, value);
+}
+
+void CpuCachingAllocator::UpdateReservedBytes(int64_t delta) {
+  const int64_t value = reserved_bytes_.fetch_add(delta, std::memory_order_relaxed) + delta;
+  UpdatePeak(&peak_reserved_bytes_, value);
+}
+
+void CpuCachingAllocator::InsertPiece2Bin(Piece* piece) {
+  CHECK(piece->is_free && piece->bin_num == kInvalidBinNum);
+  int32_t bin_num = BinNum4BinSize(piece->size);
+  piece->bin_num = bin_num;
+  CHECK(bins_.at(bin_num).pieces.insert(piece).second);
+}
+
+void CpuCachingAllocator::RemovePieceFromBin(Piece* piece) {
+  CHECK(piece->is_free);
+  CHECK_NE(piece->bin_num, kInvalidBinNum);
+  CHECK_GT(bins_.at(piece->bin_num).pieces.erase(piece), 0);
+  piece->bin_num = kInvalidBinNum;
+}
+
+CpuCachingAllocator::Piece* CpuCachingAllocator::AllocatePiece() {
+  if (recycle_piece_list_) {
+    Piece* ret = recycle_piece_list_;
+    recycle_piece_list_ = recycle_piece_list_->next;
+    return ret;
+  } else {
+    pieces_.emplace_back(new Piece());
+    return pieces_.at(pieces_.size() - 1).get();
+  }
+}
+
+void CpuCachingAllocator::DeallocatePiece(Piece* piece) {
+  piece->ptr = nullptr;
+  piece->size = 0;
+  piece->bin_num = kInvalidBinNum;
+  piece->is_free = true;
+  piece->prev = nullptr;
+  piece->next = recycle_piece_list_;
+  recycle_piece_list_ = piece;
+}
+
+void CpuCachingAllocator::MarkPiece(Piece* piece) {
+  CHECK_NOTNULL(piece->ptr);
+  CHECK(ptr2piece_.emplace(piece->ptr, piece).second);
+}
+
+void CpuCachingAllocator::UnMarkPiece(Piece* piece) {
+  CHECK_NOTNULL(piece->ptr);
+  auto it = ptr2piece_.find(piece->ptr);
+  CHECK(it != ptr2piece_.end());
+  ptr2piece_.erase(it);
+}
+
+CpuCachingAllocator::Piece* CpuCachingAllocator::FindPiece(size_t aligned_size) {
+  CHECK(IsAlignedSize(aligned_size));
+  for (int32_t bin_num = BinNum4BinSize(aligned_size); bin_num < kBinNumSize; ++bin_num) {
+    Bin* bin = &bins_.at(bin_num);
+    // pieces are sorted by size, so the first fit is the best fit of this bin.
+    Piece key;
+    key.size = aligned_size;
+    for (auto it = bin->pieces.lower_bound(&key); it != bin->pieces.end(); ++it) {
+      Piece* piece = *it;
+      CHECK(piece->is_free);
+      CHECK_NOTNULL(piece->ptr);
+      CHECK_EQ(piece->bin_num, bin_num);
+      CHECK(IsAlignedSize(piece->size));
+      if (piece->size >= aligned_size) {
+        bin->pieces.erase(it);
+        piece->bin_num = kInvalidBinNum;
+        piece->is_free = false;
+        if (piece->size >= aligned_size * 2 || piece->size - aligned_size >= kPieceSplitThreshold) {
+          Piece* new_piece = AllocatePiece();
+          new_piece->ptr = piece->ptr + aligned_size;
+          new_piece->size = piece->size - aligned_size;
+          piece->size = aligned_size;
+
+          Piece* next_p = piece->next;
+          piece->next = new_piece;
+          new_piece->prev = piece;
+          new_piece->next = next_p;
+          if (next_p != nullptr) { next_p->prev = new_piece; }
+
+          new_piece->is_free = true;
+          new_piece->bin_num = kInvalidBinNum;
+          CHECK(IsAlignedSize(piece->size));
+          CHECK(IsAlignedSize(new_piece->size));
+          InsertPiece2Bin(new_piece);
+          MarkPiece(new_piece);
+        }
+        return piece;
+      }
+    }
+  }
+  return nullptr;
+}
+
+void CpuCachingAllocator::MergeNeighbourFreePiece(Piece* lhs, Piece* rhs) {
+  CHECK(lhs->is_free);
+  CHECK(rhs->is_free);
+  CHECK(lhs->next == rhs);
+  CHECK(lhs == rhs->prev);
+  CHECK(lhs->ptr + lhs->size == rhs->ptr);
+
+  lhs->size += rhs->size;
+  lhs->next = rhs->next;
+  if (rhs->next != nullptr) { rhs->next->prev = lhs; }
+  UnMarkPiece(rhs);
+  DeallocatePiece(rhs);
+}
+
+char* CpuCachingAllocator::AllocateHostMemory(size_t size) {
+  if (use_huge_page_) {
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr == MAP_FAILED) {
+      // no reserved hugetlbfs pages, fall back to transparent huge pages.
+      ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (ptr == MAP_FAILED) { return nullptr; }
+#ifdef MADV_HUGEPAGE
+      madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+    }
+    return reinterpret_cast<char*>(ptr);
+  } else {
+    return reinterpret_cast<char*>(aligned_alloc(kHostAlignSize, size));
+  }
+}
+
+void CpuCachingAllocator::DeallocateHostMemory(char* ptr, size_t size) {
+  if (use_huge_page_) {
+    PCHECK(munmap(ptr, size) == 0);
+  } else {
+    std::free(ptr);
+  }
+}
+
+bool CpuCachingAllocator::AllocateBlockToExtendTotalMem(size_t aligned_size) {
+  CHECK(IsAlignedSize(aligned_size));
+
+  size_t allocate_bytes = aligned_size;
+  if (allocate_bytes < 1048576) {
+    // Allocate 2MB if `allocate_bytes` is less than 1MB
+    allocate_bytes = 2097152;
+  } else if (allocate_bytes < 10485760) {
+    // Allocate 20MB if `allocate_bytes` is between 1MB and 10MB
+    allocate_bytes = 20971520;
+  } else {
+    // Round up to 2MB if `allocate_bytes` is larger than 10MB
+    allocate_bytes = RoundUp(allocate_bytes, kHugePageSize);
+  }
+  const size_t final_allocate_bytes = HostMemAlignedBytes(allocate_bytes);
+  if (final_allocate_bytes < aligned_size) { return false; }
+
+  char* mem_ptr = AllocateHostMemory(final_allocate_bytes);
+  if (mem_ptr == nullptr) { return false; }
+
+  UpdateReservedBytes(final_allocate_bytes);
+
+  Piece* piece = AllocatePiece();
+  piece->size = final_allocate_bytes;
+  piece->ptr = mem_ptr;
+  piece->prev = nullptr;
+  piece->next = nullptr;
+  piece->is_free = true;
+  piece->bin_num = kInvalidBinNum;
+  InsertPiece2Bin(piece);
+  MarkPiece(piece);
+
+  CHECK(mem_ptr2block_.emplace(mem_ptr, Block(piece)).second);
+  block_cnt_.fetch_add(1, std::memory_order_relaxed);
+
+  return true;
+}
+
+void CpuCachingAllocator::ReleaseFreeBlock(char* block_ptr) {
+  auto it = mem_ptr2block_.find(block_ptr);
+  CHECK(it != mem_ptr2block_.end());
+  const Block& block = it->second;
+  const size_t block_size = block.size;
+  CHECK_EQ(block.ptr, block.start_piece->ptr);
+
+  // delete all Piece on Block
+  size_t piece_size_sum = 0;
+  Piece* p = block.start_piece;
+  while (p != nullptr) {
+    Piece* next_p = p->next;
+    CHECK(p->is_free);
+    piece_size_sum += p->size;
+    RemovePieceFromBin(p);
+    UnMarkPiece(p);
+    DeallocatePiece(p);
+    p = next_p;
+  }
+  CHECK_EQ(block_size, piece_size_sum);
+
+  mem_ptr2block_.erase(it);
+  block_cnt_.fetch_sub(1, std::memory_order_relaxed);
+  DeallocateHostMemory(block_ptr, block_size);
+  UpdateReservedBytes(-static_cast<int64_t>(block_size));
+}
+
+bool CpuCachingAllocator::DeallocateFreeBlockForGarbageCollection() {
+  std::vector<char*> free_block_ptrs;
+  for (const auto& pair : mem_ptr2block_) {
+    const Piece* start_piece = pair.second.start_piece;
+    // a free block is made of exactly one free piece since free neighbours are always merged.
+    if (start_piece->is_free && start_piece->next == nullptr) {
+      free_block_ptrs.emplace_back(pair.first);
+    }
+  }
+  for (char* ptr : free_block_ptrs) { ReleaseFreeBlock(ptr); }
+  if (!free_block_ptrs.empty()) {
+    LOG(INFO) << "CpuCachingAllocator release " << free_block_ptrs.size()
+              << " free blocks for garbage collection.";
+  }
+  return !free_block_ptrs.empty();
+}
+
+void CpuCachingAllocator::Allocate(char** mem_ptr, std::size_t size) {
+  if (size == 0) {
+    *mem_ptr = nullptr;
+    return;
+  }
+  allocate_cnt_.fetch_add(1, std::memory_order_relaxed);
+  size_t aligned_size = HostMemAlignedBytes(size);
+
+  Piece* piece = FindPiece(aligned_size);
+  if (piece != nullptr) {
+    cache_hit_cnt_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    if (AllocateBlockToExtendTotalMem(aligned_size)) { piece = FindPiece(aligned_size); }
+  }
+
+  if (piece == nullptr) {
+    if (DeallocateFreeBlockForGarbageCollection() && AllocateBlockToExtendTotalMem(aligned_size)) {
+      piece = FindPiece(aligned_size);
+    }
+  }
+
+  if (piece == nullptr) {
+    LOG(FATAL) << "Error! : Out of memory when allocate size : " << size
+               << ".\n The stat of this CpuCachingAllocator is : " << GetStat().ToString();
+  }
+  CHECK_NOTNULL(piece->ptr);
+  CHECK(ptr2piece_.find(piece->ptr) != ptr2piece_.end());
+  UpdateAllocatedBytes(piece->size);
+  *mem_ptr = piece->ptr;
+}
+
+void CpuCachingAllocator::Deallocate(char* mem_ptr, std::size_t size) {
+  if (mem_ptr == nullptr) { return; }
+
+  auto it = ptr2piece_.find(mem_ptr);
+  CHECK(it != ptr2piece_.end()) << "Error! : Try deallocate mem_ptr non-existent. mem ptr = "
+                                << mem_ptr << " size = " << size;
+  Piece* piece = it->second;
+  CHECK_NOTNULL(piece);
+  CHECK_EQ(piece->ptr, mem_ptr);
+  CHECK(!piece->is_free);
+
+  piece->is_free = true;
+  UpdateAllocatedBytes(-static_cast<int64_t>(piece->size));
+
+  Piece* last_piece_insert_to_bin = piece;
+  Piece* next_p = piece->next;
+  Piece* prev_p = piece->prev;
+
+  if (next_p != nullptr && next_p->is_free) {
+    CHECK_EQ(next_p->ptr, piece->ptr + piece->size);
+    RemovePieceFromBin(next_p);
+    MergeNeighbourFreePiece(piece, next_p);
+  }
+
+  if (prev_p != nullptr && prev_p->is_free) {
+    CHECK_EQ(piece->ptr, prev_p->ptr + prev_p->size);
+    RemovePieceFromBin(prev_p);
+    MergeNeighbourFreePiece(prev_p, piece);
+    last_piece_insert_to_bin = prev_p;
+  }
+  InsertPiece2Bin(last_piece_insert_to_bin);
+
+  if (last_piece_insert_to_bin->prev == nullptr && last_piece_insert_to_bin->next == nullptr) {
+    // the whole block is free now.
+    const int64_t cached_free_bytes = reserved_bytes_.load(std::memory_order_relaxed)
+                                      - allocated_bytes_.load(std::memory_order_relaxed);
+    if (cached_free_bytes > static_cast<int64_t>(release_threshold_)) {
+      ReleaseFreeBlock(last_piece_insert_to_bin->ptr);
+    }
+  }
+}
+
+ThreadLocalCachingAllocator::ThreadLocalCachingAllocator(
+    std::unique_ptr<Allocator>&& thread_safe_backend, size_t max_cached_bytes_per_thread)
+    : Allocator(),
+      uid_([]() {
+        static std::atomic<int64_t> uid_cnt(0);
+        return uid_cnt++;
+      }()),
+      backend_(std::move(thread_safe_backend)),
+      max_cached_bytes_per_thread_(max_cached_bytes_per_thread),
+      cache_hit_cnt_(0) {}
+
+ThreadLocalCachingAllocator::~ThreadLocalCachingAllocator() {
+  std::unique_lock<std::mutex> lock(thread_caches_mutex_);
+  for (const auto& thread_cache : thread_caches_) {
+    FOR_RANGE(int32_t, size_class, 0, kSizeClassNum) {
+      for (char* ptr : thread_cache->free_list[size_class]) {
+        backend_->Deallocate(ptr, Size4SizeClass(size_class));
+      }
+    }
+  }
+}
+
+int32_t ThreadLocalCachingAllocator::SizeClass4Size(size_t size) {
+  uint64_t value = (std::max(size, kHostAlignSize) - 1) >> 6;
+  const int32_t size_class = value == 0 ? 0 : static_cast<int32_t>(64 - __builtin_clzll(value));
+  return size_class < kSizeClassNum ? size_class : -1;
+}
+
+ThreadLocalCachingAllocator::ThreadCache* ThreadLocalCachingAllocator::GetThreadCache() {
+  // uid_ is never reused, so the entries of destructed allocators are never hit again.
+  thread_local HashMap<int64_t, ThreadCache*> uid2thread_cache;
+  auto it = uid2thread_cache.find(uid_);
+  if (it != uid2thread_cache.end()) { return it->second; }
+  std::unique_lock<std::mutex> lock(thread_caches_mutex_);
+  thread_caches_.emplace_back(new ThreadCache());
+  ThreadCache* thread_cache = thread_caches_.back().get();
+  uid2thread_cache.emplace(uid_, thread_cache);
+  return thread_cache;
+}
+
+void ThreadLocalCachingAllocator::Allocate(char** mem_ptr, std::size_t size) {
+  const int32_t size_class = SizeClass4Size(size);
+  if (size == 0 || size_class < 0) {
+    backend_->Allocate(mem_ptr, size);
+    return;
+  }
+  ThreadCache* thread_cache = GetThreadCache();
+  auto* free_list = &thread_cache->free_list[size_class];
+  if (!free_list->empty()) {
+    *mem_ptr = free_list->back();
+    free_list->pop_back();
+    thread_cache->cached_bytes -= Size4SizeClass(size_class);
+    cache_hit_cnt_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  backend_->Allocate(mem_ptr, Size4SizeClass(size_class));
+}
+
+void ThreadLocalCachingAllocator::Deallocate(char* mem_ptr, std::size_t size) {
+  if (mem_ptr == nullptr) { return; }
+  const int32_t size_class = SizeClass4Size(size);
+  if (size == 0 || size_class < 0) {
+    backend_->Deallocate(mem_ptr, size);
+    return;
+  }
+  const size_t class_size = Size4SizeClass(size_class);
+  ThreadCache* thread_cache = GetThreadCache();
+  if (thread_cache->cached_bytes + class_size > max_cached_bytes_per_thread_) {
+    backend_->Deallocate(mem_ptr, class_size);
+    return;
+  }
+  thread_cache->free_list[size_class].emplace_back(mem_ptr);
+  thread_cache->cached_bytes += class_size;
+}
+
+EagerCpuAllocator::EagerCpuAllocator() : Allocator(), caching_allocator_(nullptr) {
+  if (!ParseBooleanFromEnv("ONEFLOW_EAGER_CPU_ALLOCATOR_ENABLE_CACHING", true)) {
+    allocator_.reset(new CpuAllocator());
+    return;
+  }
+  const bool use_huge_page = ParseBooleanFromEnv("ONEFLOW_EAGER_CPU_ALLOCATOR_USE_HUGE_PAGE", false);
+  const int64_t release_threshold_mb =
+      ParseIntegerFromEnv("ONEFLOW_EAGER_CPU_ALLOCATOR_RELEASE_THRESHOLD_MB", 1024);
+  const int64_t thread_cache_bytes =
+      ParseIntegerFromEnv("ONEFLOW_EAGER_CPU_ALLOCATOR_THREAD_CACHE_BYTES", 0);
+  auto* caching_allocator = new CpuCachingAllocator(use_huge_page, release_threshold_mb << 20);
+  caching_allocator_ = caching_allocator;
+  allocator_.reset(new ThreadSafeAllocator(std::unique_ptr<Allocator>(caching_allocator)));
+  if (thread_cache_bytes > 0) {
+    allocator_.reset(new ThreadLocalCachingAllocator(std::move(allocator_), thread_cache_bytes));
+  }
+}
+
+COMMAND(Global<EagerCpuAllocator>::SetAllocated(new EagerCpuAllocator()));
+
+}  // namespace vm
+}  // namespace oneflow
@@ -0,0 +1,201 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_VM_CPU_CACHING_ALLOCATOR_H_
+#define ONEFLOW_CORE_VM_CPU_CACHING_ALLOCATOR_H_
+
+#include <cstdint>
+#include "oneflow/core/vm/allocator.h"
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+namespace vm {
+
+struct CpuCachingAllocatorStat {
+  int64_t allocate_cnt = 0;
+  // number of allocations served from cached memory without allocating a new block
+  int64_t cache_hit_cnt = 0;
+  int64_t allocated_bytes = 0;
+  int64_t reserved_bytes = 0;
+  int64_t peak_allocated_bytes = 0;
+  int64_t peak_reserved_bytes = 0;
+  int64_t block_cnt = 0;
+
+  double HitRate() const;
+  // the ratio of reserved bytes which are not allocated
+  double Fragmentation() const;
+  std::string ToString() const;
+};
+
+// Host memory allocator with the Bin/Piece/Block design of CudaAllocator.
+// Not thread safe, wrap it with ThreadSafeAllocator when it is shared by threads.
+class CpuCachingAllocator final : public Allocator {
+ public:
+  // Blocks are mmapped with 2MiB huge pages if use_huge_page is true. Fully free blocks are
+  // returned to the system as soon as the cached free bytes exceed release_threshold.
+  CpuCachingAllocator(bool use_huge_page, size_t release_threshold);
+  ~CpuCachingAllocator() override;
+
+  void Allocate(char** mem_ptr, std::size_t size) override;
+  void Deallocate(char* mem_ptr, std::size_t size) override;
+
+  // May be called from any thread.
+  CpuCachingAllocatorStat GetStat() const;
+
+ private:
+  static constexpr int32_t kInvalidBinNum = -1;
+  static constexpr int32_t kBinNumSize = 24;
+
+  // Same as CudaAllocator::Piece.
+  struct Piece {
+    size_t size = 0;
+    char* ptr = nullptr;
+    bool is_free = false;
+    Piece* prev = nullptr;
+    Piece* next = nullptr;
+    int32_t bin_num = kInvalidBinNum;
+  };
+
+  // Bins are sized by powers of two from kHostAlignSize:
+  //    BinNum:   Bin0, Bin1, Bin2, Bin3, ..., Bin23
+  //    BinSize:  64,   128,  256,  512,  ..., 512MB
+  struct Bin {
+    size_t size = 0;
+
+    struct PieceCmp {
+      bool operator()(const Piece* lhs, const Piece* rhs) const {
+        if (lhs->size != rhs->size) { return lhs->size < rhs->size; }
+        return lhs->ptr < rhs->ptr;
+      }
+    };
+    std::set<Piece*, PieceCmp> pieces;
+  };
+
+  struct Block {
+    size_t size = 0;
+    char* ptr = nullptr;
+    Piece* start_piece = nullptr;
+    Block(Piece* p) : size(p->size), ptr(p->ptr), start_piece(p) {}
+  };
+
+  size_t BinSize4BinNum(int32_t bin_num) { return kHostAlignSize << bin_num; }
+
+  int32_t BinNum4BinSize(size_t size) {
+    uint64_t value = std::max(size, kHostAlignSize) >> 6;
+    return std::min(kBinNumSize - 1, static_cast<int32_t>(63 ^ __builtin_clzll(value)));
+  }
+
+  Piece* FindPiece(size_t aligned_size);
+  void InsertPiece2Bin(Piece* piece);
+  Piece* AllocatePiece();
+  void DeallocatePiece(Piece* piece);
+  void MarkPiece(Piece* piece);
+  void UnMarkPiece(Piece* piece);
+  void MergeNeighbourFreePiece(Piece* lhs, Piece* rhs);
+  void RemovePieceFromBin(Piece* piece);
+
+  char* AllocateHostMemory(size_t size);
+  void DeallocateHostMemory(char* ptr, size_t size);
+  bool AllocateBlockToExtendTotalMem(size_t aligned_size);
+  // Returns the memory of a block back to the system, all its pieces must be free.
+  void ReleaseFreeBlock(char* block_ptr);
+  bool DeallocateFreeBlockForGarbageCollection();
+
+  void UpdateAllocatedBytes(int64_t delta);
+  void UpdateReservedBytes(int64_t delta);
+
+  const bool use_huge_page_;
+  const size_t release_threshold_;
+  HashMap<char*, Block> mem_ptr2block_;
+
+  std::vector<Bin> bins_;
+  std::vector<std::unique_ptr<Piece>> pieces_;
+  HashMap<char*, Piece*> ptr2piece_;
+  Piece* recycle_piece_list_;
+
+  std::atomic<int64_t> allocate_cnt_;
+  std::atomic<int64_t> cache_hit_cnt_;
+  std::atomic<int64_t> allocated_bytes_;
+  std::atomic<int64_t> reserved_bytes_;
+  std::atomic<int64_t> peak_allocated_bytes_;
+  std::atomic<int64_t> peak_reserved_bytes_;
+  std::atomic<int64_t> block_cnt_;
+};
+
+// Per-thread free lists of power-of-two size classes in front of a thread safe backend, so that
+// the hot small allocations of a thread do not contend the backend lock. Memory freed on another
+// thread goes to the cache of the freeing thread.
+class ThreadLocalCachingAllocator final : public Allocator {
+ public:
+  ThreadLocalCachingAllocator(std::unique_ptr<Allocator>&& thread_safe_backend,
+                              size_t max_cached_bytes_per_thread);
+  ~ThreadLocalCachingAllocator() override;
+
+  void Allocate(char** mem_ptr, std::size_t size) override;
+  void Deallocate(char* mem_ptr, std::size_t size) override;
+
+  int64_t cache_hit_cnt() const { return cache_hit_cnt_.load(std::memory_order_relaxed); }
+
+ private:
+  static constexpr int32_t kSizeClassNum = 15;  // 64B ~ 1MiB
+
+  struct ThreadCache {
+    std::vector<char*> free_list[kSizeClassNum];
+    size_t cached_bytes = 0;
+  };
+
+  static size_t Size4SizeClass(int32_t size_class) { return kHostAlignSize << size_class; }
+  // Returns -1 if size is too large to be cached.
+  static int32_t SizeClass4Size(size_t size);
+  ThreadCache* GetThreadCache();
+
+  const int64_t uid_;
+  std::unique_ptr<Allocator> backend_;
+  const size_t max_cached_bytes_per_thread_;
+  std::mutex thread_caches_mutex_;
+  std::vector<std::unique_ptr<ThreadCache>> thread_caches_;
+  std::atomic<int64_t> cache_hit_cnt_;
+};
+
+// Allocator of eager cpu blobs:
+//   ThreadLocalCachingAllocator (optional) -> ThreadSafeAllocator -> CpuCachingAllocator
+// Configured by environment variables:
+//   ONEFLOW_EAGER_CPU_ALLOCATOR_ENABLE_CACHING: false to use CpuAllocator directly
+//   ONEFLOW_EAGER_CPU_ALLOCATOR_THREAD_CACHE_BYTES: per-thread cache size, 0 to disable
+//   ONEFLOW_EAGER_CPU_ALLOCATOR_USE_HUGE_PAGE: allocate blocks with 2MiB huge pages
+//   ONEFLOW_EAGER_CPU_ALLOCATOR_RELEASE_THRESHOLD_MB: cached free memory kept from the system
+class EagerCpuAllocator final : public Allocator {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(EagerCpuAllocator);
+  EagerCpuAllocator();
+  ~EagerCpuAllocator() override = default;
+
+  void Allocate(char** mem_ptr, std::size_t size) override { allocator_->Allocate(mem_ptr, size); }
+  void Deallocate(char* mem_ptr, std::size_t size) override {
+    allocator_->Deallocate(mem_ptr, size);
+  }
+
+  // Returns nullptr if caching is disabled.
+  const CpuCachingAllocator* caching_allocator() const { return caching_allocator_; }
+
+ private:
+  std::unique_ptr<Allocator> allocator_;
+  const CpuCachingAllocator* caching_allocator_;
+};
+
+}  // namespace vm
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_VM_CPU_CACHING_ALLOCATOR_H_
@@ -0,0 +1,109 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/vm/cpu_caching_allocator.h"
+#include "oneflow/core/vm/thread_safe_allocator.h"
+
+namespace oneflow {
+namespace vm {
+
+namespace {
+
+void TestAllocator(Allocator* a) {
+  std::vector<char*> ptrs;
+  for (int i = 0; i < 512; ++i) {
+    char* ptr = nullptr;
+    a->Allocate(&ptr, 1);
+    ASSERT_TRUE(ptr != nullptr);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) % kHostAlignSize, 0);
+    ptrs.emplace_back(ptr);
+  }
+  std::sort(ptrs.begin(), ptrs.end());
+  for (int i = 0; i < 512; ++i) {
+    if (i > 0) {
+      ASSERT_TRUE(ptrs.at(i) != ptrs.at(i - 1));
+      ASSERT_TRUE(std::abs(ptrs.at(i) - ptrs.at(i - 1)) >= kHostAlignSize);
+    }
+    a->Deallocate(ptrs.at(i), 1);
+  }
+
+  char* data_ptr_1 = nullptr;
+  a->Allocate(&data_ptr_1, 2048 * sizeof(float));
+  char* data_ptr_2 = nullptr;
+  a->Allocate(&data_ptr_2, 4096 * sizeof(double));
+  ASSERT_TRUE(data_ptr_1 != data_ptr_2);
+  if (data_ptr_1 < data_ptr_2) {
+    ASSERT_TRUE(data_ptr_1 + 2048 * sizeof(float) <= data_ptr_2);
+  } else {
+    ASSERT_TRUE(data_ptr_2 + 4096 * sizeof(double) <= data_ptr_1);
+  }
+  std::memset(data_ptr_1, 0, 2048 * sizeof(float));
+  std::memset(data_ptr_2, 0, 4096 * sizeof(double));
+  a->Deallocate(data_ptr_2, 4096 * sizeof(double));
+  a->Deallocate(data_ptr_1, 2048 * sizeof(float));
+}
+
+}  // namespace
+
+TEST(CpuCachingAllocator, cpu_caching_allocator) {
+  CpuCachingAllocator allocator(false, 0);
+  TestAllocator(&allocator);
+  CpuCachingAllocatorStat stat = allocator.GetStat();
+  ASSERT_EQ(stat.allocate_cnt, 514);
+  ASSERT_GT(stat.HitRate(), 0.99);
+  ASSERT_EQ(stat.allocated_bytes, 0);
+  ASSERT_GT(stat.peak_allocated_bytes, 0);
+  // every block became free and the release threshold is 0.
+  ASSERT_EQ(stat.reserved_bytes, 0);
+  ASSERT_EQ(stat.block_cnt, 0);
+}
+
+TEST(CpuCachingAllocator, release_threshold) {
+  CpuCachingAllocator allocator(false, 64 << 20);
+  char* ptr = nullptr;
+  allocator.Allocate(&ptr, 1 << 20);
+  allocator.Deallocate(ptr, 1 << 20);
+  CpuCachingAllocatorStat stat = allocator.GetStat();
+  ASSERT_EQ(stat.allocated_bytes, 0);
+  ASSERT_GT(stat.reserved_bytes, 0);
+  ASSERT_DOUBLE_EQ(stat.Fragmentation(), 1.0);
+  char* reused_ptr = nullptr;
+  allocator.Allocate(&reused_ptr, 1 << 20);
+  ASSERT_EQ(ptr, reused_ptr);
+  allocator.Deallocate(reused_ptr, 1 << 20);
+}
+
+TEST(CpuCachingAllocator, huge_page) {
+  CpuCachingAllocator allocator(true, 0);
+  TestAllocator(&allocator);
+}
+
+TEST(ThreadLocalCachingAllocator, multi_thread) {
+  auto* caching_allocator = new CpuCachingAllocator(false, 0);
+  std::unique_ptr<Allocator> backend(
+      new ThreadSafeAllocator(std::unique_ptr<Allocator>(caching_allocator)));
+  ThreadLocalCachingAllocator allocator(std::move(backend), 1 << 20);
+  std::vector<std::thread> threads;
+  FOR_RANGE(int, i, 0, 4) {
+    threads.emplace_back([&allocator]() {
+      FOR_RANGE(int, j, 0, 4) { TestAllocator(&allocator); }
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
+  ASSERT_GT(allocator.cache_hit_cnt(), 0);
+}
+
+}  // namespace vm
+}  // namespace oneflow
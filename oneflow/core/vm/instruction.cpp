@@ -92,6 +92,14 @@ void InstructionMsg::__Init__(VirtualMachineEngine* vm, const std::string& instr
   phy_instr_operand_ = phy_instr_operand;
 }
 
+void InstructionMsg::__Delete__() {
+  instr_type_id_.clear();
+  phy_instr_parallel_desc_.reset();
+  operand_list_.Reset();
+  phy_instr_operand_.reset();
+  phy_instr_stream_ = nullptr;
+}
+
 void InstructionMsg::__Init__(const InstructionProto& proto) { InitFromProto(this, proto); }
 void InstructionMsg::__Init__(const cfg::InstructionProto& proto) { InitFromProto(this, proto); }
 
@@ -241,11 +249,11 @@ intrusive::shared_ptr<InstructionMsg> InstructionMsg::add_del_operand(ObjectId l
 }
 
 intrusive::shared_ptr<InstructionMsg> InstructionMsg::Clone() const {
-  return intrusive::make_shared<InstructionMsg>(*this);
+  return NewInstructionMsg(*this);
 }
 
 intrusive::shared_ptr<InstructionMsg> InstructionMsg::MakeInferInstrMsg() const {
-  auto infer_instr_msg = intrusive::make_shared<InstructionMsg>(*this);
+  auto infer_instr_msg = NewInstructionMsg(*this);
   auto* stream_type_id = infer_instr_msg->mut_instr_type_id()->mut_stream_type_id();
   CHECK_EQ(stream_type_id->interpret_type(), InterpretType::kCompute);
   stream_type_id->CopyFrom(LookupInferStreamTypeId(*stream_type_id));
@@ -54,7 +54,12 @@ class InstructionOperandList final : public intrusive::Base {
 
 class VirtualMachineEngine;
 
-class InstructionMsg final : public intrusive::Base {
+// Instruction messages are built on the user threads and released on the scheduler and worker
+// threads, they are recycled through per thread pools. Use NewInstructionMsg to create them.
+class InstructionMsg final
+    : public intrusive::Base,
+      public intrusive::EnableObjectPool<InstructionMsg,
+                                         intrusive::kThreadLocalAndDisableDestruct> {
  public:
   // Getters
   bool has_parallel_desc_symbol_id() const { return 0 != parallel_desc_symbol_id_; }
@@ -92,6 +97,7 @@ class InstructionMsg final : public intrusive::Base {
   void __Init__(const InstructionProto& proto);
   void __Init__(const cfg::InstructionProto& proto);
   void __Init__(const InstructionMsg& instr_msg);
+  void __Delete__();
 
   void ToProto(InstructionProto* proto) const;
   intrusive::shared_ptr<InstructionMsg> add_parallel_desc(int64_t symbol_id);
@@ -130,6 +136,7 @@ class InstructionMsg final : public intrusive::Base {
  private:
   InstructionOperand* add_instr_operand();
   friend class intrusive::Ref;
+  friend class intrusive::ObjectPool<InstructionMsg, intrusive::kThreadLocalAndDisableDestruct>;
   intrusive::Ref* mut_intrusive_ref() { return &intrusive_ref_; }
 
   InstructionMsg()
@@ -160,6 +167,12 @@ class InstructionMsg final : public intrusive::Base {
 
 using InstructionMsgList = intrusive::List<INTRUSIVE_FIELD(InstructionMsg, instr_msg_hook_)>;
 
+template<typename... Args>
+intrusive::shared_ptr<InstructionMsg> NewInstructionMsg(Args&&... args) {
+  return InstructionMsg::object_pool_type::ThisThreadPool()->make_shared(
+      std::forward<Args>(args)...);
+}
+
 template<OperandMemZoneModifier mem_zone_modifier>
 void CheckOperand(const Operand& operand);
 
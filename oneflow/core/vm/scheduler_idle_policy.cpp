@@ -0,0 +1,87 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/vm/scheduler_idle_policy.h"
+
+namespace oneflow {
+
+namespace vm {
+
+namespace {
+
+constexpr int64_t kDefaultWorkingMicroseconds = 1000;
+constexpr int64_t kDefaultMinWorkingMicroseconds = 10;
+// Spin for kAdaptiveSpinFactor times the average gap, so most gaps end before the thread parks.
+constexpr double kAdaptiveSpinFactor = 2;
+// Weight of the newest gap in the exponential moving average.
+constexpr double kAdaptiveGapWeight = 0.125;
+
+class FixedSchedulerIdlePolicy final : public SchedulerIdlePolicy {
+ public:
+  explicit FixedSchedulerIdlePolicy(int64_t working_us) : working_us_(working_us) {}
+  ~FixedSchedulerIdlePolicy() override = default;
+
+  int64_t WorkingMicroseconds() const override { return working_us_; }
+
+ private:
+  int64_t working_us_;
+};
+
+int64_t WorkingMicrosecondsFromEnv() {
+  return std::max<int64_t>(
+      ParseIntegerFromEnv("ONEFLOW_VM_SCHEDULER_WORKING_MICROSECONDS", kDefaultWorkingMicroseconds),
+      0);
+}
+
+}  // namespace
+
+constexpr int64_t SchedulerIdlePolicy::kSpinForever;
+
+int64_t AdaptiveSchedulerIdlePolicy::WorkingMicroseconds() const {
+  const double working_us = avg_gap_us_ * kAdaptiveSpinFactor;
+  // the next gap is likely long as well, spinning through part of it only burns the core
+  if (working_us > max_working_us_) { return 0; }
+  return std::max(static_cast<int64_t>(working_us), min_working_us_);
+}
+
+void AdaptiveSchedulerIdlePolicy::OnIdleGap(int64_t gap_us) {
+  avg_gap_us_ += (gap_us - avg_gap_us_) * kAdaptiveGapWeight;
+}
+
+std::unique_ptr<SchedulerIdlePolicy> NewSchedulerIdlePolicy() {
+  const std::string policy = GetStringFromEnv("ONEFLOW_VM_SCHEDULER_IDLE_POLICY", "fixed");
+  if (policy == "fixed") {
+    return std::make_unique<FixedSchedulerIdlePolicy>(WorkingMicrosecondsFromEnv());
+  } else if (policy == "spin") {
+    return std::make_unique<FixedSchedulerIdlePolicy>(SchedulerIdlePolicy::kSpinForever);
+  } else if (policy == "park") {
+    return std::make_unique<FixedSchedulerIdlePolicy>(0);
+  } else if (policy == "adaptive") {
+    const int64_t max_working_us = WorkingMicrosecondsFromEnv();
+    const int64_t min_working_us = std::min(
+        std::max<int64_t>(ParseIntegerFromEnv("ONEFLOW_VM_SCHEDULER_MIN_WORKING_MICROSECONDS",
+                                              kDefaultMinWorkingMicroseconds),
+                          0),
+        max_working_us);
+    return std::make_unique<AdaptiveSchedulerIdlePolicy>(min_working_us, max_working_us);
+  }
+  LOG(FATAL) << "invalid env ONEFLOW_VM_SCHEDULER_IDLE_POLICY " << policy
+             << ", expected fixed, spin, park or adaptive";
+  return nullptr;
+}
+
+}  // namespace vm
+
+}  // namespace oneflow
@@ -0,0 +1,71 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_VM_SCHEDULER_IDLE_POLICY_H_
+#define ONEFLOW_CORE_VM_SCHEDULER_IDLE_POLICY_H_
+
+#include <limits>
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+namespace vm {
+
+// Decides how long the scheduler thread keeps spinning on an idle vm before it parks on the
+// notifier. Spinning through short gaps between instructions saves the 5-10 microseconds of a
+// thread wakeup, parking frees the core.
+class SchedulerIdlePolicy {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SchedulerIdlePolicy);
+  SchedulerIdlePolicy() = default;
+  virtual ~SchedulerIdlePolicy() = default;
+
+  static constexpr int64_t kSpinForever = std::numeric_limits<int64_t>::max();
+
+  // Microseconds the idle vm is scheduled before the scheduler thread parks.
+  virtual int64_t WorkingMicroseconds() const = 0;
+  // Called with the length of every idle gap that was ended by new instructions.
+  virtual void OnIdleGap(int64_t gap_us) {}
+};
+
+// ONEFLOW_VM_SCHEDULER_IDLE_POLICY selects the policy:
+//   fixed (default): spin for ONEFLOW_VM_SCHEDULER_WORKING_MICROSECONDS (1000) then park.
+//   spin: never park, for latency critical processes owning a core.
+//   park: park as soon as the vm is idle, for shared hosts.
+//   adaptive: spin for twice the recent average idle gap, bounded by
+//     ONEFLOW_VM_SCHEDULER_MIN_WORKING_MICROSECONDS and ONEFLOW_VM_SCHEDULER_WORKING_MICROSECONDS.
+//     Park right away when the gaps are longer than the upper bound.
+std::unique_ptr<SchedulerIdlePolicy> NewSchedulerIdlePolicy();
+
+class AdaptiveSchedulerIdlePolicy final : public SchedulerIdlePolicy {
+ public:
+  AdaptiveSchedulerIdlePolicy(int64_t min_working_us, int64_t max_working_us)
+      : min_working_us_(min_working_us), max_working_us_(max_working_us), avg_gap_us_(0) {}
+  ~AdaptiveSchedulerIdlePolicy() override = default;
+
+  int64_t WorkingMicroseconds() const override;
+  void OnIdleGap(int64_t gap_us) override;
+
+ private:
+  int64_t min_working_us_;
+  int64_t max_working_us_;
+  double avg_gap_us_;
+};
+
+}  // namespace vm
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_VM_SCHEDULER_IDLE_POLICY_H_
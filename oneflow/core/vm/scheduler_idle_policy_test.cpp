@@ -0,0 +1,69 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include "oneflow/core/vm/scheduler_idle_policy.h"
+#include "oneflow/core/vm/scheduler_telemetry.h"
+
+namespace oneflow {
+namespace vm {
+namespace test {
+
+TEST(AdaptiveSchedulerIdlePolicy, learn_idle_gaps) {
+  AdaptiveSchedulerIdlePolicy policy(10, 1000);
+  ASSERT_EQ(policy.WorkingMicroseconds(), 10);
+  // short gaps make the scheduler spin through them
+  for (int i = 0; i < 100; ++i) { policy.OnIdleGap(100); }
+  ASSERT_GE(policy.WorkingMicroseconds(), 190);
+  ASSERT_LE(policy.WorkingMicroseconds(), 200);
+  // gaps longer than the upper bound are not worth spinning for, the scheduler parks at once
+  for (int i = 0; i < 100; ++i) { policy.OnIdleGap(100000); }
+  ASSERT_EQ(policy.WorkingMicroseconds(), 0);
+  // tiny gaps are bounded below
+  for (int i = 0; i < 200; ++i) { policy.OnIdleGap(1); }
+  ASSERT_EQ(policy.WorkingMicroseconds(), 10);
+}
+
+TEST(SchedulerIdlePolicy, policy_from_env) {
+  setenv("ONEFLOW_VM_SCHEDULER_IDLE_POLICY", "spin", 1);
+  ASSERT_EQ(NewSchedulerIdlePolicy()->WorkingMicroseconds(), SchedulerIdlePolicy::kSpinForever);
+  setenv("ONEFLOW_VM_SCHEDULER_IDLE_POLICY", "park", 1);
+  ASSERT_EQ(NewSchedulerIdlePolicy()->WorkingMicroseconds(), 0);
+  setenv("ONEFLOW_VM_SCHEDULER_IDLE_POLICY", "fixed", 1);
+  setenv("ONEFLOW_VM_SCHEDULER_WORKING_MICROSECONDS", "300", 1);
+  ASSERT_EQ(NewSchedulerIdlePolicy()->WorkingMicroseconds(), 300);
+  unsetenv("ONEFLOW_VM_SCHEDULER_WORKING_MICROSECONDS");
+  unsetenv("ONEFLOW_VM_SCHEDULER_IDLE_POLICY");
+  ASSERT_EQ(NewSchedulerIdlePolicy()->WorkingMicroseconds(), 1000);
+}
+
+TEST(LatencyHistogram, buckets) {
+  ASSERT_EQ(LatencyHistogram::BucketIndex(0), 0);
+  ASSERT_EQ(LatencyHistogram::BucketIndex(1), 1);
+  ASSERT_EQ(LatencyHistogram::BucketIndex(3), 2);
+  ASSERT_EQ(LatencyHistogram::BucketIndex(4), 3);
+  ASSERT_EQ(LatencyHistogram::BucketIndex(int64_t(1) << 40), LatencyHistogram::kBucketNum - 1);
+  LatencyHistogram histogram;
+  for (int i = 0; i < 99; ++i) { histogram.Record(5); }
+  histogram.Record(5000);
+  ASSERT_EQ(histogram.TotalCnt(), 100);
+  ASSERT_EQ(histogram.QuantileUpperBound(0.5), 8);
+  ASSERT_EQ(histogram.QuantileUpperBound(0.99), 8);
+  ASSERT_EQ(histogram.QuantileUpperBound(1), 8192);
+}
+
+}  // namespace test
+}  // namespace vm
+}  // namespace oneflow
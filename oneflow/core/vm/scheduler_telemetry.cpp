@@ -0,0 +1,63 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/vm/scheduler_telemetry.h"
+
+namespace oneflow {
+
+namespace vm {
+
+constexpr int LatencyHistogram::kBucketNum;
+
+int64_t LatencyHistogram::TotalCnt() const {
+  int64_t total = 0;
+  FOR_RANGE(int, i, 0, kBucketNum) { total += bucket_cnt(i); }
+  return total;
+}
+
+int64_t LatencyHistogram::QuantileUpperBound(double quantile) const {
+  const int64_t total = TotalCnt();
+  if (total == 0) { return 0; }
+  int64_t cnt = 0;
+  FOR_RANGE(int, i, 0, kBucketNum) {
+    cnt += bucket_cnt(i);
+    if (cnt >= quantile * total) { return int64_t(1) << i; }
+  }
+  return int64_t(1) << (kBucketNum - 1);
+}
+
+std::string LatencyHistogram::ToString() const {
+  std::stringstream ss;
+  ss << "cnt " << TotalCnt() << ", p50 <" << QuantileUpperBound(0.5) << "us, p99 <"
+     << QuantileUpperBound(0.99) << "us, buckets [";
+  FOR_RANGE(int, i, 0, kBucketNum) { ss << (i > 0 ? " " : "") << bucket_cnt(i); }
+  ss << "]";
+  return ss.str();
+}
+
+std::string SchedulerTelemetry::ToString() const {
+  const int64_t wakeups = std::max<int64_t>(wakeup_num.load(), 1);
+  std::stringstream ss;
+  ss << "wakeups " << wakeup_num.load() << ", schedules " << schedule_num.load()
+     << ", idle schedules " << idle_schedule_num.load() << ", instructions "
+     << received_instruction_num.load() << " (" << received_instruction_num.load() / wakeups
+     << " per wakeup, max " << max_instruction_num_per_wakeup.load() << "), pending latency {"
+     << pending_latency_us.ToString() << "}, idle gap {" << idle_gap_us.ToString() << "}";
+  return ss.str();
+}
+
+}  // namespace vm
+
+}  // namespace oneflow
@@ -0,0 +1,87 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_VM_SCHEDULER_TELEMETRY_H_
+#define ONEFLOW_CORE_VM_SCHEDULER_TELEMETRY_H_
+
+#include <array>
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+namespace vm {
+
+// Histogram over power of two microsecond buckets: bucket 0 counts [0, 1us), bucket i counts
+// [2^(i-1), 2^i) us and the last bucket everything above.
+class LatencyHistogram final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(LatencyHistogram);
+  LatencyHistogram() : bucket_cnts_() {}
+  ~LatencyHistogram() = default;
+
+  static constexpr int kBucketNum = 24;
+
+  static int BucketIndex(int64_t us) {
+    if (us <= 0) { return 0; }
+    const int index = 64 - __builtin_clzll(static_cast<uint64_t>(us));
+    return std::min(index, kBucketNum - 1);
+  }
+
+  void Record(int64_t us) {
+    bucket_cnts_[BucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+  }
+  int64_t bucket_cnt(int index) const {
+    return bucket_cnts_[index].load(std::memory_order_relaxed);
+  }
+  int64_t TotalCnt() const;
+  // Upper bound in microseconds of the bucket holding the given quantile, e.g. 0.99.
+  int64_t QuantileUpperBound(double quantile) const;
+  std::string ToString() const;
+
+ private:
+  std::array<std::atomic<int64_t>, kBucketNum> bucket_cnts_;
+};
+
+// Counters of VirtualMachine::Loop. Written by the scheduler thread and by the threads receiving
+// instructions, readable from anywhere.
+struct SchedulerTelemetry final {
+  SchedulerTelemetry()
+      : wakeup_num(0),
+        schedule_num(0),
+        idle_schedule_num(0),
+        received_instruction_num(0),
+        max_instruction_num_per_wakeup(0) {}
+
+  // times the scheduler thread left the notifier
+  std::atomic<int64_t> wakeup_num;
+  // calls of VirtualMachineEngine::Schedule
+  std::atomic<int64_t> schedule_num;
+  // schedules which found the vm idle, i.e. spinning
+  std::atomic<int64_t> idle_schedule_num;
+  std::atomic<int64_t> received_instruction_num;
+  std::atomic<int64_t> max_instruction_num_per_wakeup;
+  // from an instruction reaching the empty pending list to the schedule that handles it
+  LatencyHistogram pending_latency_us;
+  // gaps between the vm going idle and new instructions arriving
+  LatencyHistogram idle_gap_us;
+
+  std::string ToString() const;
+};
+
+}  // namespace vm
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_VM_SCHEDULER_TELEMETRY_H_
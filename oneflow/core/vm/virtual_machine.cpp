@@ -95,7 +95,9 @@ void GetWorkerThreadInitializer(intrusive::shared_ptr<vm::VirtualMachineEngine>
 
 VirtualMachine::VirtualMachine(const Resource& resource, int64_t this_machine_id)
     : vm_(intrusive::make_shared<vm::VirtualMachineEngine>(
-        vm::MakeVmDesc(resource, this_machine_id).Get())) {
+        vm::MakeVmDesc(resource, this_machine_id).Get())),
+      idle_policy_(vm::NewSchedulerIdlePolicy()),
+      pending_since_ns_(0) {
   OF_PROFILER_NAME_THIS_HOST_THREAD("_VM::Main");
   std::function<void()> SchedulerInitializer;
   GetSchedulerThreadInitializer(&SchedulerInitializer);
@@ -115,13 +117,38 @@ namespace {
 void MakeCtrlSeqInstructions(vm::VirtualMachineEngine* vm, vm::InstructionMsgList* list,
                              const std::function<void()>& ComputeCallback) {
   const auto& phy_instr_operand = std::make_shared<vm::NoArgCbPhyInstrOperand>(ComputeCallback);
-  auto instruction = intrusive::make_shared<vm::InstructionMsg>(
+  auto instruction = vm::NewInstructionMsg(
       vm, "CtrlComputeRankFrontSeqCallback", std::shared_ptr<const ParallelDesc>(),
       phy_instr_operand);
   instruction->add_int64_operand(GlobalProcessCtx::Rank());
   list->EmplaceBack(std::move(instruction));
 }
 
+int64_t NowNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+template<typename T>
+int64_t MicrosecondsBetween(const T& start, const T& end) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+int64_t NumSchedulingPerTimeoutTest() {
+  return std::max<int64_t>(
+      ParseIntegerFromEnv("ONEFLOW_VM_SCHEDULER_NUM_SCHEDULING_PER_TIMEOUT_TEST", 10000), 1);
+}
+
+// Short working windows are tested more often, assuming an empty scheduling costs about 10ns.
+int64_t NumSchedulingPerTest(int64_t working_us, int64_t num_scheduling_per_timeout_test) {
+  constexpr int64_t kNumSchedulingPerMicrosecond = 100;
+  if (working_us >= num_scheduling_per_timeout_test / kNumSchedulingPerMicrosecond) {
+    return num_scheduling_per_timeout_test;
+  }
+  return std::max<int64_t>(working_us * kNumSchedulingPerMicrosecond, 1);
+}
+
 }  // namespace
 
 void VirtualMachine::ControlSync() {
@@ -137,6 +164,7 @@ VirtualMachine::~VirtualMachine() {
   notifier_.Close();
   schedule_thread_.join();
   CHECK(!vm_);
+  VLOG(1) << "VirtualMachine scheduler: " << scheduler_telemetry_.ToString();
 }
 
 Maybe<void> VirtualMachine::Receive(vm::InstructionMsgList* instr_list) {
@@ -150,43 +178,52 @@ Maybe<void> VirtualMachine::Receive(vm::InstructionMsgList* instr_list) {
     JUST(vm_->Receive(instr_list));
     while (!vm_->Empty()) { vm_->Schedule(); }
   } else {
+    const int64_t instruction_num = instr_list->size();
     if (JUST(vm_->Receive(instr_list))) {
       // old pending_instruction_list is empty.
+      pending_since_ns_.store(NowNanoseconds(), std::memory_order_relaxed);
       notifier_.Notify();
     }
+    scheduler_telemetry_.received_instruction_num.fetch_add(instruction_num,
+                                                            std::memory_order_relaxed);
   }
   return Maybe<void>::Ok();
 }
 
-namespace {
-
-template<typename T>
-int MicrosecondsFrom(const T& start) {
-  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()
-                                                               - start)
-      .count();
+void VirtualMachine::RecordPendingLatency() {
+  const int64_t pending_since_ns = pending_since_ns_.exchange(0, std::memory_order_relaxed);
+  if (pending_since_ns == 0) { return; }
+  scheduler_telemetry_.pending_latency_us.Record((NowNanoseconds() - pending_since_ns) / 1000);
 }
 
-}  // namespace
-
 void VirtualMachine::Loop(const std::function<void()>& Initializer) {
   Initializer();
   auto* vm = mut_vm();
+  const int64_t num_scheduling_per_timeout_test = NumSchedulingPerTimeoutTest();
+  int64_t last_received_instruction_num = 0;
+  // The vm is idle since `idle_begin`, it is not reset by spurious wakeups.
+  auto idle_begin = std::chrono::steady_clock::now();
   while (notifier_.WaitAndClearNotifiedCnt() == kNotifierStatusSuccess) {
     OF_PROFILER_RANGE_PUSH("VirtualMachine::Loop");
-    auto start = std::chrono::steady_clock::now();
-    static constexpr int kWorkingMicroseconds = 1000;
-    // Every time this thread wakes up, vm is scheduled for about `kWorkingMicroseconds`.
-    // The cost of os thread switching is about 5-10 microseconds. Doing more scheduling in
-    // a single waiting up can reach higher performance.
+    // Every time this thread wakes up, vm is scheduled until it has been idle for
+    // `working_us`, which the idle policy picks. The cost of os thread switching is about 5-10
+    // microseconds. Doing more scheduling in a single waiting up can reach higher performance.
+    const int64_t working_us = idle_policy_->WorkingMicroseconds();
+    // The cost of reading the clock is about 400ns, while the empty scheduling costs about 10ns.
+    // Hence the timeout is tested every `num_scheduling_per_test` schedulings.
+    const int64_t num_scheduling_per_test =
+        NumSchedulingPerTest(working_us, num_scheduling_per_timeout_test);
+    int64_t schedule_num = 0;
+    int64_t idle_schedule_num = 0;
+    bool idle = true;
+    std::chrono::steady_clock::time_point now;
     do {
-      static constexpr int kNumSchedulingPerTimoutTest = 10000;
-      // Every time kWorkingMicroseconds timeout tested, vm is scheduled for about
-      // kNumSchedulingPerTimoutTest.
-      // The cost of `MicrosecondsFrom(start)` is about 400ns, while the empty scheduling costs
-      // about 10ns.
-      int i = 0;
+      bool busy = false;
+      int64_t i = 0;
       do {
+        if (unlikely(pending_since_ns_.load(std::memory_order_relaxed) != 0)) {
+          RecordPendingLatency();
+        }
         // Use ThreadUnsafeEmpty to avoid acquiring mutex lock.
         // It's safe to use ThreadUnsafeEmpty here. notifier_.notified_cnt_ will be greater than
         // zero
@@ -197,9 +234,45 @@ void VirtualMachine::Loop(const std::function<void()>& Initializer) {
         //  VirtualMachine::Receive may be less effiencient if the thread safe version `vm->Empty()`
         // used
         //  here, because VirtualMachine::Loop is more likely to get the mutex lock.
-        do { vm->Schedule(); } while (!vm->ThreadUnsafeEmpty());
-      } while (++i < kNumSchedulingPerTimoutTest);
-    } while (MicrosecondsFrom(start) < kWorkingMicroseconds);
+        vm->Schedule();
+        ++schedule_num;
+        if (vm->ThreadUnsafeEmpty()) {
+          ++idle_schedule_num;
+        } else {
+          busy = true;
+          do {
+            vm->Schedule();
+            ++schedule_num;
+          } while (!vm->ThreadUnsafeEmpty());
+        }
+      } while (++i < num_scheduling_per_test);
+      now = std::chrono::steady_clock::now();
+      // Flushed along with each clock read, so the counters also move while the vm keeps
+      // spinning and never waits.
+      scheduler_telemetry_.schedule_num.fetch_add(schedule_num, std::memory_order_relaxed);
+      scheduler_telemetry_.idle_schedule_num.fetch_add(idle_schedule_num,
+                                                       std::memory_order_relaxed);
+      schedule_num = 0;
+      idle_schedule_num = 0;
+      if (busy) {
+        if (idle) {
+          // new instructions ended an idle gap, either while parked or while spinning
+          const int64_t gap_us = MicrosecondsBetween(idle_begin, now);
+          idle_policy_->OnIdleGap(gap_us);
+          scheduler_telemetry_.idle_gap_us.Record(gap_us);
+        }
+        idle_begin = now;
+      }
+      idle = !busy;
+    } while (MicrosecondsBetween(idle_begin, now) < working_us && !notifier_.IsClosed());
+    scheduler_telemetry_.wakeup_num.fetch_add(1, std::memory_order_relaxed);
+    const int64_t received_instruction_num =
+        scheduler_telemetry_.received_instruction_num.load(std::memory_order_relaxed);
+    const int64_t instruction_num = received_instruction_num - last_received_instruction_num;
+    last_received_instruction_num = received_instruction_num;
+    if (instruction_num > scheduler_telemetry_.max_instruction_num_per_wakeup.load()) {
+      scheduler_telemetry_.max_instruction_num_per_wakeup.store(instruction_num);
+    }
     OF_PROFILER_RANGE_POP();
   }
   while (!vm->Empty()) { vm->Schedule(); }
@@ -20,6 +20,8 @@ limitations under the License.
 #include "oneflow/core/vm/interpret_type.h"
 #include "oneflow/core/vm/vm_desc.h"
 #include "oneflow/core/vm/virtual_machine_engine.h"
+#include "oneflow/core/vm/scheduler_idle_policy.h"
+#include "oneflow/core/vm/scheduler_telemetry.h"
 #include "oneflow/core/thread/thread_pool.h"
 
 namespace oneflow {
@@ -36,6 +38,7 @@ class VirtualMachine final {
   Maybe<void> Receive(vm::InstructionMsgList* instr_list);
 
   const vm::VirtualMachineEngine& vm() const { return *vm_; }
+  const vm::SchedulerTelemetry& scheduler_telemetry() const { return scheduler_telemetry_; }
 
  private:
   friend class InstructionsBuilder;
@@ -44,12 +47,17 @@ class VirtualMachine final {
 
   vm::VirtualMachineEngine* mut_vm() { return vm_.Mutable(); }
   void ControlSync();
+  void RecordPendingLatency();
 
   intrusive::shared_ptr<vm::VirtualMachineEngine> vm_;
   // for asynchronized execution
   std::list<std::unique_ptr<std::thread>> worker_threads_;
   std::thread schedule_thread_;
   Notifier notifier_;
+  std::unique_ptr<vm::SchedulerIdlePolicy> idle_policy_;
+  vm::SchedulerTelemetry scheduler_telemetry_;
+  // steady clock nanoseconds when instructions reached an empty pending list, 0 once handled
+  std::atomic<int64_t> pending_since_ns_;
 };
 
 }  // namespace oneflow
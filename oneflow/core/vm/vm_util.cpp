@@ -32,7 +32,7 @@ namespace oneflow {
 namespace vm {
 
 intrusive::shared_ptr<InstructionMsg> NewInstruction(const std::string& instr_type_name) {
-  return intrusive::make_shared<InstructionMsg>(instr_type_name);
+  return NewInstructionMsg(instr_type_name);
 }
 
 Maybe<void> Run(vm::InstructionMsgList* instr_msg_list) {
@@ -26,13 +26,20 @@ namespace data {
 
 static const int32_t kDataReaderBatchBufferSize = 4;
 
+// The number of batches loaded ahead of the kernel
+inline int32_t DataReaderBatchBufferSize() {
+  static const int32_t batch_buffer_size = std::max<int64_t>(
+      ParseIntegerFromEnv("ONEFLOW_DATA_READER_BATCH_BUFFER_SIZE", kDataReaderBatchBufferSize), 1);
+  return batch_buffer_size;
+}
+
 template<typename LoadTarget>
 class DataReader {
  public:
   using LoadTargetPtr = std::shared_ptr<LoadTarget>;
   using LoadTargetPtrList = std::vector<LoadTargetPtr>;
   DataReader(user_op::KernelInitContext* ctx)
-      : is_closed_(false), batch_buffer_(kDataReaderBatchBufferSize) {}
+      : is_closed_(false), batch_buffer_(DataReaderBatchBufferSize()) {}
   virtual ~DataReader() {
     Close();
     if (load_thrd_.joinable()) { load_thrd_.join(); }
@@ -33,6 +33,8 @@ class Dataset {
   virtual ~Dataset() = default;
 
   virtual LoadTargetPtrList Next() = 0;
+  // The epoch of the samples returned by the last Next, 0 for the datasets without epochs
+  virtual int64_t Epoch() const { return 0; }
 };
 
 template<typename LoadTarget>
@@ -17,6 +17,7 @@ limitations under the License.
 #define ONEFLOW_USER_DATA_OFRECORD_DATASET_H_
 
 #include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/common/buffer.h"
 #include "oneflow/core/common/multi_client.h"
 #include "oneflow/core/common/str_util.h"
 #include "oneflow/core/framework/op_kernel.h"
@@ -25,6 +26,7 @@ limitations under the License.
 #include "oneflow/core/rpc/include/global_process_ctx.h"
 #include "oneflow/core/job/env_desc.h"
 #include "oneflow/user/data/dataset.h"
+#include "oneflow/user/data/tensor_buffer_pool.h"
 
 namespace oneflow {
 namespace data {
@@ -34,80 +36,148 @@ class OFRecordDataset final : public Dataset<TensorBuffer> {
   using LoadTargetPtr = std::shared_ptr<TensorBuffer>;
   using LoadTargetPtrList = std::vector<LoadTargetPtr>;
   OF_DISALLOW_COPY_AND_MOVE(OFRecordDataset);
-  OFRecordDataset(user_op::KernelInitContext* ctx) {
-    current_epoch_ = 0;
-    shuffle_after_epoch_ = ctx->Attr<bool>("shuffle_after_epoch");
-
-    // in stream
-    data_part_num_ = ctx->Attr<int32_t>("data_part_num");
-    std::string data_dir = ctx->Attr<std::string>("data_dir");
-    std::string part_name_prefix = ctx->Attr<std::string>("part_name_prefix");
-    int32_t part_name_suffix_length = ctx->Attr<int32_t>("part_name_suffix_length");
-
-    for (int i = 0; i < data_part_num_; ++i) {
-      std::string num = std::to_string(i);
-      int32_t zero_count =
-          std::max(part_name_suffix_length - static_cast<int32_t>(num.length()), 0);
-      data_file_paths_.emplace_back(
-          JoinPath(data_dir, part_name_prefix + std::string(zero_count, '0') + num));
-    }
-
-    bool is_local = false;
-    // NOTE(zwx): OFRecordDataset is used by OFRecordDataReader and
-    // OFRecordImageClassificationDataReader both, the latter has no attr nd_sbp,
-    // so it couldn't work in DDP for now. The If condition here could be removed when
-    // OFRecordImageClassificationDataReader had supported DDP (add attr nd_sbp)
-    // or been deprecated.
-    if (ctx->op_type_name() == "OFRecordReader") {
-      auto nd_sbp_str_vec = ctx->Attr<std::vector<std::string>>("nd_sbp");
-      // NOTE(zwx): OFRecordDataset is not consistent since attr nd_sbp is empty,
-      // we assume that it works in DDP
-      if (nd_sbp_str_vec.empty() && CHECK_JUST(IsMultiClient())) { is_local = true; }
+  OFRecordDataset(user_op::KernelInitContext* ctx)
+      : OFRecordDataset(GenDataFilePaths(ctx), GenLocalRange(ctx),
+                        ctx->Attr<bool>("shuffle_after_epoch"),
+                        ParseIntegerFromEnv("ONEFLOW_OFRECORD_READER_THREAD_NUM", 1),
+                        ParseIntegerFromEnv("ONEFLOW_DATA_READER_RESUME_EPOCH", 0)) {}
+  OFRecordDataset(std::vector<std::string> data_file_paths, Range range, bool shuffle_after_epoch,
+                  int64_t reader_thread_num, int64_t resume_epoch)
+      : current_epoch_(0),
+        shuffle_after_epoch_(shuffle_after_epoch),
+        range_(range),
+        data_file_paths_(std::move(data_file_paths)) {
+    CHECK_GT(range_.size(), 0);
+    CHECK_LE(range_.end(), static_cast<int64_t>(data_file_paths_.size()));
+    // Part files are read by reader_thread_num threads, reader thread i reads local part files
+    // i, i + reader_thread_num, ... ahead of Next(). Next() still takes the samples file by file,
+    // so the order only depends on the files and the epoch seed, not on the thread number.
+    shards_.resize(std::min<int64_t>(std::max<int64_t>(reader_thread_num, 1), range_.size()));
+    const size_t prefetch_chunk_num =
+        std::max<int64_t>(ParseIntegerFromEnv("ONEFLOW_OFRECORD_READER_PREFETCH_CHUNK_NUM", 2), 1);
+    // a part file is scanned sequentially, so its stream reads ahead while the samples are parsed
+    read_ahead_num_ =
+        std::max<int64_t>(ParseIntegerFromEnv("ONEFLOW_DATA_READER_READ_AHEAD_NUM", 2), 0);
+    tensor_buffer_pool_ = std::make_shared<TensorBufferPool>(
+        shards_.size() * (prefetch_chunk_num + 1) * kSampleChunkSize);
+    for (auto& shard : shards_) {
+      shard.reset(new Shard(prefetch_chunk_num));
+      Shard* shard_ptr = shard.get();
+      shard->thread = std::thread([this, shard_ptr]() { ReadShard(shard_ptr); });
     }
-    if (is_local) {
-      parallel_id_ = GlobalProcessCtx::Rank();
-      parallel_num_ = GlobalProcessCtx::WorldSize();
-    } else {
-      parallel_id_ = ctx->parallel_ctx().parallel_id();
-      parallel_num_ = ctx->parallel_ctx().parallel_num();
+    // the part file order of an epoch only depends on the epochs before it, so a job can resume
+    // from any epoch
+    while (current_epoch_ < resume_epoch) { NextEpoch(); }
+    StartEpoch();
+  }
+  ~OFRecordDataset() {
+    for (auto& shard : shards_) {
+      shard->file_paths.Close();
+      shard->sample_chunks.Close();
     }
-    CHECK_LE(parallel_num_, data_part_num_);
-    BalancedSplitter bs(data_part_num_, parallel_num_);
-    range_ = bs.At(parallel_id_);
-    std::vector<std::string> local_file_paths = GetLocalFilePaths();
-    in_stream_.reset(
-        new PersistentInStream(DataFS(), local_file_paths, !shuffle_after_epoch_, false));
+    for (auto& shard : shards_) { shard->thread.join(); }
   }
-  ~OFRecordDataset() = default;
 
   LoadTargetPtrList Next() override {
     LoadTargetPtrList ret;
-    LoadTargetPtr sample_ptr(new TensorBuffer());
-    ReadSample(*sample_ptr);
-    ret.emplace_back(std::move(sample_ptr));
-    return ret;
+    while (true) {
+      if (cur_file_idx_ == range_.size()) {
+        CHECK_GT(epoch_sample_num_, 0) << "no OFRecord found in the part files";
+        NextEpoch();
+        StartEpoch();
+      }
+      Shard* shard = shards_.at(cur_file_idx_ % shards_.size()).get();
+      if (shard->cur_chunk == nullptr || shard->cur_chunk_idx == shard->cur_chunk->size()) {
+        CHECK_EQ(shard->sample_chunks.Pull(&shard->cur_chunk), kBufferStatusSuccess);
+        shard->cur_chunk_idx = 0;
+      }
+      if (shard->cur_chunk == nullptr) {
+        cur_file_idx_ += 1;
+        continue;
+      }
+      ret.emplace_back(std::move(shard->cur_chunk->at(shard->cur_chunk_idx)));
+      shard->cur_chunk_idx += 1;
+      epoch_sample_num_ += 1;
+      return ret;
+    }
   }
 
+  int64_t Epoch() const override { return current_epoch_; }
+
  private:
-  void ReadSample(TensorBuffer& tensor) {
+  // Samples are passed from a reader thread in chunks of this size
+  static constexpr size_t kSampleChunkSize = 64;
+
+  struct Shard {
+    explicit Shard(size_t prefetch_chunk_num)
+        : file_paths(1), sample_chunks(prefetch_chunk_num), cur_chunk_idx(0) {}
+    std::thread thread;
+    // the part files of each epoch
+    Buffer<std::shared_ptr<std::vector<std::string>>> file_paths;
+    // a nullptr chunk marks the end of a part file
+    Buffer<std::shared_ptr<LoadTargetPtrList>> sample_chunks;
+    std::shared_ptr<LoadTargetPtrList> cur_chunk;
+    size_t cur_chunk_idx;
+  };
+
+  void ReadShard(Shard* shard) {
+    std::shared_ptr<std::vector<std::string>> file_paths;
+    while (shard->file_paths.Pull(&file_paths) == kBufferStatusSuccess) {
+      for (const std::string& file_path : *file_paths) {
+        PersistentInStream in_stream(DataFS(), {file_path}, 0, false, false, read_ahead_num_);
+        bool eof = false;
+        while (!eof) {
+          auto chunk = std::make_shared<LoadTargetPtrList>();
+          chunk->reserve(kSampleChunkSize);
+          while (chunk->size() < kSampleChunkSize) {
+            LoadTargetPtr sample_ptr = tensor_buffer_pool_->New();
+            if (!ReadSample(&in_stream, sample_ptr.get())) {
+              eof = true;
+              break;
+            }
+            chunk->emplace_back(std::move(sample_ptr));
+          }
+          if (chunk->empty()) { continue; }
+          if (shard->sample_chunks.Push(chunk) != kBufferStatusSuccess) { return; }
+        }
+        if (shard->sample_chunks.Push(nullptr) != kBufferStatusSuccess) { return; }
+      }
+    }
+  }
+
+  // Returns false at the end of the stream
+  static bool ReadSample(PersistentInStream* in_stream, TensorBuffer* tensor) {
     int64_t OFRecord_size = -1;
     char* size_ptr = reinterpret_cast<char*>(&OFRecord_size);
-    if (in_stream_->ReadFully(size_ptr, sizeof(int64_t)) != 0) {
-      ShuffleAfterEpoch();
-      CHECK_EQ(in_stream_->ReadFully(size_ptr, sizeof(int64_t)), 0);
-    }
+    if (in_stream->ReadFully(size_ptr, sizeof(int64_t)) != 0) { return false; }
     CHECK_GT(OFRecord_size, 0);
-    tensor.Resize(Shape({OFRecord_size}), DataType::kChar);
-    CHECK_EQ(in_stream_->ReadFully(tensor.mut_data<char>(), OFRecord_size), 0);
+    tensor->Resize(Shape({OFRecord_size}), DataType::kChar);
+    CHECK_EQ(in_stream->ReadFully(tensor->mut_data<char>(), OFRecord_size), 0);
+    return true;
+  }
+
+  void NextEpoch() {
+    current_epoch_ += 1;
+    if (shuffle_after_epoch_) { ShuffleAfterEpoch(); }
   }
 
   void ShuffleAfterEpoch() {
     CHECK(shuffle_after_epoch_);
-    current_epoch_++;  // move to next epoch
     std::mt19937 g(kOneflowDatasetSeed + current_epoch_);
     std::shuffle(data_file_paths_.begin(), data_file_paths_.end(), g);
+  }
+
+  void StartEpoch() {
     std::vector<std::string> local_file_paths = GetLocalFilePaths();
-    in_stream_.reset(new PersistentInStream(DataFS(), local_file_paths, false, false));
+    FOR_RANGE(size_t, shard_id, 0, shards_.size()) {
+      auto file_paths = std::make_shared<std::vector<std::string>>();
+      for (size_t i = shard_id; i < local_file_paths.size(); i += shards_.size()) {
+        file_paths->emplace_back(local_file_paths.at(i));
+      }
+      CHECK_EQ(shards_.at(shard_id)->file_paths.Push(file_paths), kBufferStatusSuccess);
+    }
+    cur_file_idx_ = 0;
+    epoch_sample_num_ = 0;
   }
 
   std::vector<std::string> GetLocalFilePaths() {
@@ -118,15 +188,61 @@ class OFRecordDataset final : public Dataset<TensorBuffer> {
     return ret;
   }
 
-  int32_t current_epoch_;
+  static std::vector<std::string> GenDataFilePaths(user_op::KernelInitContext* ctx) {
+    const int32_t data_part_num = ctx->Attr<int32_t>("data_part_num");
+    const std::string data_dir = ctx->Attr<std::string>("data_dir");
+    const std::string part_name_prefix = ctx->Attr<std::string>("part_name_prefix");
+    const int32_t part_name_suffix_length = ctx->Attr<int32_t>("part_name_suffix_length");
+    std::vector<std::string> ret;
+    for (int i = 0; i < data_part_num; ++i) {
+      std::string num = std::to_string(i);
+      int32_t zero_count =
+          std::max(part_name_suffix_length - static_cast<int32_t>(num.length()), 0);
+      ret.emplace_back(JoinPath(data_dir, part_name_prefix + std::string(zero_count, '0') + num));
+    }
+    return ret;
+  }
+
+  static Range GenLocalRange(user_op::KernelInitContext* ctx) {
+    bool is_local = false;
+    // NOTE(zwx): OFRecordDataset is used by OFRecordDataReader and
+    // OFRecordImageClassificationDataReader both, the latter has no attr nd_sbp,
+    // so it couldn't work in DDP for now. The If condition here could be removed when
+    // OFRecordImageClassificationDataReader had supported DDP (add attr nd_sbp)
+    // or been deprecated.
+    if (ctx->op_type_name() == "OFRecordReader") {
+      auto nd_sbp_str_vec = ctx->Attr<std::vector<std::string>>("nd_sbp");
+      // NOTE(zwx): OFRecordDataset is not consistent since attr nd_sbp is empty,
+      // we assume that it works in DDP
+      if (nd_sbp_str_vec.empty() && CHECK_JUST(IsMultiClient())) { is_local = true; }
+    }
+    int32_t parallel_id = 0;
+    int32_t parallel_num = 0;
+    if (is_local) {
+      parallel_id = GlobalProcessCtx::Rank();
+      parallel_num = GlobalProcessCtx::WorldSize();
+    } else {
+      parallel_id = ctx->parallel_ctx().parallel_id();
+      parallel_num = ctx->parallel_ctx().parallel_num();
+    }
+    const int32_t data_part_num = ctx->Attr<int32_t>("data_part_num");
+    CHECK_LE(parallel_num, data_part_num);
+    BalancedSplitter bs(data_part_num, parallel_num);
+    return bs.At(parallel_id);
+  }
+
+  int64_t current_epoch_;
   bool shuffle_after_epoch_;
 
-  int32_t data_part_num_;
-  int32_t parallel_id_;
-  int32_t parallel_num_;
   Range range_;
   std::vector<std::string> data_file_paths_;
-  std::unique_ptr<PersistentInStream> in_stream_;
+
+  std::shared_ptr<TensorBufferPool> tensor_buffer_pool_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  size_t read_ahead_num_;
+  // index of the local part file Next() takes samples from
+  int64_t cur_file_idx_;
+  int64_t epoch_sample_num_;
 };
 
 }  // namespace data
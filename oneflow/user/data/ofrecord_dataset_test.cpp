@@ -0,0 +1,158 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/persistence/file_system.h"
+#include "oneflow/user/data/ofrecord_dataset.h"
+
+#ifdef OF_PLATFORM_POSIX
+
+namespace oneflow {
+namespace data {
+namespace test {
+
+namespace {
+
+// the part files hold a different number of records each, some of them straddle the
+// 64 sample chunks and one of them is empty
+const std::vector<int64_t> kPartSampleNums = {70, 1, 128, 0, 200, 33, 64};
+
+std::string TestDirPath(const std::string& name) {
+  std::string current_dir = GetCwd();
+  StringReplace(&current_dir, '\\', '/');
+  std::string path = JoinPath(current_dir, name);
+  if (LocalFS()->IsDirectory(path)) { LocalFS()->RecursivelyDeleteDir(path); }
+  LocalFS()->RecursivelyCreateDir(path);
+  return path;
+}
+
+std::string SampleName(size_t part_id, int64_t sample_id) {
+  return std::to_string(part_id) + ":" + std::to_string(sample_id);
+}
+
+std::vector<std::string> WritePartFiles(const std::string& dir) {
+  std::vector<std::string> file_paths;
+  FOR_RANGE(size_t, part_id, 0, kPartSampleNums.size()) {
+    file_paths.emplace_back(JoinPath(dir, "part-" + std::to_string(part_id)));
+    std::unique_ptr<fs::WritableFile> file;
+    DataFS()->NewWritableFile(file_paths.back(), &file);
+    FOR_RANGE(int64_t, sample_id, 0, kPartSampleNums.at(part_id)) {
+      const std::string record = SampleName(part_id, sample_id);
+      const int64_t record_size = record.size();
+      file->Append(reinterpret_cast<const char*>(&record_size), sizeof(int64_t));
+      file->Append(record.data(), record.size());
+    }
+    file->Close();
+  }
+  return file_paths;
+}
+
+int64_t LocalSampleNum(const Range& range) {
+  int64_t ret = 0;
+  for (int64_t i = range.begin(); i < range.end(); ++i) { ret += kPartSampleNums.at(i); }
+  return ret;
+}
+
+struct ReadSample {
+  std::string name;
+  int64_t epoch;
+};
+
+std::vector<ReadSample> ReadSamples(OFRecordDataset* dataset, int64_t sample_num) {
+  std::vector<ReadSample> samples;
+  FOR_RANGE(int64_t, i, 0, sample_num) {
+    auto ret = dataset->Next();
+    CHECK_EQ(ret.size(), 1);
+    const TensorBuffer* buffer = ret.front().get();
+    samples.emplace_back(
+        ReadSample{std::string(buffer->data<char>(), buffer->elem_cnt()), dataset->Epoch()});
+  }
+  return samples;
+}
+
+}  // namespace
+
+TEST(OFRecordDataset, same_order_for_any_reader_thread_num) {
+  const std::string dir = TestDirPath("/tmp_test_ofrecord_dataset_order");
+  const std::vector<std::string> file_paths = WritePartFiles(dir);
+  const Range range(0, file_paths.size());
+  const int64_t sample_num = LocalSampleNum(range) * 3;
+  for (bool shuffle_after_epoch : {false, true}) {
+    std::vector<ReadSample> expected;
+    {
+      OFRecordDataset dataset(file_paths, range, shuffle_after_epoch, 1, 0);
+      expected = ReadSamples(&dataset, sample_num);
+    }
+    // the first epoch is in the part file order
+    int64_t idx = 0;
+    FOR_RANGE(size_t, part_id, 0, kPartSampleNums.size()) {
+      FOR_RANGE(int64_t, sample_id, 0, kPartSampleNums.at(part_id)) {
+        ASSERT_EQ(expected.at(idx).name, SampleName(part_id, sample_id));
+        idx += 1;
+      }
+    }
+    for (int64_t reader_thread_num : {2, 3, 16}) {
+      OFRecordDataset dataset(file_paths, range, shuffle_after_epoch, reader_thread_num, 0);
+      const std::vector<ReadSample> samples = ReadSamples(&dataset, sample_num);
+      FOR_RANGE(int64_t, i, 0, sample_num) {
+        ASSERT_EQ(samples.at(i).name, expected.at(i).name) << reader_thread_num << " " << i;
+        ASSERT_EQ(samples.at(i).epoch, expected.at(i).epoch) << reader_thread_num << " " << i;
+      }
+    }
+  }
+  LocalFS()->RecursivelyDeleteDir(dir);
+}
+
+TEST(OFRecordDataset, epoch_boundary) {
+  const std::string dir = TestDirPath("/tmp_test_ofrecord_dataset_epoch");
+  const std::vector<std::string> file_paths = WritePartFiles(dir);
+  // a local range which starts and ends on a non empty part file
+  const Range range(2, 6);
+  const int64_t epoch_sample_num = LocalSampleNum(range);
+  OFRecordDataset dataset(file_paths, range, false, 3, 0);
+  FOR_RANGE(int64_t, epoch, 0, 3) {
+    const std::vector<ReadSample> samples = ReadSamples(&dataset, epoch_sample_num);
+    ASSERT_EQ(samples.front().name, SampleName(range.begin(), 0));
+    ASSERT_EQ(samples.back().name, SampleName(range.end() - 1, kPartSampleNums.at(5) - 1));
+    // the end of the last part file moves to the next epoch only when a sample is asked for
+    for (const auto& sample : samples) { ASSERT_EQ(sample.epoch, epoch); }
+    ASSERT_EQ(dataset.Epoch(), epoch);
+  }
+  LocalFS()->RecursivelyDeleteDir(dir);
+}
+
+TEST(OFRecordDataset, destroy_mid_epoch) {
+  const std::string dir = TestDirPath("/tmp_test_ofrecord_dataset_destroy");
+  const std::vector<std::string> file_paths = WritePartFiles(dir);
+  const Range range(0, file_paths.size());
+  // the reader threads are blocked on full prefetch buffers or on the part files of the next
+  // epoch, the destructor must wake them up and join them
+  const std::vector<int64_t> sample_nums = {0, 1, 65, 300, LocalSampleNum(range)};
+  for (int64_t sample_num : sample_nums) {
+    for (int64_t reader_thread_num : {1, 4}) {
+      OFRecordDataset dataset(file_paths, range, true, reader_thread_num, 0);
+      ReadSamples(&dataset, sample_num);
+    }
+  }
+  LocalFS()->RecursivelyDeleteDir(dir);
+}
+
+}  // namespace test
+}  // namespace data
+}  // namespace oneflow
+
+#endif  // OF_PLATFORM_POSIX
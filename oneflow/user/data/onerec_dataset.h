@@ -84,6 +84,9 @@ class OneRecDataset final : public Dataset<TensorBuffer> {
     parallel_num_ = ctx->parallel_ctx().parallel_num();
     BalancedSplitter bs(data_file_paths_.size(), parallel_num_);
     range_ = bs.At(parallel_id_);
+    // the part files are scanned sequentially, so the stream reads ahead while frames are decoded
+    read_ahead_num_ =
+        std::max<int64_t>(ParseIntegerFromEnv("ONEFLOW_DATA_READER_READ_AHEAD_NUM", 2), 0);
     ResetInstream();
     hash_state_ = LZ4_XXH64_createState();
   }
@@ -142,7 +145,8 @@ class OneRecDataset final : public Dataset<TensorBuffer> {
       std::shuffle(data_file_paths_.begin(), data_file_paths_.end(), g);
     }
     std::vector<std::string> file_paths = GetLocalFilePaths();
-    in_stream_.reset(new PersistentInStream(DataFS(), file_paths, false, false));
+    in_stream_.reset(
+        new PersistentInStream(DataFS(), file_paths, 0, false, false, read_ahead_num_));
   }
 
   std::vector<std::string> GetLocalFilePaths() {
@@ -161,6 +165,7 @@ class OneRecDataset final : public Dataset<TensorBuffer> {
   Range range_;
   std::vector<std::string> data_file_paths_;
   std::unique_ptr<PersistentInStream> in_stream_;
+  size_t read_ahead_num_;
   XXH64_state_t* hash_state_;
   int32_t batch_size_;
 };
@@ -23,6 +23,17 @@ limitations under the License.
 namespace oneflow {
 namespace data {
 
+// Shuffles the samples through a buffer of shuffle_buffer_size samples. Every Next moves a random
+// sample out of the buffer and its slot is refilled by the last one. The buffer grows by one sample
+// per Next until it is full, so the first batches do not wait for shuffle_buffer_size reads.
+//
+// The buffer does not mix epochs: the samples of the next epoch wait until the buffer is drained,
+// and the random engine is reseeded with (seed, epoch) at the start of each epoch. The output of an
+// epoch then only depends on the seed and the input order of the epoch. With shuffle_after_epoch
+// the OFRecord part files are permuted per epoch as well, so the part file permutation and the
+// buffer shuffle together spread the samples over the epoch while the buffer stays small.
+// ONEFLOW_DATA_READER_RESUME_OFFSET skips the samples already taken in the resumed epoch, see
+// ONEFLOW_DATA_READER_RESUME_EPOCH in OFRecordDataset.
 template<typename LoadTarget>
 class RandomShuffleDataset final : public Dataset<LoadTarget> {
  public:
@@ -30,43 +41,78 @@ class RandomShuffleDataset final : public Dataset<LoadTarget> {
   using LoadTargetPtrList = std::vector<LoadTargetPtr>;
   RandomShuffleDataset(user_op::KernelInitContext* ctx,
                        std::unique_ptr<Dataset<LoadTarget>>&& data_set)
-      : loader_(std::move(data_set)) {
-    // random
-    seed_ = ctx->Attr<int64_t>("seed");
+      : RandomShuffleDataset(ctx->Attr<int64_t>("seed"), ctx->Attr<int32_t>("shuffle_buffer_size"),
+                             std::move(data_set)) {}
+  // seed -1 picks a random seed
+  RandomShuffleDataset(int64_t seed, int32_t shuffle_buffer_size,
+                       std::unique_ptr<Dataset<LoadTarget>>&& data_set)
+      : loader_(std::move(data_set)), epoch_(-1), next_epoch_(-1) {
+    seed_ = seed;
     if (seed_ == -1) { seed_ = NewRandomSeed(); }
-    std::seed_seq seq({seed_});
-    rand_engine_ = std::default_random_engine(seq);
-
-    // fill buffer
-    initial_buffer_fill_ = ctx->Attr<int32_t>("shuffle_buffer_size");
-    int32_t remain_cnt = initial_buffer_fill_;
-    while (remain_cnt > 0) {
-      LoadTargetPtrList sample_list = loader_->Next();
-      for (auto& sample_ptr : sample_list) {
-        sample_buffer_.emplace_back(std::move(sample_ptr));
-        remain_cnt--;
-      }
-    }
+    buffer_size_ = std::max<int32_t>(shuffle_buffer_size, 1);
+    buffer_.reserve(buffer_size_);
+    skip_num_ = std::max<int64_t>(ParseIntegerFromEnv("ONEFLOW_DATA_READER_RESUME_OFFSET", 0), 0);
   }
   ~RandomShuffleDataset() = default;
 
   LoadTargetPtrList Next() override {
-    LoadTargetPtrList ret = loader_->Next();
-    for (auto& sample_ptr : ret) {
-      std::uniform_int_distribution<> dis(0, sample_buffer_.size() - 1);
-      int offset = dis(rand_engine_);
-      std::swap(sample_buffer_[offset], sample_ptr);
-    }
+    for (; skip_num_ > 0; --skip_num_) { NextSample(); }
+    LoadTargetPtrList ret;
+    ret.emplace_back(NextSample());
     return ret;
   }
 
+  int64_t Epoch() const override { return epoch_; }
+
  private:
+  LoadTargetPtr NextSample() {
+    if (next_epoch_samples_.empty() && buffer_.size() + 1 < buffer_size_) { Fill(); }
+    if (next_epoch_samples_.empty()) { Fill(); }
+    if (buffer_.empty()) { StartNextEpoch(); }
+    const size_t index = RandomIndex(buffer_.size());
+    LoadTargetPtr sample = std::move(buffer_.at(index));
+    buffer_.at(index) = std::move(buffer_.back());
+    buffer_.pop_back();
+    return sample;
+  }
+
+  void Fill() {
+    LoadTargetPtrList samples = loader_->Next();
+    const int64_t epoch = loader_->Epoch();
+    if (epoch != epoch_) {
+      next_epoch_samples_ = std::move(samples);
+      next_epoch_ = epoch;
+    } else {
+      for (auto& sample : samples) { buffer_.emplace_back(std::move(sample)); }
+    }
+  }
+
+  void StartNextEpoch() {
+    CHECK(!next_epoch_samples_.empty());
+    epoch_ = next_epoch_;
+    std::seed_seq seq({seed_, epoch_});
+    rand_engine_.seed(seq);
+    for (auto& sample : next_epoch_samples_) { buffer_.emplace_back(std::move(sample)); }
+    next_epoch_samples_.clear();
+  }
+
+  // Multiply-shift instead of std::uniform_int_distribution, whose output is implementation
+  // defined, so that the order is the same with every standard library.
+  size_t RandomIndex(size_t size) {
+    return static_cast<size_t>((static_cast<unsigned __int128>(rand_engine_()) * size) >> 64);
+  }
+
   std::unique_ptr<Dataset<LoadTarget>> loader_;
-  std::vector<LoadTargetPtr> sample_buffer_;
+  std::vector<LoadTargetPtr> buffer_;
+  size_t buffer_size_;
+  // the samples of the next epoch read while the buffer still holds the current epoch
+  LoadTargetPtrList next_epoch_samples_;
 
-  int32_t initial_buffer_fill_;
+  int64_t epoch_;
+  int64_t next_epoch_;
+  int64_t skip_num_;
 
-  std::default_random_engine rand_engine_;
+  std::mt19937_64 rand_engine_;
   int64_t seed_;
 };
 
@@ -0,0 +1,120 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include "oneflow/user/data/random_shuffle_dataset.h"
+
+namespace oneflow {
+namespace data {
+namespace test {
+
+namespace {
+
+constexpr int64_t kEpochSize = 30;
+constexpr int64_t kEpochNum = 3;
+
+// Returns the samples epoch * kEpochSize + [0, kEpochSize) in order, one per Next like
+// OFRecordDataset. start_epoch stands for a reader resumed with ONEFLOW_DATA_READER_RESUME_EPOCH.
+class FakeEpochDataset final : public Dataset<int64_t> {
+ public:
+  explicit FakeEpochDataset(int64_t start_epoch) : epoch_(start_epoch), index_(0) {}
+  ~FakeEpochDataset() override = default;
+
+  LoadTargetPtrList Next() override {
+    if (index_ == kEpochSize) {
+      epoch_ += 1;
+      index_ = 0;
+    }
+    LoadTargetPtrList ret;
+    ret.emplace_back(std::make_shared<int64_t>(epoch_ * kEpochSize + index_));
+    index_ += 1;
+    return ret;
+  }
+
+  int64_t Epoch() const override { return epoch_; }
+
+ private:
+  int64_t epoch_;
+  int64_t index_;
+};
+
+struct ShuffledSample {
+  int64_t value;
+  int64_t epoch;
+};
+
+std::vector<ShuffledSample> Shuffle(int64_t seed, int32_t buffer_size, int64_t start_epoch,
+                                    int64_t sample_num) {
+  RandomShuffleDataset<int64_t> dataset(
+      seed, buffer_size, std::unique_ptr<Dataset<int64_t>>(new FakeEpochDataset(start_epoch)));
+  std::vector<ShuffledSample> samples;
+  for (int64_t i = 0; i < sample_num; ++i) {
+    const auto& ret = dataset.Next();
+    CHECK_EQ(ret.size(), 1);
+    samples.emplace_back(ShuffledSample{*ret.front(), dataset.Epoch()});
+  }
+  return samples;
+}
+
+std::vector<int64_t> Values(const std::vector<ShuffledSample>& samples) {
+  std::vector<int64_t> values;
+  for (const auto& sample : samples) { values.emplace_back(sample.value); }
+  return values;
+}
+
+}  // namespace
+
+TEST(RandomShuffleDataset, same_seed_same_order) {
+  const int64_t sample_num = kEpochSize * kEpochNum;
+  const auto& values = Values(Shuffle(7, 8, 0, sample_num));
+  ASSERT_EQ(Values(Shuffle(7, 8, 0, sample_num)), values);
+  ASSERT_NE(Values(Shuffle(8, 8, 0, sample_num)), values);
+  std::vector<int64_t> sorted_values(values);
+  std::sort(sorted_values.begin(), sorted_values.end());
+  FOR_RANGE(int64_t, i, 0, sample_num) { ASSERT_EQ(sorted_values.at(i), i); }
+  ASSERT_NE(sorted_values, values);
+}
+
+TEST(RandomShuffleDataset, never_mixes_epochs) {
+  // smaller than, equal to and larger than an epoch
+  const std::vector<int32_t> buffer_sizes = {1, 8, kEpochSize, 2 * kEpochSize};
+  for (int32_t buffer_size : buffer_sizes) {
+    const auto& samples = Shuffle(7, buffer_size, 0, kEpochSize * kEpochNum);
+    FOR_RANGE(size_t, i, 0, samples.size()) {
+      ASSERT_EQ(samples.at(i).epoch, i / kEpochSize) << "buffer size " << buffer_size;
+      ASSERT_EQ(samples.at(i).value / kEpochSize, samples.at(i).epoch)
+          << "buffer size " << buffer_size;
+    }
+  }
+}
+
+TEST(RandomShuffleDataset, resume) {
+  const int64_t sample_num = kEpochSize * kEpochNum;
+  const auto& values = Values(Shuffle(7, 8, 0, sample_num));
+  // resume in the middle of epoch 1
+  const int64_t resume_epoch = 1;
+  const int64_t resume_offset = 11;
+  setenv("ONEFLOW_DATA_READER_RESUME_OFFSET", std::to_string(resume_offset).c_str(), 1);
+  const int64_t resumed_num = sample_num - resume_epoch * kEpochSize - resume_offset;
+  const auto& resumed_samples = Shuffle(7, 8, resume_epoch, resumed_num);
+  unsetenv("ONEFLOW_DATA_READER_RESUME_OFFSET");
+  ASSERT_EQ(resumed_samples.front().epoch, resume_epoch);
+  ASSERT_EQ(Values(resumed_samples),
+            std::vector<int64_t>(values.end() - resumed_num, values.end()));
+}
+
+}  // namespace test
+}  // namespace data
+}  // namespace oneflow
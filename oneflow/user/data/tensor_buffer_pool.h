@@ -0,0 +1,64 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_DATA_TENSOR_BUFFER_POOL_H_
+#define ONEFLOW_USER_DATA_TENSOR_BUFFER_POOL_H_
+
+#include "oneflow/core/common/tensor_buffer.h"
+
+namespace oneflow {
+namespace data {
+
+// Thread safe pool of TensorBuffers. The buffers keep their storage when they go back to the pool,
+// so samples of similar size are read without allocation. Unlike obj_pool::SingleThreadObjPool
+// buffers may be taken on a reader thread and released on a compute thread.
+class TensorBufferPool final : public std::enable_shared_from_this<TensorBufferPool> {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(TensorBufferPool);
+  explicit TensorBufferPool(size_t max_free_num) : max_free_num_(max_free_num) {}
+  ~TensorBufferPool() = default;
+
+  std::shared_ptr<TensorBuffer> New() {
+    TensorBuffer* buffer = nullptr;
+    {
+      std::unique_lock<std::mutex> lck(mutex_);
+      if (!free_buffers_.empty()) {
+        buffer = free_buffers_.back().release();
+        free_buffers_.pop_back();
+      }
+    }
+    if (buffer == nullptr) { buffer = new TensorBuffer(); }
+    std::weak_ptr<TensorBufferPool> pool(shared_from_this());
+    return std::shared_ptr<TensorBuffer>(buffer, [pool](TensorBuffer* buffer) {
+      std::unique_ptr<TensorBuffer> buffer_ptr(buffer);
+      if (auto shared_pool = pool.lock()) { shared_pool->Put(std::move(buffer_ptr)); }
+    });
+  }
+
+ private:
+  void Put(std::unique_ptr<TensorBuffer>&& buffer) {
+    std::unique_lock<std::mutex> lck(mutex_);
+    if (free_buffers_.size() < max_free_num_) { free_buffers_.emplace_back(std::move(buffer)); }
+  }
+
+  size_t max_free_num_;
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<TensorBuffer>> free_buffers_;
+};
+
+}  // namespace data
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_DATA_TENSOR_BUFFER_POOL_H_
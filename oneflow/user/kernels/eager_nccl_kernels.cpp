@@ -197,14 +197,19 @@ class EagerCclReduceScatterKernel final : public user_op::OpKernel {
     user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
     CHECK_EQ(in->data_type(), out->data_type());
     const auto& op_type = ctx->Attr<std::string>("op_type");
-    CHECK_EQ(op_type, "sum");
     CHECK_JUST(ccl::ReduceScatter<DeviceType::kCPU>(
-        in->dptr(), out->mut_dptr(), out->shape().elem_cnt(), out->data_type(), ccl::kSum,
-        kernel_cache->parallel_desc(), ctx->stream()));
+        in->dptr(), out->mut_dptr(), out->shape().elem_cnt(), out->data_type(),
+        CHECK_JUST(MapAt(op_type2ccl_reduce_type, op_type)), kernel_cache->parallel_desc(),
+        ctx->stream()));
   };
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+
+  static HashMap<std::string, ccl::ReduceType> op_type2ccl_reduce_type;
 };
 
+HashMap<std::string, ccl::ReduceType> EagerCclReduceScatterKernel::op_type2ccl_reduce_type = {
+    {"sum", ccl::kSum}, {"max", ccl::kMax}, {"min", ccl::kMin}, {"prod", ccl::kProd}};
+
 REGISTER_USER_KERNEL("eager_nccl_reduce_scatter")
     .SetCreateFn<EagerCclReduceScatterKernel>()
     .SetIsMatchedHob(user_op::HobDeviceType() == DeviceType::kCPU);
@@ -14,9 +14,363 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
+#include "oneflow/core/ep/cpu/cpu_parallel.h"
+#include "oneflow/core/ep/cpu/primitive/vectorized_math.h"
 
 namespace oneflow {
 
+namespace {
+
+// Number of elements a task of the row parallel loops handles at least.
+constexpr int64_t kParallelGrainSize = 32 * 1024;
+// The rows of layer_norm_param_grad are split into at most this many chunks, every chunk sums its
+// rows into its own partial gamma_diff and beta_diff. The chunks do not depend on the thread
+// count, so the result is deterministic.
+constexpr int64_t kMaxParamGradChunkNum = 64;
+
+// Same algorithm as oneflow/core/cuda/layer_norm.cuh: the mean and the biased variance of a row
+// come from Welford's online algorithm, partial statistics are merged with Chan's formula and
+// inv_variance = 1 / sqrt(variance + epsilon).
+template<typename T>
+struct WelfordStats {
+  T mean = 0;
+  T m2 = 0;
+  T count = 0;
+
+  void Add(T x) {
+    count += 1;
+    const T delta = x - mean;
+    mean += delta / count;
+    m2 += delta * (x - mean);
+  }
+
+  void Merge(T b_mean, T b_m2, T b_count) {
+    if (b_count == 0) { return; }
+    const T new_count = count + b_count;
+    const T nb_over_n = b_count / new_count;
+    const T delta = b_mean - mean;
+    mean += delta * nb_over_n;
+    m2 += b_m2 + delta * delta * count * nb_over_n;
+    count = new_count;
+  }
+
+  T InvVariance(double epsilon) const {
+    const T variance = std::max(m2 / count, static_cast<T>(0));
+    return static_cast<T>(1) / std::sqrt(variance + static_cast<T>(epsilon));
+  }
+};
+
+template<typename T, bool do_scale, bool do_center>
+void LayerNormRowScalar(int64_t cols, double epsilon, const T* x, const T* gamma, const T* beta,
+                        T* y, T* mean, T* inv_variance) {
+  WelfordStats<T> stats;
+  for (int64_t j = 0; j < cols; ++j) { stats.Add(x[j]); }
+  const T row_mean = stats.mean;
+  const T row_inv_var = stats.InvVariance(epsilon);
+  for (int64_t j = 0; j < cols; ++j) {
+    T normalized = (x[j] - row_mean) * row_inv_var;
+    if (do_scale) { normalized *= gamma[j]; }
+    if (do_center) { normalized += beta[j]; }
+    y[j] = normalized;
+  }
+  *mean = row_mean;
+  *inv_variance = row_inv_var;
+}
+
+/*
+normalized = (x - mean) * inv_var
+scaled_dy = dy * gamma
+sum_stats1 = sum(scaled_dy)
+sum_stats2 = sum(scaled_dy * normalized)
+dx = (cols * scaled_dy - sum_stats1 - normalized * sum_stats2) * inv_var / cols
+*/
+template<typename T, bool do_scale, bool do_add>
+void LayerNormGradRowScalar(int64_t cols, const T* dy, const T* x, T mean, T inv_variance,
+                            const T* gamma, const T* add_to_output, T* dx) {
+  T sum_stats1 = 0;
+  T sum_stats2 = 0;
+  for (int64_t j = 0; j < cols; ++j) {
+    const T scaled_dy = do_scale ? dy[j] * gamma[j] : dy[j];
+    sum_stats1 += scaled_dy;
+    sum_stats2 += scaled_dy * (x[j] - mean) * inv_variance;
+  }
+  const T inv_variance_over_cols = inv_variance / static_cast<T>(cols);
+  for (int64_t j = 0; j < cols; ++j) {
+    const T scaled_dy = do_scale ? dy[j] * gamma[j] : dy[j];
+    const T normalized = (x[j] - mean) * inv_variance;
+    T dx_j = (static_cast<T>(cols) * scaled_dy - sum_stats1 - normalized * sum_stats2)
+             * inv_variance_over_cols;
+    if (do_add) { dx_j += add_to_output[j]; }
+    dx[j] = dx_j;
+  }
+}
+
+#ifdef OF_CPU_X86_SIMD
+
+using ep::primitive::vectorized_math::ReduceSum256;
+
+// Every lane keeps its own Welford statistics over the columns j % 8 == lane, they are merged at
+// the end of the row like the per thread statistics of the cuda kernels.
+template<bool do_scale, bool do_center>
+OF_CPU_AVX2_TARGET void LayerNormRowAvx2(int64_t cols, double epsilon, const float* x,
+                                         const float* gamma, const float* beta, float* y,
+                                         float* mean, float* inv_variance) {
+  constexpr int64_t kPackSize = 8;
+  const int64_t vec_cols = cols / kPackSize * kPackSize;
+  __m256 v_mean = _mm256_setzero_ps();
+  __m256 v_m2 = _mm256_setzero_ps();
+  float lane_count = 0;
+  for (int64_t j = 0; j < vec_cols; j += kPackSize) {
+    lane_count += 1;
+    const __m256 v_x = _mm256_loadu_ps(x + j);
+    const __m256 delta = _mm256_sub_ps(v_x, v_mean);
+    v_mean = _mm256_fmadd_ps(delta, _mm256_set1_ps(1.0f / lane_count), v_mean);
+    v_m2 = _mm256_fmadd_ps(delta, _mm256_sub_ps(v_x, v_mean), v_m2);
+  }
+  float lane_mean[kPackSize];
+  float lane_m2[kPackSize];
+  _mm256_storeu_ps(lane_mean, v_mean);
+  _mm256_storeu_ps(lane_m2, v_m2);
+  WelfordStats<float> stats;
+  for (int64_t lane = 0; lane < kPackSize; ++lane) {
+    stats.Merge(lane_mean[lane], lane_m2[lane], lane_count);
+  }
+  for (int64_t j = vec_cols; j < cols; ++j) { stats.Add(x[j]); }
+  const float row_mean = stats.mean;
+  const float row_inv_var = stats.InvVariance(epsilon);
+
+  const __m256 v_row_mean = _mm256_set1_ps(row_mean);
+  const __m256 v_row_inv_var = _mm256_set1_ps(row_inv_var);
+  for (int64_t j = 0; j < vec_cols; j += kPackSize) {
+    __m256 normalized =
+        _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x + j), v_row_mean), v_row_inv_var);
+    if (do_scale && do_center) {
+      normalized =
+          _mm256_fmadd_ps(normalized, _mm256_loadu_ps(gamma + j), _mm256_loadu_ps(beta + j));
+    } else if (do_scale) {
+      normalized = _mm256_mul_ps(normalized, _mm256_loadu_ps(gamma + j));
+    } else if (do_center) {
+      normalized = _mm256_add_ps(normalized, _mm256_loadu_ps(beta + j));
+    }
+    _mm256_storeu_ps(y + j, normalized);
+  }
+  for (int64_t j = vec_cols; j < cols; ++j) {
+    float normalized = (x[j] - row_mean) * row_inv_var;
+    if (do_scale) { normalized *= gamma[j]; }
+    if (do_center) { normalized += beta[j]; }
+    y[j] = normalized;
+  }
+  *mean = row_mean;
+  *inv_variance = row_inv_var;
+}
+
+template<bool do_scale, bool do_add>
+OF_CPU_AVX2_TARGET void LayerNormGradRowAvx2(int64_t cols, const float* dy, const float* x,
+                                             float mean, float inv_variance, const float* gamma,
+                                             const float* add_to_output, float* dx) {
+  constexpr int64_t kPackSize = 8;
+  const int64_t vec_cols = cols / kPackSize * kPackSize;
+  const __m256 v_mean = _mm256_set1_ps(mean);
+  const __m256 v_inv_var = _mm256_set1_ps(inv_variance);
+  __m256 v_sum_stats1 = _mm256_setzero_ps();
+  __m256 v_sum_stats2 = _mm256_setzero_ps();
+  for (int64_t j = 0; j < vec_cols; j += kPackSize) {
+    __m256 scaled_dy = _mm256_loadu_ps(dy + j);
+    if (do_scale) { scaled_dy = _mm256_mul_ps(scaled_dy, _mm256_loadu_ps(gamma + j)); }
+    const __m256 normalized =
+        _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x + j), v_mean), v_inv_var);
+    v_sum_stats1 = _mm256_add_ps(v_sum_stats1, scaled_dy);
+    v_sum_stats2 = _mm256_fmadd_ps(scaled_dy, normalized, v_sum_stats2);
+  }
+  float sum_stats1 = ReduceSum256(v_sum_stats1);
+  float sum_stats2 = ReduceSum256(v_sum_stats2);
+  for (int64_t j = vec_cols; j < cols; ++j) {
+    const float scaled_dy = do_scale ? dy[j] * gamma[j] : dy[j];
+    sum_stats1 += scaled_dy;
+    sum_stats2 += scaled_dy * (x[j] - mean) * inv_variance;
+  }
+  const float fcols = static_cast<float>(cols);
+  const float inv_variance_over_cols = inv_variance / fcols;
+  const __m256 v_cols = _mm256_set1_ps(fcols);
+  const __m256 v_sum_stats1_b = _mm256_set1_ps(sum_stats1);
+  const __m256 v_sum_stats2_b = _mm256_set1_ps(sum_stats2);
+  const __m256 v_inv_variance_over_cols = _mm256_set1_ps(inv_variance_over_cols);
+  for (int64_t j = 0; j < vec_cols; j += kPackSize) {
+    __m256 scaled_dy = _mm256_loadu_ps(dy + j);
+    if (do_scale) { scaled_dy = _mm256_mul_ps(scaled_dy, _mm256_loadu_ps(gamma + j)); }
+    const __m256 normalized =
+        _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x + j), v_mean), v_inv_var);
+    __m256 v_dx = _mm256_fmsub_ps(v_cols, scaled_dy, v_sum_stats1_b);
+    v_dx = _mm256_fnmadd_ps(normalized, v_sum_stats2_b, v_dx);
+    v_dx = _mm256_mul_ps(v_dx, v_inv_variance_over_cols);
+    if (do_add) { v_dx = _mm256_add_ps(v_dx, _mm256_loadu_ps(add_to_output + j)); }
+    _mm256_storeu_ps(dx + j, v_dx);
+  }
+  for (int64_t j = vec_cols; j < cols; ++j) {
+    const float scaled_dy = do_scale ? dy[j] * gamma[j] : dy[j];
+    const float normalized = (x[j] - mean) * inv_variance;
+    float dx_j =
+        (fcols * scaled_dy - sum_stats1 - normalized * sum_stats2) * inv_variance_over_cols;
+    if (do_add) { dx_j += add_to_output[j]; }
+    dx[j] = dx_j;
+  }
+}
+
+#endif  // OF_CPU_X86_SIMD
+
+template<typename T, bool do_scale, bool do_center>
+struct LayerNormRowFunc {
+  using FuncType = void (*)(int64_t cols, double epsilon, const T* x, const T* gamma,
+                            const T* beta, T* y, T* mean, T* inv_variance);
+  static FuncType Get() { return &LayerNormRowScalar<T, do_scale, do_center>; }
+};
+
+template<bool do_scale, bool do_center>
+struct LayerNormRowFunc<float, do_scale, do_center> {
+  using FuncType = void (*)(int64_t cols, double epsilon, const float* x, const float* gamma,
+                            const float* beta, float* y, float* mean, float* inv_variance);
+  static FuncType Get() {
+#ifdef OF_CPU_X86_SIMD
+    if (ep::GetCpuIsa() >= ep::CpuIsa::kAvx2) { return &LayerNormRowAvx2<do_scale, do_center>; }
+#endif  // OF_CPU_X86_SIMD
+    return &LayerNormRowScalar<float, do_scale, do_center>;
+  }
+};
+
+template<typename T, bool do_scale, bool do_add>
+struct LayerNormGradRowFunc {
+  using FuncType = void (*)(int64_t cols, const T* dy, const T* x, T mean, T inv_variance,
+                            const T* gamma, const T* add_to_output, T* dx);
+  static FuncType Get() { return &LayerNormGradRowScalar<T, do_scale, do_add>; }
+};
+
+template<bool do_scale, bool do_add>
+struct LayerNormGradRowFunc<float, do_scale, do_add> {
+  using FuncType = void (*)(int64_t cols, const float* dy, const float* x, float mean,
+                            float inv_variance, const float* gamma, const float* add_to_output,
+                            float* dx);
+  static FuncType Get() {
+#ifdef OF_CPU_X86_SIMD
+    if (ep::GetCpuIsa() >= ep::CpuIsa::kAvx2) { return &LayerNormGradRowAvx2<do_scale, do_add>; }
+#endif  // OF_CPU_X86_SIMD
+    return &LayerNormGradRowScalar<float, do_scale, do_add>;
+  }
+};
+
+int64_t RowGrainSize(int64_t cols) { return std::max<int64_t>(kParallelGrainSize / cols, 1); }
+
+template<typename T, bool do_scale, bool do_center>
+void LayerNormForwardCpu(const int64_t num_instances, const int64_t norm_size,
+                         const double epsilon, const T* x_ptr, const T* gamma_ptr,
+                         const T* beta_ptr, T* y_ptr, T* mean_ptr, T* inv_variance_ptr) {
+  const auto RowFunc = LayerNormRowFunc<T, do_scale, do_center>::Get();
+  ep::CpuParallelFor(num_instances, RowGrainSize(norm_size), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const int64_t offset = i * norm_size;
+      RowFunc(norm_size, epsilon, x_ptr + offset, gamma_ptr, beta_ptr, y_ptr + offset,
+              mean_ptr + i, inv_variance_ptr + i);
+    }
+  });
+}
+
+template<typename T>
+void DispatchLayerNormForwardCpu(const int64_t num_instances, const int64_t norm_size,
+                                 const double epsilon, const T* x_ptr, const T* gamma_ptr,
+                                 const T* beta_ptr, T* y_ptr, T* mean_ptr, T* inv_variance_ptr) {
+  if (gamma_ptr != nullptr && beta_ptr != nullptr) {
+    LayerNormForwardCpu<T, true, true>(num_instances, norm_size, epsilon, x_ptr, gamma_ptr,
+                                       beta_ptr, y_ptr, mean_ptr, inv_variance_ptr);
+  } else if (gamma_ptr != nullptr && beta_ptr == nullptr) {
+    LayerNormForwardCpu<T, true, false>(num_instances, norm_size, epsilon, x_ptr, gamma_ptr,
+                                        beta_ptr, y_ptr, mean_ptr, inv_variance_ptr);
+  } else if (gamma_ptr == nullptr && beta_ptr != nullptr) {
+    LayerNormForwardCpu<T, false, true>(num_instances, norm_size, epsilon, x_ptr, gamma_ptr,
+                                        beta_ptr, y_ptr, mean_ptr, inv_variance_ptr);
+  } else {
+    LayerNormForwardCpu<T, false, false>(num_instances, norm_size, epsilon, x_ptr, gamma_ptr,
+                                         beta_ptr, y_ptr, mean_ptr, inv_variance_ptr);
+  }
+}
+
+template<typename T, bool do_scale, bool do_add>
+void LayerNormBackwardCpu(const int64_t num_instances, const int64_t norm_size, const T* dy_ptr,
+                          const T* x_ptr, const T* mean_ptr, const T* inv_variance_ptr,
+                          const T* gamma_ptr, const T* add_to_output_ptr, T* dx_ptr) {
+  const auto RowFunc = LayerNormGradRowFunc<T, do_scale, do_add>::Get();
+  ep::CpuParallelFor(num_instances, RowGrainSize(norm_size), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const int64_t offset = i * norm_size;
+      RowFunc(norm_size, dy_ptr + offset, x_ptr + offset, mean_ptr[i], inv_variance_ptr[i],
+              gamma_ptr, do_add ? add_to_output_ptr + offset : nullptr, dx_ptr + offset);
+    }
+  });
+}
+
+template<typename T>
+void LaunchLayerNormBackward(const int64_t num_instances, const int64_t norm_size,
+                             const T* dy_ptr, const T* x_ptr, const T* mean_ptr,
+                             const T* inv_variance_ptr, const T* gamma_ptr,
+                             const T* add_to_output_ptr, T* dx_ptr) {
+  if (gamma_ptr != nullptr && add_to_output_ptr != nullptr) {
+    LayerNormBackwardCpu<T, true, true>(num_instances, norm_size, dy_ptr, x_ptr, mean_ptr,
+                                        inv_variance_ptr, gamma_ptr, add_to_output_ptr, dx_ptr);
+  } else if (gamma_ptr != nullptr && add_to_output_ptr == nullptr) {
+    LayerNormBackwardCpu<T, true, false>(num_instances, norm_size, dy_ptr, x_ptr, mean_ptr,
+                                         inv_variance_ptr, gamma_ptr, add_to_output_ptr, dx_ptr);
+  } else if (gamma_ptr == nullptr && add_to_output_ptr != nullptr) {
+    LayerNormBackwardCpu<T, false, true>(num_instances, norm_size, dy_ptr, x_ptr, mean_ptr,
+                                         inv_variance_ptr, gamma_ptr, add_to_output_ptr, dx_ptr);
+  } else {
+    LayerNormBackwardCpu<T, false, false>(num_instances, norm_size, dy_ptr, x_ptr, mean_ptr,
+                                          inv_variance_ptr, gamma_ptr, add_to_output_ptr, dx_ptr);
+  }
+}
+
+// gamma_diff = sum(dy * normalized) and beta_diff = sum(dy) over the rows, either may be nullptr.
+template<typename T>
+void LayerNormParamGradCpu(const int64_t num_instances, const int64_t norm_size, const T* dy_ptr,
+                           const T* x_ptr, const T* mean_ptr, const T* inv_variance_ptr,
+                           T* gamma_diff_ptr, T* beta_diff_ptr) {
+  const int64_t num_chunks = std::max<int64_t>(
+      std::min(num_instances * norm_size / kParallelGrainSize,
+               std::min(num_instances, kMaxParamGradChunkNum)),
+      1);
+  // partial gamma_diff and beta_diff of every chunk
+  std::vector<T> partial_diff(num_chunks * 2 * norm_size, 0);
+  ep::CpuParallelFor(num_chunks, 1, [&](size_t begin, size_t end) {
+    for (size_t chunk = begin; chunk < end; ++chunk) {
+      T* partial_gamma_diff = partial_diff.data() + chunk * 2 * norm_size;
+      T* partial_beta_diff = partial_gamma_diff + norm_size;
+      const int64_t row_begin = num_instances * chunk / num_chunks;
+      const int64_t row_end = num_instances * (chunk + 1) / num_chunks;
+      for (int64_t i = row_begin; i < row_end; ++i) {
+        const T* dy = dy_ptr + i * norm_size;
+        const T* x = x_ptr + i * norm_size;
+        const T mean = mean_ptr[i];
+        const T inv_variance = inv_variance_ptr[i];
+        for (int64_t j = 0; j < norm_size; ++j) {
+          partial_gamma_diff[j] += dy[j] * (x[j] - mean) * inv_variance;
+          partial_beta_diff[j] += dy[j];
+        }
+      }
+    }
+  });
+  ep::CpuParallelFor(norm_size, kParallelGrainSize / num_chunks + 1, [&](size_t begin, size_t end) {
+    for (size_t j = begin; j < end; ++j) {
+      T gamma_diff = 0;
+      T beta_diff = 0;
+      for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+        gamma_diff += partial_diff[chunk * 2 * norm_size + j];
+        beta_diff += partial_diff[chunk * 2 * norm_size + norm_size + j];
+      }
+      if (gamma_diff_ptr != nullptr) { gamma_diff_ptr[j] = gamma_diff; }
+      if (beta_diff_ptr != nullptr) { beta_diff_ptr[j] = beta_diff; }
+    }
+  });
+}
+
+}  // namespace
+
 template<typename T>
 class LayerNormCpuKernel final : public user_op::OpKernel {
  public:
@@ -25,7 +379,27 @@ class LayerNormCpuKernel final : public user_op::OpKernel {
 
  private:
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
-  void Compute(user_op::KernelComputeContext* ctx) const override { TODO(); };
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
+    user_op::Tensor* y = ctx->Tensor4ArgNameAndIndex("y", 0);
+    user_op::Tensor* mean = ctx->Tensor4ArgNameAndIndex("mean", 0);
+    user_op::Tensor* inv_variance = ctx->Tensor4ArgNameAndIndex("inv_variance", 0);
+    const double epsilon = ctx->Attr<double>("epsilon");
+    const int64_t num_instances = mean->shape().elem_cnt();
+    if (num_instances == 0) { return; }
+    const int64_t norm_size = x->shape().elem_cnt() / num_instances;
+    const T* gamma_ptr = nullptr;
+    const T* beta_ptr = nullptr;
+    if (ctx->has_input("gamma", 0)) {
+      const user_op::Tensor* gamma = ctx->Tensor4ArgNameAndIndex("gamma", 0);
+      gamma_ptr = gamma->dptr<T>();
+      CHECK_EQ(gamma->shape().elem_cnt(), norm_size);
+    }
+    if (ctx->has_input("beta", 0)) { beta_ptr = ctx->Tensor4ArgNameAndIndex("beta", 0)->dptr<T>(); }
+    DispatchLayerNormForwardCpu<T>(num_instances, norm_size, epsilon, x->dptr<T>(), gamma_ptr,
+                                   beta_ptr, y->mut_dptr<T>(), mean->mut_dptr<T>(),
+                                   inv_variance->mut_dptr<T>());
+  };
 };
 
 #define REGISTER_LAYER_NORM_CPU_KERNEL(dtype)                         \
@@ -45,14 +419,45 @@ class LayerNormGradCpuKernel final : public user_op::OpKernel {
 
  private:
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
-  void Compute(user_op::KernelComputeContext* ctx) const override { TODO(); };
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* dy = ctx->Tensor4ArgNameAndIndex("dy", 0);
+    const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
+    const user_op::Tensor* mean = ctx->Tensor4ArgNameAndIndex("mean", 0);
+    const user_op::Tensor* inv_variance = ctx->Tensor4ArgNameAndIndex("inv_variance", 0);
+    user_op::Tensor* dx = ctx->Tensor4ArgNameAndIndex("dx", 0);
+    const int64_t num_instances = mean->shape().elem_cnt();
+    if (num_instances == 0) { return; }
+    const int64_t norm_size = x->shape().elem_cnt() / num_instances;
+    const T* gamma_ptr = nullptr;
+    if (ctx->has_input("gamma", 0)) {
+      gamma_ptr = ctx->Tensor4ArgNameAndIndex("gamma", 0)->dptr<T>();
+    }
+    const T* add_to_output_ptr = nullptr;
+    if (ctx->has_input("_add_to_output", 0)) {
+      const user_op::Tensor* add_to_output = ctx->Tensor4ArgNameAndIndex("_add_to_output", 0);
+      CHECK_EQ(add_to_output->data_type(), dx->data_type());
+      CHECK_EQ(add_to_output->shape(), dx->shape());
+      add_to_output_ptr = add_to_output->dptr<T>();
+    }
+    LaunchLayerNormBackward<T>(num_instances, norm_size, dy->dptr<T>(), x->dptr<T>(),
+                               mean->dptr<T>(), inv_variance->dptr<T>(), gamma_ptr,
+                               add_to_output_ptr, dx->mut_dptr<T>());
+  };
 };
 
-#define REGISTER_LAYER_NORM_GRAD_CPU_KERNEL(dtype)                    \
-  REGISTER_USER_KERNEL("layer_norm_grad")                             \
-      .SetCreateFn<LayerNormGradCpuKernel<dtype>>()                   \
-      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kCPU) \
-                       && (user_op::HobDataType("dy", 0) == GetDataType<dtype>::value));
+#define REGISTER_LAYER_NORM_GRAD_CPU_KERNEL(dtype)                                         \
+  REGISTER_USER_KERNEL("layer_norm_grad")                                                  \
+      .SetCreateFn<LayerNormGradCpuKernel<dtype>>()                                        \
+      .SetIsMatchedHob((user_op::HobDeviceType() == DeviceType::kCPU)                      \
+                       && (user_op::HobDataType("dy", 0) == GetDataType<dtype>::value))    \
+      .SetInplaceProposalFn(                                                               \
+          [](const user_op::InferContext& ctx,                                             \
+             const user_op::AddInplaceArgPair& AddInplaceArgPairFn) -> Maybe<void> {       \
+            if (ctx.has_input("_add_to_output", 0)) {                                      \
+              OF_RETURN_IF_ERROR(AddInplaceArgPairFn("dx", 0, "_add_to_output", 0, true)); \
+            }                                                                              \
+            return Maybe<void>::Ok();                                                      \
+          });
 
 REGISTER_LAYER_NORM_GRAD_CPU_KERNEL(float)
 REGISTER_LAYER_NORM_GRAD_CPU_KERNEL(double)
@@ -65,7 +470,26 @@ class LayerNormParamGradCpuKernel final : public user_op::OpKernel {
 
  private:
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
-  void Compute(user_op::KernelComputeContext* ctx) const override { TODO(); };
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* dy = ctx->Tensor4ArgNameAndIndex("dy", 0);
+    const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
+    const user_op::Tensor* mean = ctx->Tensor4ArgNameAndIndex("mean", 0);
+    const user_op::Tensor* inv_variance = ctx->Tensor4ArgNameAndIndex("inv_variance", 0);
+    const int64_t num_instances = mean->shape().elem_cnt();
+    const int64_t norm_size = x->shape().Count(ctx->Attr<int64_t>("begin_params_axis"));
+    T* gamma_diff_ptr = nullptr;
+    T* beta_diff_ptr = nullptr;
+    if (ctx->has_output("gamma_diff", 0)) {
+      gamma_diff_ptr = ctx->Tensor4ArgNameAndIndex("gamma_diff", 0)->mut_dptr<T>();
+    }
+    if (ctx->has_output("beta_diff", 0)) {
+      beta_diff_ptr = ctx->Tensor4ArgNameAndIndex("beta_diff", 0)->mut_dptr<T>();
+    }
+    if (norm_size == 0) { return; }
+    LayerNormParamGradCpu<T>(num_instances, norm_size, dy->dptr<T>(), x->dptr<T>(),
+                             mean->dptr<T>(), inv_variance->dptr<T>(), gamma_diff_ptr,
+                             beta_diff_ptr);
+  };
 };
 
 #define REGISTER_LAYER_NORM_PARAM_GRAD_CPU_KERNEL(dtype)              \
@@ -427,6 +427,7 @@ Maybe<void> StatefulLocalOpKernel::ChooseOpKernel(
     EagerBlobObjectListRawPtr inputs, EagerBlobObjectListRawPtr outputs,
     ConsistentTensorInferResultRawPtr consistent_tensor_infer_result) {
   OF_PROFILER_RANGE_GUARD("ChooseOpKernel");
+  std::unique_lock<std::mutex> lock(choose_kernel_mutex_);
   reg_ctx_->Update(attrs, inputs, outputs, consistent_tensor_infer_result);
 
   DataType primary_dtype = kInvalidDataType;
@@ -493,6 +494,7 @@ void StatefulLocalOpKernel::TryInitOpKernelStateAndCache(
 
 const user_op::InferTmpSizeFn& StatefulLocalOpKernel::GetInferTmpSizeFn(
     const user_op::OpKernel* op_kernel) const {
+  std::unique_lock<std::mutex> lock(choose_kernel_mutex_);
   return *infer_tmp_size_fn_map_.at(op_kernel);
 }
 
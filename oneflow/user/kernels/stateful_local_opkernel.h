@@ -466,6 +466,9 @@ class StatefulLocalOpKernel final {
   HashMap<const user_op::OpKernel*, std::shared_ptr<user_op::OpKernelState>> op_kernel_state_map_;
   HashMap<const user_op::OpKernel*, std::shared_ptr<user_op::OpKernelCache>> op_kernel_cache_map_;
   HashMap<const user_op::OpKernel*, const user_op::InferTmpSizeFn*> infer_tmp_size_fn_map_;
+  // Guards reg_ctx_, dtype2cached_kernels_ and infer_tmp_size_fn_map_. The kernel of an op expr
+  // is shared by all the threads dispatching it, e.g. the eager backward threads.
+  mutable std::mutex choose_kernel_mutex_;
   std::unique_ptr<vm::EagerBlobObject> tmp_blob_object_;
   std::vector<int64_t> input_tuple_indexes4const_ibns_;
   std::vector<int64_t> input_tuple_indexes4mut_ibns_;
@@ -249,6 +249,8 @@ def atexit_hook(hook):
                 oneflow._oneflow_internal.eager.multi_client.Sync()
             elif oneflow.env.get_rank() == 0:
                 oneflow._oneflow_internal.eager.single_client.Sync()
+        # files of asynchronous saves are finished before the env is destroyed
+        oneflow._oneflow_internal.async_snapshot.wait_all()
     oneflow.framework.session_context.TryCloseDefaultSession()
     if hook.is_normal_exit():
         oneflow._oneflow_internal.DestroyEnv()
@@ -104,19 +104,39 @@ class FileBackendVariableBlob:
         ).reshape(self.shape)
 
 
-def _save_tensor_to_disk(tensor: "oneflow.Tensor", dir_name: Union[str, Path]) -> None:
-    os.makedirs(dir_name, exist_ok=True)
+def _async_write_file(root: Path, path: Path, data: Union[bytes, np.ndarray]) -> None:
+    if isinstance(data, bytes):
+        data = np.frombuffer(data, dtype=np.uint8)
+    oneflow._oneflow_internal.async_snapshot.write(
+        str(root), str(Path(path).relative_to(root)), np.ascontiguousarray(data)
+    )
+
+
+def _save_tensor_to_disk(
+    tensor: "oneflow.Tensor",
+    dir_name: Union[str, Path],
+    async_write_root: Optional[Path] = None,
+) -> None:
     meta_info = variable_meta_info_pb.VariableMetaInfo()
     meta_info.shape.dim[:] = tensor.shape
     meta_info.data_type = oneflow._oneflow_internal.deprecated.GetProtoDtype4OfDtype(
         tensor.dtype
     )
     data_path = os.path.join(dir_name, DATA_FILENAME)
+    meta_info_path = os.path.join(dir_name, META_INFO_FILENAME)
+    meta_info_str = text_format.MessageToString(meta_info)
+    if async_write_root is not None:
+        # tensor.numpy() is the host copy, the files are written in background
+        _async_write_file(async_write_root, data_path, tensor.numpy())
+        _async_write_file(async_write_root, meta_info_path, meta_info_str.encode())
+        return
+
+    os.makedirs(dir_name, exist_ok=True)
     with open(data_path, "wb") as f:
         f.write(tensor.numpy().tobytes())
 
-    with open(os.path.join(dir_name, META_INFO_FILENAME), "w") as f:
-        f.write(text_format.MessageToString(meta_info))
+    with open(meta_info_path, "w") as f:
+        f.write(meta_info_str)
 
 
 ValueContainer = Union[FileBackendVariableBlob, np.ndarray, "oneflow.Tensor"]
@@ -179,7 +199,9 @@ def tensor_getstate(self):
             consistent_src_dsk_rank is None
             or consistent_src_dsk_rank == flow.env.get_rank()
         ):
-            _save_tensor_to_disk(tensor, abs_dir_name)
+            _save_tensor_to_disk(
+                tensor, abs_dir_name, save_load_path if save_async_write else None,
+            )
 
         return {"path": rel_dir_name}
     else:
@@ -235,16 +257,21 @@ def legacy_load(
 
 
 @contextmanager
-def tensor_pickling_context(path: Path, consistent_src_dst_rank: int):
+def tensor_pickling_context(
+    path: Path, consistent_src_dst_rank: int, async_write: bool = False
+):
     global save_load_path
     global consistent_src_dsk_rank
+    global save_async_write
     consistent_src_dsk_rank = consistent_src_dst_rank
     save_load_path = path
+    save_async_write = async_write
     try:
         yield
     finally:
         consistent_src_dsk_rank = None
         save_load_path = None
+        save_async_write = False
 
 
 def load(path: str, consistent_src_rank: Optional[int] = None,) -> Any:
@@ -291,7 +318,10 @@ def load(path: str, consistent_src_rank: Optional[int] = None,) -> Any:
 
 
 def save(
-    obj: Any, path: Union[str, Path], consistent_dst_rank: Optional[int] = None,
+    obj: Any,
+    path: Union[str, Path],
+    consistent_dst_rank: Optional[int] = None,
+    async_write: bool = False,
 ) -> None:
     r"""Save an object to a directory.
 
@@ -303,8 +333,15 @@ def save(
             will be saved by the process whose rank == 
             consistent_src_rank, while other processes will not do any
             disk I/O.
+        async_write (bool, optional): Return once the tensors are copied
+            to host memory and write the files in background. A
+            "snapshot_done" manifest is renamed into `path` when all the
+            files are synced, see :func:`wait_save` and :func:`is_save_done`.
     """
     path: Path = Path(path)
+    if async_write:
+        # an earlier async save to the same path is finished first
+        wait_save(path)
 
     if isinstance(obj, graph_util.Graph):
         graph: graph_util.Graph = obj
@@ -317,19 +354,51 @@ def save(
         oneflow._oneflow_internal.nn.graph.SaveJobToIR(serialized_job, str(path))
 
         for x in graph._state():
-            _save_tensor_to_disk(x.origin, path / f"{x.name_prefix}{x.name}")
+            _save_tensor_to_disk(
+                x.origin,
+                path / f"{x.name_prefix}{x.name}",
+                path if async_write else None,
+            )
+        if async_write:
+            oneflow._oneflow_internal.async_snapshot.close(
+                str(path), SNAPSHOT_DONE_FILENAME
+            )
 
         return
 
     obj = {"protocol_version": PROTOCOL_VERSION, "data": obj}
-    with tensor_pickling_context(path, consistent_dst_rank):
+    with tensor_pickling_context(path, consistent_dst_rank, async_write):
         pickled_bytes = pickle.dumps(obj)
     rank = flow.env.get_rank()
     if consistent_dst_rank is None or consistent_dst_rank == rank:
         path.mkdir(exist_ok=True)
         pickle_path = path / PICKLE_FILENAME
-        pickle_path.write_bytes(pickled_bytes)
+        if async_write:
+            _async_write_file(path, pickle_path, pickled_bytes)
+            oneflow._oneflow_internal.async_snapshot.close(
+                str(path), SNAPSHOT_DONE_FILENAME
+            )
+        else:
+            pickle_path.write_bytes(pickled_bytes)
+
+
+def wait_save(path: Optional[Union[str, Path]] = None) -> None:
+    r"""Waits for the files of :func:`save` with `async_write=True` to `path`, or
+    of all the asynchronous saves if `path` is None.
+    """
+    if path is None:
+        oneflow._oneflow_internal.async_snapshot.wait_all()
+    else:
+        oneflow._oneflow_internal.async_snapshot.wait(str(Path(path)))
+
+
+def is_save_done(path: Union[str, Path]) -> bool:
+    r"""Returns True if no file of :func:`save` with `async_write=True` to `path`
+    is still being written.
+    """
+    return oneflow._oneflow_internal.async_snapshot.is_done(str(Path(path)))
 
 
 save_load_path = None
 consistent_src_dsk_rank = None
+save_async_write = False
@@ -0,0 +1,96 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+
+import numpy as np
+
+import oneflow as flow
+import oneflow.core.job.plan_pb2 as plan_pb
+import oneflow.unittest
+
+# _WIDTH independent chains of _DEPTH cheap ops, so every topological level of the task
+# graph holds _WIDTH nodes and the parallel build has something to split.
+_WIDTH = 8
+_DEPTH = 8
+_PARALLEL_BUILD_ENV = "ONEFLOW_COMPILER_PARALLEL_BUILD"
+# Ids come from process wide counters, each build runs in a fresh child process so
+# that both plans start from the same ids.
+_DUMP_PATH_ENV = "ONEFLOW_TEST_COMPILE_DUMP_PATH"
+
+
+class _SyntheticGraph(flow.nn.Graph):
+    def build(self, x):
+        outs = []
+        for branch in range(_WIDTH):
+            y = x + branch
+            for _ in range(_DEPTH):
+                y = flow.relu(y * 0.5 + 1)
+            outs.append(y)
+        return flow.cat(outs, dim=1)
+
+
+def _build_in_subprocess(test_case, parallel_build, dump_path):
+    env = dict(os.environ)
+    env[_PARALLEL_BUILD_ENV] = "1" if parallel_build else "0"
+    env[_DUMP_PATH_ENV] = dump_path
+    result = subprocess.run(
+        [sys.executable, os.path.abspath(__file__), "TestGraphCompileDump"], env=env
+    )
+    test_case.assertEqual(result.returncode, 0)
+    plan = plan_pb.Plan()
+    with open(dump_path + ".plan", "rb") as f:
+        plan.ParseFromString(f.read())
+    # tasks, mem blocks and chunks are appended by the worker threads in any order
+    plan.task.sort(key=lambda task: task.task_id)
+    plan.block_chunk_list.mem_block.sort(key=lambda block: block.mem_block_id)
+    plan.block_chunk_list.chunk.sort(key=lambda chunk: chunk.chunk_id)
+    return plan, np.load(dump_path + ".npy")
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestGraphParallelBuild(oneflow.unittest.TestCase):
+    def test_parallel_build_matches_serial_build(test_case):
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            serial_plan, serial_out = _build_in_subprocess(
+                test_case, False, os.path.join(tmp_dir, "serial")
+            )
+            parallel_plan, parallel_out = _build_in_subprocess(
+                test_case, True, os.path.join(tmp_dir, "parallel")
+            )
+        test_case.assertEqual(len(serial_plan.task), len(parallel_plan.task))
+        test_case.assertEqual(serial_plan, parallel_plan)
+        test_case.assertTrue(np.array_equal(serial_out, parallel_out))
+
+
+@flow.unittest.skip_unless_1n1d()
+@unittest.skipUnless(os.getenv(_DUMP_PATH_ENV), "run by TestGraphParallelBuild")
+class TestGraphCompileDump(oneflow.unittest.TestCase):
+    def test_dump_plan_and_output(test_case):
+        dump_path = os.environ[_DUMP_PATH_ENV]
+        x = flow.tensor(np.arange(32, dtype=np.float32).reshape(4, 8) / 32)
+        graph = _SyntheticGraph()
+        out = graph(x).numpy()
+        with open(dump_path + ".plan", "wb") as f:
+            f.write(graph._c_nn_graph.serialized_plan)
+        np.save(dump_path + ".npy", out)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,130 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+
+import numpy as np
+
+import oneflow as flow
+import oneflow.unittest
+
+# Covers recursive doubling (<= 64KB), a single ring sub-chunk and several ring sub-chunks
+# with the default ONEFLOW_CCL_CPU_RECURSIVE_DOUBLING_MAX_BYTES and
+# ONEFLOW_CCL_CPU_RING_CHUNK_BYTES.
+_ELEM_CNTS = [1, 7, 4093, 65537, 1 << 20, (3 << 20) + 5]
+_REDUCE_FUNCS = {
+    "max": np.maximum.reduce,
+    "min": np.minimum.reduce,
+    "prod": np.multiply.reduce,
+}
+
+
+def _rank_input(elem_cnt, rank):
+    return np.arange(elem_cnt, dtype=np.float32) % 97 + rank
+
+
+def _all_reduce(test_case, elem_cnt, world_size):
+    rank = flow.env.get_rank()
+    tensor = flow.tensor(_rank_input(elem_cnt, rank))
+    flow.comm.all_reduce(tensor)
+    expected = sum(_rank_input(elem_cnt, r) for r in range(world_size))
+    test_case.assertTrue(np.allclose(tensor.numpy(), expected))
+
+
+def _reduce_scatter_and_all_gather(test_case, elem_cnt, world_size):
+    rank = flow.env.get_rank()
+    placement = flow.env.all_device_placement("cpu")
+    x = flow.tensor(_rank_input(elem_cnt * world_size, rank)).to_consistent(
+        placement=placement, sbp=flow.sbp.partial_sum
+    )
+    # partial_sum -> split(0) is a reduce-scatter, split(0) -> broadcast is an all-gather.
+    y = x.to_consistent(placement=placement, sbp=flow.sbp.split(0))
+    z = y.to_consistent(placement=placement, sbp=flow.sbp.broadcast)
+    expected = sum(_rank_input(elem_cnt * world_size, r) for r in range(world_size))
+    test_case.assertTrue(
+        np.allclose(
+            y.to_local().numpy(), expected[rank * elem_cnt : (rank + 1) * elem_cnt]
+        )
+    )
+    test_case.assertTrue(np.allclose(z.to_local().numpy(), expected))
+
+
+def _small_rank_input(elem_cnt, rank):
+    # small values keep the products exact, the largest value moves between the ranks
+    return (np.arange(elem_cnt, dtype=np.float32) + rank * 3) % 5 + 1
+
+
+def _reduce_scatter_by_op(test_case, elem_cnt, world_size, op_type):
+    rank = flow.env.get_rank()
+    placement = flow.env.all_device_placement("cpu")
+    # the local data of each rank differs, the broadcast -> split(0) reduce-scatter
+    # reduces them with op_type
+    x = flow.tensor(_small_rank_input(elem_cnt * world_size, rank)).to_consistent(
+        placement=placement, sbp=flow.sbp.broadcast
+    )
+    y = flow._C.consistent_reduce_scatter(x, op_type)
+    expected = _REDUCE_FUNCS[op_type](
+        [_small_rank_input(elem_cnt * world_size, r) for r in range(world_size)]
+    )
+    test_case.assertTrue(
+        np.array_equal(
+            y.to_local().numpy(), expected[rank * elem_cnt : (rank + 1) * elem_cnt]
+        )
+    )
+
+
+@flow.unittest.skip_unless_1n4d()
+class TestCpuRingCollective(flow.unittest.TestCase):
+    def test_all_reduce(test_case):
+        for elem_cnt in _ELEM_CNTS:
+            _all_reduce(test_case, elem_cnt, flow.env.get_world_size())
+
+    def test_reduce_scatter_and_all_gather(test_case):
+        for elem_cnt in _ELEM_CNTS:
+            _reduce_scatter_and_all_gather(
+                test_case, elem_cnt, flow.env.get_world_size()
+            )
+
+    def test_reduce_scatter_max_min_prod(test_case):
+        for op_type in _REDUCE_FUNCS:
+            for elem_cnt in _ELEM_CNTS:
+                _reduce_scatter_by_op(
+                    test_case, elem_cnt, flow.env.get_world_size(), op_type
+                )
+
+
+@flow.unittest.skip_unless_1n2d()
+class TestCpuRingCollective2Ranks(flow.unittest.TestCase):
+    def test_all_reduce(test_case):
+        for elem_cnt in _ELEM_CNTS:
+            _all_reduce(test_case, elem_cnt, flow.env.get_world_size())
+
+    def test_reduce_scatter_and_all_gather(test_case):
+        for elem_cnt in _ELEM_CNTS:
+            _reduce_scatter_and_all_gather(
+                test_case, elem_cnt, flow.env.get_world_size()
+            )
+
+    def test_reduce_scatter_max_min_prod(test_case):
+        for op_type in _REDUCE_FUNCS:
+            for elem_cnt in _ELEM_CNTS:
+                _reduce_scatter_by_op(
+                    test_case, elem_cnt, flow.env.get_world_size(), op_type
+                )
+
+
+if __name__ == "__main__":
+    unittest.main()
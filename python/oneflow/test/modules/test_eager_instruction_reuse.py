@@ -0,0 +1,55 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+
+import numpy as np
+
+import oneflow as flow
+import oneflow.unittest
+
+_CHAIN_OPS = 20000
+_SYNC_INTERVAL = 997
+
+
+def _run_chain(x, op_num):
+    for _ in range(op_num):
+        x = x + 1
+    return x
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestEagerInstructionReuse(flow.unittest.TestCase):
+    def test_tiny_cpu_op_chain(test_case):
+        # Instructions and their messages are recycled once an op is done, a long chain
+        # of tiny ops reuses them many times while the earlier ones are still in flight.
+        x = _run_chain(flow.zeros(1, dtype=flow.float32), _CHAIN_OPS)
+        test_case.assertTrue(
+            np.array_equal(x.numpy(), np.array([_CHAIN_OPS], dtype=np.float32))
+        )
+
+    def test_tiny_cpu_op_chain_with_syncs(test_case):
+        # the syncs drain the virtual machine, so the next ops start from a full pool
+        x = flow.zeros(1, dtype=flow.float32)
+        expected = 0
+        for _ in range(_CHAIN_OPS // _SYNC_INTERVAL):
+            x = _run_chain(x, _SYNC_INTERVAL)
+            expected += _SYNC_INTERVAL
+            test_case.assertEqual(x.numpy()[0], expected)
+
+
+if __name__ == "__main__":
+    unittest.main()
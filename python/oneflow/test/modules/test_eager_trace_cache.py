@@ -0,0 +1,97 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+
+import numpy as np
+
+import oneflow as flow
+import oneflow.unittest
+
+_eager_trace = flow._oneflow_internal.eager_trace
+
+
+def _run_region(key, x, w):
+    _eager_trace.begin_region(key)
+    try:
+        y = flow.relu(flow.matmul(x, w)) + 1
+    finally:
+        _eager_trace.end_region()
+    return y
+
+
+def _expected(x, w):
+    return np.maximum(np.matmul(x, w), 0) + 1
+
+
+def _stats_delta(before):
+    after = _eager_trace.stats()
+    return {k: after[k] - before[k] for k in after}
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestEagerTraceCache(flow.unittest.TestCase):
+    def test_replay_with_fresh_inputs(test_case):
+        _eager_trace.clear()
+        before = _eager_trace.stats()
+        w_np = np.random.randn(8, 4).astype(np.float32)
+        w = flow.tensor(w_np)
+        for _ in range(3):
+            x_np = np.random.randn(2, 8).astype(np.float32)
+            y = _run_region("replay_with_fresh_inputs", flow.tensor(x_np), w)
+            test_case.assertEqual(tuple(y.shape), (2, 4))
+            test_case.assertTrue(
+                np.allclose(y.numpy(), _expected(x_np, w_np), 1e-4, 1e-4)
+            )
+        delta = _stats_delta(before)
+        test_case.assertEqual(delta["region_miss_num"], 1)
+        test_case.assertEqual(delta["region_hit_num"], 2)
+        test_case.assertEqual(delta["op_hit_num"], 2 * delta["op_miss_num"])
+        test_case.assertEqual(delta["invalidation_num"], 0)
+
+    def test_invalidate_on_shape_change(test_case):
+        _eager_trace.clear()
+        w_np = np.random.randn(8, 4).astype(np.float32)
+        w = flow.tensor(w_np)
+        _run_region("invalidate_on_shape_change", flow.randn(2, 8), w)
+        before = _eager_trace.stats()
+        x_np = np.random.randn(5, 8).astype(np.float32)
+        y = _run_region("invalidate_on_shape_change", flow.tensor(x_np), w)
+        test_case.assertEqual(tuple(y.shape), (5, 4))
+        test_case.assertTrue(np.allclose(y.numpy(), _expected(x_np, w_np), 1e-4, 1e-4))
+        delta = _stats_delta(before)
+        test_case.assertEqual(delta["invalidation_num"], 1)
+        test_case.assertEqual(delta["region_miss_num"], 1)
+        test_case.assertEqual(delta["op_hit_num"], 0)
+        # the region is recorded again with the new shapes
+        before = _eager_trace.stats()
+        _run_region("invalidate_on_shape_change", flow.tensor(x_np), w)
+        _run_region("invalidate_on_shape_change", flow.tensor(x_np), w)
+        delta = _stats_delta(before)
+        test_case.assertEqual(delta["region_miss_num"], 1)
+        test_case.assertEqual(delta["region_hit_num"], 1)
+
+    def test_unbalanced_region(test_case):
+        _eager_trace.begin_region("unbalanced_region")
+        with test_case.assertRaises(Exception):
+            _eager_trace.begin_region("unbalanced_region")
+        _eager_trace.end_region()
+        with test_case.assertRaises(Exception):
+            _eager_trace.end_region()
+
+
+if __name__ == "__main__":
+    unittest.main()
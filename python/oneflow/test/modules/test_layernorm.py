@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 """
 
+import os
 import unittest
 from collections import OrderedDict
 
@@ -126,6 +127,22 @@ def _test_layernorm_backward(test_case, device):
     )
 
 
+def _test_layernorm_cpu_matches_cuda(test_case, shape, begin_norm_axis):
+    x_arr = np.random.randn(*shape).astype(np.float32)
+    dy_arr = np.random.randn(*shape).astype(np.float32)
+    results = []
+    for device in ["cpu", "cuda"]:
+        x = flow.tensor(x_arr, device=flow.device(device), requires_grad=True)
+        m = flow.nn.LayerNorm(shape[begin_norm_axis:]).to(device=flow.device(device))
+        y = m(x)
+        y.backward(flow.tensor(dy_arr, device=flow.device(device)))
+        results.append(
+            [y.numpy(), x.grad.numpy(), m.weight.grad.numpy(), m.bias.grad.numpy()]
+        )
+    for cpu_result, cuda_result in zip(*results):
+        test_case.assertTrue(np.allclose(cpu_result, cuda_result, 1e-4, 1e-4))
+
+
 @flow.unittest.skip_unless_1n1d()
 class TestLayerNorm(flow.unittest.TestCase):
     def test_layernorm(test_case):
@@ -221,6 +238,14 @@ class TestLayerNorm(flow.unittest.TestCase):
         y = m(x)
         return y
 
+    @unittest.skipIf(os.getenv("ONEFLOW_TEST_CPU_ONLY"), "only test cpu cases")
+    def test_layernorm_cpu_matches_cuda(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["shape"] = [(4, 7), (16, 768), (3, 2, 1031), (64, 8192)]
+        arg_dict["begin_norm_axis"] = [1]
+        for arg in GenArgList(arg_dict):
+            _test_layernorm_cpu_matches_cuda(test_case, *arg)
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -201,6 +201,26 @@ class TestModule(flow.unittest.TestCase):
         res2 = m()
         test_case.assertTrue(np.array_equal(res1.numpy(), res2.numpy()))
 
+    @flow.unittest.skip_unless_1n1d()
+    def test_async_save_state_dict(test_case):
+        m = flow.nn.Linear(1024, 512)
+        res1 = m(flow.ones(4, 1024))
+        with tempfile.TemporaryDirectory() as save_dir:
+            flow.save(m.state_dict(), save_dir, async_write=True)
+            # the tensors are copied, updating them does not change the snapshot
+            with flow.no_grad():
+                m.weight.fill_(0)
+            flow.framework.check_point_v2.wait_save(save_dir)
+            test_case.assertTrue(flow.framework.check_point_v2.is_save_done(save_dir))
+            with open(os.path.join(save_dir, "snapshot_done")) as fp:
+                manifest = fp.read().split("\n")
+            test_case.assertTrue(
+                any(line.startswith("pickled_data ") for line in manifest)
+            )
+            m.load_state_dict(flow.load(save_dir))
+        res2 = m(flow.ones(4, 1024))
+        test_case.assertTrue(np.array_equal(res1.numpy(), res2.numpy()))
+
     @flow.unittest.skip_unless_1n2d()
     def test_save_and_load_consistent_from_nested_dict(test_case):
         class CustomModule(flow.nn.Module):
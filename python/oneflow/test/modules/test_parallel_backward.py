@@ -0,0 +1,135 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+
+import numpy as np
+
+import oneflow as flow
+import oneflow.unittest
+
+_BRANCH_NUM = 8
+# Read once on the first backward of a process, the checks run in a child process that
+# has it set instead of changing it for the other tests of this process.
+_THREAD_NUM_ENV = "ONEFLOW_AUTOGRAD_BACKWARD_THREAD_NUM"
+# The child reads its inputs from this directory and saves its gradients there
+_DUMP_DIR_ENV = "ONEFLOW_TEST_PARALLEL_BACKWARD_DUMP_DIR"
+
+
+def _branchy_loss(x, weights):
+    # independent branches, each of them is a chain of a few backward nodes
+    return sum([(flow.matmul(x, w).relu() * 2).sum() for w in weights])
+
+
+def _branchy_x_grad(x_np, w_nps):
+    x = flow.tensor(x_np, requires_grad=True)
+    weights = [flow.tensor(w_np) for w_np in w_nps]
+    _branchy_loss(x, weights).backward()
+    return x.grad.numpy()
+
+
+def _expected_x_grad(x_np, w_nps):
+    grad = np.zeros_like(x_np)
+    for w_np in w_nps:
+        mask = (np.matmul(x_np, w_np) > 0).astype(np.float32)
+        grad += np.matmul(mask * 2, w_np.T)
+    return grad
+
+
+@flow.unittest.skip_unless_1n1d()
+@unittest.skipIf(os.getenv(_THREAD_NUM_ENV), "the serial reference needs thread num 0")
+class TestParallelBackwardInSubprocess(flow.unittest.TestCase):
+    def test_parallel_backward(test_case):
+        x_np = np.random.randn(16, 32).astype(np.float32)
+        w_nps = [np.random.randn(32, 32).astype(np.float32) for _ in range(_BRANCH_NUM)]
+        with tempfile.TemporaryDirectory() as dump_dir:
+            np.savez(os.path.join(dump_dir, "inputs.npz"), x_np, *w_nps)
+            env = dict(os.environ)
+            env[_THREAD_NUM_ENV] = "4"
+            env[_DUMP_DIR_ENV] = dump_dir
+            result = subprocess.run(
+                [sys.executable, os.path.abspath(__file__), "TestParallelBackward"],
+                env=env,
+            )
+            test_case.assertEqual(result.returncode, 0)
+            parallel_x_grad = np.load(os.path.join(dump_dir, "x_grad.npy"))
+        # this process runs the backward serially, the parallel gradients are
+        # accumulated in the same order so they match bit for bit
+        test_case.assertTrue(
+            np.array_equal(parallel_x_grad, _branchy_x_grad(x_np, w_nps))
+        )
+
+
+@flow.unittest.skip_unless_1n1d()
+@unittest.skipUnless(
+    os.getenv(_THREAD_NUM_ENV), "run by TestParallelBackwardInSubprocess"
+)
+class TestParallelBackward(flow.unittest.TestCase):
+    def test_independent_branches(test_case):
+        x_np = np.random.randn(16, 32).astype(np.float32)
+        w_nps = [np.random.randn(32, 32).astype(np.float32) for _ in range(_BRANCH_NUM)]
+        x = flow.tensor(x_np, requires_grad=True)
+        weights = [flow.tensor(w_np, requires_grad=True) for w_np in w_nps]
+        _branchy_loss(x, weights).backward()
+        test_case.assertTrue(
+            np.allclose(x.grad.numpy(), _expected_x_grad(x_np, w_nps), 1e-4, 1e-4)
+        )
+        for w, w_np in zip(weights, w_nps):
+            mask = (np.matmul(x_np, w_np) > 0).astype(np.float32)
+            test_case.assertTrue(
+                np.allclose(w.grad.numpy(), np.matmul(x_np.T, mask * 2), 1e-4, 1e-4)
+            )
+
+    def test_deterministic_accumulation(test_case):
+        dump_dir = os.environ[_DUMP_DIR_ENV]
+        inputs = np.load(os.path.join(dump_dir, "inputs.npz"))
+        x_np = inputs["arr_0"]
+        w_nps = [inputs["arr_{}".format(i + 1)] for i in range(_BRANCH_NUM)]
+        grads = [_branchy_x_grad(x_np, w_nps) for _ in range(3)]
+        for grad in grads[1:]:
+            test_case.assertTrue(np.array_equal(grad, grads[0]))
+        # compared with the serial backward by TestParallelBackwardInSubprocess
+        np.save(os.path.join(dump_dir, "x_grad.npy"), grads[0])
+
+    def test_retain_graph(test_case):
+        x_np = np.random.randn(16, 32).astype(np.float32)
+        w_nps = [np.random.randn(32, 32).astype(np.float32) for _ in range(_BRANCH_NUM)]
+        x = flow.tensor(x_np, requires_grad=True)
+        loss = _branchy_loss(x, [flow.tensor(w_np) for w_np in w_nps])
+        loss.backward(retain_graph=True)
+        loss.backward()
+        test_case.assertTrue(
+            np.allclose(x.grad.numpy(), 2 * _expected_x_grad(x_np, w_nps), 1e-4, 1e-4)
+        )
+
+    def test_create_graph(test_case):
+        x_np = np.random.randn(4, 5).astype(np.float32)
+        x = flow.tensor(x_np, requires_grad=True)
+        y = (x * x * x).sum() + (x * x).sum()
+        (dx,) = flow.autograd.grad(y, x, create_graph=True)
+        test_case.assertTrue(
+            np.allclose(dx.numpy(), 3 * x_np ** 2 + 2 * x_np, 1e-4, 1e-4)
+        )
+        dx.sum().backward()
+        test_case.assertTrue(np.allclose(x.grad.numpy(), 6 * x_np + 2, 1e-4, 1e-4))
+
+
+if __name__ == "__main__":
+    unittest.main()